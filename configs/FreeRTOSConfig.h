@@ -250,6 +250,12 @@ extern void vApplicationSleep( uint32_t xExpectedIdleTime );
 #define portSUPPRESS_TICKS_AND_SLEEP( xIdleTime ) vApplicationSleep( xIdleTime )
 #define configUSE_TICKLESS_IDLE                 2
 
+/* Account the time spent in tickless idle, see source/power_stats.c */
+extern void power_stats_idle_enter( void );
+extern void power_stats_idle_exit( void );
+#define traceLOW_POWER_IDLE_BEGIN()             power_stats_idle_enter()
+#define traceLOW_POWER_IDLE_END()               power_stats_idle_exit()
+
 #else
 #define configUSE_TICKLESS_IDLE                 0
 #endif
@@ -49,13 +49,38 @@
 /* The MQTT topics for Publisher and Subscriber. */
 #define MQTT_PUB_TOPIC_STATUS                   "presence status"
 #define MQTT_PUB_TOPIC_EVENTS                   "presence events"
+#define MQTT_PUB_TOPIC_DIAGNOSTICS              "presence diagnostics"
+#define MQTT_PUB_TOPIC_CAPTURE                  "presence capture"
+#define MQTT_PUB_TOPIC_STATE                    "presence state"
 #define MQTT_SUB_TOPIC                          "presence config"
 
+/* Set this macro to 1 to give each device topics of its own: the topic names
+ * above under MQTT_TOPIC_PREFIX and the unique silicon ID of the MCU, for
+ * example "site/0123456789abcdef/presence events". The topics are built once
+ * at boot, see source/mqtt_topics.h.
+ */
+#ifndef MQTT_DEVICE_TOPICS
+#define MQTT_DEVICE_TOPICS                      ( 0 )
+#endif
+#define MQTT_TOPIC_PREFIX                       "site"
+
 /* Set the QoS that is associated with the MQTT publish, and subscribe messages.
  * Valid choices are 0, 1, and 2. Other values should not be used in this macro.
  */
 #define MQTT_MESSAGES_QOS                 ( 1 )
 
+/* QoS of the raw frame capture stream. Capture batches are large and
+ * replaced by the next batch within milliseconds, so they are not
+ * acknowledged or retransmitted.
+ */
+#define MQTT_CAPTURE_QOS                  ( 0 )
+
+/* QoS of the diagnostics topic. The reports are periodic and the next one
+ * supersedes a lost one, so they do not hold a slot of the MQTT library
+ * until the broker acknowledges them.
+ */
+#define MQTT_TELEMETRY_QOS                ( 0 )
+
 /* Configuration for the 'Last Will and Testament (LWT)'. It is an MQTT message
  * that will be published by the MQTT broker if the MQTT connection is
  * unexpectedly closed. This configuration is sent to the MQTT broker during
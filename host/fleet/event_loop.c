@@ -0,0 +1,336 @@
+/******************************************************************************
+ * File Name:   event_loop.c
+ *
+ * Description: Host build: single-threaded epoll event loop with a timer heap. One
+ *              thread serves all sockets and timers of the fleet simulator, so the
+ *              number of virtual devices is not limited by threads or stacks.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <errno.h>
+#include <stdlib.h>
+#include <sys/epoll.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Header file includes */
+#include "event_loop.h"
+
+/*******************************************************************************
+ * Function Name: event_loop_now_us
+ ******************************************************************************/
+uint64_t event_loop_now_us(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000u) + ((uint64_t)now.tv_nsec / 1000u);
+}
+
+/*******************************************************************************
+ * Function Name: heap_swap
+ ******************************************************************************/
+static void heap_swap(event_loop_t *loop, uint32_t a, uint32_t b)
+{
+    event_loop_timer_t *timer = loop->heap[a];
+
+    loop->heap[a] = loop->heap[b];
+    loop->heap[b] = timer;
+    loop->heap[a]->heap_index = a;
+    loop->heap[b]->heap_index = b;
+}
+
+/*******************************************************************************
+ * Function Name: heap_up
+ ******************************************************************************/
+static void heap_up(event_loop_t *loop, uint32_t i)
+{
+    while (i > 0u)
+    {
+        uint32_t parent = (i - 1u) / 2u;
+
+        if (loop->heap[parent]->deadline_us <= loop->heap[i]->deadline_us)
+        {
+            break;
+        }
+        heap_swap(loop, parent, i);
+        i = parent;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: heap_down
+ ******************************************************************************/
+static void heap_down(event_loop_t *loop, uint32_t i)
+{
+    for (;;)
+    {
+        uint32_t left = (2u * i) + 1u;
+        uint32_t smallest = i;
+
+        if ((left < loop->num_timers) &&
+            (loop->heap[left]->deadline_us < loop->heap[smallest]->deadline_us))
+        {
+            smallest = left;
+        }
+        if (((left + 1u) < loop->num_timers) &&
+            (loop->heap[left + 1u]->deadline_us < loop->heap[smallest]->deadline_us))
+        {
+            smallest = left + 1u;
+        }
+        if (smallest == i)
+        {
+            break;
+        }
+        heap_swap(loop, i, smallest);
+        i = smallest;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: event_loop_init
+ *******************************************************************************
+ * Summary:
+ *   Creates the epoll instance and the timer heap.
+ *
+ * Parameters:
+ *   loop: loop to initialize
+ *   max_timers: most timers armed at the same time
+ *
+ * Return:
+ *   0 on success, -1 on error
+ ******************************************************************************/
+int event_loop_init(event_loop_t *loop, uint32_t max_timers)
+{
+    loop->heap = calloc(max_timers, sizeof(*loop->heap));
+    loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    loop->num_timers = 0;
+    loop->max_timers = max_timers;
+    loop->stopped = false;
+
+    if ((loop->heap == NULL) || (loop->epoll_fd < 0))
+    {
+        event_loop_free(loop);
+        return -1;
+    }
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: event_loop_free
+ ******************************************************************************/
+void event_loop_free(event_loop_t *loop)
+{
+    if (loop->epoll_fd >= 0)
+    {
+        close(loop->epoll_fd);
+        loop->epoll_fd = -1;
+    }
+    free(loop->heap);
+    loop->heap = NULL;
+}
+
+/*******************************************************************************
+ * Function Name: event_loop_add
+ *******************************************************************************
+ * Summary:
+ *   Watches io->fd for the given epoll events. io must stay valid until it
+ *   is removed.
+ *
+ * Return:
+ *   0 on success, -1 on error
+ ******************************************************************************/
+int event_loop_add(event_loop_t *loop, event_loop_io_t *io, uint32_t events)
+{
+    struct epoll_event event = { .events = events, .data.ptr = io };
+
+    return epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, io->fd, &event);
+}
+
+/*******************************************************************************
+ * Function Name: event_loop_modify
+ ******************************************************************************/
+int event_loop_modify(event_loop_t *loop, event_loop_io_t *io, uint32_t events)
+{
+    struct epoll_event event = { .events = events, .data.ptr = io };
+
+    return epoll_ctl(loop->epoll_fd, EPOLL_CTL_MOD, io->fd, &event);
+}
+
+/*******************************************************************************
+ * Function Name: event_loop_remove
+ ******************************************************************************/
+void event_loop_remove(event_loop_t *loop, event_loop_io_t *io)
+{
+    (void)epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, io->fd, NULL);
+}
+
+/*******************************************************************************
+ * Function Name: event_loop_timer_init
+ ******************************************************************************/
+void event_loop_timer_init(event_loop_timer_t *timer, event_loop_timer_fn_t fn, void *context)
+{
+    timer->fn = fn;
+    timer->context = context;
+    timer->deadline_us = 0;
+    timer->heap_index = EVENT_LOOP_TIMER_STOPPED;
+}
+
+/*******************************************************************************
+ * Function Name: event_loop_timer_start
+ *******************************************************************************
+ * Summary:
+ *   Arms a timer, or moves it if it is already armed.
+ *
+ * Parameters:
+ *   loop: event loop
+ *   timer: timer to arm
+ *   deadline_us: expiry time on the event_loop_now_us() clock
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void event_loop_timer_start(event_loop_t *loop, event_loop_timer_t *timer, uint64_t deadline_us)
+{
+    if (timer->heap_index == EVENT_LOOP_TIMER_STOPPED)
+    {
+        if (loop->num_timers >= loop->max_timers)
+        {
+            abort();
+        }
+        timer->deadline_us = deadline_us;
+        timer->heap_index = loop->num_timers;
+        loop->heap[loop->num_timers++] = timer;
+        heap_up(loop, timer->heap_index);
+    }
+    else
+    {
+        uint64_t previous = timer->deadline_us;
+
+        timer->deadline_us = deadline_us;
+        if (deadline_us < previous)
+        {
+            heap_up(loop, timer->heap_index);
+        }
+        else
+        {
+            heap_down(loop, timer->heap_index);
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: event_loop_timer_stop
+ ******************************************************************************/
+void event_loop_timer_stop(event_loop_t *loop, event_loop_timer_t *timer)
+{
+    uint32_t i = timer->heap_index;
+
+    if (i == EVENT_LOOP_TIMER_STOPPED)
+    {
+        return;
+    }
+
+    loop->num_timers--;
+    if (i != loop->num_timers)
+    {
+        heap_swap(loop, i, loop->num_timers);
+        heap_up(loop, i);
+        heap_down(loop, i);
+    }
+    timer->heap_index = EVENT_LOOP_TIMER_STOPPED;
+}
+
+/*******************************************************************************
+ * Function Name: event_loop_run
+ *******************************************************************************
+ * Summary:
+ *   Dispatches socket events and expired timers until 'until_us' or until
+ *   event_loop_stop() is called.
+ *
+ * Parameters:
+ *   loop: event loop
+ *   until_us: end time on the event_loop_now_us() clock
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void event_loop_run(event_loop_t *loop, uint64_t until_us)
+{
+    struct epoll_event events[EVENT_LOOP_MAX_EVENTS];
+
+    loop->stopped = false;
+
+    while (!loop->stopped)
+    {
+        uint64_t now = event_loop_now_us();
+        uint64_t wake = until_us;
+        int timeout_ms;
+        int count;
+
+        if (now >= until_us)
+        {
+            break;
+        }
+
+        if ((loop->num_timers > 0u) && (loop->heap[0]->deadline_us < wake))
+        {
+            wake = loop->heap[0]->deadline_us;
+        }
+        /* Round up, so that a timer is not polled for repeatedly */
+        timeout_ms = (wake > now) ? (int)((wake - now + 999u) / 1000u) : 0;
+
+        count = epoll_wait(loop->epoll_fd, events, EVENT_LOOP_MAX_EVENTS, timeout_ms);
+        if ((count < 0) && (errno != EINTR))
+        {
+            break;
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+            event_loop_io_t *io = events[i].data.ptr;
+
+            io->fn(io->context, events[i].events);
+        }
+
+        now = event_loop_now_us();
+        while ((loop->num_timers > 0u) && (loop->heap[0]->deadline_us <= now) && !loop->stopped)
+        {
+            event_loop_timer_t *timer = loop->heap[0];
+
+            event_loop_timer_stop(loop, timer);
+            timer->fn(timer->context);
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: event_loop_stop
+ ******************************************************************************/
+void event_loop_stop(event_loop_t *loop)
+{
+    loop->stopped = true;
+}
+
+/* [] END OF FILE */
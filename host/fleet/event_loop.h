@@ -0,0 +1,97 @@
+/******************************************************************************
+ * File Name:   event_loop.h
+ *
+ * Description: Host build: single-threaded epoll event loop with a timer heap, shared by
+ *              the virtual devices of the fleet simulator.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef EVENT_LOOP_H_
+#define EVENT_LOOP_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Readiness events handled per call of epoll_wait() */
+#define EVENT_LOOP_MAX_EVENTS   (256u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+/* Called with the epoll events of a file descriptor */
+typedef void (*event_loop_io_fn_t)(void *context, uint32_t events);
+
+/* Called when a timer expires, the timer is stopped before the call */
+typedef void (*event_loop_timer_fn_t)(void *context);
+
+/* Registration of a file descriptor, owned by the caller */
+typedef struct
+{
+    event_loop_io_fn_t fn;
+    void *context;
+    int fd;
+} event_loop_io_t;
+
+/* One-shot timer, owned by the caller */
+typedef struct
+{
+    event_loop_timer_fn_t fn;
+    void *context;
+    uint64_t deadline_us;
+    uint32_t heap_index;        /* EVENT_LOOP_TIMER_STOPPED when not armed */
+} event_loop_timer_t;
+
+#define EVENT_LOOP_TIMER_STOPPED    (UINT32_MAX)
+
+typedef struct
+{
+    int epoll_fd;
+    event_loop_timer_t **heap;  /* Min-heap on deadline_us */
+    uint32_t num_timers;
+    uint32_t max_timers;
+    bool stopped;
+} event_loop_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+uint64_t event_loop_now_us(void);
+
+int event_loop_init(event_loop_t *loop, uint32_t max_timers);
+void event_loop_free(event_loop_t *loop);
+
+int event_loop_add(event_loop_t *loop, event_loop_io_t *io, uint32_t events);
+int event_loop_modify(event_loop_t *loop, event_loop_io_t *io, uint32_t events);
+void event_loop_remove(event_loop_t *loop, event_loop_io_t *io);
+
+void event_loop_timer_init(event_loop_timer_t *timer, event_loop_timer_fn_t fn, void *context);
+void event_loop_timer_start(event_loop_t *loop, event_loop_timer_t *timer, uint64_t deadline_us);
+void event_loop_timer_stop(event_loop_t *loop, event_loop_timer_t *timer);
+
+void event_loop_run(event_loop_t *loop, uint64_t until_us);
+void event_loop_stop(event_loop_t *loop);
+
+#endif
+/* [] END OF FILE */
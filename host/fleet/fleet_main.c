@@ -0,0 +1,2011 @@
+/******************************************************************************
+ * File Name:   fleet_main.c
+ *
+ * Description: Host build: fleet simulator. Runs hundreds of virtual presence nodes
+ *              against one MQTT broker on a single epoll event loop. Every device has
+ *              its own client ID, connection, publisher queue and subscription, follows
+ *              the connect, subscribe and publish behaviour of mqtt_task.c,
+ *              subscriber_task.c and publisher_task.c, and raises presence events from
+ *              an occupancy script of scene_gen.c. Reports broker throughput, publish
+ *              latency per device, configuration fan-out and reconnection convergence
+ *              for each fleet size as JSON.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <errno.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Header file includes */
+#include "event_loop.h"
+#include "mqtt_client_config.h"
+#include "mqtt_lite.h"
+#include "payload_writer.h"
+#include "presence_event.h"
+#include "publisher_task.h"
+#include "radar_settings.h"
+#include "scene_gen.h"
+#include "subscriber_task.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define FLEET_MAX_RUNS              (16u)
+#define FLEET_TX_BUFFER_SIZE        (2048u)
+#define FLEET_RX_BUFFER_SIZE        (2048u)
+
+/* Interval at which a virtual sensor evaluates its occupancy script. The
+ * presence library reports with a latency of its own, so this does not
+ * need the frame rate.
+ */
+#define FLEET_SENSOR_TICK_MS        (100u)
+
+/* Occupancy scripts repeat within this period, devices start at random
+ * phases of it so that their events do not line up.
+ */
+#define FLEET_SCENE_PERIOD_MS       (60000u)
+
+/* Period of the throughput sampling and of the storm and configuration
+ * schedules
+ */
+#define FLEET_TICK_MS               (1000u)
+
+/* Time given to the devices to send DISCONNECT at the end of a run */
+#define FLEET_DRAIN_MS              (500u)
+
+/* Topics the monitor connection counts */
+#define FLEET_MONITOR_TOPICS        (3u)
+
+/* Bucket b of the latency histograms holds the values below 2^b us */
+#define FLEET_NUM_BUCKETS           (32u)
+
+/* QoS 2 is not implemented by mqtt_lite.c, it is simulated as QoS 1 */
+#define FLEET_QOS                   ((MQTT_MESSAGES_QOS > 1) ? 1u : (uint8_t)MQTT_MESSAGES_QOS)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef enum
+{
+    DEVICE_IDLE,            /* Waiting for the next connection attempt */
+    DEVICE_CONNECTING,      /* TCP connection in progress */
+    DEVICE_CONNACK_WAIT,
+    DEVICE_SUBSCRIBING,
+    DEVICE_READY,           /* Connected and subscribed, or subscribe given up */
+    DEVICE_FAILED           /* MAX_MQTT_CONN_RETRIES exceeded */
+} device_state_t;
+
+/* A message in the publisher queue, like publisher_data_t */
+typedef struct
+{
+    const char *topic;
+    uint16_t topic_len;
+    uint16_t len;
+    char data[MQTT_PUB_MSG_MAX_SIZE * 2];
+} fleet_message_t;
+
+typedef struct
+{
+    uint32_t *values;
+    uint32_t count;
+    uint32_t capacity;
+} fleet_series_t;
+
+typedef struct
+{
+    uint64_t queued;
+    uint64_t queue_full;        /* Dropped like xQueueSendToBack(.., 0) */
+    uint64_t published;
+    uint64_t acked;
+    uint64_t timeouts;          /* No PUBACK within MQTT_TIMEOUT_MS */
+    uint64_t not_connected;     /* Publish while disconnected */
+    uint64_t payload_overflow;  /* Event payload did not fit, dropped */
+    uint64_t delivered[FLEET_MONITOR_TOPICS];
+    uint64_t connect_attempts;
+    uint64_t connect_failures;
+    uint64_t disconnections;
+    uint64_t subscribe_failures;
+    uint64_t configs_sent;
+    uint64_t configs_received;
+} fleet_counters_t;
+
+typedef struct fleet fleet_t;
+
+typedef struct
+{
+    fleet_t *fleet;
+    fleet_counters_t *counters; /* Of the fleet, or of the monitor */
+    uint32_t index;
+    bool monitor;               /* The backend connection, not a device */
+    char client_id[MQTT_CLIENT_IDENTIFIER_MAX_LEN + 1];
+    device_state_t state;
+    event_loop_io_t io;
+    event_loop_timer_t timer;
+    uint32_t epoll_events;
+
+    /* Connection, like mqtt_connect() and subscribe_to_topic() */
+    uint32_t connect_retries;
+    uint32_t subscribe_retries;
+    uint32_t subscribed;        /* Topic filters acknowledged so far */
+    uint64_t retry_at_us;       /* Next connection or subscribe attempt, 0 for none */
+    uint64_t ack_deadline_us;   /* CONNACK or SUBACK timeout, 0 for none */
+    uint64_t last_tx_us;
+    uint64_t ping_deadline_us;  /* PINGRESP timeout, 0 for none */
+    uint16_t next_packet_id;
+    uint16_t subscribe_id;
+
+    /* Virtual sensor */
+    scene_gen_t scene;
+    uint32_t scene_offset_ms;
+    scene_truth_t truth;
+    uint32_t event_seq;
+    uint64_t next_sensor_us;
+    uint64_t next_telemetry_us;
+
+    /* Publisher, one publish in flight like cy_mqtt_publish() */
+    fleet_message_t queue[PUBLISHER_LANES_TOTAL_DEPTH];
+    uint32_t queue_head;
+    uint32_t queue_count;
+    bool in_flight;
+    uint16_t in_flight_id;
+    uint64_t publish_sent_us;
+
+    uint8_t tx[FLEET_TX_BUFFER_SIZE];
+    size_t tx_len;
+    uint8_t rx[FLEET_RX_BUFFER_SIZE];
+    size_t rx_len;
+
+    fleet_series_t latency;     /* PUBLISH to PUBACK, us */
+} fleet_device_t;
+
+/* Time from a loss of connections until all devices are ready again */
+typedef struct
+{
+    uint64_t start_us;
+    uint64_t end_us;            /* 0 if not converged */
+    uint32_t devices_down;      /* Most devices not ready at once */
+    uint64_t connect_attempts;  /* Counter value at the start */
+} fleet_episode_t;
+
+typedef struct
+{
+    const char *host;
+    const char *port;
+    const char *username;
+    const char *password;
+    const char *scene;
+    const char *client_prefix;
+    const char *config_payload;
+    uint32_t sizes[FLEET_MAX_RUNS];
+    uint32_t num_sizes;
+    uint32_t duration_s;
+    uint32_t ramp_ms;
+    uint32_t jitter_ms;
+    uint32_t storm_every_s;
+    double storm_fraction;
+    uint32_t config_every_s;
+    double telemetry_hz;
+    uint32_t telemetry_bytes;
+} fleet_options_t;
+
+struct fleet
+{
+    const fleet_options_t *options;
+    struct sockaddr_storage address;
+    socklen_t address_len;
+    event_loop_t loop;
+    event_loop_timer_t tick;
+    fleet_device_t *devices;
+    uint32_t num_devices;
+    fleet_device_t monitor;
+    uint32_t random_state;
+    uint64_t start_us;
+    uint64_t end_us;
+    uint32_t num_ready;
+    uint32_t num_failed;
+    bool draining;
+
+    fleet_counters_t counters;
+    fleet_counters_t monitor_counters;
+    fleet_counters_t last_tick;
+    double peak_acked_per_s;
+    double peak_delivered_per_s;
+    uint64_t last_config_us;
+    fleet_series_t config_latency;
+
+    fleet_episode_t *episodes;
+    uint32_t num_episodes;
+    uint32_t max_episodes;
+    bool episode_open;
+};
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+static void device_schedule(fleet_device_t *dev);
+static void device_disconnected(fleet_device_t *dev, bool abort_connection);
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static const char *const monitor_topics[FLEET_MONITOR_TOPICS] =
+{
+    PAYLOAD_EVENTS_TOPIC, MQTT_PUB_TOPIC_STATUS, MQTT_PUB_TOPIC_DIAGNOSTICS
+};
+
+static const char *const monitor_topic_keys[FLEET_MONITOR_TOPICS] =
+{
+    "events", "status", "diagnostics"
+};
+
+/* Reply of radar_config_task.c to an accepted configuration */
+static const char config_reply[] = "{\"presence configuration updated and application resumed\"}";
+
+/*******************************************************************************
+ * Function Name: next_random
+ ******************************************************************************/
+static uint32_t next_random(uint32_t *state)
+{
+    /* xorshift32 */
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+/*******************************************************************************
+ * Function Name: series_add
+ ******************************************************************************/
+static void series_add(fleet_series_t *series, uint32_t value)
+{
+    if (series->count == series->capacity)
+    {
+        uint32_t capacity = (series->capacity == 0u) ? 64u : (series->capacity * 2u);
+        uint32_t *values = realloc(series->values, capacity * sizeof(*values));
+
+        if (values == NULL)
+        {
+            return;
+        }
+        series->values = values;
+        series->capacity = capacity;
+    }
+    series->values[series->count++] = value;
+}
+
+/*******************************************************************************
+ * Function Name: retry_delay_us
+ *******************************************************************************
+ * Summary:
+ *   Returns a retry interval plus the random jitter set with --jitter-ms.
+ *   The firmware retries at fixed intervals, which is the default.
+ ******************************************************************************/
+static uint64_t retry_delay_us(fleet_t *fleet, uint32_t interval_ms)
+{
+    uint32_t jitter = fleet->options->jitter_ms;
+
+    if (jitter > 0u)
+    {
+        interval_ms += next_random(&fleet->random_state) % (jitter + 1u);
+    }
+
+    return (uint64_t)interval_ms * 1000u;
+}
+
+/*******************************************************************************
+ * Function Name: update_episodes
+ *******************************************************************************
+ * Summary:
+ *   Opens a convergence episode when a device stops being ready and closes
+ *   it when all devices that have not given up are ready again.
+ ******************************************************************************/
+static void update_episodes(fleet_t *fleet, uint64_t now)
+{
+    uint32_t active = fleet->num_devices - fleet->num_failed;
+    uint32_t down = active - fleet->num_ready;
+
+    if (fleet->draining)
+    {
+        return;
+    }
+
+    if (!fleet->episode_open && (down > 0u) && (fleet->num_episodes < fleet->max_episodes))
+    {
+        fleet_episode_t *episode = &fleet->episodes[fleet->num_episodes++];
+
+        episode->start_us = now;
+        episode->end_us = 0;
+        episode->devices_down = down;
+        episode->connect_attempts = fleet->counters.connect_attempts;
+        fleet->episode_open = true;
+    }
+    else if (fleet->episode_open)
+    {
+        fleet_episode_t *episode = &fleet->episodes[fleet->num_episodes - 1u];
+
+        if (down > episode->devices_down)
+        {
+            episode->devices_down = down;
+        }
+        if (down == 0u)
+        {
+            episode->end_us = now;
+            fleet->episode_open = false;
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: set_state
+ ******************************************************************************/
+static void set_state(fleet_device_t *dev, device_state_t state)
+{
+    fleet_t *fleet = dev->fleet;
+
+    if (!dev->monitor)
+    {
+        if ((dev->state == DEVICE_READY) && (state != DEVICE_READY))
+        {
+            fleet->num_ready--;
+        }
+        else if ((dev->state != DEVICE_READY) && (state == DEVICE_READY))
+        {
+            fleet->num_ready++;
+        }
+        if (state == DEVICE_FAILED)
+        {
+            fleet->num_failed++;
+        }
+    }
+
+    dev->state = state;
+
+    if (!dev->monitor)
+    {
+        update_episodes(fleet, event_loop_now_us());
+    }
+}
+
+/*******************************************************************************
+ * Function Name: watch
+ *******************************************************************************
+ * Summary:
+ *   Updates the epoll events of the device socket: readable always,
+ *   writable while a connection is in progress or data is pending.
+ ******************************************************************************/
+static void watch(fleet_device_t *dev)
+{
+    uint32_t events = EPOLLIN;
+
+    if ((dev->state == DEVICE_CONNECTING) || (dev->tx_len > 0u))
+    {
+        events |= EPOLLOUT;
+    }
+
+    if (events != dev->epoll_events)
+    {
+        dev->epoll_events = events;
+        event_loop_modify(&dev->fleet->loop, &dev->io, events);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: flush
+ *******************************************************************************
+ * Summary:
+ *   Writes pending data to the socket as far as it accepts it.
+ *
+ * Return:
+ *   false if the connection failed
+ ******************************************************************************/
+static bool flush(fleet_device_t *dev)
+{
+    while (dev->tx_len > 0u)
+    {
+        ssize_t n = send(dev->io.fd, dev->tx, dev->tx_len, MSG_NOSIGNAL);
+
+        if (n < 0)
+        {
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+            {
+                break;
+            }
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+
+        memmove(dev->tx, &dev->tx[n], dev->tx_len - (size_t)n);
+        dev->tx_len -= (size_t)n;
+    }
+
+    watch(dev);
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: sent
+ *******************************************************************************
+ * Summary:
+ *   Commits a packet encoded at the end of the transmit buffer and sends it.
+ *
+ * Parameters:
+ *   dev: device
+ *   len: packet size returned by the encoder, 0 if it did not fit
+ *
+ * Return:
+ *   false if the packet did not fit or the connection failed
+ ******************************************************************************/
+static bool sent(fleet_device_t *dev, size_t len)
+{
+    if (len == 0u)
+    {
+        return false;
+    }
+
+    dev->tx_len += len;
+    dev->last_tx_us = event_loop_now_us();
+
+    if (!flush(dev))
+    {
+        device_disconnected(dev, true);
+        return false;
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: tx_space
+ ******************************************************************************/
+static size_t tx_space(const fleet_device_t *dev)
+{
+    return sizeof(dev->tx) - dev->tx_len;
+}
+
+/*******************************************************************************
+ * Function Name: new_packet_id
+ ******************************************************************************/
+static uint16_t new_packet_id(fleet_device_t *dev)
+{
+    if (++dev->next_packet_id == 0u)
+    {
+        dev->next_packet_id = 1u;
+    }
+    return dev->next_packet_id;
+}
+
+/*******************************************************************************
+ * Function Name: enqueue
+ *******************************************************************************
+ * Summary:
+ *   Adds a message to the publisher queue of a device. Like the radar task,
+ *   the message is dropped if the queue is full.
+ *
+ * Return:
+ *   Message to fill in, NULL if the queue is full
+ ******************************************************************************/
+static fleet_message_t *enqueue(fleet_device_t *dev, const char *topic)
+{
+    fleet_message_t *msg;
+
+    if (dev->queue_count >= PUBLISHER_LANES_TOTAL_DEPTH)
+    {
+        dev->counters->queue_full++;
+        return NULL;
+    }
+
+    msg = &dev->queue[(dev->queue_head + dev->queue_count) % PUBLISHER_LANES_TOTAL_DEPTH];
+    dev->queue_count++;
+    dev->counters->queued++;
+    msg->topic = topic;
+    msg->topic_len = (uint16_t)strlen(topic);
+    msg->len = 0;
+
+    return msg;
+}
+
+/*******************************************************************************
+ * Function Name: dequeue
+ ******************************************************************************/
+static void dequeue(fleet_device_t *dev)
+{
+    dev->queue_head = (dev->queue_head + 1u) % PUBLISHER_LANES_TOTAL_DEPTH;
+    dev->queue_count--;
+}
+
+/*******************************************************************************
+ * Function Name: unqueue
+ *******************************************************************************
+ * Summary:
+ *   Drops the message of the last enqueue(), as the radar task frees a pool
+ *   block it could not fill.
+ ******************************************************************************/
+static void unqueue(fleet_device_t *dev)
+{
+    dev->queue_count--;
+    dev->counters->queued--;
+}
+
+/*******************************************************************************
+ * Function Name: publisher_service
+ *******************************************************************************
+ * Summary:
+ *   Publishes the next queued message when no publish is in flight. While
+ *   disconnected the publishes fail at once, as cy_mqtt_publish() does.
+ ******************************************************************************/
+static void publisher_service(fleet_device_t *dev)
+{
+    fleet_counters_t *counters = dev->counters;
+
+    while ((dev->queue_count > 0u) && !dev->in_flight)
+    {
+        fleet_message_t *msg = &dev->queue[dev->queue_head];
+        uint16_t packet_id = 0;
+        size_t len;
+
+        if (dev->state != DEVICE_READY)
+        {
+            counters->not_connected++;
+            dequeue(dev);
+            continue;
+        }
+
+        if (FLEET_QOS > 0u)
+        {
+            packet_id = new_packet_id(dev);
+        }
+        len = mqtt_lite_publish(&dev->tx[dev->tx_len], tx_space(dev), msg->topic, msg->topic_len,
+                                msg->data, msg->len, FLEET_QOS, packet_id, false, false);
+        if (len == 0u)
+        {
+            /* Wait until the socket takes the pending data */
+            break;
+        }
+
+        dequeue(dev);
+        counters->published++;
+        if (FLEET_QOS > 0u)
+        {
+            dev->in_flight = true;
+            dev->in_flight_id = packet_id;
+            dev->publish_sent_us = event_loop_now_us();
+        }
+        if (!sent(dev, len))
+        {
+            return;
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: subscribe_next
+ *******************************************************************************
+ * Summary:
+ *   Sends the SUBSCRIBE of the next topic filter: the configuration topic
+ *   for devices, the device topics for the monitor. The device is ready
+ *   when all filters are acknowledged.
+ ******************************************************************************/
+static void subscribe_next(fleet_device_t *dev)
+{
+    uint32_t total = dev->monitor ? FLEET_MONITOR_TOPICS : 1u;
+    const char *topic = dev->monitor ? monitor_topics[dev->subscribed] : MQTT_SUB_TOPIC;
+    size_t len;
+
+    if (dev->subscribed >= total)
+    {
+        dev->ack_deadline_us = 0;
+        set_state(dev, DEVICE_READY);
+        publisher_service(dev);
+        return;
+    }
+
+    /* The monitor takes what the broker can deliver, without acknowledgements */
+    dev->subscribe_id = new_packet_id(dev);
+    len = mqtt_lite_subscribe(&dev->tx[dev->tx_len], tx_space(dev), dev->subscribe_id,
+                              topic, (uint16_t)strlen(topic), dev->monitor ? 0u : FLEET_QOS);
+    dev->ack_deadline_us = event_loop_now_us() + ((uint64_t)MQTT_TIMEOUT_MS * 1000u);
+    set_state(dev, DEVICE_SUBSCRIBING);
+    (void)sent(dev, len);
+}
+
+/*******************************************************************************
+ * Function Name: subscribe_failed
+ *******************************************************************************
+ * Summary:
+ *   Retries a failed subscription like subscribe_to_topic(). After
+ *   MAX_SUBSCRIBE_RETRIES the firmware carries on without it.
+ ******************************************************************************/
+static void subscribe_failed(fleet_device_t *dev)
+{
+    dev->ack_deadline_us = 0;
+
+    if (++dev->subscribe_retries < MAX_SUBSCRIBE_RETRIES)
+    {
+        dev->retry_at_us = event_loop_now_us() + retry_delay_us(dev->fleet, MQTT_SUBSCRIBE_RETRY_INTERVAL_MS);
+        return;
+    }
+
+    dev->counters->subscribe_failures++;
+    dev->subscribe_retries = 0;
+    dev->subscribed++;
+    subscribe_next(dev);
+}
+
+/*******************************************************************************
+ * Function Name: on_config
+ *******************************************************************************
+ * Summary:
+ *   Handles a message on the configuration topic like the subscriber and
+ *   radar configuration tasks: the configuration is accepted and the reply
+ *   is published on the status topic.
+ ******************************************************************************/
+static void on_config(fleet_device_t *dev)
+{
+    fleet_t *fleet = dev->fleet;
+    fleet_message_t *msg;
+
+    fleet->counters.configs_received++;
+    if (fleet->last_config_us != 0u)
+    {
+        series_add(&fleet->config_latency, (uint32_t)(event_loop_now_us() - fleet->last_config_us));
+    }
+
+    msg = enqueue(dev, MQTT_PUB_TOPIC_STATUS);
+    if (msg != NULL)
+    {
+        memcpy(msg->data, config_reply, sizeof(config_reply) - 1u);
+        msg->len = sizeof(config_reply) - 1u;
+        publisher_service(dev);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: handle_packet
+ *******************************************************************************
+ * Summary:
+ *   Processes a packet received from the broker.
+ *
+ * Return:
+ *   false if the connection has to be dropped
+ ******************************************************************************/
+static bool handle_packet(fleet_device_t *dev, const mqtt_lite_packet_t *packet)
+{
+    fleet_t *fleet = dev->fleet;
+    uint64_t now = event_loop_now_us();
+
+    switch (packet->type)
+    {
+        case MQTT_LITE_CONNACK:
+            if ((dev->state != DEVICE_CONNACK_WAIT) || (packet->return_code != MQTT_LITE_CONNACK_ACCEPTED))
+            {
+                dev->counters->connect_failures++;
+                return false;
+            }
+            dev->connect_retries = 0;
+            dev->subscribe_retries = 0;
+            dev->subscribed = 0;
+            subscribe_next(dev);
+            break;
+
+        case MQTT_LITE_SUBACK:
+            if ((dev->state != DEVICE_SUBSCRIBING) || (packet->packet_id != dev->subscribe_id))
+            {
+                break;
+            }
+            if (packet->return_code == MQTT_LITE_SUBACK_FAILURE)
+            {
+                subscribe_failed(dev);
+            }
+            else
+            {
+                dev->subscribe_retries = 0;
+                dev->subscribed++;
+                subscribe_next(dev);
+            }
+            break;
+
+        case MQTT_LITE_PUBACK:
+            if (dev->in_flight && (packet->packet_id == dev->in_flight_id))
+            {
+                dev->in_flight = false;
+                dev->counters->acked++;
+                series_add(&dev->latency, (uint32_t)(now - dev->publish_sent_us));
+                publisher_service(dev);
+            }
+            break;
+
+        case MQTT_LITE_PUBLISH:
+            if (packet->qos > 0u)
+            {
+                /* QoS 2 is acknowledged with PUBREC, see FLEET_QOS */
+                mqtt_lite_type_t ack = (packet->qos == 1u) ? MQTT_LITE_PUBACK : MQTT_LITE_PUBREC;
+
+                if (!sent(dev, mqtt_lite_ack(&dev->tx[dev->tx_len], tx_space(dev), ack, packet->packet_id)))
+                {
+                    return false;
+                }
+            }
+
+            if (dev->monitor)
+            {
+                for (uint32_t i = 0; i < FLEET_MONITOR_TOPICS; ++i)
+                {
+                    if ((packet->topic_len == strlen(monitor_topics[i])) &&
+                        (memcmp(packet->topic, monitor_topics[i], packet->topic_len) == 0))
+                    {
+                        fleet->counters.delivered[i]++;
+                    }
+                }
+            }
+            else if ((packet->topic_len == (sizeof(MQTT_SUB_TOPIC) - 1u)) &&
+                     (memcmp(packet->topic, MQTT_SUB_TOPIC, packet->topic_len) == 0))
+            {
+                on_config(dev);
+            }
+            break;
+
+        case MQTT_LITE_PUBREL:
+            return sent(dev, mqtt_lite_ack(&dev->tx[dev->tx_len], tx_space(dev), MQTT_LITE_PUBCOMP,
+                                           packet->packet_id));
+
+        case MQTT_LITE_PINGRESP:
+            dev->ping_deadline_us = 0;
+            break;
+
+        default:
+            break;
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: receive
+ *******************************************************************************
+ * Summary:
+ *   Reads from the socket and processes all complete packets.
+ *
+ * Return:
+ *   false if the connection failed
+ ******************************************************************************/
+static bool receive(fleet_device_t *dev)
+{
+    for (;;)
+    {
+        ssize_t n = recv(dev->io.fd, &dev->rx[dev->rx_len], sizeof(dev->rx) - dev->rx_len, 0);
+        size_t offset = 0;
+
+        if (n == 0)
+        {
+            return false;
+        }
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return (errno == EAGAIN) || (errno == EWOULDBLOCK);
+        }
+        dev->rx_len += (size_t)n;
+
+        for (;;)
+        {
+            mqtt_lite_packet_t packet;
+            long size = mqtt_lite_parse(&dev->rx[offset], dev->rx_len - offset, &packet);
+
+            if (size < 0)
+            {
+                return false;
+            }
+            if (size == 0)
+            {
+                break;
+            }
+            offset += (size_t)size;
+            if (!handle_packet(dev, &packet) || (dev->io.fd < 0))
+            {
+                return false;
+            }
+        }
+
+        /* A packet larger than the buffer cannot be completed */
+        if ((offset == 0u) && (dev->rx_len == sizeof(dev->rx)))
+        {
+            return false;
+        }
+        memmove(dev->rx, &dev->rx[offset], dev->rx_len - offset);
+        dev->rx_len -= offset;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: send_connect
+ ******************************************************************************/
+static bool send_connect(fleet_device_t *dev)
+{
+    const fleet_options_t *options = dev->fleet->options;
+    mqtt_lite_connect_t connect =
+    {
+        .client_id = dev->client_id,
+        .username = options->username,
+        .password = options->password,
+        .keep_alive_s = MQTT_KEEP_ALIVE_SECONDS,
+        .clean_session = true
+    };
+
+    dev->ack_deadline_us = event_loop_now_us() + ((uint64_t)MQTT_TIMEOUT_MS * 1000u);
+    set_state(dev, DEVICE_CONNACK_WAIT);
+    return sent(dev, mqtt_lite_connect(&dev->tx[dev->tx_len], tx_space(dev), &connect));
+}
+
+/*******************************************************************************
+ * Function Name: on_io
+ *******************************************************************************
+ * Summary:
+ *   Socket events of a device.
+ ******************************************************************************/
+static void on_io(void *context, uint32_t events)
+{
+    fleet_device_t *dev = context;
+
+    /* The socket may have been closed by an earlier event of the same batch */
+    if (dev->io.fd < 0)
+    {
+        return;
+    }
+
+    if (dev->state == DEVICE_CONNECTING)
+    {
+        int error = 0;
+        socklen_t error_len = sizeof(error);
+
+        if ((events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) == 0u)
+        {
+            return;
+        }
+        getsockopt(dev->io.fd, SOL_SOCKET, SO_ERROR, &error, &error_len);
+        if (error != 0)
+        {
+            dev->counters->connect_failures++;
+            device_disconnected(dev, true);
+            return;
+        }
+        (void)send_connect(dev);
+        device_schedule(dev);
+        return;
+    }
+
+    if (((events & EPOLLIN) != 0u) && !receive(dev))
+    {
+        /* Unless a failed send has handled it already */
+        if (dev->io.fd >= 0)
+        {
+            device_disconnected(dev, false);
+        }
+        return;
+    }
+
+    if ((events & (EPOLLERR | EPOLLHUP)) != 0u)
+    {
+        device_disconnected(dev, false);
+        return;
+    }
+
+    if ((events & EPOLLOUT) != 0u)
+    {
+        if (!flush(dev))
+        {
+            device_disconnected(dev, true);
+            return;
+        }
+        publisher_service(dev);
+    }
+
+    if (dev->io.fd >= 0)
+    {
+        device_schedule(dev);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: connect_attempt
+ *******************************************************************************
+ * Summary:
+ *   Starts a connection attempt. Like mqtt_connect(), a device gives up
+ *   after MAX_MQTT_CONN_RETRIES attempts.
+ ******************************************************************************/
+static void connect_attempt(fleet_device_t *dev)
+{
+    fleet_t *fleet = dev->fleet;
+    int one = 1;
+    int fd;
+
+    dev->retry_at_us = 0;
+    if (dev->connect_retries++ >= MAX_MQTT_CONN_RETRIES)
+    {
+        set_state(dev, DEVICE_FAILED);
+        return;
+    }
+    dev->counters->connect_attempts++;
+
+    fd = socket(fleet->address.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        dev->counters->connect_failures++;
+        dev->retry_at_us = event_loop_now_us() + retry_delay_us(fleet, MQTT_CONN_RETRY_INTERVAL_MS);
+        return;
+    }
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    dev->io.fd = fd;
+    dev->tx_len = 0;
+    dev->rx_len = 0;
+    dev->in_flight = false;
+    dev->ping_deadline_us = 0;
+    dev->epoll_events = EPOLLIN | EPOLLOUT;
+    set_state(dev, DEVICE_CONNECTING);
+    dev->ack_deadline_us = event_loop_now_us() + ((uint64_t)MQTT_TIMEOUT_MS * 1000u);
+
+    if (event_loop_add(&fleet->loop, &dev->io, dev->epoll_events) != 0)
+    {
+        close(fd);
+        dev->io.fd = -1;
+        dev->counters->connect_failures++;
+        set_state(dev, DEVICE_IDLE);
+        dev->retry_at_us = event_loop_now_us() + retry_delay_us(fleet, MQTT_CONN_RETRY_INTERVAL_MS);
+        return;
+    }
+
+    if ((connect(fd, (const struct sockaddr *)&fleet->address, fleet->address_len) != 0) &&
+        (errno != EINPROGRESS))
+    {
+        dev->counters->connect_failures++;
+        device_disconnected(dev, true);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: close_socket
+ *******************************************************************************
+ * Summary:
+ *   Closes the socket of a device. With 'abort_connection' the connection is
+ *   reset instead of closed, as on a loss of power or of the access point,
+ *   which also leaves no TIME_WAIT state behind.
+ ******************************************************************************/
+static void close_socket(fleet_device_t *dev, bool abort_connection)
+{
+    if (dev->io.fd < 0)
+    {
+        return;
+    }
+
+    if (abort_connection)
+    {
+        struct linger linger = { .l_onoff = 1, .l_linger = 0 };
+
+        setsockopt(dev->io.fd, SOL_SOCKET, SO_LINGER, &linger, sizeof(linger));
+    }
+
+    event_loop_remove(&dev->fleet->loop, &dev->io);
+    close(dev->io.fd);
+    dev->io.fd = -1;
+}
+
+/*******************************************************************************
+ * Function Name: device_disconnected
+ *******************************************************************************
+ * Summary:
+ *   Handles a lost or failed connection like the HANDLE_DISCONNECTION case
+ *   of the MQTT client task: the first reconnection attempt is immediate
+ *   after a lost connection, attempts that fail are repeated every
+ *   MQTT_CONN_RETRY_INTERVAL_MS.
+ ******************************************************************************/
+static void device_disconnected(fleet_device_t *dev, bool abort_connection)
+{
+    fleet_t *fleet = dev->fleet;
+    bool was_connected = (dev->state == DEVICE_READY) || (dev->state == DEVICE_SUBSCRIBING);
+    uint64_t now = event_loop_now_us();
+
+    close_socket(dev, abort_connection);
+    dev->ack_deadline_us = 0;
+    dev->ping_deadline_us = 0;
+    if (dev->in_flight)
+    {
+        dev->in_flight = false;
+        dev->counters->not_connected++;
+    }
+
+    if (fleet->draining)
+    {
+        set_state(dev, DEVICE_IDLE);
+        return;
+    }
+
+    if (was_connected)
+    {
+        dev->counters->disconnections++;
+        dev->connect_retries = 0;
+        dev->retry_at_us = now + retry_delay_us(fleet, 0u);
+    }
+    else
+    {
+        dev->retry_at_us = now + retry_delay_us(fleet, MQTT_CONN_RETRY_INTERVAL_MS);
+    }
+
+    set_state(dev, DEVICE_IDLE);
+    publisher_service(dev);
+    device_schedule(dev);
+}
+
+/*******************************************************************************
+ * Function Name: sensor_tick
+ *******************************************************************************
+ * Summary:
+ *   Evaluates the occupancy script and queues the presence event of a
+ *   state change with the payload of presence_detection_cb().
+ ******************************************************************************/
+static void sensor_tick(fleet_device_t *dev, uint64_t now)
+{
+    fleet_t *fleet = dev->fleet;
+    uint32_t time_ms = (uint32_t)((now - fleet->start_us) / 1000u) + dev->scene_offset_ms;
+    float range_m;
+    scene_truth_t truth = scene_gen_truth(&dev->scene, time_ms, &range_m);
+
+    if (truth != dev->truth)
+    {
+        fleet_message_t *msg = enqueue(dev, PAYLOAD_EVENTS_TOPIC);
+
+        dev->truth = truth;
+        if (msg != NULL)
+        {
+            static const presence_event_state_t states[] =
+            {
+                [SCENE_TRUTH_ABSENT] = PRESENCE_EVENT_ABSENCE,
+                [SCENE_TRUTH_MACRO] = PRESENCE_EVENT_MACRO,
+                [SCENE_TRUTH_MICRO] = PRESENCE_EVENT_MICRO
+            };
+            presence_event_t event =
+            {
+                .seq = ++dev->event_seq,
+                .timestamp_ms = time_ms,
+                .frame = (uint32_t)(((uint64_t)time_ms * 1000u) / RADAR_SETTINGS_FRAME_PERIOD_US),
+                .range_mm = (truth == SCENE_TRUTH_ABSENT) ? PRESENCE_EVENT_NO_RANGE : (int32_t)(range_m * 1000.0f),
+                .state = states[truth]
+            };
+            payload_writer_t writer;
+
+            payload_writer_init(&writer, PAYLOAD_FORMAT, msg->data, sizeof(msg->data));
+            presence_event_begin(&writer, &event, 0u);
+            payload_end(&writer);
+            msg->len = (uint16_t)payload_writer_finish(&writer);
+            if (msg->len == 0u)
+            {
+                unqueue(dev);
+                dev->counters->payload_overflow++;
+            }
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: telemetry_tick
+ *******************************************************************************
+ * Summary:
+ *   Queues a diagnostics message of --telemetry-bytes, the same padding as
+ *   the telemetry of latency_bench.c.
+ ******************************************************************************/
+static void telemetry_tick(fleet_device_t *dev)
+{
+    const fleet_options_t *options = dev->fleet->options;
+    fleet_message_t *msg = enqueue(dev, MQTT_PUB_TOPIC_DIAGNOSTICS);
+    int len;
+
+    if (msg == NULL)
+    {
+        return;
+    }
+
+    len = snprintf(msg->data, sizeof(msg->data), "{\"telemetry\": %" PRIu64 ", \"pad\": \"",
+                   dev->counters->queued);
+    while (((uint32_t)len < (options->telemetry_bytes - 2u)) && ((size_t)len < (sizeof(msg->data) - 3u)))
+    {
+        msg->data[len++] = 'x';
+    }
+    memcpy(&msg->data[len], "\"}", 2);
+    msg->len = (uint16_t)(len + 2);
+}
+
+/*******************************************************************************
+ * Function Name: on_timer
+ *******************************************************************************
+ * Summary:
+ *   Handles the deadlines of a device that are due: connection and
+ *   subscribe retries, acknowledgement timeouts, keep-alive and the
+ *   virtual sensor.
+ ******************************************************************************/
+static void on_timer(void *context)
+{
+    fleet_device_t *dev = context;
+    fleet_t *fleet = dev->fleet;
+    const fleet_options_t *options = fleet->options;
+    uint64_t now = event_loop_now_us();
+
+    if ((dev->state == DEVICE_FAILED) || fleet->draining)
+    {
+        return;
+    }
+
+    if ((dev->ack_deadline_us != 0u) && (now >= dev->ack_deadline_us))
+    {
+        if (dev->state == DEVICE_SUBSCRIBING)
+        {
+            subscribe_failed(dev);
+        }
+        else
+        {
+            dev->counters->connect_failures++;
+            device_disconnected(dev, true);
+            return;
+        }
+    }
+
+    if ((dev->ping_deadline_us != 0u) && (now >= dev->ping_deadline_us))
+    {
+        device_disconnected(dev, true);
+        return;
+    }
+
+    if ((dev->retry_at_us != 0u) && (now >= dev->retry_at_us))
+    {
+        dev->retry_at_us = 0;
+        if (dev->state == DEVICE_IDLE)
+        {
+            connect_attempt(dev);
+            if (dev->state == DEVICE_FAILED)
+            {
+                return;
+            }
+        }
+        else if (dev->state == DEVICE_SUBSCRIBING)
+        {
+            subscribe_next(dev);
+        }
+    }
+
+    if (dev->in_flight && (now >= (dev->publish_sent_us + ((uint64_t)MQTT_TIMEOUT_MS * 1000u))))
+    {
+        /* HANDLE_MQTT_PUBLISH_FAILURE does not reconnect, the message is lost */
+        dev->in_flight = false;
+        dev->counters->timeouts++;
+    }
+
+    if ((dev->state == DEVICE_READY) && (dev->ping_deadline_us == 0u) &&
+        (now >= (dev->last_tx_us + ((uint64_t)MQTT_KEEP_ALIVE_SECONDS * 1000000u))))
+    {
+        if (!sent(dev, mqtt_lite_empty(&dev->tx[dev->tx_len], tx_space(dev), MQTT_LITE_PINGREQ)))
+        {
+            return;
+        }
+        dev->ping_deadline_us = now + ((uint64_t)MQTT_TIMEOUT_MS * 1000u);
+    }
+
+    if (!dev->monitor && (now >= dev->next_sensor_us))
+    {
+        sensor_tick(dev, now);
+        dev->next_sensor_us += (uint64_t)FLEET_SENSOR_TICK_MS * 1000u;
+    }
+
+    if (!dev->monitor && (options->telemetry_hz > 0.0) && (now >= dev->next_telemetry_us))
+    {
+        telemetry_tick(dev);
+        dev->next_telemetry_us += (uint64_t)(1e6 / options->telemetry_hz);
+    }
+
+    publisher_service(dev);
+    if (dev->state != DEVICE_FAILED)
+    {
+        device_schedule(dev);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: device_schedule
+ *******************************************************************************
+ * Summary:
+ *   Arms the timer of a device for its earliest deadline.
+ ******************************************************************************/
+static void device_schedule(fleet_device_t *dev)
+{
+    const fleet_options_t *options = dev->fleet->options;
+    uint64_t deadline = UINT64_MAX;
+    uint64_t candidates[7] = { 0 };
+
+    candidates[0] = dev->retry_at_us;
+    candidates[1] = dev->ack_deadline_us;
+    candidates[2] = dev->ping_deadline_us;
+    candidates[3] = dev->in_flight ? (dev->publish_sent_us + ((uint64_t)MQTT_TIMEOUT_MS * 1000u)) : 0u;
+    if (dev->state == DEVICE_READY)
+    {
+        candidates[4] = dev->last_tx_us + ((uint64_t)MQTT_KEEP_ALIVE_SECONDS * 1000000u);
+    }
+    if (!dev->monitor)
+    {
+        candidates[5] = dev->next_sensor_us;
+        candidates[6] = (options->telemetry_hz > 0.0) ? dev->next_telemetry_us : 0u;
+    }
+
+    for (uint32_t i = 0; i < (sizeof(candidates) / sizeof(candidates[0])); ++i)
+    {
+        if ((candidates[i] != 0u) && (candidates[i] < deadline))
+        {
+            deadline = candidates[i];
+        }
+    }
+
+    if (deadline != UINT64_MAX)
+    {
+        event_loop_timer_start(&dev->fleet->loop, &dev->timer, deadline);
+    }
+    else
+    {
+        event_loop_timer_stop(&dev->fleet->loop, &dev->timer);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: device_init
+ ******************************************************************************/
+static void device_init(fleet_t *fleet, fleet_device_t *dev, uint32_t index, bool monitor, uint64_t start_us)
+{
+    const fleet_options_t *options = fleet->options;
+
+    memset(dev, 0, sizeof(*dev));
+    dev->fleet = fleet;
+    dev->counters = monitor ? &fleet->monitor_counters : &fleet->counters;
+    dev->index = index;
+    dev->monitor = monitor;
+    dev->io.fn = on_io;
+    dev->io.context = dev;
+    dev->io.fd = -1;
+    dev->state = DEVICE_IDLE;
+    dev->retry_at_us = start_us;
+    event_loop_timer_init(&dev->timer, on_timer, dev);
+
+    if (monitor)
+    {
+        snprintf(dev->client_id, sizeof(dev->client_id), "%.15s-monitor", options->client_prefix);
+        return;
+    }
+
+    /* The firmware appends a number to MQTT_CLIENT_IDENTIFIER too, see
+     * GENERATE_UNIQUE_CLIENT_ID
+     */
+    snprintf(dev->client_id, sizeof(dev->client_id), "%.17s-%05" PRIu32, options->client_prefix, index);
+    scene_gen_init(&dev->scene, options->scene, index + 1u);
+    dev->scene_offset_ms = next_random(&fleet->random_state) % FLEET_SCENE_PERIOD_MS;
+    dev->truth = SCENE_TRUTH_ABSENT;
+    dev->next_sensor_us = start_us;
+    if (options->telemetry_hz > 0.0)
+    {
+        dev->next_telemetry_us = start_us + (next_random(&fleet->random_state) % (uint32_t)(1e6 / options->telemetry_hz));
+    }
+}
+
+/*******************************************************************************
+ * Function Name: storm
+ *******************************************************************************
+ * Summary:
+ *   Resets the connections of a fraction of the ready devices at once, as
+ *   a broker restart or an access point outage would.
+ ******************************************************************************/
+static void storm(fleet_t *fleet)
+{
+    uint32_t threshold = (uint32_t)(fleet->options->storm_fraction * (double)UINT32_MAX);
+
+    for (uint32_t i = 0; i < fleet->num_devices; ++i)
+    {
+        fleet_device_t *dev = &fleet->devices[i];
+
+        if ((dev->state == DEVICE_READY) && (next_random(&fleet->random_state) <= threshold))
+        {
+            device_disconnected(dev, true);
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: on_tick
+ *******************************************************************************
+ * Summary:
+ *   Samples the throughput and runs the storm and configuration schedules.
+ ******************************************************************************/
+static void on_tick(void *context)
+{
+    fleet_t *fleet = context;
+    const fleet_options_t *options = fleet->options;
+    uint64_t now = event_loop_now_us();
+    uint32_t elapsed_s = (uint32_t)((now - fleet->start_us) / 1000000u);
+    uint64_t delivered = 0;
+    uint64_t last_delivered = 0;
+    double seconds = (double)FLEET_TICK_MS / 1000.0;
+    double acked_per_s = (double)(fleet->counters.acked - fleet->last_tick.acked) / seconds;
+    double delivered_per_s;
+
+    for (uint32_t i = 0; i < FLEET_MONITOR_TOPICS; ++i)
+    {
+        delivered += fleet->counters.delivered[i];
+        last_delivered += fleet->last_tick.delivered[i];
+    }
+    delivered_per_s = (double)(delivered - last_delivered) / seconds;
+    fleet->peak_acked_per_s = (acked_per_s > fleet->peak_acked_per_s) ? acked_per_s : fleet->peak_acked_per_s;
+    fleet->peak_delivered_per_s = (delivered_per_s > fleet->peak_delivered_per_s) ?
+                                  delivered_per_s : fleet->peak_delivered_per_s;
+    fleet->last_tick = fleet->counters;
+
+    fprintf(stderr, "fleet: %5" PRIu32 " s  ready %" PRIu32 "/%" PRIu32 "  acked %.0f/s  delivered %.0f/s\n",
+            elapsed_s, fleet->num_ready, fleet->num_devices, acked_per_s, delivered_per_s);
+
+    /* Nothing is started on the last tick, it could not be measured */
+    if (elapsed_s >= options->duration_s)
+    {
+        return;
+    }
+
+    if ((options->storm_every_s > 0u) && (elapsed_s > 0u) && ((elapsed_s % options->storm_every_s) == 0u))
+    {
+        storm(fleet);
+    }
+
+    if ((options->config_every_s > 0u) && (elapsed_s > 0u) && ((elapsed_s % options->config_every_s) == 0u) &&
+        (fleet->monitor.state == DEVICE_READY))
+    {
+        fleet_message_t *msg = enqueue(&fleet->monitor, MQTT_SUB_TOPIC);
+
+        if (msg != NULL)
+        {
+            msg->len = (uint16_t)snprintf(msg->data, sizeof(msg->data), "%s", options->config_payload);
+            fleet->last_config_us = now;
+            fleet->counters.configs_sent++;
+            publisher_service(&fleet->monitor);
+            device_schedule(&fleet->monitor);
+        }
+    }
+
+    event_loop_timer_start(&fleet->loop, &fleet->tick, fleet->start_us +
+                           ((uint64_t)(elapsed_s + 1u) * FLEET_TICK_MS * 1000u));
+}
+
+/*******************************************************************************
+ * Function Name: compare_u32
+ ******************************************************************************/
+static int compare_u32(const void *a, const void *b)
+{
+    uint32_t va = *(const uint32_t *)a;
+    uint32_t vb = *(const uint32_t *)b;
+
+    return (va > vb) - (va < vb);
+}
+
+/*******************************************************************************
+ * Function Name: percentile
+ ******************************************************************************/
+static uint32_t percentile(const uint32_t *sorted, uint32_t count, uint32_t percent)
+{
+    return sorted[(((uint64_t)count * percent) - 1u) / 100u];
+}
+
+/*******************************************************************************
+ * Function Name: print_series
+ *******************************************************************************
+ * Summary:
+ *   Writes the statistics and the histogram of latencies in microseconds,
+ *   in the format of latency_bench.c. The values are sorted in place.
+ ******************************************************************************/
+static void print_series(FILE *out, const char *name, uint32_t *values, uint32_t count, bool last)
+{
+    uint32_t buckets[FLEET_NUM_BUCKETS] = { 0 };
+    uint64_t total = 0;
+    bool first = true;
+
+    fprintf(out, "        \"%s\": {\"count\": %" PRIu32, name, count);
+    if (count > 0u)
+    {
+        qsort(values, count, sizeof(values[0]), compare_u32);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            uint32_t bucket = (values[i] == 0u) ? 0u : (32u - (uint32_t)__builtin_clz(values[i]));
+
+            total += values[i];
+            buckets[(bucket < FLEET_NUM_BUCKETS) ? bucket : (FLEET_NUM_BUCKETS - 1u)]++;
+        }
+
+        fprintf(out, ", \"min_us\": %" PRIu32 ", \"mean_us\": %.1f, \"p50_us\": %" PRIu32
+                ", \"p90_us\": %" PRIu32 ", \"p99_us\": %" PRIu32 ", \"max_us\": %" PRIu32,
+                values[0], (double)total / count, percentile(values, count, 50u),
+                percentile(values, count, 90u), percentile(values, count, 99u), values[count - 1u]);
+
+        fprintf(out, ", \"histogram\": {");
+        for (uint32_t b = 0; b < FLEET_NUM_BUCKETS; ++b)
+        {
+            if (buckets[b] > 0u)
+            {
+                fprintf(out, "%s\"%" PRIu32 "\": %" PRIu32, first ? "" : ", ", (uint32_t)1u << b, buckets[b]);
+                first = false;
+            }
+        }
+        fprintf(out, "}");
+    }
+    fprintf(out, "}%s\n", last ? "" : ",");
+}
+
+/*******************************************************************************
+ * Function Name: print_run
+ *******************************************************************************
+ * Summary:
+ *   Writes the results of one fleet size. The per-device latencies are
+ *   summarized by the distribution of the 99th percentile over the
+ *   devices, which shows whether some devices are starved.
+ ******************************************************************************/
+static void print_run(FILE *out, fleet_t *fleet, double cpu_s, bool last)
+{
+    const fleet_counters_t *c = &fleet->counters;
+    double duration_s = (double)(fleet->end_us - fleet->start_us) * 1e-6;
+    uint32_t *device_p99 = calloc(fleet->num_devices + 1u, sizeof(uint32_t));
+    fleet_series_t all = { 0 };
+    uint32_t num_p99 = 0;
+    uint32_t worst = 0;
+    uint32_t worst_p99 = 0;
+    uint64_t delivered = 0;
+
+    for (uint32_t i = 0; i < FLEET_MONITOR_TOPICS; ++i)
+    {
+        delivered += c->delivered[i];
+    }
+
+    for (uint32_t i = 0; i < fleet->num_devices; ++i)
+    {
+        fleet_series_t *series = &fleet->devices[i].latency;
+        uint32_t p99;
+
+        if (series->count == 0u)
+        {
+            continue;
+        }
+        for (uint32_t j = 0; j < series->count; ++j)
+        {
+            series_add(&all, series->values[j]);
+        }
+        qsort(series->values, series->count, sizeof(series->values[0]), compare_u32);
+        p99 = percentile(series->values, series->count, 99u);
+        if (p99 >= worst_p99)
+        {
+            worst = i;
+            worst_p99 = p99;
+        }
+        if (device_p99 != NULL)
+        {
+            device_p99[num_p99++] = p99;
+        }
+    }
+
+    fprintf(out, "    {\n");
+    fprintf(out, "      \"devices\": %" PRIu32 ",\n", fleet->num_devices);
+    fprintf(out, "      \"duration_s\": %.1f,\n", duration_s);
+    fprintf(out, "      \"ready\": %" PRIu32 ",\n", fleet->num_ready);
+    fprintf(out, "      \"failed\": %" PRIu32 ",\n", fleet->num_failed);
+    fprintf(out, "      \"loop_cpu_ratio\": %.3f,\n", cpu_s / duration_s);
+    fprintf(out, "      \"messages\": {\"queued\": %" PRIu64 ", \"queue_full\": %" PRIu64
+            ", \"published\": %" PRIu64 ", \"acked\": %" PRIu64 ", \"timeouts\": %" PRIu64
+            ", \"not_connected\": %" PRIu64 ", \"payload_overflow\": %" PRIu64 "},\n",
+            c->queued, c->queue_full, c->published, c->acked, c->timeouts, c->not_connected,
+            c->payload_overflow);
+    fprintf(out, "      \"delivered\": {");
+    for (uint32_t i = 0; i < FLEET_MONITOR_TOPICS; ++i)
+    {
+        fprintf(out, "%s\"%s\": %" PRIu64, (i > 0u) ? ", " : "", monitor_topic_keys[i], c->delivered[i]);
+    }
+    fprintf(out, "},\n");
+    fprintf(out, "      \"throughput\": {\"published_per_s\": %.1f, \"acked_per_s\": %.1f"
+            ", \"delivered_per_s\": %.1f, \"peak_acked_per_s\": %.1f, \"peak_delivered_per_s\": %.1f},\n",
+            (double)c->published / duration_s, (double)c->acked / duration_s, (double)delivered / duration_s,
+            fleet->peak_acked_per_s, fleet->peak_delivered_per_s);
+    fprintf(out, "      \"connections\": {\"attempts\": %" PRIu64 ", \"failures\": %" PRIu64
+            ", \"disconnections\": %" PRIu64 ", \"subscribe_failures\": %" PRIu64 "},\n",
+            c->connect_attempts, c->connect_failures, c->disconnections, c->subscribe_failures);
+
+    fprintf(out, "      \"convergence\": [");
+    for (uint32_t i = 0; i < fleet->num_episodes; ++i)
+    {
+        const fleet_episode_t *e = &fleet->episodes[i];
+        uint64_t attempts = ((i + 1u) < fleet->num_episodes) ? fleet->episodes[i + 1u].connect_attempts :
+                            c->connect_attempts;
+
+        fprintf(out, "%s\n        {\"start_s\": %.3f, \"devices_down\": %" PRIu32 ", \"connect_attempts\": %" PRIu64
+                ", \"converged_ms\": ", (i > 0u) ? "," : "", (double)(e->start_us - fleet->start_us) * 1e-6,
+                e->devices_down, attempts - e->connect_attempts);
+        if (e->end_us != 0u)
+        {
+            fprintf(out, "%.1f}", (double)(e->end_us - e->start_us) * 1e-3);
+        }
+        else
+        {
+            fprintf(out, "null}");
+        }
+    }
+    fprintf(out, "%s],\n", (fleet->num_episodes > 0u) ? "\n      " : "");
+
+    fprintf(out, "      \"config\": {\"sent\": %" PRIu64 ", \"received\": %" PRIu64 "},\n",
+            c->configs_sent, c->configs_received);
+
+    fprintf(out, "      \"latency\": {\n");
+    if ((device_p99 != NULL) && (num_p99 > 0u))
+    {
+        qsort(device_p99, num_p99, sizeof(device_p99[0]), compare_u32);
+        fprintf(out, "        \"device_p99\": {\"devices\": %" PRIu32 ", \"min_us\": %" PRIu32 ", \"p50_us\": %" PRIu32
+                ", \"max_us\": %" PRIu32 ", \"worst_client_id\": \"%s\"},\n", num_p99, device_p99[0],
+                percentile(device_p99, num_p99, 50u), device_p99[num_p99 - 1u], fleet->devices[worst].client_id);
+    }
+    print_series(out, "publish", all.values, all.count, false);
+    print_series(out, "config_fanout", fleet->config_latency.values, fleet->config_latency.count, true);
+    fprintf(out, "      }\n");
+    fprintf(out, "    }%s\n", last ? "" : ",");
+
+    free(all.values);
+    free(device_p99);
+}
+
+/*******************************************************************************
+ * Function Name: cpu_seconds
+ ******************************************************************************/
+static double cpu_seconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    return (double)now.tv_sec + ((double)now.tv_nsec * 1e-9);
+}
+
+/*******************************************************************************
+ * Function Name: run_fleet
+ *******************************************************************************
+ * Summary:
+ *   Runs a fleet of 'num_devices' for the configured duration and writes its
+ *   results.
+ *
+ * Return:
+ *   0 on success, -1 on error
+ ******************************************************************************/
+static int run_fleet(fleet_t *fleet, uint32_t num_devices, FILE *out, bool last)
+{
+    const fleet_options_t *options = fleet->options;
+    uint64_t now;
+    double cpu_start;
+    int result = 0;
+
+    fleet->devices = calloc(num_devices, sizeof(*fleet->devices));
+    fleet->max_episodes = 1024u;
+    fleet->episodes = calloc(fleet->max_episodes, sizeof(*fleet->episodes));
+    if ((fleet->devices == NULL) || (fleet->episodes == NULL) ||
+        (event_loop_init(&fleet->loop, num_devices + 2u) != 0))
+    {
+        free(fleet->devices);
+        free(fleet->episodes);
+        return -1;
+    }
+
+    fleet->num_devices = num_devices;
+    fleet->start_us = event_loop_now_us();
+
+    /* All devices are down at the start, the first episode is the power-up */
+    update_episodes(fleet, fleet->start_us);
+
+    device_init(fleet, &fleet->monitor, 0, true, fleet->start_us);
+    device_schedule(&fleet->monitor);
+    for (uint32_t i = 0; i < num_devices; ++i)
+    {
+        uint64_t start = fleet->start_us;
+
+        if (options->ramp_ms > 0u)
+        {
+            start += ((uint64_t)options->ramp_ms * 1000u * i) / num_devices;
+        }
+        device_init(fleet, &fleet->devices[i], i, false, start);
+        device_schedule(&fleet->devices[i]);
+    }
+
+    event_loop_timer_init(&fleet->tick, on_tick, fleet);
+    event_loop_timer_start(&fleet->loop, &fleet->tick, fleet->start_us + ((uint64_t)FLEET_TICK_MS * 1000u));
+
+    cpu_start = cpu_seconds();
+    event_loop_run(&fleet->loop, fleet->start_us + ((uint64_t)options->duration_s * 1000000u));
+    fleet->end_us = event_loop_now_us();
+    print_run(out, fleet, cpu_seconds() - cpu_start, last);
+
+    /* Disconnect cleanly, so that the broker does not count these as lost */
+    fleet->draining = true;
+    for (uint32_t i = 0; i <= num_devices; ++i)
+    {
+        fleet_device_t *dev = (i < num_devices) ? &fleet->devices[i] : &fleet->monitor;
+
+        event_loop_timer_stop(&fleet->loop, &dev->timer);
+        if ((dev->io.fd >= 0) && (dev->state != DEVICE_CONNECTING))
+        {
+            (void)sent(dev, mqtt_lite_empty(&dev->tx[dev->tx_len], tx_space(dev), MQTT_LITE_DISCONNECT));
+        }
+    }
+    event_loop_timer_stop(&fleet->loop, &fleet->tick);
+    now = event_loop_now_us();
+    event_loop_run(&fleet->loop, now + ((uint64_t)FLEET_DRAIN_MS * 1000u));
+
+    for (uint32_t i = 0; i <= num_devices; ++i)
+    {
+        fleet_device_t *dev = (i < num_devices) ? &fleet->devices[i] : &fleet->monitor;
+
+        close_socket(dev, false);
+        free(dev->latency.values);
+    }
+
+    event_loop_free(&fleet->loop);
+    free(fleet->devices);
+    free(fleet->episodes);
+    free(fleet->config_latency.values);
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: resolve
+ ******************************************************************************/
+static int resolve(fleet_t *fleet, const char *host, const char *port)
+{
+    struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM };
+    struct addrinfo *info;
+    int status = getaddrinfo(host, port, &hints, &info);
+
+    if (status != 0)
+    {
+        fprintf(stderr, "fleet: %s:%s: %s\n", host, port, gai_strerror(status));
+        return -1;
+    }
+
+    memcpy(&fleet->address, info->ai_addr, info->ai_addrlen);
+    fleet->address_len = info->ai_addrlen;
+    freeaddrinfo(info);
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: raise_file_limit
+ *******************************************************************************
+ * Summary:
+ *   Raises the limit of open files to what the devices need, as far as the
+ *   hard limit allows.
+ ******************************************************************************/
+static int raise_file_limit(uint32_t needed)
+{
+    struct rlimit limit;
+
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0)
+    {
+        return -1;
+    }
+    if (limit.rlim_cur < needed)
+    {
+        limit.rlim_cur = (limit.rlim_max < needed) ? limit.rlim_max : needed;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+    if (limit.rlim_cur < needed)
+    {
+        fprintf(stderr, "fleet: %" PRIu32 " sockets needed, the open file limit is %lu\n",
+                needed, (unsigned long)limit.rlim_cur);
+        return -1;
+    }
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: parse_sizes
+ ******************************************************************************/
+static int parse_sizes(fleet_options_t *options, const char *text)
+{
+    char *end;
+
+    options->num_sizes = 0;
+    do
+    {
+        unsigned long size = strtoul(text, &end, 0);
+
+        if ((end == text) || (size == 0u) || (size > 99999u) || (options->num_sizes >= FLEET_MAX_RUNS))
+        {
+            return -1;
+        }
+        options->sizes[options->num_sizes++] = (uint32_t)size;
+        text = end + 1;
+    } while (*end == ',');
+
+    return (*end == '\0') ? 0 : -1;
+}
+
+/*******************************************************************************
+ * Function Name: usage
+ ******************************************************************************/
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s [options] [broker[:port]]\n"
+            "  broker                      MQTT broker without TLS, default: localhost:1883\n"
+            "  -n N[,N...]                 fleet sizes, one run each, default: 100\n"
+            "  -d S                        duration of each run in seconds, default: 60\n"
+            "  -s SCENE                    occupancy script of the devices, default: pulse\n"
+            "  -o FILE                     write the results to FILE instead of stdout\n"
+            "  -u USER, -P PASSWORD        broker credentials\n"
+            "  --client-prefix ID          client ID prefix, default: " MQTT_CLIENT_IDENTIFIER "\n"
+            "  --ramp-ms MS                spread the first connections over MS, default: 0\n"
+            "  --jitter-ms MS              random delay added to the retry intervals, default: 0\n"
+            "  --storm-every S             reset the device connections every S seconds\n"
+            "  --storm-fraction F          fraction of the devices reset, default: 1\n"
+            "  --config-every S            publish a configuration every S seconds\n"
+            "  --config-payload JSON       configuration published, default: the default macro threshold\n"
+            "  --telemetry-hz HZ           diagnostics messages per device and second\n"
+            "  --telemetry-bytes N         size of the diagnostics messages, default: 200\n",
+            name);
+}
+
+/*******************************************************************************
+ * Function Name: main
+ *******************************************************************************
+ * Summary:
+ *   Runs a fleet of each requested size against the broker and writes the
+ *   results as JSON.
+ *
+ * Return:
+ *   0 on success, 1 on error
+ ******************************************************************************/
+int main(int argc, char **argv)
+{
+    static const struct option long_options[] =
+    {
+        { "client-prefix", required_argument, NULL, 'c' },
+        { "ramp-ms", required_argument, NULL, 'r' },
+        { "jitter-ms", required_argument, NULL, 'J' },
+        { "storm-every", required_argument, NULL, 'S' },
+        { "storm-fraction", required_argument, NULL, 'F' },
+        { "config-every", required_argument, NULL, 'C' },
+        { "config-payload", required_argument, NULL, 'p' },
+        { "telemetry-hz", required_argument, NULL, 't' },
+        { "telemetry-bytes", required_argument, NULL, 'b' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    /* The default macro threshold of radar_pipeline_default_config, so
+     * that the configuration storm does not change the devices
+     */
+    fleet_options_t options =
+    {
+        .host = "localhost",
+        .port = "1883",
+        .scene = "pulse",
+        .client_prefix = MQTT_CLIENT_IDENTIFIER,
+        .config_payload = "{\"macro_threshold\": \"0.50\"}",
+        .sizes = { 100 },
+        .num_sizes = 1,
+        .duration_s = 60,
+        .storm_fraction = 1.0,
+        .telemetry_bytes = 200
+    };
+    static fleet_t fleet;
+    const char *output = NULL;
+    scene_gen_t scene;
+    uint32_t max_size = 0;
+    char port[16];
+    FILE *out = stdout;
+    int result = 0;
+    int opt;
+
+    while ((opt = getopt_long(argc, argv, "n:d:s:o:u:P:h", long_options, NULL)) != -1)
+    {
+        switch (opt)
+        {
+            case 'n':
+                if (parse_sizes(&options, optarg) != 0)
+                {
+                    fprintf(stderr, "fleet: invalid fleet sizes '%s'\n", optarg);
+                    return 1;
+                }
+                break;
+
+            case 'd':
+                options.duration_s = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 's':
+                options.scene = optarg;
+                break;
+
+            case 'o':
+                output = optarg;
+                break;
+
+            case 'u':
+                options.username = optarg;
+                break;
+
+            case 'P':
+                options.password = optarg;
+                break;
+
+            case 'c':
+                options.client_prefix = optarg;
+                break;
+
+            case 'r':
+                options.ramp_ms = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'J':
+                options.jitter_ms = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'S':
+                options.storm_every_s = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'F':
+                options.storm_fraction = strtod(optarg, NULL);
+                break;
+
+            case 'C':
+                options.config_every_s = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'p':
+                options.config_payload = optarg;
+                break;
+
+            case 't':
+                options.telemetry_hz = strtod(optarg, NULL);
+                break;
+
+            case 'b':
+                options.telemetry_bytes = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (optind < argc)
+    {
+        const char *colon = strrchr(argv[optind], ':');
+
+        options.host = argv[optind];
+        if (colon != NULL)
+        {
+            static char host[256];
+
+            snprintf(host, sizeof(host), "%.*s", (int)(colon - argv[optind]), argv[optind]);
+            snprintf(port, sizeof(port), "%s", colon + 1);
+            options.host = host;
+            options.port = port;
+        }
+        optind++;
+    }
+
+    if ((optind < argc) || (options.duration_s == 0u) || (options.telemetry_bytes < 32u) ||
+        (options.storm_fraction < 0.0) || (options.storm_fraction > 1.0) || (options.telemetry_hz > 1000.0))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    if (scene_gen_init(&scene, options.scene, 1) != 0)
+    {
+        fprintf(stderr, "fleet: unknown scene '%s'\n", options.scene);
+        return 1;
+    }
+
+    for (uint32_t i = 0; i < options.num_sizes; ++i)
+    {
+        max_size = (options.sizes[i] > max_size) ? options.sizes[i] : max_size;
+    }
+    /* Devices, the monitor, the event loop and the standard streams */
+    if ((raise_file_limit(max_size + 16u) != 0) || (resolve(&fleet, options.host, options.port) != 0))
+    {
+        return 1;
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    if (output != NULL)
+    {
+        out = fopen(output, "w");
+        if (out == NULL)
+        {
+            perror(output);
+            return 1;
+        }
+    }
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"broker\": \"%s:%s\",\n", options.host, options.port);
+    fprintf(out, "  \"scene\": \"%s\",\n", options.scene);
+    fprintf(out, "  \"qos\": %u,\n", (unsigned)FLEET_QOS);
+    fprintf(out, "  \"ramp_ms\": %" PRIu32 ",\n", options.ramp_ms);
+    fprintf(out, "  \"jitter_ms\": %" PRIu32 ",\n", options.jitter_ms);
+    fprintf(out, "  \"storm_every_s\": %" PRIu32 ",\n", options.storm_every_s);
+    fprintf(out, "  \"config_every_s\": %" PRIu32 ",\n", options.config_every_s);
+    fprintf(out, "  \"telemetry_hz\": %.2f,\n", options.telemetry_hz);
+    fprintf(out, "  \"runs\": [\n");
+
+    for (uint32_t i = 0; i < options.num_sizes; ++i)
+    {
+        memset(&fleet.counters, 0, sizeof(fleet.counters));
+        memset(&fleet.monitor_counters, 0, sizeof(fleet.monitor_counters));
+        memset(&fleet.last_tick, 0, sizeof(fleet.last_tick));
+        memset(&fleet.config_latency, 0, sizeof(fleet.config_latency));
+        fleet.options = &options;
+        fleet.random_state = 0x2545F491u + i;
+        fleet.num_ready = 0;
+        fleet.num_failed = 0;
+        fleet.num_episodes = 0;
+        fleet.episode_open = false;
+        fleet.draining = false;
+        fleet.peak_acked_per_s = 0.0;
+        fleet.peak_delivered_per_s = 0.0;
+        fleet.last_config_us = 0;
+
+        fprintf(stderr, "fleet: %" PRIu32 " devices for %" PRIu32 " s\n", options.sizes[i], options.duration_s);
+        if (run_fleet(&fleet, options.sizes[i], out, (i + 1u) == options.num_sizes) != 0)
+        {
+            fprintf(stderr, "fleet: cannot create %" PRIu32 " devices\n", options.sizes[i]);
+            result = 1;
+            break;
+        }
+    }
+
+    fprintf(out, "  ]\n}\n");
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+
+    return result;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,440 @@
+/******************************************************************************
+ * File Name:   mqtt_lite.c
+ *
+ * Description: Host build: minimal MQTT 3.1.1 packet codec for the fleet tools.
+ *              Covers what the device does on the wire: CONNECT, PUBLISH with QoS 0
+ *              and 1, SUBSCRIBE to one filter, PINGREQ and DISCONNECT, plus parsing of
+ *              all packets a broker sends to such a client.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <string.h>
+
+/* Header file includes */
+#include "mqtt_lite.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define MQTT_LITE_PROTOCOL_LEVEL    (4u)
+
+#define MQTT_LITE_FLAG_CLEAN        (0x02u)
+#define MQTT_LITE_FLAG_PASSWORD     (0x40u)
+#define MQTT_LITE_FLAG_USERNAME     (0x80u)
+
+/*******************************************************************************
+ * Function Name: put_header
+ *******************************************************************************
+ * Summary:
+ *   Writes the fixed header of a packet.
+ *
+ * Parameters:
+ *   buf, size: output buffer
+ *   first: packet type and flags
+ *   remaining: size of the packet after the fixed header
+ *
+ * Return:
+ *   Size of the fixed header, or 0 if the packet does not fit
+ ******************************************************************************/
+static size_t put_header(uint8_t *buf, size_t size, uint8_t first, size_t remaining)
+{
+    size_t n = 1;
+
+    if (remaining > MQTT_LITE_MAX_REMAINING_LENGTH)
+    {
+        return 0;
+    }
+
+    buf[0] = first;
+    do
+    {
+        uint8_t digit = (uint8_t)(remaining & 0x7Fu);
+
+        remaining >>= 7;
+        if (n >= size)
+        {
+            return 0;
+        }
+        buf[n++] = digit | ((remaining > 0u) ? 0x80u : 0u);
+    } while (remaining > 0u);
+
+    return n;
+}
+
+/*******************************************************************************
+ * Function Name: put_string
+ ******************************************************************************/
+static uint8_t *put_string(uint8_t *p, const char *s, uint16_t len)
+{
+    p[0] = (uint8_t)(len >> 8);
+    p[1] = (uint8_t)len;
+    memcpy(&p[2], s, len);
+    return p + 2 + len;
+}
+
+/*******************************************************************************
+ * Function Name: header_size
+ ******************************************************************************/
+static size_t header_size(size_t remaining)
+{
+    size_t n = 2;
+
+    while (remaining >= 128u)
+    {
+        remaining >>= 7;
+        n++;
+    }
+
+    return n;
+}
+
+/*******************************************************************************
+ * Function Name: mqtt_lite_connect
+ *******************************************************************************
+ * Summary:
+ *   Encodes a CONNECT packet without will message.
+ *
+ * Parameters:
+ *   buf, size: output buffer
+ *   connect: connection parameters
+ *
+ * Return:
+ *   Packet size, or 0 if it does not fit
+ ******************************************************************************/
+size_t mqtt_lite_connect(uint8_t *buf, size_t size, const mqtt_lite_connect_t *connect)
+{
+    static const char protocol[] = "MQTT";
+    uint16_t id_len = (uint16_t)strlen(connect->client_id);
+    uint16_t user_len = (connect->username != NULL) ? (uint16_t)strlen(connect->username) : 0u;
+    uint16_t pass_len = (connect->password != NULL) ? (uint16_t)strlen(connect->password) : 0u;
+    uint8_t flags = connect->clean_session ? MQTT_LITE_FLAG_CLEAN : 0u;
+    size_t remaining = 2u + (sizeof(protocol) - 1u) + 1u + 1u + 2u + 2u + id_len;
+    size_t n;
+    uint8_t *p;
+
+    if (connect->username != NULL)
+    {
+        flags |= MQTT_LITE_FLAG_USERNAME;
+        remaining += 2u + user_len;
+
+        if (connect->password != NULL)
+        {
+            flags |= MQTT_LITE_FLAG_PASSWORD;
+            remaining += 2u + pass_len;
+        }
+    }
+
+    if ((header_size(remaining) + remaining) > size)
+    {
+        return 0;
+    }
+
+    n = put_header(buf, size, (uint8_t)(MQTT_LITE_CONNECT << 4), remaining);
+    p = put_string(&buf[n], protocol, sizeof(protocol) - 1u);
+    *p++ = MQTT_LITE_PROTOCOL_LEVEL;
+    *p++ = flags;
+    *p++ = (uint8_t)(connect->keep_alive_s >> 8);
+    *p++ = (uint8_t)connect->keep_alive_s;
+    p = put_string(p, connect->client_id, id_len);
+    if ((flags & MQTT_LITE_FLAG_USERNAME) != 0u)
+    {
+        p = put_string(p, connect->username, user_len);
+    }
+    if ((flags & MQTT_LITE_FLAG_PASSWORD) != 0u)
+    {
+        p = put_string(p, connect->password, pass_len);
+    }
+
+    return (size_t)(p - buf);
+}
+
+/*******************************************************************************
+ * Function Name: mqtt_lite_publish
+ *******************************************************************************
+ * Summary:
+ *   Encodes a PUBLISH packet.
+ *
+ * Parameters:
+ *   buf, size: output buffer
+ *   topic, topic_len: topic name
+ *   payload, payload_len: message payload
+ *   qos: 0 or 1
+ *   packet_id: identifier for QoS 1, ignored for QoS 0
+ *   dup: retransmission of a QoS 1 message
+ *   retain: retained message
+ *
+ * Return:
+ *   Packet size, or 0 if it does not fit
+ ******************************************************************************/
+size_t mqtt_lite_publish(uint8_t *buf, size_t size, const char *topic, uint16_t topic_len,
+                         const void *payload, size_t payload_len, uint8_t qos, uint16_t packet_id,
+                         bool dup, bool retain)
+{
+    size_t remaining = 2u + topic_len + ((qos > 0u) ? 2u : 0u) + payload_len;
+    uint8_t first = (uint8_t)((MQTT_LITE_PUBLISH << 4) | ((qos & 3u) << 1));
+    size_t n;
+    uint8_t *p;
+
+    if ((header_size(remaining) + remaining) > size)
+    {
+        return 0;
+    }
+
+    if (dup && (qos > 0u))
+    {
+        first |= 0x08u;
+    }
+    if (retain)
+    {
+        first |= 0x01u;
+    }
+
+    n = put_header(buf, size, first, remaining);
+    p = put_string(&buf[n], topic, topic_len);
+    if (qos > 0u)
+    {
+        *p++ = (uint8_t)(packet_id >> 8);
+        *p++ = (uint8_t)packet_id;
+    }
+    memcpy(p, payload, payload_len);
+
+    return (size_t)(p - buf) + payload_len;
+}
+
+/*******************************************************************************
+ * Function Name: mqtt_lite_subscribe
+ *******************************************************************************
+ * Summary:
+ *   Encodes a SUBSCRIBE packet for one topic filter.
+ *
+ * Parameters:
+ *   buf, size: output buffer
+ *   packet_id: identifier echoed in the SUBACK
+ *   topic, topic_len: topic filter
+ *   qos: requested QoS
+ *
+ * Return:
+ *   Packet size, or 0 if it does not fit
+ ******************************************************************************/
+size_t mqtt_lite_subscribe(uint8_t *buf, size_t size, uint16_t packet_id,
+                           const char *topic, uint16_t topic_len, uint8_t qos)
+{
+    size_t remaining = 2u + 2u + topic_len + 1u;
+    size_t n;
+    uint8_t *p;
+
+    if ((header_size(remaining) + remaining) > size)
+    {
+        return 0;
+    }
+
+    /* The reserved flags of SUBSCRIBE are 0b0010 */
+    n = put_header(buf, size, (uint8_t)((MQTT_LITE_SUBSCRIBE << 4) | 0x02u), remaining);
+    p = &buf[n];
+    *p++ = (uint8_t)(packet_id >> 8);
+    *p++ = (uint8_t)packet_id;
+    p = put_string(p, topic, topic_len);
+    *p++ = qos & 3u;
+
+    return (size_t)(p - buf);
+}
+
+/*******************************************************************************
+ * Function Name: mqtt_lite_ack
+ *******************************************************************************
+ * Summary:
+ *   Encodes a packet that only carries a packet identifier, e.g. PUBACK.
+ *
+ * Parameters:
+ *   buf, size: output buffer
+ *   type: packet type
+ *   packet_id: acknowledged identifier
+ *
+ * Return:
+ *   Packet size, or 0 if it does not fit
+ ******************************************************************************/
+size_t mqtt_lite_ack(uint8_t *buf, size_t size, mqtt_lite_type_t type, uint16_t packet_id)
+{
+    uint8_t flags = (type == MQTT_LITE_PUBREL) ? 0x02u : 0u;
+
+    if (size < 4u)
+    {
+        return 0;
+    }
+
+    buf[0] = (uint8_t)((type << 4) | flags);
+    buf[1] = 2u;
+    buf[2] = (uint8_t)(packet_id >> 8);
+    buf[3] = (uint8_t)packet_id;
+
+    return 4;
+}
+
+/*******************************************************************************
+ * Function Name: mqtt_lite_empty
+ *******************************************************************************
+ * Summary:
+ *   Encodes a packet without variable header, PINGREQ or DISCONNECT.
+ ******************************************************************************/
+size_t mqtt_lite_empty(uint8_t *buf, size_t size, mqtt_lite_type_t type)
+{
+    if (size < 2u)
+    {
+        return 0;
+    }
+
+    buf[0] = (uint8_t)(type << 4);
+    buf[1] = 0;
+
+    return 2;
+}
+
+/*******************************************************************************
+ * Function Name: mqtt_lite_parse
+ *******************************************************************************
+ * Summary:
+ *   Parses the packet at the start of a receive buffer. Topic and payload
+ *   of a PUBLISH are not copied, they stay valid as long as the buffer.
+ *
+ * Parameters:
+ *   buf, len: received bytes
+ *   packet: set to the parsed packet
+ *
+ * Return:
+ *   Size of the packet, 0 if more bytes are needed, -1 if it is malformed
+ ******************************************************************************/
+long mqtt_lite_parse(const uint8_t *buf, size_t len, mqtt_lite_packet_t *packet)
+{
+    size_t remaining = 0;
+    size_t n = 1;
+    uint32_t shift = 0;
+    const uint8_t *p;
+
+    if (len < 2u)
+    {
+        return 0;
+    }
+
+    for (;;)
+    {
+        if (n >= len)
+        {
+            return 0;
+        }
+        remaining |= (size_t)(buf[n] & 0x7Fu) << shift;
+        if ((buf[n++] & 0x80u) == 0u)
+        {
+            break;
+        }
+        shift += 7u;
+        if (n >= MQTT_LITE_MAX_HEADER_SIZE)
+        {
+            return -1;
+        }
+    }
+
+    if ((len - n) < remaining)
+    {
+        return 0;
+    }
+
+    memset(packet, 0, sizeof(*packet));
+    packet->type = (mqtt_lite_type_t)(buf[0] >> 4);
+    p = &buf[n];
+
+    switch (packet->type)
+    {
+        case MQTT_LITE_CONNACK:
+            if (remaining != 2u)
+            {
+                return -1;
+            }
+            packet->return_code = p[1];
+            break;
+
+        case MQTT_LITE_PUBLISH:
+        {
+            size_t header;
+
+            packet->qos = (buf[0] >> 1) & 3u;
+            packet->dup = (buf[0] & 0x08u) != 0u;
+            packet->retain = (buf[0] & 0x01u) != 0u;
+            if ((remaining < 2u) || (packet->qos > 2u))
+            {
+                return -1;
+            }
+            packet->topic_len = (uint16_t)((p[0] << 8) | p[1]);
+            header = 2u + packet->topic_len + ((packet->qos > 0u) ? 2u : 0u);
+            if (header > remaining)
+            {
+                return -1;
+            }
+            packet->topic = (const char *)&p[2];
+            if (packet->qos > 0u)
+            {
+                packet->packet_id = (uint16_t)((p[2 + packet->topic_len] << 8) | p[3 + packet->topic_len]);
+            }
+            packet->payload = &p[header];
+            packet->payload_len = remaining - header;
+            break;
+        }
+
+        case MQTT_LITE_PUBACK:
+        case MQTT_LITE_PUBREC:
+        case MQTT_LITE_PUBREL:
+        case MQTT_LITE_PUBCOMP:
+        case MQTT_LITE_UNSUBACK:
+            if (remaining != 2u)
+            {
+                return -1;
+            }
+            packet->packet_id = (uint16_t)((p[0] << 8) | p[1]);
+            break;
+
+        case MQTT_LITE_SUBACK:
+            if (remaining < 3u)
+            {
+                return -1;
+            }
+            packet->packet_id = (uint16_t)((p[0] << 8) | p[1]);
+            packet->return_code = p[2];
+            break;
+
+        case MQTT_LITE_PINGREQ:
+        case MQTT_LITE_PINGRESP:
+        case MQTT_LITE_DISCONNECT:
+            if (remaining != 0u)
+            {
+                return -1;
+            }
+            break;
+
+        default:
+            /* CONNECT, SUBSCRIBE and UNSUBSCRIBE are not sent to clients */
+            return -1;
+    }
+
+    return (long)(n + remaining);
+}
+
+/* [] END OF FILE */
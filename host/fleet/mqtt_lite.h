@@ -0,0 +1,114 @@
+/******************************************************************************
+ * File Name:   mqtt_lite.h
+ *
+ * Description: Host build: minimal MQTT 3.1.1 packet codec for the fleet tools.
+ *              Encodes into and parses from caller buffers without allocation.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef MQTT_LITE_H_
+#define MQTT_LITE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Fixed header plus the longest remaining length field */
+#define MQTT_LITE_MAX_HEADER_SIZE       (5u)
+
+/* Largest remaining length the protocol can encode */
+#define MQTT_LITE_MAX_REMAINING_LENGTH  (268435455u)
+
+/* CONNACK return code of an accepted connection */
+#define MQTT_LITE_CONNACK_ACCEPTED      (0u)
+
+/* SUBACK return code of a rejected subscription */
+#define MQTT_LITE_SUBACK_FAILURE        (0x80u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef enum
+{
+    MQTT_LITE_CONNECT = 1,
+    MQTT_LITE_CONNACK = 2,
+    MQTT_LITE_PUBLISH = 3,
+    MQTT_LITE_PUBACK = 4,
+    MQTT_LITE_PUBREC = 5,
+    MQTT_LITE_PUBREL = 6,
+    MQTT_LITE_PUBCOMP = 7,
+    MQTT_LITE_SUBSCRIBE = 8,
+    MQTT_LITE_SUBACK = 9,
+    MQTT_LITE_UNSUBSCRIBE = 10,
+    MQTT_LITE_UNSUBACK = 11,
+    MQTT_LITE_PINGREQ = 12,
+    MQTT_LITE_PINGRESP = 13,
+    MQTT_LITE_DISCONNECT = 14
+} mqtt_lite_type_t;
+
+/* A parsed packet. Topic and payload point into the parsed buffer. */
+typedef struct
+{
+    mqtt_lite_type_t type;
+    uint8_t qos;                /* PUBLISH only */
+    bool dup;
+    bool retain;
+    uint16_t packet_id;         /* Acknowledgements, SUBACK and QoS > 0 PUBLISH */
+    uint8_t return_code;        /* CONNACK, and the first topic of a SUBACK */
+    const char *topic;          /* PUBLISH only */
+    uint16_t topic_len;
+    const uint8_t *payload;     /* PUBLISH only */
+    size_t payload_len;
+} mqtt_lite_packet_t;
+
+typedef struct
+{
+    const char *client_id;
+    const char *username;       /* NULL for none */
+    const char *password;       /* NULL for none, requires a username */
+    uint16_t keep_alive_s;
+    bool clean_session;
+} mqtt_lite_connect_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+/* The encoders return the packet size, or 0 if it does not fit into 'size' */
+size_t mqtt_lite_connect(uint8_t *buf, size_t size, const mqtt_lite_connect_t *connect);
+size_t mqtt_lite_publish(uint8_t *buf, size_t size, const char *topic, uint16_t topic_len,
+                         const void *payload, size_t payload_len, uint8_t qos, uint16_t packet_id,
+                         bool dup, bool retain);
+size_t mqtt_lite_subscribe(uint8_t *buf, size_t size, uint16_t packet_id,
+                           const char *topic, uint16_t topic_len, uint8_t qos);
+size_t mqtt_lite_ack(uint8_t *buf, size_t size, mqtt_lite_type_t type, uint16_t packet_id);
+size_t mqtt_lite_empty(uint8_t *buf, size_t size, mqtt_lite_type_t type);
+
+/* Returns the size of the packet at the start of 'buf', 0 if it is not
+ * complete yet, or -1 if it is malformed.
+ */
+long mqtt_lite_parse(const uint8_t *buf, size_t len, mqtt_lite_packet_t *packet);
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,236 @@
+/******************************************************************************
+ * File Name:   cbor_scan.c
+ *
+ * Description: Host build: zero-allocation scanner for the members of a CBOR map.
+ *              The counterpart of json_scan.c for the payloads of payload_writer.c:
+ *              returns each key and value of the top-level map as pointers into the
+ *              payload.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file includes */
+#include <string.h>
+
+#include "cbor_scan.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Nesting skipped inside a member value */
+#define CBOR_SCAN_MAX_DEPTH         (16u)
+
+/*******************************************************************************
+ * Function Name: scan_head
+ *******************************************************************************
+ * Summary:
+ *   Reads the head of a data item: major type and argument. Indefinite
+ *   lengths are not supported; payload_writer.c does not produce them.
+ ******************************************************************************/
+static bool scan_head(cbor_scan_t *scan, uint8_t *major, uint64_t *arg)
+{
+    uint8_t info;
+    size_t bytes;
+
+    if (scan->p >= scan->end)
+    {
+        return false;
+    }
+
+    *major = (uint8_t)(*scan->p >> 5);
+    info = (uint8_t)(*scan->p & 0x1Fu);
+    scan->p++;
+
+    if (info < 24u)
+    {
+        *arg = info;
+        return true;
+    }
+    if (info > 27u)
+    {
+        return false;
+    }
+
+    bytes = (size_t)1u << (info - 24u);
+    if ((size_t)(scan->end - scan->p) < bytes)
+    {
+        return false;
+    }
+
+    *arg = 0;
+    for (size_t i = 0; i < bytes; i++)
+    {
+        *arg = (*arg << 8) | *scan->p++;
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: scan_item
+ *******************************************************************************
+ * Summary:
+ *   Scans a data item at the current position, skipping nested items.
+ ******************************************************************************/
+static bool scan_item(cbor_scan_t *scan, cbor_scan_token_t *token, uint32_t depth)
+{
+    const uint8_t *start = scan->p;
+    uint8_t major;
+    uint64_t arg;
+
+    if ((depth > CBOR_SCAN_MAX_DEPTH) || !scan_head(scan, &major, &arg))
+    {
+        return false;
+    }
+
+    token->value = arg;
+    switch (major)
+    {
+        case 0:
+        case 1:
+            token->type = (major == 0u) ? CBOR_SCAN_UINT : CBOR_SCAN_NEGINT;
+            break;
+
+        case 2:
+        case 3:
+            if ((uint64_t)(scan->end - scan->p) < arg)
+            {
+                return false;
+            }
+            token->type = (major == 2u) ? CBOR_SCAN_BYTES : CBOR_SCAN_TEXT;
+            token->ptr = scan->p;
+            token->len = (size_t)arg;
+            scan->p += arg;
+            return true;
+
+        case 4:
+        case 5:
+        {
+            cbor_scan_token_t ignored;
+            uint64_t items = (major == 4u) ? arg : (arg * 2u);
+
+            /* Each item takes at least one byte */
+            if ((uint64_t)(scan->end - scan->p) < items)
+            {
+                return false;
+            }
+            for (uint64_t i = 0; i < items; i++)
+            {
+                if (!scan_item(scan, &ignored, depth + 1u))
+                {
+                    return false;
+                }
+            }
+            token->type = (major == 4u) ? CBOR_SCAN_ARRAY : CBOR_SCAN_MAP;
+            break;
+        }
+
+        case 6:
+            /* A tag applies to the item that follows */
+            return scan_item(scan, token, depth + 1u);
+
+        default:
+            token->type = CBOR_SCAN_SIMPLE;
+            break;
+    }
+
+    token->ptr = start;
+    token->len = (size_t)(scan->p - start);
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: cbor_scan_init
+ *******************************************************************************
+ * Summary:
+ *   Starts scanning a CBOR map.
+ *
+ * Parameters:
+ *   scan: scanner
+ *   data, len: payload
+ *
+ * Return:
+ *   none, an input that is no map sets scan->error
+ ******************************************************************************/
+void cbor_scan_init(cbor_scan_t *scan, const uint8_t *data, size_t len)
+{
+    uint8_t major;
+
+    scan->p = data;
+    scan->end = data + len;
+    scan->error = false;
+    scan->done = false;
+
+    if (!scan_head(scan, &major, &scan->remaining) || (major != 5u))
+    {
+        scan->error = true;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: cbor_scan_member
+ *******************************************************************************
+ * Summary:
+ *   Returns the next member of the map.
+ *
+ * Parameters:
+ *   scan: scanner
+ *   key: set to the key
+ *   value: set to the value
+ *
+ * Return:
+ *   true if a member was found, false at the end of the map or on an
+ *   error (scan->error)
+ ******************************************************************************/
+bool cbor_scan_member(cbor_scan_t *scan, cbor_scan_token_t *key, cbor_scan_token_t *value)
+{
+    if (scan->error || scan->done)
+    {
+        return false;
+    }
+
+    if (scan->remaining == 0u)
+    {
+        scan->done = true;
+        return false;
+    }
+
+    if (!scan_item(scan, key, 0u) || !scan_item(scan, value, 0u))
+    {
+        scan->error = true;
+        return false;
+    }
+
+    scan->remaining--;
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: cbor_scan_equals
+ ******************************************************************************/
+bool cbor_scan_equals(const cbor_scan_token_t *token, const char *literal)
+{
+    size_t len = strlen(literal);
+
+    return (token->type == CBOR_SCAN_TEXT) && (token->len == len) && (memcmp(token->ptr, literal, len) == 0);
+}
+
+/* [] END OF FILE */
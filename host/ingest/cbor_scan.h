@@ -0,0 +1,73 @@
+/******************************************************************************
+ * File Name:   cbor_scan.h
+ *
+ * Description: Host build: zero-allocation scanner for the members of a CBOR map.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef CBOR_SCAN_H_
+#define CBOR_SCAN_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef enum
+{
+    CBOR_SCAN_UINT,
+    CBOR_SCAN_NEGINT,       /* The value is -1 - 'value' */
+    CBOR_SCAN_BYTES,
+    CBOR_SCAN_TEXT,
+    CBOR_SCAN_ARRAY,        /* Nested items are returned as a whole */
+    CBOR_SCAN_MAP,
+    CBOR_SCAN_SIMPLE        /* false (20), true (21), null (22), floats */
+} cbor_scan_type_t;
+
+typedef struct
+{
+    cbor_scan_type_t type;
+    const uint8_t *ptr;     /* Text and bytes: the content; else the whole item */
+    size_t len;
+    uint64_t value;         /* Number, simple value, or count of items */
+} cbor_scan_token_t;
+
+typedef struct
+{
+    const uint8_t *p;
+    const uint8_t *end;
+    uint64_t remaining;     /* Members left in the map */
+    bool error;
+    bool done;
+} cbor_scan_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+void cbor_scan_init(cbor_scan_t *scan, const uint8_t *data, size_t len);
+bool cbor_scan_member(cbor_scan_t *scan, cbor_scan_token_t *key, cbor_scan_token_t *value);
+bool cbor_scan_equals(const cbor_scan_token_t *token, const char *literal);
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,242 @@
+/******************************************************************************
+ * File Name:   device_table.c
+ *
+ * Description: Host build: open-addressing table of the per-device state of the
+ *              ingest service. Linear probing over one cache line sized entry per
+ *              device; the table doubles when it is three quarters full, so a message
+ *              for a known device touches a single line in the common case.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <stdlib.h>
+#include <string.h>
+
+/* Header file includes */
+#include "device_table.h"
+
+_Static_assert(sizeof(device_entry_t) == 64u, "device_entry_t must fill one cache line");
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define DEVICE_TABLE_MIN_CAPACITY   (64u)
+
+/*******************************************************************************
+ * Function Name: device_table_hash
+ *******************************************************************************
+ * Summary:
+ *   FNV-1a of a device ID, never 0 as that marks empty slots.
+ ******************************************************************************/
+uint64_t device_table_hash(const char *key, size_t len)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+    for (size_t i = 0; i < len; ++i)
+    {
+        hash = (hash ^ (uint8_t)key[i]) * 0x100000001b3ull;
+    }
+
+    return (hash == 0u) ? 1u : hash;
+}
+
+/*******************************************************************************
+ * Function Name: device_table_init
+ *******************************************************************************
+ * Summary:
+ *   Allocates an empty table for at least 'capacity' slots.
+ *
+ * Return:
+ *   0 on success, -1 if out of memory
+ ******************************************************************************/
+int device_table_init(device_table_t *table, uint32_t capacity)
+{
+    uint32_t size = DEVICE_TABLE_MIN_CAPACITY;
+
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+
+    table->slots = aligned_alloc(64, (size_t)size * sizeof(device_entry_t));
+    if (table->slots == NULL)
+    {
+        return -1;
+    }
+
+    table->mask = size - 1u;
+    device_table_clear(table);
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: device_table_free
+ ******************************************************************************/
+void device_table_free(device_table_t *table)
+{
+    free(table->slots);
+    table->slots = NULL;
+}
+
+/*******************************************************************************
+ * Function Name: device_table_clear
+ ******************************************************************************/
+void device_table_clear(device_table_t *table)
+{
+    memset(table->slots, 0, ((size_t)table->mask + 1u) * sizeof(device_entry_t));
+    table->count = 0;
+    table->max_probe = 0;
+}
+
+/*******************************************************************************
+ * Function Name: probe
+ *******************************************************************************
+ * Summary:
+ *   Returns the slot holding the key or the empty slot where it belongs.
+ ******************************************************************************/
+static device_entry_t *probe(const device_table_t *table, const char *key, size_t len, uint64_t hash,
+                             uint32_t *distance)
+{
+    uint32_t index = (uint32_t)hash & table->mask;
+
+    for (*distance = 0;; ++*distance)
+    {
+        device_entry_t *entry = &table->slots[index];
+
+        if ((entry->hash == 0u) ||
+            ((entry->hash == hash) && (entry->key_len == len) && (memcmp(entry->key, key, len) == 0)))
+        {
+            return entry;
+        }
+        index = (index + 1u) & table->mask;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: grow
+ ******************************************************************************/
+static int grow(device_table_t *table)
+{
+    device_table_t bigger;
+
+    if (device_table_init(&bigger, (table->mask + 1u) * 2u) != 0)
+    {
+        return -1;
+    }
+
+    for (uint32_t i = 0; i <= table->mask; ++i)
+    {
+        const device_entry_t *entry = &table->slots[i];
+        uint32_t distance;
+
+        if (entry->hash != 0u)
+        {
+            *probe(&bigger, entry->key, entry->key_len, entry->hash, &distance) = *entry;
+            bigger.max_probe = (distance > bigger.max_probe) ? distance : bigger.max_probe;
+        }
+    }
+
+    bigger.count = table->count;
+    free(table->slots);
+    *table = bigger;
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: device_table_find
+ *******************************************************************************
+ * Parameters:
+ *   table: table
+ *   key, len: device ID
+ *   hash: device_table_hash() of the ID
+ *
+ * Return:
+ *   the entry of the device, NULL if not in the table
+ ******************************************************************************/
+device_entry_t *device_table_find(const device_table_t *table, const char *key, size_t len, uint64_t hash)
+{
+    uint32_t distance;
+    device_entry_t *entry;
+
+    if (len > DEVICE_TABLE_MAX_KEY)
+    {
+        return NULL;
+    }
+
+    entry = probe(table, key, len, hash, &distance);
+    return (entry->hash != 0u) ? entry : NULL;
+}
+
+/*******************************************************************************
+ * Function Name: device_table_insert
+ *******************************************************************************
+ * Summary:
+ *   Returns the entry of a device, adding a zeroed entry for an unknown
+ *   device. Entries move when the table grows, a returned pointer is only
+ *   valid until the next insertion.
+ *
+ * Parameters:
+ *   table: table
+ *   key, len: device ID
+ *   hash: device_table_hash() of the ID
+ *   created: set to true if the entry was added
+ *
+ * Return:
+ *   the entry, NULL if the ID is too long or out of memory
+ ******************************************************************************/
+device_entry_t *device_table_insert(device_table_t *table, const char *key, size_t len, uint64_t hash, bool *created)
+{
+    uint32_t distance;
+    device_entry_t *entry;
+
+    *created = false;
+    if (len > DEVICE_TABLE_MAX_KEY)
+    {
+        return NULL;
+    }
+
+    entry = probe(table, key, len, hash, &distance);
+    if (entry->hash != 0u)
+    {
+        return entry;
+    }
+
+    if (((table->count + 1u) * 4u) > ((table->mask + 1u) * 3u))
+    {
+        if (grow(table) != 0)
+        {
+            return NULL;
+        }
+        entry = probe(table, key, len, hash, &distance);
+    }
+
+    memset(entry, 0, sizeof(*entry));
+    entry->hash = hash;
+    entry->key_len = (uint8_t)len;
+    memcpy(entry->key, key, len);
+    table->count++;
+    table->max_probe = (distance > table->max_probe) ? distance : table->max_probe;
+    *created = true;
+    return entry;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,81 @@
+/******************************************************************************
+ * File Name:   device_table.h
+ *
+ * Description: Host build: open-addressing table of the per-device state of the
+ *              ingest service.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef DEVICE_TABLE_H_
+#define DEVICE_TABLE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Longest device ID kept inline, an entry fills one cache line */
+#define DEVICE_TABLE_MAX_KEY        (32u)
+
+/* Device state as last reported on the events topic */
+#define DEVICE_STATE_UNKNOWN        (0u)
+#define DEVICE_STATE_ABSENT         (1u)
+#define DEVICE_STATE_MACRO          (2u)
+#define DEVICE_STATE_MICRO          (3u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    uint64_t hash;          /* 0 marks an empty slot */
+    uint64_t event_us;      /* Arrival of the last event */
+    uint64_t seen_us;       /* Arrival of the last message of any kind */
+    uint32_t messages;
+    uint16_t room;
+    uint8_t state;
+    uint8_t key_len;
+    char key[DEVICE_TABLE_MAX_KEY];
+} device_entry_t;
+
+typedef struct
+{
+    device_entry_t *slots;
+    uint32_t mask;          /* Capacity minus one, the capacity is a power of two */
+    uint32_t count;
+    uint32_t max_probe;     /* Longest probe sequence seen, for the reports */
+} device_table_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+uint64_t device_table_hash(const char *key, size_t len);
+int device_table_init(device_table_t *table, uint32_t capacity);
+void device_table_free(device_table_t *table);
+void device_table_clear(device_table_t *table);
+device_entry_t *device_table_find(const device_table_t *table, const char *key, size_t len, uint64_t hash);
+device_entry_t *device_table_insert(device_table_t *table, const char *key, size_t len, uint64_t hash, bool *created);
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,1561 @@
+/******************************************************************************
+ * File Name:   ingest_main.c
+ *
+ * Description: Host build: ingest service for the presence events of many devices.
+ *              Worker threads share the load of the event and status topics as members
+ *              of an MQTT shared subscription. Each worker parses the messages in place,
+ *              keeps the latest state of every device in its own open-addressing table
+ *              and acknowledges the messages in batches. The main thread merges the
+ *              worker tables at a fixed interval and writes the occupancy of each room
+ *              as one JSON line. The same receive path runs in a benchmark mode over
+ *              recorded or simulated traffic and reports messages per second per core.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <errno.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Header file includes */
+#include "device_table.h"
+#include "json_scan.h"
+#include "cbor_scan.h"
+#include "payload_writer.h"
+#include "presence_event.h"
+#include "mqtt_client_config.h"
+#include "mqtt_lite.h"
+#include "scene_gen.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define INGEST_MAX_WORKERS          (64u)
+#define INGEST_MAX_FILTERS          (8u)
+#define INGEST_MAX_ROOMS            (4096u)
+#define INGEST_MAX_NAME             (64u)
+
+/* A receive fills the buffer as far as it can, all complete packets in it
+ * are processed under one lock of the worker table
+ */
+#define INGEST_RX_BUFFER_SIZE       (64u * 1024u)
+
+/* Acknowledgements of one receive, sent with a single write */
+#define INGEST_TX_BUFFER_SIZE       (16u * 1024u)
+
+#define INGEST_RECONNECT_MS         (1000u)
+
+/* Receive timeout, bounds the reaction to a stop request */
+#define INGEST_POLL_MS              (200u)
+
+/* Room of the devices missing from the rooms file */
+#define INGEST_UNASSIGNED           "unassigned"
+
+/* Traffic simulated for the benchmark: device IDs like the 64-bit unique
+ * ID of the MCU in hex, below a site level
+ */
+#define INGEST_SIM_TOPIC_PREFIX     "site/"
+#define INGEST_SIM_TICK_MS          (100u)
+#define INGEST_SIM_SCENE_PERIOD_MS  (60000u)
+#define INGEST_SIM_PAYLOAD_SIZE     (192u)
+
+/* One in this many simulated messages is a configuration reply */
+#define INGEST_SIM_STATUS_EVERY     (16u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    uint64_t messages;          /* PUBLISH packets */
+    uint64_t bytes;             /* Their payload bytes */
+    uint64_t events;
+    uint64_t statuses;
+    uint64_t other_topics;
+    uint64_t parse_errors;      /* Events without a known PRESENCE value */
+    uint64_t replayed;          /* Events replayed from the log of a device */
+    uint64_t long_ids;          /* Device IDs above DEVICE_TABLE_MAX_KEY */
+    uint64_t connections;
+    uint64_t subscribe_failures;
+} ingest_counters_t;
+
+typedef struct
+{
+    const char *host;
+    const char *port;
+    const char *group;
+    const char *username;
+    const char *password;
+    const char *rooms_path;
+    const char *record_path;
+    const char *bench_path;
+    const char *filters[INGEST_MAX_FILTERS];
+    uint32_t num_filters;
+    uint32_t num_workers;
+    uint32_t interval_s;
+    uint32_t duration_s;
+    uint32_t stale_s;
+    uint32_t bench_devices;
+    uint32_t bench_messages;
+    uint32_t bench_s;
+    bool bench_cbor;
+    uint8_t qos;
+} ingest_options_t;
+
+/* Device to room assignment, read-only after start-up. The room of a
+ * device is the 'room' field of its entry.
+ */
+typedef struct
+{
+    char names[INGEST_MAX_ROOMS][INGEST_MAX_NAME];
+    uint32_t count;
+    device_table_t devices;
+} ingest_rooms_t;
+
+typedef struct ingest ingest_t;
+
+typedef struct
+{
+    ingest_t *ingest;
+    uint32_t index;
+    pthread_t thread;
+
+    /* Held while a receive is processed and while the table is merged */
+    pthread_mutex_t lock;
+    device_table_t table;
+    ingest_counters_t counters;
+
+    int fd;
+    uint64_t last_tx_us;
+    size_t rx_len;
+    size_t tx_len;
+    uint8_t rx[INGEST_RX_BUFFER_SIZE];
+    uint8_t tx[INGEST_TX_BUFFER_SIZE];
+} ingest_worker_t;
+
+struct ingest
+{
+    const ingest_options_t *options;
+    ingest_rooms_t *rooms;
+    ingest_worker_t *workers;
+    struct sockaddr_storage address;
+    socklen_t address_len;
+    FILE *record;
+    pthread_mutex_t record_lock;
+    device_table_t merged;
+};
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static volatile sig_atomic_t stop_requested;
+
+/*******************************************************************************
+ * Function Name: now_us
+ ******************************************************************************/
+static uint64_t now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000u) + ((uint64_t)ts.tv_nsec / 1000u);
+}
+
+/*******************************************************************************
+ * Function Name: thread_cpu_s
+ ******************************************************************************/
+static double thread_cpu_s(pthread_t thread)
+{
+    clockid_t clock;
+    struct timespec ts;
+
+    if ((pthread_getcpuclockid(thread, &clock) != 0) || (clock_gettime(clock, &ts) != 0))
+    {
+        return 0.0;
+    }
+
+    return (double)ts.tv_sec + ((double)ts.tv_nsec * 1e-9);
+}
+
+/*******************************************************************************
+ * Function Name: on_signal
+ ******************************************************************************/
+static void on_signal(int signal_number)
+{
+    (void)signal_number;
+    stop_requested = 1;
+}
+
+/*******************************************************************************
+ * Function Name: state_of
+ *******************************************************************************
+ * Summary:
+ *   Returns the state of a "PRESENCE" value, DEVICE_STATE_UNKNOWN for other
+ *   values.
+ ******************************************************************************/
+static uint8_t state_of(const void *name, size_t len)
+{
+    static const struct
+    {
+        const char *name;
+        uint8_t state;
+    } states[] =
+    {
+        { "OUT", DEVICE_STATE_ABSENT },
+        { "IN macro", DEVICE_STATE_MACRO },
+        { "IN micro", DEVICE_STATE_MICRO }
+    };
+
+    for (size_t i = 0; i < (sizeof(states) / sizeof(states[0])); ++i)
+    {
+        if ((len == strlen(states[i].name)) && (memcmp(name, states[i].name, len) == 0))
+        {
+            return states[i].state;
+        }
+    }
+
+    return DEVICE_STATE_UNKNOWN;
+}
+
+/*******************************************************************************
+ * Function Name: parse_event
+ *******************************************************************************
+ * Summary:
+ *   Returns the state reported by a payload of presence_detection_cb(), in
+ *   JSON or CBOR. Other members are skipped, so that fields added to the
+ *   events do not break older ingest services.
+ *
+ * Parameters:
+ *   payload, len: event payload
+ *   cbor: the payload is CBOR, from a topic with PAYLOAD_CBOR_TOPIC_SUFFIX
+ *   replayed: set if the event is replayed from the event log of the
+ *             device, and so is not its current state
+ *
+ * Return:
+ *   DEVICE_STATE_*, DEVICE_STATE_UNKNOWN if the payload has no state
+ ******************************************************************************/
+static uint8_t parse_event(const uint8_t *payload, size_t len, bool cbor, bool *replayed)
+{
+    uint8_t state = DEVICE_STATE_UNKNOWN;
+
+    *replayed = false;
+    if (cbor)
+    {
+        cbor_scan_t scan;
+        cbor_scan_token_t key;
+        cbor_scan_token_t value;
+
+        cbor_scan_init(&scan, payload, len);
+        while (cbor_scan_member(&scan, &key, &value))
+        {
+            if ((value.type == CBOR_SCAN_TEXT) && cbor_scan_equals(&key, "PRESENCE"))
+            {
+                state = state_of(value.ptr, value.len);
+            }
+            else if ((value.type == CBOR_SCAN_SIMPLE) && cbor_scan_equals(&key, "replayed"))
+            {
+                *replayed = (value.value == 21u);
+            }
+        }
+    }
+    else
+    {
+        json_scan_t scan;
+        json_scan_token_t key;
+        json_scan_token_t value;
+
+        json_scan_init(&scan, (const char *)payload, len);
+        while (json_scan_member(&scan, &key, &value))
+        {
+            if ((value.type == JSON_SCAN_STRING) && json_scan_equals(&key, "PRESENCE"))
+            {
+                state = state_of(value.ptr, value.len);
+            }
+            else if ((value.type == JSON_SCAN_LITERAL) && json_scan_equals(&key, "replayed"))
+            {
+                *replayed = json_scan_equals(&value, "true");
+            }
+        }
+    }
+
+    return state;
+}
+
+/*******************************************************************************
+ * Function Name: topic_equals
+ ******************************************************************************/
+static bool topic_equals(const char *level, size_t len, const char *name)
+{
+    return (len == strlen(name)) && (memcmp(level, name, len) == 0);
+}
+
+/*******************************************************************************
+ * Function Name: ingest_message
+ *******************************************************************************
+ * Summary:
+ *   Updates the state of the sending device. The last topic level names
+ *   the kind of message, with the content type as suffix for CBOR; the
+ *   level before it identifies the device. The topics without a device
+ *   level all map to the device "".
+ ******************************************************************************/
+static void ingest_message(ingest_worker_t *worker, const mqtt_lite_packet_t *packet, uint64_t now)
+{
+    const char *topic = packet->topic;
+    const char *name = topic + packet->topic_len;
+    const char *id;
+    size_t id_len;
+    size_t name_len;
+    size_t suffix_len = sizeof(PAYLOAD_CBOR_TOPIC_SUFFIX) - 1u;
+    bool is_event;
+    bool is_cbor;
+    bool created;
+    device_entry_t *entry;
+    uint64_t hash;
+
+    worker->counters.messages++;
+    worker->counters.bytes += packet->payload_len;
+
+    while ((name > topic) && (name[-1] != '/'))
+    {
+        name--;
+    }
+    name_len = (size_t)(topic + packet->topic_len - name);
+
+    is_cbor = (name_len > suffix_len) &&
+              (memcmp(name + name_len - suffix_len, PAYLOAD_CBOR_TOPIC_SUFFIX, suffix_len) == 0);
+    if (is_cbor)
+    {
+        name_len -= suffix_len;
+    }
+
+    is_event = topic_equals(name, name_len, MQTT_PUB_TOPIC_EVENTS);
+    if (!is_event && !topic_equals(name, name_len, MQTT_PUB_TOPIC_STATUS))
+    {
+        worker->counters.other_topics++;
+        return;
+    }
+
+    id = (name > topic) ? (name - 1) : name;
+    while ((id > topic) && (id[-1] != '/'))
+    {
+        id--;
+    }
+    id_len = (size_t)((name > topic) ? (name - 1 - id) : 0);
+
+    hash = device_table_hash(id, id_len);
+    entry = device_table_insert(&worker->table, id, id_len, hash, &created);
+    if (entry == NULL)
+    {
+        worker->counters.long_ids++;
+        return;
+    }
+
+    if (created)
+    {
+        const ingest_rooms_t *rooms = worker->ingest->rooms;
+        const device_entry_t *assigned = device_table_find(&rooms->devices, entry->key, entry->key_len, hash);
+
+        entry->room = (assigned != NULL) ? assigned->room : 0u;
+    }
+
+    entry->messages++;
+    entry->seen_us = now;
+
+    if (is_event)
+    {
+        bool replayed;
+        uint8_t state = parse_event(packet->payload, packet->payload_len, is_cbor, &replayed);
+
+        worker->counters.events++;
+        if (state == DEVICE_STATE_UNKNOWN)
+        {
+            worker->counters.parse_errors++;
+        }
+        else if (replayed)
+        {
+            worker->counters.replayed++;
+        }
+        else
+        {
+            entry->state = state;
+            entry->event_us = now;
+        }
+    }
+    else
+    {
+        worker->counters.statuses++;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: flush_tx
+ *******************************************************************************
+ * Return:
+ *   false if the connection failed; without a connection the data is
+ *   discarded, as the benchmark does
+ ******************************************************************************/
+static bool flush_tx(ingest_worker_t *worker)
+{
+    size_t sent = 0;
+
+    while ((worker->fd >= 0) && (sent < worker->tx_len))
+    {
+        ssize_t result = send(worker->fd, worker->tx + sent, worker->tx_len - sent, MSG_NOSIGNAL);
+
+        if (result < 0)
+        {
+            if ((errno == EINTR) || (errno == EAGAIN))
+            {
+                continue;
+            }
+            worker->tx_len = 0;
+            return false;
+        }
+        sent += (size_t)result;
+    }
+
+    if (worker->tx_len > 0u)
+    {
+        worker->last_tx_us = now_us();
+    }
+    worker->tx_len = 0;
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: consume
+ *******************************************************************************
+ * Summary:
+ *   Processes the complete packets in the receive buffer and queues their
+ *   acknowledgements. An incomplete packet at the end is kept for the next
+ *   receive.
+ *
+ * Return:
+ *   false if the stream is malformed or the broker refused the connection
+ ******************************************************************************/
+static bool consume(ingest_worker_t *worker, uint64_t now)
+{
+    size_t offset = 0;
+    bool ok = true;
+
+    pthread_mutex_lock(&worker->lock);
+
+    while (offset < worker->rx_len)
+    {
+        mqtt_lite_packet_t packet;
+        long size = mqtt_lite_parse(worker->rx + offset, worker->rx_len - offset, &packet);
+
+        if (size == 0)
+        {
+            break;
+        }
+        if (size < 0)
+        {
+            ok = false;
+            break;
+        }
+
+        switch (packet.type)
+        {
+            case MQTT_LITE_PUBLISH:
+                ingest_message(worker, &packet, now);
+                if (worker->ingest->record != NULL)
+                {
+                    pthread_mutex_lock(&worker->ingest->record_lock);
+                    fwrite(worker->rx + offset, 1, (size_t)size, worker->ingest->record);
+                    pthread_mutex_unlock(&worker->ingest->record_lock);
+                }
+                if (packet.qos > 0u)
+                {
+                    if ((INGEST_TX_BUFFER_SIZE - worker->tx_len) < 4u)
+                    {
+                        ok = flush_tx(worker);
+                    }
+                    worker->tx_len += mqtt_lite_ack(worker->tx + worker->tx_len, INGEST_TX_BUFFER_SIZE - worker->tx_len,
+                                                    (packet.qos == 1u) ? MQTT_LITE_PUBACK : MQTT_LITE_PUBREC,
+                                                    packet.packet_id);
+                }
+                break;
+
+            case MQTT_LITE_PUBREL:
+                worker->tx_len += mqtt_lite_ack(worker->tx + worker->tx_len, INGEST_TX_BUFFER_SIZE - worker->tx_len,
+                                                MQTT_LITE_PUBCOMP, packet.packet_id);
+                break;
+
+            case MQTT_LITE_CONNACK:
+                if (packet.return_code != MQTT_LITE_CONNACK_ACCEPTED)
+                {
+                    fprintf(stderr, "ingest: connection refused, return code %u\n", (unsigned)packet.return_code);
+                    ok = false;
+                }
+                break;
+
+            case MQTT_LITE_SUBACK:
+                if (packet.return_code == MQTT_LITE_SUBACK_FAILURE)
+                {
+                    worker->counters.subscribe_failures++;
+                }
+                break;
+
+            default:
+                break;
+        }
+
+        offset += (size_t)size;
+        if (!ok)
+        {
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&worker->lock);
+
+    memmove(worker->rx, worker->rx + offset, worker->rx_len - offset);
+    worker->rx_len -= offset;
+    return ok;
+}
+
+/*******************************************************************************
+ * Function Name: open_connection
+ *******************************************************************************
+ * Summary:
+ *   Connects to the broker and subscribes to the filters, in the shared
+ *   subscription group if one is configured. The CONNACK and SUBACK
+ *   packets are handled by consume().
+ *
+ * Return:
+ *   0 on success, -1 on error
+ ******************************************************************************/
+static int open_connection(ingest_worker_t *worker)
+{
+    const ingest_options_t *options = worker->ingest->options;
+    struct timeval timeout = { .tv_sec = 0, .tv_usec = INGEST_POLL_MS * 1000 };
+    char client_id[MQTT_CLIENT_IDENTIFIER_MAX_LEN + 1];
+    mqtt_lite_connect_t connect_info =
+    {
+        .client_id = client_id,
+        .username = options->username,
+        .password = options->password,
+        .keep_alive_s = MQTT_KEEP_ALIVE_SECONDS,
+        .clean_session = true
+    };
+    int one = 1;
+    size_t len;
+
+    worker->fd = socket(worker->ingest->address.ss_family, SOCK_STREAM, 0);
+    if (worker->fd < 0)
+    {
+        return -1;
+    }
+    setsockopt(worker->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    setsockopt(worker->fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    if (connect(worker->fd, (const struct sockaddr *)&worker->ingest->address, worker->ingest->address_len) != 0)
+    {
+        close(worker->fd);
+        worker->fd = -1;
+        return -1;
+    }
+
+    snprintf(client_id, sizeof(client_id), "ingest-%u-%u", (unsigned)(getpid() % 100000), (unsigned)worker->index);
+    worker->rx_len = 0;
+    worker->tx_len = mqtt_lite_connect(worker->tx, INGEST_TX_BUFFER_SIZE, &connect_info);
+
+    for (uint32_t i = 0; i < options->num_filters; ++i)
+    {
+        char filter[256];
+
+        if (options->group[0] != '\0')
+        {
+            len = (size_t)snprintf(filter, sizeof(filter), "$share/%s/%s", options->group, options->filters[i]);
+        }
+        else
+        {
+            len = (size_t)snprintf(filter, sizeof(filter), "%s", options->filters[i]);
+        }
+        worker->tx_len += mqtt_lite_subscribe(worker->tx + worker->tx_len, INGEST_TX_BUFFER_SIZE - worker->tx_len,
+                                              (uint16_t)(i + 1u), filter, (uint16_t)len, options->qos);
+    }
+
+    worker->counters.connections++;
+    return flush_tx(worker) ? 0 : -1;
+}
+
+/*******************************************************************************
+ * Function Name: close_connection
+ ******************************************************************************/
+static void close_connection(ingest_worker_t *worker, bool graceful)
+{
+    if (worker->fd < 0)
+    {
+        return;
+    }
+
+    if (graceful)
+    {
+        worker->tx_len = mqtt_lite_empty(worker->tx, INGEST_TX_BUFFER_SIZE, MQTT_LITE_DISCONNECT);
+        (void)flush_tx(worker);
+    }
+    close(worker->fd);
+    worker->fd = -1;
+}
+
+/*******************************************************************************
+ * Function Name: worker_main
+ *******************************************************************************
+ * Summary:
+ *   Receives from one broker connection until a stop is requested, and
+ *   reconnects after INGEST_RECONNECT_MS when the connection is lost.
+ ******************************************************************************/
+static void *worker_main(void *arg)
+{
+    ingest_worker_t *worker = arg;
+    uint64_t keep_alive_us = (uint64_t)MQTT_KEEP_ALIVE_SECONDS * 500000u;
+
+    while (!stop_requested)
+    {
+        bool ok;
+
+        if (open_connection(worker) != 0)
+        {
+            close_connection(worker, false);
+            for (uint32_t waited = 0; (waited < INGEST_RECONNECT_MS) && !stop_requested; waited += INGEST_POLL_MS)
+            {
+                usleep(INGEST_POLL_MS * 1000u);
+            }
+            continue;
+        }
+
+        do
+        {
+            ssize_t received = recv(worker->fd, worker->rx + worker->rx_len, INGEST_RX_BUFFER_SIZE - worker->rx_len, 0);
+            uint64_t now = now_us();
+
+            if (received > 0)
+            {
+                worker->rx_len += (size_t)received;
+                ok = consume(worker, now) && (worker->rx_len < INGEST_RX_BUFFER_SIZE);
+            }
+            else
+            {
+                ok = (received < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR));
+            }
+
+            /* Half the keep-alive interval, as the coreMQTT agent does */
+            if (ok && (worker->tx_len == 0u) && ((now - worker->last_tx_us) >= keep_alive_us))
+            {
+                worker->tx_len = mqtt_lite_empty(worker->tx, INGEST_TX_BUFFER_SIZE, MQTT_LITE_PINGREQ);
+            }
+            ok = ok && flush_tx(worker);
+        } while (ok && !stop_requested);
+
+        close_connection(worker, ok);
+        if (!ok)
+        {
+            fprintf(stderr, "ingest: worker %u lost the connection\n", (unsigned)worker->index);
+        }
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+ * Function Name: add_counters
+ ******************************************************************************/
+static void add_counters(ingest_counters_t *total, const ingest_counters_t *counters)
+{
+    total->messages += counters->messages;
+    total->bytes += counters->bytes;
+    total->events += counters->events;
+    total->statuses += counters->statuses;
+    total->other_topics += counters->other_topics;
+    total->parse_errors += counters->parse_errors;
+    total->replayed += counters->replayed;
+    total->long_ids += counters->long_ids;
+    total->connections += counters->connections;
+    total->subscribe_failures += counters->subscribe_failures;
+}
+
+/*******************************************************************************
+ * Function Name: merge
+ *******************************************************************************
+ * Summary:
+ *   Merges the worker tables. A device whose messages went to several
+ *   workers takes the state of its most recent event.
+ *
+ * Parameters:
+ *   ingest: service
+ *   total: set to the sum of the worker counters
+ ******************************************************************************/
+static void merge(ingest_t *ingest, ingest_counters_t *total)
+{
+    device_table_clear(&ingest->merged);
+    memset(total, 0, sizeof(*total));
+
+    for (uint32_t w = 0; w < ingest->options->num_workers; ++w)
+    {
+        ingest_worker_t *worker = &ingest->workers[w];
+
+        pthread_mutex_lock(&worker->lock);
+        add_counters(total, &worker->counters);
+
+        for (uint32_t i = 0; i <= worker->table.mask; ++i)
+        {
+            const device_entry_t *entry = &worker->table.slots[i];
+            device_entry_t *merged;
+            bool created;
+
+            if (entry->hash == 0u)
+            {
+                continue;
+            }
+
+            merged = device_table_insert(&ingest->merged, entry->key, entry->key_len, entry->hash, &created);
+            if (merged == NULL)
+            {
+                continue;
+            }
+            if (created)
+            {
+                merged->room = entry->room;
+            }
+            if (entry->event_us > merged->event_us)
+            {
+                merged->event_us = entry->event_us;
+                merged->state = entry->state;
+            }
+            merged->seen_us = (entry->seen_us > merged->seen_us) ? entry->seen_us : merged->seen_us;
+            merged->messages += entry->messages;
+        }
+
+        pthread_mutex_unlock(&worker->lock);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: report
+ *******************************************************************************
+ * Summary:
+ *   Writes the occupancy of each room as one JSON line. A room is occupied
+ *   if any of its devices reports presence. Devices silent for more than
+ *   --stale-s count as stale and do not make a room occupied.
+ ******************************************************************************/
+static void report(ingest_t *ingest, FILE *out, uint64_t start, uint64_t now, double interval_s,
+                   uint64_t *last_messages, double cpu_s)
+{
+    static uint32_t devices[INGEST_MAX_ROOMS];
+    static uint32_t present[INGEST_MAX_ROOMS];
+    static uint32_t stale[INGEST_MAX_ROOMS];
+    const ingest_options_t *options = ingest->options;
+    const ingest_rooms_t *rooms = ingest->rooms;
+    uint64_t stale_us = (uint64_t)options->stale_s * 1000000u;
+    ingest_counters_t total;
+    bool first = true;
+
+    merge(ingest, &total);
+
+    memset(devices, 0, rooms->count * sizeof(devices[0]));
+    memset(present, 0, rooms->count * sizeof(present[0]));
+    memset(stale, 0, rooms->count * sizeof(stale[0]));
+
+    for (uint32_t i = 0; i <= ingest->merged.mask; ++i)
+    {
+        const device_entry_t *entry = &ingest->merged.slots[i];
+
+        if (entry->hash == 0u)
+        {
+            continue;
+        }
+
+        devices[entry->room]++;
+        if ((stale_us > 0u) && ((now - entry->seen_us) > stale_us))
+        {
+            stale[entry->room]++;
+        }
+        else if ((entry->state == DEVICE_STATE_MACRO) || (entry->state == DEVICE_STATE_MICRO))
+        {
+            present[entry->room]++;
+        }
+    }
+
+    fprintf(out, "{\"time_s\": %.1f, \"messages\": %" PRIu64 ", \"messages_per_s\": %.1f, "
+            "\"messages_per_cpu_s\": %.0f, \"events\": %" PRIu64 ", \"statuses\": %" PRIu64 ", "
+            "\"parse_errors\": %" PRIu64 ", \"replayed\": %" PRIu64 ", \"long_ids\": %" PRIu64 ", "
+            "\"connections\": %" PRIu64 ", "
+            "\"subscribe_failures\": %" PRIu64 ", \"devices\": %" PRIu32 ", \"rooms\": [",
+            (double)(now - start) * 1e-6, total.messages,
+            (double)(total.messages - *last_messages) / interval_s,
+            (cpu_s > 0.0) ? ((double)total.messages / cpu_s) : 0.0,
+            total.events, total.statuses, total.parse_errors, total.replayed, total.long_ids,
+            total.connections, total.subscribe_failures, ingest->merged.count);
+
+    /* The rooms of the rooms file are always listed, "unassigned" only
+     * when devices are missing from the file
+     */
+    for (uint32_t room = (devices[0] > 0u) ? 0u : 1u; room < rooms->count; ++room)
+    {
+        fprintf(out, "%s{\"room\": \"%s\", \"devices\": %" PRIu32 ", \"present\": %" PRIu32 ", "
+                "\"stale\": %" PRIu32 ", \"occupied\": %s}",
+                first ? "" : ", ", rooms->names[room], devices[room], present[room], stale[room],
+                (present[room] > 0u) ? "true" : "false");
+        first = false;
+    }
+
+    fprintf(out, "]}\n");
+    fflush(out);
+    *last_messages = total.messages;
+}
+
+/*******************************************************************************
+ * Function Name: load_rooms
+ *******************************************************************************
+ * Summary:
+ *   Reads the room of each device from a text file with one device per
+ *   line: "<device ID> <room>". Room 0 collects the unlisted devices.
+ *
+ * Return:
+ *   0 on success, -1 on error
+ ******************************************************************************/
+static int load_rooms(ingest_rooms_t *rooms, const char *path)
+{
+    char line[256];
+    uint32_t number = 0;
+    FILE *file;
+
+    snprintf(rooms->names[0], INGEST_MAX_NAME, "%s", INGEST_UNASSIGNED);
+    rooms->count = 1;
+    if (device_table_init(&rooms->devices, 0) != 0)
+    {
+        return -1;
+    }
+    if (path == NULL)
+    {
+        return 0;
+    }
+
+    file = fopen(path, "r");
+    if (file == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        char id[DEVICE_TABLE_MAX_KEY + 2];
+        char room[INGEST_MAX_NAME];
+        char *comment = strchr(line, '#');
+        device_entry_t *entry;
+        uint32_t index;
+        bool created;
+        size_t len;
+
+        number++;
+        if (comment != NULL)
+        {
+            *comment = '\0';
+        }
+        if (sscanf(line, "%33s %63s", id, room) != 2)
+        {
+            if (sscanf(line, "%1s", room) == 1)
+            {
+                fprintf(stderr, "ingest: %s:%" PRIu32 ": expected '<device ID> <room>'\n", path, number);
+                fclose(file);
+                return -1;
+            }
+            continue;
+        }
+        if ((strlen(id) > DEVICE_TABLE_MAX_KEY) || (strpbrk(room, "\"\\") != NULL))
+        {
+            fprintf(stderr, "ingest: %s:%" PRIu32 ": invalid device ID or room name\n", path, number);
+            fclose(file);
+            return -1;
+        }
+
+        for (index = 0; (index < rooms->count) && (strcmp(rooms->names[index], room) != 0); ++index)
+        {
+        }
+        if (index == rooms->count)
+        {
+            if (rooms->count == INGEST_MAX_ROOMS)
+            {
+                fprintf(stderr, "ingest: %s: more than %u rooms\n", path, INGEST_MAX_ROOMS);
+                fclose(file);
+                return -1;
+            }
+            snprintf(rooms->names[rooms->count++], INGEST_MAX_NAME, "%s", room);
+        }
+
+        len = strlen(id);
+        entry = device_table_insert(&rooms->devices, id, len, device_table_hash(id, len), &created);
+        if (entry == NULL)
+        {
+            fclose(file);
+            return -1;
+        }
+        entry->room = (uint16_t)index;
+    }
+
+    fclose(file);
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: next_random
+ ******************************************************************************/
+static uint32_t next_random(uint32_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+/*******************************************************************************
+ * Function Name: simulate_traffic
+ *******************************************************************************
+ * Summary:
+ *   Builds the stream of PUBLISH packets a broker would deliver for
+ *   'num_devices' devices on per-device topics. Every device follows the
+ *   cycle occupancy script from a random phase and publishes the payloads
+ *   of presence_detection_cb() on state changes, with the occasional
+ *   configuration reply in between.
+ *
+ * Parameters:
+ *   cbor: the events are CBOR, on the topic with PAYLOAD_CBOR_TOPIC_SUFFIX
+ *
+ * Return:
+ *   the stream, NULL if out of memory or an event payload does not fit
+ ******************************************************************************/
+static uint8_t *simulate_traffic(uint32_t num_devices, uint32_t num_messages, bool cbor, size_t *len)
+{
+    static const presence_event_state_t states[] =
+    {
+        [SCENE_TRUTH_ABSENT] = PRESENCE_EVENT_ABSENCE,
+        [SCENE_TRUTH_MACRO] = PRESENCE_EVENT_MACRO,
+        [SCENE_TRUTH_MICRO] = PRESENCE_EVENT_MICRO
+    };
+    static const char status[] = "{\"presence configuration updated and application resumed\"}";
+    uint8_t payload[INGEST_SIM_PAYLOAD_SIZE];
+    size_t payload_len = 0;
+    size_t capacity = (size_t)num_messages * 256u;
+    uint8_t *stream = malloc(capacity);
+    uint32_t *offsets = malloc(num_devices * sizeof(uint32_t));
+    uint32_t *seqs = calloc(num_devices, sizeof(uint32_t));
+    uint8_t *truth = malloc(num_devices);
+    uint32_t random_state = 0x9E3779B9u;
+    uint32_t count = 0;
+    scene_gen_t scene;
+
+    *len = 0;
+    if ((stream == NULL) || (offsets == NULL) || (seqs == NULL) || (truth == NULL) ||
+        (scene_gen_init(&scene, "cycle", 1) != 0))
+    {
+        free(stream);
+        free(offsets);
+        free(seqs);
+        free(truth);
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < num_devices; ++i)
+    {
+        offsets[i] = next_random(&random_state) % INGEST_SIM_SCENE_PERIOD_MS;
+        truth[i] = SCENE_TRUTH_ABSENT;
+    }
+
+    for (uint32_t time_ms = 0; (count < num_messages) && (stream != NULL); time_ms += INGEST_SIM_TICK_MS)
+    {
+        for (uint32_t i = 0; (i < num_devices) && (count < num_messages); ++i)
+        {
+            float range_m;
+            scene_truth_t now = scene_gen_truth(&scene, time_ms + offsets[i], &range_m);
+            char topic[64];
+            int topic_len;
+
+            if (now == truth[i])
+            {
+                continue;
+            }
+            truth[i] = (uint8_t)now;
+
+            /* The event of presence_detection_cb() */
+            presence_event_t event =
+            {
+                .seq = ++seqs[i],
+                .timestamp_ms = time_ms + offsets[i],
+                .frame = (time_ms + offsets[i]) / INGEST_SIM_TICK_MS,
+                .range_mm = (now == SCENE_TRUTH_ABSENT) ? PRESENCE_EVENT_NO_RANGE : (int32_t)(range_m * 1000.0f),
+                .state = states[now]
+            };
+            payload_writer_t writer;
+
+            payload_writer_init(&writer, cbor ? PAYLOAD_FORMAT_CBOR : PAYLOAD_FORMAT_JSON, payload, sizeof(payload));
+            presence_event_begin(&writer, &event, 0u);
+            payload_end(&writer);
+            payload_len = payload_writer_finish(&writer);
+            if (payload_len == 0u)
+            {
+                fprintf(stderr, "ingest: event payload does not fit %u bytes\n", (unsigned)sizeof(payload));
+                free(stream);
+                stream = NULL;
+                *len = 0;
+                break;
+            }
+
+            for (uint32_t k = 0; (k < 2u) && (count < num_messages); ++k)
+            {
+                bool is_status = (k == 1u);
+
+                if (is_status && ((next_random(&random_state) % INGEST_SIM_STATUS_EVERY) != 0u))
+                {
+                    break;
+                }
+                topic_len = snprintf(topic, sizeof(topic), INGEST_SIM_TOPIC_PREFIX "%08" PRIx32 "%08" PRIx32 "/%s%s",
+                                     i * 0x9E3779B1u, i, is_status ? MQTT_PUB_TOPIC_STATUS : MQTT_PUB_TOPIC_EVENTS,
+                                     (cbor && !is_status) ? PAYLOAD_CBOR_TOPIC_SUFFIX : "");
+                *len += mqtt_lite_publish(stream + *len, capacity - *len, topic, (uint16_t)topic_len,
+                                          is_status ? (const void *)status : (const void *)payload,
+                                          is_status ? (sizeof(status) - 1u) : payload_len,
+                                          1, (uint16_t)((count % 65535u) + 1u), false, false);
+                count++;
+            }
+        }
+    }
+
+    free(offsets);
+    free(seqs);
+    free(truth);
+    return stream;
+}
+
+/*******************************************************************************
+ * Function Name: read_traffic
+ ******************************************************************************/
+static uint8_t *read_traffic(const char *path, size_t *len)
+{
+    FILE *file = fopen(path, "rb");
+    uint8_t *stream = NULL;
+    long size;
+
+    if (file == NULL)
+    {
+        perror(path);
+        return NULL;
+    }
+    if ((fseek(file, 0, SEEK_END) == 0) && ((size = ftell(file)) > 0) && (fseek(file, 0, SEEK_SET) == 0))
+    {
+        stream = malloc((size_t)size);
+        if ((stream != NULL) && (fread(stream, 1, (size_t)size, file) != (size_t)size))
+        {
+            free(stream);
+            stream = NULL;
+        }
+        *len = (size_t)size;
+    }
+    fclose(file);
+
+    if (stream == NULL)
+    {
+        fprintf(stderr, "ingest: cannot read %s\n", path);
+    }
+    return stream;
+}
+
+typedef struct
+{
+    ingest_worker_t *worker;
+    const uint8_t *stream;
+    size_t len;
+    uint32_t seconds;
+    uint32_t passes;
+    double cpu_s;
+    bool ok;
+} bench_job_t;
+
+/*******************************************************************************
+ * Function Name: bench_main
+ *******************************************************************************
+ * Summary:
+ *   Feeds the stream through consume() in receive sized pieces until the
+ *   benchmark time has passed, a whole pass at a time.
+ ******************************************************************************/
+static void *bench_main(void *arg)
+{
+    bench_job_t *job = arg;
+    ingest_worker_t *worker = job->worker;
+    uint64_t end = now_us() + ((uint64_t)job->seconds * 1000000u);
+
+    job->ok = true;
+    do
+    {
+        size_t offset = 0;
+
+        while (offset < job->len)
+        {
+            size_t piece = INGEST_RX_BUFFER_SIZE - worker->rx_len;
+
+            piece = (piece < (job->len - offset)) ? piece : (job->len - offset);
+            memcpy(worker->rx + worker->rx_len, job->stream + offset, piece);
+            worker->rx_len += piece;
+            offset += piece;
+
+            job->ok = consume(worker, now_us()) && job->ok;
+            worker->tx_len = 0;
+        }
+        job->passes++;
+    } while (job->ok && (now_us() < end));
+
+    job->cpu_s = thread_cpu_s(pthread_self());
+    return NULL;
+}
+
+/*******************************************************************************
+ * Function Name: run_bench
+ *******************************************************************************
+ * Summary:
+ *   Runs the benchmark on each worker and writes the throughput as JSON.
+ *   The workers process the stream independently, as they would with a
+ *   broker that shares the subscription between them.
+ ******************************************************************************/
+static int run_bench(ingest_t *ingest, const uint8_t *stream, size_t len, FILE *out)
+{
+    const ingest_options_t *options = ingest->options;
+    bench_job_t jobs[INGEST_MAX_WORKERS];
+    ingest_counters_t total;
+    uint64_t start = now_us();
+    uint64_t merge_start;
+    uint64_t merge_us;
+    double wall_s;
+    double cpu_s = 0.0;
+    uint32_t max_probe = 0;
+    bool ok = true;
+
+    for (uint32_t w = 0; w < options->num_workers; ++w)
+    {
+        jobs[w] = (bench_job_t){ .worker = &ingest->workers[w], .stream = stream, .len = len,
+                                 .seconds = options->bench_s };
+        if (pthread_create(&ingest->workers[w].thread, NULL, bench_main, &jobs[w]) != 0)
+        {
+            return -1;
+        }
+    }
+    for (uint32_t w = 0; w < options->num_workers; ++w)
+    {
+        pthread_join(ingest->workers[w].thread, NULL);
+        cpu_s += jobs[w].cpu_s;
+        ok = ok && jobs[w].ok;
+        max_probe = (ingest->workers[w].table.max_probe > max_probe) ? ingest->workers[w].table.max_probe : max_probe;
+    }
+    wall_s = (double)(now_us() - start) * 1e-6;
+
+    merge_start = now_us();
+    merge(ingest, &total);
+    merge_us = now_us() - merge_start;
+
+    if (!ok)
+    {
+        fprintf(stderr, "ingest: the traffic is not a stream of MQTT packets\n");
+        return -1;
+    }
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"traffic\": \"%s\",\n", (options->bench_path != NULL) ? options->bench_path : "simulated");
+    if (options->bench_path == NULL)
+    {
+        fprintf(out, "  \"events_format\": \"%s\",\n", options->bench_cbor ? "cbor" : "json");
+    }
+    fprintf(out, "  \"stream_bytes\": %zu,\n", len);
+    fprintf(out, "  \"workers\": %" PRIu32 ",\n", options->num_workers);
+    fprintf(out, "  \"passes\": %" PRIu32 ",\n", jobs[0].passes);
+    fprintf(out, "  \"messages\": %" PRIu64 ",\n", total.messages);
+    fprintf(out, "  \"events\": %" PRIu64 ",\n", total.events);
+    fprintf(out, "  \"statuses\": %" PRIu64 ",\n", total.statuses);
+    fprintf(out, "  \"parse_errors\": %" PRIu64 ",\n", total.parse_errors);
+    fprintf(out, "  \"replayed\": %" PRIu64 ",\n", total.replayed);
+    fprintf(out, "  \"devices\": %" PRIu32 ",\n", ingest->merged.count);
+    fprintf(out, "  \"max_probe\": %" PRIu32 ",\n", max_probe);
+    fprintf(out, "  \"wall_s\": %.3f,\n", wall_s);
+    fprintf(out, "  \"cpu_s\": %.3f,\n", cpu_s);
+    fprintf(out, "  \"messages_per_s\": %.0f,\n", (double)total.messages / wall_s);
+    fprintf(out, "  \"messages_per_s_per_core\": %.0f,\n", (double)total.messages / cpu_s);
+    fprintf(out, "  \"ns_per_message\": %.1f,\n", (cpu_s * 1e9) / (double)total.messages);
+    fprintf(out, "  \"payload_mb_per_s\": %.1f,\n", ((double)total.bytes / wall_s) * 1e-6);
+    fprintf(out, "  \"merge_us\": %" PRIu64 "\n", merge_us);
+    fprintf(out, "}\n");
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: run_service
+ ******************************************************************************/
+static int run_service(ingest_t *ingest, FILE *out)
+{
+    const ingest_options_t *options = ingest->options;
+    uint64_t start = now_us();
+    uint64_t next = start;
+    uint64_t last_messages = 0;
+    uint32_t started = 0;
+    struct sigaction action = { .sa_handler = on_signal };
+
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    for (; started < options->num_workers; ++started)
+    {
+        if (pthread_create(&ingest->workers[started].thread, NULL, worker_main, &ingest->workers[started]) != 0)
+        {
+            stop_requested = 1;
+            break;
+        }
+    }
+
+    /* The last report is written when the run ends, before the workers
+     * exit so that their CPU time can still be read
+     */
+    for (bool last = (started < options->num_workers); !last;)
+    {
+        uint64_t now = now_us();
+        uint64_t interval_us = (uint64_t)options->interval_s * 1000000u;
+        double cpu_s = 0.0;
+
+        if ((options->duration_s > 0u) && ((now - start) >= ((uint64_t)options->duration_s * 1000000u)))
+        {
+            stop_requested = 1;
+        }
+        last = (stop_requested != 0);
+
+        if (!last && (now < (next + interval_us)))
+        {
+            usleep(INGEST_POLL_MS * 1000u);
+            continue;
+        }
+
+        for (uint32_t w = 0; w < options->num_workers; ++w)
+        {
+            cpu_s += thread_cpu_s(ingest->workers[w].thread);
+        }
+        report(ingest, out, start, now, (double)(now - next) * 1e-6, &last_messages, cpu_s);
+        next = now;
+    }
+
+    for (uint32_t w = 0; w < started; ++w)
+    {
+        pthread_join(ingest->workers[w].thread, NULL);
+    }
+
+    return (started == options->num_workers) ? 0 : -1;
+}
+
+/*******************************************************************************
+ * Function Name: resolve
+ ******************************************************************************/
+static int resolve(ingest_t *ingest, const char *host, const char *port)
+{
+    struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM };
+    struct addrinfo *info;
+    int status = getaddrinfo(host, port, &hints, &info);
+
+    if (status != 0)
+    {
+        fprintf(stderr, "ingest: %s:%s: %s\n", host, port, gai_strerror(status));
+        return -1;
+    }
+
+    memcpy(&ingest->address, info->ai_addr, info->ai_addrlen);
+    ingest->address_len = info->ai_addrlen;
+    freeaddrinfo(info);
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: usage
+ ******************************************************************************/
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s [options] [broker[:port]]\n"
+            "  broker                      MQTT broker without TLS, default: localhost:1883\n"
+            "  -j N                        workers, default: one per CPU\n"
+            "  -g GROUP                    shared subscription group, \"\" for plain subscriptions,\n"
+            "                              default: presence-ingest\n"
+            "  -t FILTER                   topic filter, repeatable, default: the firmware topics\n"
+            "                              '" MQTT_PUB_TOPIC_EVENTS "', '" MQTT_PUB_TOPIC_EVENTS PAYLOAD_CBOR_TOPIC_SUFFIX "'\n"
+            "                              and '" MQTT_PUB_TOPIC_STATUS "'\n"
+            "  -q QOS                      subscription QoS, default: 1\n"
+            "  -r FILE                     rooms of the devices, lines of '<device ID> <room>'\n"
+            "  -i S                        report interval in seconds, default: 10\n"
+            "  -d S                        stop after S seconds, default: run until SIGINT\n"
+            "  -o FILE                     write the reports to FILE instead of stdout\n"
+            "  -u USER, -P PASSWORD        broker credentials\n"
+            "  --stale-s S                 devices silent for S seconds are stale, default: off\n"
+            "  --record FILE               save the received messages for --bench\n"
+            "  --bench FILE                benchmark over recorded messages instead of a broker\n"
+            "  --bench-sim N               benchmark over simulated messages of N devices\n"
+            "  --bench-messages N          messages simulated, default: 1000000\n"
+            "  --bench-cbor                simulated events in CBOR instead of JSON\n"
+            "  --bench-s S                 benchmark time per worker, default: 5\n",
+            name);
+}
+
+/*******************************************************************************
+ * Function Name: main
+ *******************************************************************************
+ * Summary:
+ *   Runs the ingest service against a broker, or the benchmark.
+ *
+ * Return:
+ *   0 on success, 1 on error
+ ******************************************************************************/
+int main(int argc, char **argv)
+{
+    static const struct option long_options[] =
+    {
+        { "stale-s", required_argument, NULL, 's' },
+        { "record", required_argument, NULL, 'R' },
+        { "bench", required_argument, NULL, 'B' },
+        { "bench-sim", required_argument, NULL, 'S' },
+        { "bench-messages", required_argument, NULL, 'M' },
+        { "bench-s", required_argument, NULL, 'T' },
+        { "bench-cbor", no_argument, NULL, 'C' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    ingest_options_t options =
+    {
+        .host = "localhost",
+        .port = "1883",
+        .group = "presence-ingest",
+        .num_workers = (uint32_t)sysconf(_SC_NPROCESSORS_ONLN),
+        .interval_s = 10,
+        .bench_messages = 1000000,
+        .bench_s = 5,
+        .qos = 1
+    };
+    static ingest_t ingest;
+    static ingest_rooms_t rooms;
+    const char *output = NULL;
+    uint8_t *stream = NULL;
+    size_t stream_len = 0;
+    char port[16];
+    FILE *out = stdout;
+    int result;
+    int opt;
+
+    while ((opt = getopt_long(argc, argv, "j:g:t:q:r:i:d:o:u:P:h", long_options, NULL)) != -1)
+    {
+        switch (opt)
+        {
+            case 'j':
+                options.num_workers = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'g':
+                options.group = optarg;
+                break;
+
+            case 't':
+                if (options.num_filters == INGEST_MAX_FILTERS)
+                {
+                    fprintf(stderr, "ingest: more than %u topic filters\n", INGEST_MAX_FILTERS);
+                    return 1;
+                }
+                options.filters[options.num_filters++] = optarg;
+                break;
+
+            case 'q':
+                options.qos = (uint8_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'r':
+                options.rooms_path = optarg;
+                break;
+
+            case 'i':
+                options.interval_s = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'd':
+                options.duration_s = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'o':
+                output = optarg;
+                break;
+
+            case 'u':
+                options.username = optarg;
+                break;
+
+            case 'P':
+                options.password = optarg;
+                break;
+
+            case 's':
+                options.stale_s = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'R':
+                options.record_path = optarg;
+                break;
+
+            case 'B':
+                options.bench_path = optarg;
+                break;
+
+            case 'S':
+                options.bench_devices = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'M':
+                options.bench_messages = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'T':
+                options.bench_s = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'C':
+                options.bench_cbor = true;
+                break;
+
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (optind < argc)
+    {
+        const char *colon = strrchr(argv[optind], ':');
+
+        options.host = argv[optind];
+        if (colon != NULL)
+        {
+            static char host[256];
+
+            snprintf(host, sizeof(host), "%.*s", (int)(colon - argv[optind]), argv[optind]);
+            snprintf(port, sizeof(port), "%s", colon + 1);
+            options.host = host;
+            options.port = port;
+        }
+        optind++;
+    }
+
+    if (options.num_filters == 0u)
+    {
+        options.filters[options.num_filters++] = MQTT_PUB_TOPIC_EVENTS;
+        options.filters[options.num_filters++] = MQTT_PUB_TOPIC_EVENTS PAYLOAD_CBOR_TOPIC_SUFFIX;
+        options.filters[options.num_filters++] = MQTT_PUB_TOPIC_STATUS;
+    }
+
+    if ((optind < argc) || (options.num_workers == 0u) || (options.num_workers > INGEST_MAX_WORKERS) ||
+        (options.interval_s == 0u) || (options.qos > 2u) || (options.bench_s == 0u) ||
+        (options.bench_messages == 0u))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    if ((options.num_workers > 1u) && (options.group[0] == '\0') &&
+        (options.bench_path == NULL) && (options.bench_devices == 0u))
+    {
+        fprintf(stderr, "ingest: several workers need a shared subscription group\n");
+        return 1;
+    }
+
+    ingest.options = &options;
+    ingest.rooms = &rooms;
+    ingest.workers = calloc(options.num_workers, sizeof(ingest_worker_t));
+    if ((ingest.workers == NULL) || (load_rooms(&rooms, options.rooms_path) != 0) ||
+        (device_table_init(&ingest.merged, 0) != 0))
+    {
+        return 1;
+    }
+    for (uint32_t w = 0; w < options.num_workers; ++w)
+    {
+        ingest.workers[w].ingest = &ingest;
+        ingest.workers[w].index = w;
+        ingest.workers[w].fd = -1;
+        pthread_mutex_init(&ingest.workers[w].lock, NULL);
+        if (device_table_init(&ingest.workers[w].table, 0) != 0)
+        {
+            return 1;
+        }
+    }
+    pthread_mutex_init(&ingest.record_lock, NULL);
+
+    if (output != NULL)
+    {
+        out = fopen(output, "w");
+        if (out == NULL)
+        {
+            perror(output);
+            return 1;
+        }
+    }
+
+    if ((options.bench_path != NULL) || (options.bench_devices > 0u))
+    {
+        stream = (options.bench_path != NULL) ? read_traffic(options.bench_path, &stream_len)
+                                              : simulate_traffic(options.bench_devices, options.bench_messages,
+                                                                 options.bench_cbor, &stream_len);
+        result = (stream != NULL) ? run_bench(&ingest, stream, stream_len, out) : -1;
+        free(stream);
+    }
+    else
+    {
+        if (options.record_path != NULL)
+        {
+            ingest.record = fopen(options.record_path, "wb");
+            if (ingest.record == NULL)
+            {
+                perror(options.record_path);
+                return 1;
+            }
+        }
+        result = (resolve(&ingest, options.host, options.port) == 0) ? run_service(&ingest, out) : -1;
+        if (ingest.record != NULL)
+        {
+            fclose(ingest.record);
+        }
+    }
+
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+
+    return (result == 0) ? 0 : 1;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,318 @@
+/******************************************************************************
+ * File Name:   json_scan.c
+ *
+ * Description: Host build: zero-allocation scanner for the members of a flat JSON object.
+ *              Returns each key and value of the top-level object as pointers into the
+ *              payload, so that a message is parsed without copies or allocations.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file includes */
+#include "json_scan.h"
+
+/*******************************************************************************
+ * Function Name: skip_space
+ ******************************************************************************/
+static void skip_space(json_scan_t *scan)
+{
+    while ((scan->p < scan->end) &&
+           ((*scan->p == ' ') || (*scan->p == '\t') || (*scan->p == '\r') || (*scan->p == '\n')))
+    {
+        scan->p++;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: scan_string
+ *******************************************************************************
+ * Summary:
+ *   Scans a string at the current position, which is the opening quote.
+ ******************************************************************************/
+static bool scan_string(json_scan_t *scan, json_scan_token_t *token)
+{
+    const char *start = ++scan->p;
+
+    while (scan->p < scan->end)
+    {
+        if (*scan->p == '\\')
+        {
+            scan->p += 2;
+        }
+        else if (*scan->p == '"')
+        {
+            token->type = JSON_SCAN_STRING;
+            token->ptr = start;
+            token->len = (size_t)(scan->p - start);
+            scan->p++;
+            return true;
+        }
+        else
+        {
+            scan->p++;
+        }
+    }
+
+    return false;
+}
+
+/*******************************************************************************
+ * Function Name: scan_nested
+ *******************************************************************************
+ * Summary:
+ *   Skips a nested object or array, including strings with brackets.
+ ******************************************************************************/
+static bool scan_nested(json_scan_t *scan, json_scan_token_t *token)
+{
+    const char *start = scan->p;
+    uint32_t depth = 0;
+
+    token->type = (*scan->p == '{') ? JSON_SCAN_OBJECT : JSON_SCAN_ARRAY;
+
+    while (scan->p < scan->end)
+    {
+        char c = *scan->p;
+
+        if (c == '"')
+        {
+            json_scan_token_t ignored;
+
+            if (!scan_string(scan, &ignored))
+            {
+                return false;
+            }
+            continue;
+        }
+
+        scan->p++;
+        if ((c == '{') || (c == '['))
+        {
+            depth++;
+        }
+        else if (((c == '}') || (c == ']')) && (--depth == 0u))
+        {
+            token->ptr = start;
+            token->len = (size_t)(scan->p - start);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*******************************************************************************
+ * Function Name: scan_value
+ ******************************************************************************/
+static bool scan_value(json_scan_t *scan, json_scan_token_t *token)
+{
+    const char *start = scan->p;
+
+    if (scan->p >= scan->end)
+    {
+        return false;
+    }
+
+    if (*scan->p == '"')
+    {
+        return scan_string(scan, token);
+    }
+    if ((*scan->p == '{') || (*scan->p == '['))
+    {
+        return scan_nested(scan, token);
+    }
+
+    while ((scan->p < scan->end) && (*scan->p != ',') && (*scan->p != '}') &&
+           (*scan->p != ' ') && (*scan->p != '\t') && (*scan->p != '\r') && (*scan->p != '\n'))
+    {
+        scan->p++;
+    }
+    if (scan->p == start)
+    {
+        return false;
+    }
+
+    token->type = (((*start >= '0') && (*start <= '9')) || (*start == '-')) ? JSON_SCAN_NUMBER : JSON_SCAN_LITERAL;
+    token->ptr = start;
+    token->len = (size_t)(scan->p - start);
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: json_scan_init
+ *******************************************************************************
+ * Summary:
+ *   Starts scanning a JSON object.
+ *
+ * Parameters:
+ *   scan: scanner
+ *   text, len: payload, need not be terminated
+ *
+ * Return:
+ *   none, an input that is no object sets scan->error
+ ******************************************************************************/
+void json_scan_init(json_scan_t *scan, const char *text, size_t len)
+{
+    scan->p = text;
+    scan->end = text + len;
+    scan->error = false;
+    scan->done = false;
+
+    skip_space(scan);
+    if ((scan->p < scan->end) && (*scan->p == '{'))
+    {
+        scan->p++;
+    }
+    else
+    {
+        scan->error = true;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: json_scan_member
+ *******************************************************************************
+ * Summary:
+ *   Returns the next member of the object. A key that is followed by the
+ *   end of the object or a comma has the value type JSON_SCAN_NONE; the
+ *   replies of the configuration task have this form.
+ *
+ * Parameters:
+ *   scan: scanner
+ *   key: set to the key
+ *   value: set to the value
+ *
+ * Return:
+ *   true if a member was found, false at the end of the object or on an
+ *   error (scan->error)
+ ******************************************************************************/
+bool json_scan_member(json_scan_t *scan, json_scan_token_t *key, json_scan_token_t *value)
+{
+    if (scan->error || scan->done)
+    {
+        return false;
+    }
+
+    skip_space(scan);
+    if ((scan->p < scan->end) && (*scan->p == '}'))
+    {
+        scan->done = true;
+        return false;
+    }
+
+    if ((scan->p >= scan->end) || (*scan->p != '"') || !scan_string(scan, key))
+    {
+        scan->error = true;
+        return false;
+    }
+
+    skip_space(scan);
+    if ((scan->p < scan->end) && (*scan->p == ':'))
+    {
+        scan->p++;
+        skip_space(scan);
+        if (!scan_value(scan, value))
+        {
+            scan->error = true;
+            return false;
+        }
+        skip_space(scan);
+    }
+    else
+    {
+        value->type = JSON_SCAN_NONE;
+        value->ptr = scan->p;
+        value->len = 0;
+    }
+
+    if ((scan->p < scan->end) && (*scan->p == ','))
+    {
+        scan->p++;
+    }
+    else if ((scan->p >= scan->end) || (*scan->p != '}'))
+    {
+        scan->error = true;
+        return false;
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: json_scan_equals
+ ******************************************************************************/
+bool json_scan_equals(const json_scan_token_t *token, const char *literal)
+{
+    size_t i = 0;
+
+    for (; i < token->len; ++i)
+    {
+        if (literal[i] != token->ptr[i])
+        {
+            return false;
+        }
+    }
+
+    return literal[i] == '\0';
+}
+
+/*******************************************************************************
+ * Function Name: json_scan_int
+ *******************************************************************************
+ * Summary:
+ *   Converts an integer number or a string holding one.
+ *
+ * Return:
+ *   false if the token is no integer
+ ******************************************************************************/
+bool json_scan_int(const json_scan_token_t *token, int64_t *value)
+{
+    bool negative = false;
+    int64_t result = 0;
+    size_t i = 0;
+
+    if ((token->type != JSON_SCAN_NUMBER) && (token->type != JSON_SCAN_STRING))
+    {
+        return false;
+    }
+    if ((token->len > 0u) && (token->ptr[0] == '-'))
+    {
+        negative = true;
+        i++;
+    }
+    if ((i == token->len) || ((token->len - i) > 18u))
+    {
+        return false;
+    }
+
+    for (; i < token->len; ++i)
+    {
+        if ((token->ptr[i] < '0') || (token->ptr[i] > '9'))
+        {
+            return false;
+        }
+        result = (result * 10) + (token->ptr[i] - '0');
+    }
+
+    *value = negative ? -result : result;
+    return true;
+}
+
+/* [] END OF FILE */
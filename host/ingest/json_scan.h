@@ -0,0 +1,71 @@
+/******************************************************************************
+ * File Name:   json_scan.h
+ *
+ * Description: Host build: zero-allocation scanner for the members of a flat JSON object.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef JSON_SCAN_H_
+#define JSON_SCAN_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef enum
+{
+    JSON_SCAN_NONE,         /* A key without value, as in the status replies */
+    JSON_SCAN_STRING,       /* Without the quotes, escapes are not resolved */
+    JSON_SCAN_NUMBER,
+    JSON_SCAN_LITERAL,      /* true, false or null */
+    JSON_SCAN_OBJECT,       /* Nested values are returned as a whole */
+    JSON_SCAN_ARRAY
+} json_scan_type_t;
+
+typedef struct
+{
+    json_scan_type_t type;
+    const char *ptr;
+    size_t len;
+} json_scan_token_t;
+
+typedef struct
+{
+    const char *p;
+    const char *end;
+    bool error;
+    bool done;
+} json_scan_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+void json_scan_init(json_scan_t *scan, const char *text, size_t len);
+bool json_scan_member(json_scan_t *scan, json_scan_token_t *key, json_scan_token_t *value);
+bool json_scan_equals(const json_scan_token_t *token, const char *literal);
+bool json_scan_int(const json_scan_token_t *token, int64_t *value);
+
+#endif
+/* [] END OF FILE */
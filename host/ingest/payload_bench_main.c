@@ -0,0 +1,474 @@
+/******************************************************************************
+ * File Name:   payload_bench_main.c
+ *
+ * Description: Host build: encode and decode time and size of the event payloads
+ *              in JSON and CBOR.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Header file includes */
+#include "cbor_scan.h"
+#include "json_scan.h"
+#include "payload_writer.h"
+#include "presence_event.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Timed blocks per case, the fastest one is reported */
+#define PAYLOAD_BENCH_REPEATS       (5u)
+
+/* Payloads encoded or decoded per timed block */
+#define PAYLOAD_BENCH_ITERATIONS    (100000u)
+
+/* Events of the coalesced case, as many as PUBLISHER_COALESCE_MAX_EVENTS */
+#define PAYLOAD_BENCH_BATCH         (8u)
+
+#define PAYLOAD_BENCH_BUFFER_SIZE   (512u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef enum
+{
+    PAYLOAD_BENCH_SINGLE,       /* The members of the event schema */
+    PAYLOAD_BENCH_TRACED,       /* With the latency trace ID */
+    PAYLOAD_BENCH_COALESCED,    /* A window of PAYLOAD_BENCH_BATCH events */
+    PAYLOAD_BENCH_LOGGED,       /* A replayed event of the flash log */
+    PAYLOAD_BENCH_NUM_CASES
+} payload_bench_case_t;
+
+/* "snprintf" formats the same JSON as the writer, the range as a float */
+typedef enum
+{
+    PAYLOAD_BENCH_SNPRINTF,
+    PAYLOAD_BENCH_JSON,
+    PAYLOAD_BENCH_CBOR,
+    PAYLOAD_BENCH_NUM_VARIANTS
+} payload_bench_variant_t;
+
+typedef struct
+{
+    FILE *out;
+    uint32_t count;
+} payload_bench_output_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static const char *const case_names[PAYLOAD_BENCH_NUM_CASES] =
+{
+    "single", "traced", "coalesced", "logged"
+};
+
+static const char *const variant_names[PAYLOAD_BENCH_NUM_VARIANTS] =
+{
+    "snprintf", "json", "cbor"
+};
+
+/* Keeps the compiler from dropping the timed loops */
+static volatile uint32_t sink;
+
+/*******************************************************************************
+ * Function Name: now_ns
+ ******************************************************************************/
+static uint64_t now_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000ULL) + (uint64_t)now.tv_nsec;
+}
+
+/*******************************************************************************
+ * Function Name: bench_event
+ *******************************************************************************
+ * Summary:
+ *   Returns event 'e' of iteration 'i', so that the values vary.
+ ******************************************************************************/
+static presence_event_t bench_event(uint32_t i, uint32_t e)
+{
+    presence_event_t event =
+    {
+        .seq = i + e + 1u,
+        .timestamp_ms = 1000000u + i + (e * 25u),
+        .frame = 10000u + i + e,
+        .range_mm = 326 * (int32_t)((i + e) % 16u),
+        .state = (presence_event_state_t)(1u + ((i + e) % 2u))
+    };
+
+    return event;
+}
+
+/*******************************************************************************
+ * Function Name: encode_snprintf
+ *******************************************************************************
+ * Summary:
+ *   Formats the payload of a case with snprintf() and the range as a float,
+ *   the way a payload would be formatted without the payload writer.
+ *
+ * Parameters:
+ *   bench_case: payload to format
+ *   i: varies the values between iterations
+ *   buf, size: output buffer
+ *
+ * Return:
+ *   Length of the text
+ ******************************************************************************/
+static size_t encode_snprintf(payload_bench_case_t bench_case, uint32_t i, char *buf, size_t size)
+{
+    uint32_t last = (bench_case == PAYLOAD_BENCH_COALESCED) ? (PAYLOAD_BENCH_BATCH - 1u) : 0u;
+    presence_event_t event = bench_event(i, last);
+    size_t len;
+
+    len = (size_t)snprintf(buf, size, "{\"v\": %u, \"PRESENCE\": \"%s\", \"seq\": %" PRIu32 ", \"timestamp\": %" PRIu32
+                           ", \"frame\": %" PRIu32 ", \"range_m\": %.3f",
+                           PRESENCE_EVENT_SCHEMA_VERSION, presence_event_state_name(event.state), event.seq,
+                           event.timestamp_ms, event.frame, (double)((float)event.range_mm / 1000.0f));
+
+    switch (bench_case)
+    {
+        case PAYLOAD_BENCH_SINGLE:
+            break;
+
+        case PAYLOAD_BENCH_TRACED:
+            len += (size_t)snprintf(&buf[len], size - len, ", \"trace\": %" PRIu32, i);
+            break;
+
+        case PAYLOAD_BENCH_COALESCED:
+            len += (size_t)snprintf(&buf[len], size - len, ", \"events\": [");
+            for (uint32_t e = 0u; e < PAYLOAD_BENCH_BATCH; e++)
+            {
+                presence_event_t held = bench_event(i, e);
+
+                len += (size_t)snprintf(&buf[len], size - len, "%s[\"%s\", %" PRIu32 ", %" PRIu32 "]",
+                                        (e > 0u) ? ", " : "", presence_event_state_name(held.state),
+                                        held.timestamp_ms, held.seq);
+            }
+            len += (size_t)snprintf(&buf[len], size - len, "], \"trace\": %" PRIu32, i);
+            break;
+
+        case PAYLOAD_BENCH_LOGGED:
+        default:
+            len += (size_t)snprintf(&buf[len], size - len, ", \"replayed\": true");
+            break;
+    }
+    len += (size_t)snprintf(&buf[len], size - len, "}");
+
+    return len;
+}
+
+/*******************************************************************************
+ * Function Name: encode_writer
+ *******************************************************************************
+ * Summary:
+ *   Encodes the payload of a case with the payload writer, with the members
+ *   of the application.
+ *
+ * Parameters:
+ *   bench_case: payload to encode
+ *   format: JSON or CBOR
+ *   i: varies the values between iterations
+ *   buf, size: output buffer
+ *
+ * Return:
+ *   Length of the payload
+ ******************************************************************************/
+static size_t encode_writer(payload_bench_case_t bench_case, payload_format_t format, uint32_t i,
+                            void *buf, size_t size)
+{
+    uint32_t last = (bench_case == PAYLOAD_BENCH_COALESCED) ? (PAYLOAD_BENCH_BATCH - 1u) : 0u;
+    presence_event_t event = bench_event(i, last);
+    payload_writer_t writer;
+
+    payload_writer_init(&writer, format, buf, size);
+
+    switch (bench_case)
+    {
+        case PAYLOAD_BENCH_SINGLE:
+            presence_event_begin(&writer, &event, 0u);
+            break;
+
+        case PAYLOAD_BENCH_TRACED:
+            presence_event_begin(&writer, &event, 1u);
+            payload_key(&writer, "trace");
+            payload_uint(&writer, i);
+            break;
+
+        case PAYLOAD_BENCH_COALESCED:
+            presence_event_begin(&writer, &event, 2u);
+            payload_key(&writer, "events");
+            payload_begin_array(&writer, PAYLOAD_BENCH_BATCH);
+            for (uint32_t e = 0u; e < PAYLOAD_BENCH_BATCH; e++)
+            {
+                presence_event_t held = bench_event(i, e);
+
+                payload_begin_array(&writer, 3u);
+                payload_string(&writer, presence_event_state_name(held.state));
+                payload_uint(&writer, held.timestamp_ms);
+                payload_uint(&writer, held.seq);
+                payload_end(&writer);
+            }
+            payload_end(&writer);
+            payload_key(&writer, "trace");
+            payload_uint(&writer, i);
+            break;
+
+        case PAYLOAD_BENCH_LOGGED:
+        default:
+            presence_event_begin(&writer, &event, 1u);
+            payload_key(&writer, "replayed");
+            payload_bool(&writer, true);
+            break;
+    }
+
+    payload_end(&writer);
+    return payload_writer_finish(&writer);
+}
+
+/*******************************************************************************
+ * Function Name: decode
+ *******************************************************************************
+ * Summary:
+ *   Walks the members of a payload the way the ingest service does: finds
+ *   the state and the trace ID.
+ *
+ * Return:
+ *   Number of members, 0 on a malformed payload
+ ******************************************************************************/
+static uint32_t decode(payload_format_t format, const uint8_t *payload, size_t len)
+{
+    uint32_t members = 0u;
+    uint32_t found = 0u;
+
+    if (format == PAYLOAD_FORMAT_CBOR)
+    {
+        cbor_scan_t scan;
+        cbor_scan_token_t key;
+        cbor_scan_token_t value;
+
+        cbor_scan_init(&scan, payload, len);
+        while (cbor_scan_member(&scan, &key, &value))
+        {
+            members++;
+            found += (cbor_scan_equals(&key, "PRESENCE") && (value.type == CBOR_SCAN_TEXT)) ? 1u : 0u;
+            found += (cbor_scan_equals(&key, "trace") && (value.type == CBOR_SCAN_UINT)) ? 1u : 0u;
+        }
+        return (scan.error || (found == 0u)) ? 0u : members;
+    }
+    else
+    {
+        json_scan_t scan;
+        json_scan_token_t key;
+        json_scan_token_t value;
+        int64_t number;
+
+        json_scan_init(&scan, (const char *)payload, len);
+        while (json_scan_member(&scan, &key, &value))
+        {
+            members++;
+            found += (json_scan_equals(&key, "PRESENCE") && (value.type == JSON_SCAN_STRING)) ? 1u : 0u;
+            found += (json_scan_equals(&key, "trace") && json_scan_int(&value, &number)) ? 1u : 0u;
+        }
+        return (scan.error || (found == 0u)) ? 0u : members;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: time_encode
+ ******************************************************************************/
+static double time_encode(payload_bench_case_t bench_case, payload_bench_variant_t variant)
+{
+    static uint8_t buf[PAYLOAD_BENCH_BUFFER_SIZE];
+    uint64_t best = UINT64_MAX;
+
+    for (uint32_t r = 0u; r < PAYLOAD_BENCH_REPEATS; r++)
+    {
+        uint64_t start = now_ns();
+        size_t total = 0u;
+
+        for (uint32_t i = 0u; i < PAYLOAD_BENCH_ITERATIONS; i++)
+        {
+            if (variant == PAYLOAD_BENCH_SNPRINTF)
+            {
+                total += encode_snprintf(bench_case, i, (char *)buf, sizeof(buf));
+            }
+            else
+            {
+                total += encode_writer(bench_case, (variant == PAYLOAD_BENCH_CBOR) ? PAYLOAD_FORMAT_CBOR :
+                                       PAYLOAD_FORMAT_JSON, i, buf, sizeof(buf));
+            }
+        }
+
+        uint64_t elapsed = now_ns() - start;
+        sink += (uint32_t)total;
+        best = (elapsed < best) ? elapsed : best;
+    }
+
+    return (double)best / PAYLOAD_BENCH_ITERATIONS;
+}
+
+/*******************************************************************************
+ * Function Name: time_decode
+ *******************************************************************************
+ * Summary:
+ *   Times the decoding of one payload of the case.
+ *
+ * Return:
+ *   Nanoseconds per payload, negative if the payload does not decode
+ ******************************************************************************/
+static double time_decode(payload_format_t format, const uint8_t *payload, size_t len)
+{
+    uint64_t best = UINT64_MAX;
+
+    if (decode(format, payload, len) == 0u)
+    {
+        return -1.0;
+    }
+
+    for (uint32_t r = 0u; r < PAYLOAD_BENCH_REPEATS; r++)
+    {
+        uint64_t start = now_ns();
+        uint32_t total = 0u;
+
+        for (uint32_t i = 0u; i < PAYLOAD_BENCH_ITERATIONS; i++)
+        {
+            total += decode(format, payload, len);
+        }
+
+        uint64_t elapsed = now_ns() - start;
+        sink += total;
+        best = (elapsed < best) ? elapsed : best;
+    }
+
+    return (double)best / PAYLOAD_BENCH_ITERATIONS;
+}
+
+/*******************************************************************************
+ * Function Name: run_case
+ *******************************************************************************
+ * Summary:
+ *   Measures the three variants of a case and writes one result each. The
+ *   JSON of the writer must equal the snprintf text byte for byte.
+ *
+ * Return:
+ *   Number of failed checks
+ ******************************************************************************/
+static uint32_t run_case(payload_bench_case_t bench_case, payload_bench_output_t *output)
+{
+    char reference[PAYLOAD_BENCH_BUFFER_SIZE];
+    uint8_t payload[PAYLOAD_BENCH_BUFFER_SIZE];
+    size_t reference_len = encode_snprintf(bench_case, 0u, reference, sizeof(reference));
+    uint32_t failures = 0u;
+
+    for (uint32_t v = 0u; v < PAYLOAD_BENCH_NUM_VARIANTS; v++)
+    {
+        payload_format_t format = (v == PAYLOAD_BENCH_CBOR) ? PAYLOAD_FORMAT_CBOR : PAYLOAD_FORMAT_JSON;
+        size_t len;
+        bool match = true;
+
+        if (v == PAYLOAD_BENCH_SNPRINTF)
+        {
+            len = reference_len;
+            memcpy(payload, reference, len);
+        }
+        else
+        {
+            len = encode_writer(bench_case, format, 0u, payload, sizeof(payload));
+            if (v == PAYLOAD_BENCH_JSON)
+            {
+                match = (len == reference_len) && (memcmp(payload, reference, len) == 0);
+            }
+        }
+
+        double encode_ns = time_encode(bench_case, (payload_bench_variant_t)v);
+        double decode_ns = time_decode(format, payload, len);
+
+        match = match && (len > 0u) && (decode_ns >= 0.0);
+        failures += match ? 0u : 1u;
+
+        fprintf(output->out, "%s    {\"case\": \"%s\", \"format\": \"%s\", \"bytes\": %zu, "
+                "\"encode_ns\": %.1f, \"decode_ns\": %.1f, \"match\": %s}",
+                (output->count > 0u) ? ",\n" : "", case_names[bench_case], variant_names[v], len,
+                encode_ns, decode_ns, match ? "true" : "false");
+        output->count++;
+
+        fprintf(stderr, "payload_bench: %-9s %-8s %4zu bytes %8.1f ns encode %8.1f ns decode%s\n",
+                case_names[bench_case], variant_names[v], len, encode_ns, decode_ns, match ? "" : " mismatch");
+    }
+
+    return failures;
+}
+
+/*******************************************************************************
+ * Function Name: main
+ *******************************************************************************
+ * Return:
+ *   0 on success, 1 on error or if a payload does not round-trip
+ ******************************************************************************/
+int main(int argc, char **argv)
+{
+    payload_bench_output_t output = { .out = stdout };
+    uint32_t failures = 0u;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "o:h")) != -1)
+    {
+        if (opt != 'o')
+        {
+            fprintf(stderr, "usage: %s [-o FILE]\n", argv[0]);
+            return 1;
+        }
+        output.out = fopen(optarg, "w");
+        if (output.out == NULL)
+        {
+            perror(optarg);
+            return 1;
+        }
+    }
+
+    fprintf(output.out, "{\n  \"unit\": \"ns\",\n  \"repeats\": %u,\n  \"iterations\": %u,\n  \"results\": [\n",
+            PAYLOAD_BENCH_REPEATS, PAYLOAD_BENCH_ITERATIONS);
+    for (uint32_t c = 0u; c < PAYLOAD_BENCH_NUM_CASES; c++)
+    {
+        failures += run_case((payload_bench_case_t)c, &output);
+    }
+    fprintf(output.out, "\n  ],\n  \"mismatches\": %" PRIu32 "\n}\n", failures);
+
+    if (output.out != stdout)
+    {
+        fclose(output.out);
+    }
+
+    return (failures == 0u) ? 0 : 1;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,470 @@
+/******************************************************************************
+ * File Name:   bgt60_sim.c
+ *
+ * Description: Host build: simulated XENSIV BGT60TRxx sensor. A task stands in
+ *              for the frame generation of the sensor: it writes one frame into the
+ *              simulated FIFO every frame period and raises the FIFO interrupt when the
+ *              fill level reaches the FIFO limit. Frames come from a synthetic scene
+ *              or from a file of raw frames.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Header file includes */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "radar_settings.h"
+#include "scene_gen.h"
+#include "xensiv_bgt60trxx_mtb.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* The simulated sensor preempts all application tasks, like hardware */
+#define BGT60_SIM_TASK_PRIORITY     (configMAX_PRIORITIES - 1)
+#define BGT60_SIM_TASK_STACK_SIZE   (1024 * 4)
+
+#define BGT60_SIM_FRAME_SAMPLES     (RADAR_SETTINGS_NUM_SAMPLES_PER_FRAME)
+#define BGT60_SIM_FIFO_SAMPLES      (RADAR_SETTINGS_FIFO_DEPTH_SAMPLES)
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static struct
+{
+    uint16_t fifo[BGT60_SIM_FIFO_SAMPLES];
+    uint32_t fifo_read;
+    uint32_t fifo_fill;
+    uint32_t fifo_limit;
+    bool overflow;
+    bool irq_level;
+    volatile bool running;
+
+    cyhal_gpio_event_callback_t callback;
+    void *callback_arg;
+
+    /* Frame source */
+    scene_gen_t scene;
+    uint16_t *file_frames;
+    uint32_t file_num_frames;
+    uint32_t frame_index;
+} sim;
+
+/*******************************************************************************
+ * Function Name: load_frames
+ *******************************************************************************
+ * Summary:
+ *   Loads a file of raw frames: little-endian 16-bit samples,
+ *   RADAR_SETTINGS_NUM_SAMPLES_PER_FRAME per frame. The file is replayed in
+ *   a loop.
+ *
+ * Parameters:
+ *   path: file to load
+ *
+ * Return:
+ *   0 on success, -1 on error
+ ******************************************************************************/
+static int load_frames(const char *path)
+{
+    const size_t frame_bytes = BGT60_SIM_FRAME_SAMPLES * sizeof(uint16_t);
+    FILE *file = fopen(path, "rb");
+    long size;
+
+    if (file == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+
+    fseek(file, 0, SEEK_END);
+    size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    if ((size <= 0) || (((size_t)size % frame_bytes) != 0u))
+    {
+        fprintf(stderr, "%s: size is not a multiple of %zu bytes\n", path, frame_bytes);
+        fclose(file);
+        return -1;
+    }
+
+    sim.file_frames = malloc((size_t)size);
+    if ((sim.file_frames == NULL) || (fread(sim.file_frames, 1, (size_t)size, file) != (size_t)size))
+    {
+        fprintf(stderr, "%s: read failed\n", path);
+        fclose(file);
+        return -1;
+    }
+
+    fclose(file);
+    sim.file_num_frames = (uint32_t)((size_t)size / frame_bytes);
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: fifo_reset
+ ******************************************************************************/
+static void fifo_reset(void)
+{
+    sim.fifo_read = 0;
+    sim.fifo_fill = 0;
+    sim.overflow = false;
+    sim.irq_level = false;
+}
+
+/*******************************************************************************
+ * Function Name: update_irq
+ *******************************************************************************
+ * Summary:
+ *   Updates the FIFO interrupt line. It is high while the fill level is at
+ *   or above the limit; the GPIO interrupt fires on the rising edge only.
+ *   Must be called in a critical section.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   true on a rising edge
+ ******************************************************************************/
+static bool update_irq(void)
+{
+    bool level = (sim.fifo_limit != 0u) && (sim.fifo_fill >= sim.fifo_limit);
+    bool rising = level && !sim.irq_level;
+
+    sim.irq_level = level;
+    return rising;
+}
+
+/*******************************************************************************
+ * Function Name: generate_frame
+ *******************************************************************************
+ * Summary:
+ *   Writes the next frame into the FIFO. A full FIFO sets the sticky
+ *   overflow error, as the sensor does.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   true if the interrupt line had a rising edge
+ ******************************************************************************/
+static bool generate_frame(void)
+{
+    uint16_t frame[BGT60_SIM_FRAME_SAMPLES];
+    uint32_t time_ms = (uint32_t)(((uint64_t)sim.frame_index * RADAR_SETTINGS_FRAME_PERIOD_US) / 1000u);
+    bool rising = false;
+
+    if (sim.file_frames != NULL)
+    {
+        memcpy(frame, &sim.file_frames[(sim.frame_index % sim.file_num_frames) * BGT60_SIM_FRAME_SAMPLES],
+               sizeof(frame));
+    }
+    else
+    {
+        scene_gen_frame(&sim.scene, time_ms, frame);
+    }
+    sim.frame_index++;
+
+    taskENTER_CRITICAL();
+    if ((sim.fifo_fill + BGT60_SIM_FRAME_SAMPLES) > BGT60_SIM_FIFO_SAMPLES)
+    {
+        sim.overflow = true;
+    }
+    else
+    {
+        for (uint32_t i = 0; i < BGT60_SIM_FRAME_SAMPLES; ++i)
+        {
+            sim.fifo[(sim.fifo_read + sim.fifo_fill + i) % BGT60_SIM_FIFO_SAMPLES] = frame[i];
+        }
+        sim.fifo_fill += BGT60_SIM_FRAME_SAMPLES;
+        rising = update_irq();
+    }
+    taskEXIT_CRITICAL();
+
+    return rising;
+}
+
+/*******************************************************************************
+ * Function Name: bgt60_sim_task
+ *******************************************************************************
+ * Summary:
+ *   Frame generation of the simulated sensor. Frame times are accumulated
+ *   in microseconds, so the frame rate matches the profile on average even
+ *   though the tick is one millisecond.
+ *
+ * Parameters:
+ *   pvParameters: unused
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void bgt60_sim_task(void *pvParameters)
+{
+    TickType_t start = xTaskGetTickCount();
+    uint64_t elapsed_us = 0;
+
+    (void)pvParameters;
+
+    for (;;)
+    {
+        TickType_t now;
+        TickType_t due;
+
+        elapsed_us += RADAR_SETTINGS_FRAME_PERIOD_US;
+        due = start + (TickType_t)pdMS_TO_TICKS(elapsed_us / 1000u);
+        now = xTaskGetTickCount();
+        if ((int32_t)(due - now) > 0)
+        {
+            vTaskDelay(due - now);
+        }
+
+        if (sim.running && generate_frame() && (sim.callback != NULL))
+        {
+            /* Runs in task context; the FromISR APIs used by the handler
+             * are valid there on the POSIX port.
+             */
+            sim.callback(sim.callback_arg, CYHAL_GPIO_IRQ_RISE);
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: xensiv_bgt60trxx_mtb_init
+ *******************************************************************************
+ * Summary:
+ *   Initializes the simulated sensor and starts its task. The frame source
+ *   is selected with environment variables:
+ *     PRESENCE_SIM_FRAMES  file of raw frames, replayed in a loop
+ *     PRESENCE_SIM_SCENE   synthetic scene: empty, walk, sit, cycle or pulse
+ *     PRESENCE_SIM_SEED    noise seed of the synthetic scene
+ *
+ * Parameters:
+ *   obj: sensor object
+ *   spi, selpin, rstpin: bus and pins (unused)
+ *   regs, len: register list
+ *
+ * Return:
+ *   CY_RSLT_SUCCESS, or an error if the frame source cannot be opened
+ ******************************************************************************/
+cy_rslt_t xensiv_bgt60trxx_mtb_init(xensiv_bgt60trxx_mtb_t *obj, cyhal_spi_t *spi,
+                                    cyhal_gpio_t selpin, cyhal_gpio_t rstpin,
+                                    const uint32_t *regs, uint32_t len)
+{
+    const char *frames_path = getenv("PRESENCE_SIM_FRAMES");
+    const char *scene_name = getenv("PRESENCE_SIM_SCENE");
+    const char *seed = getenv("PRESENCE_SIM_SEED");
+
+    (void)spi;
+    (void)selpin;
+    (void)rstpin;
+
+    if (frames_path != NULL)
+    {
+        if (load_frames(frames_path) != 0)
+        {
+            return XENSIV_BGT60TRXX_RSLT_ERROR;
+        }
+        printf("BGT60 simulator: replaying %" PRIu32 " frames from '%s'\n", sim.file_num_frames, frames_path);
+    }
+    else
+    {
+        if (scene_gen_init(&sim.scene, scene_name, (seed != NULL) ? (uint32_t)strtoul(seed, NULL, 0) : 1u) != 0)
+        {
+            fprintf(stderr, "BGT60 simulator: unknown scene '%s'\n", scene_name);
+            return XENSIV_BGT60TRXX_RSLT_ERROR;
+        }
+        printf("BGT60 simulator: synthetic scene '%s'\n", scene_gen_name(sim.scene.scene));
+    }
+
+    if (xensiv_bgt60trxx_config(&obj->dev, regs, len) != XENSIV_BGT60TRXX_STATUS_OK)
+    {
+        return XENSIV_BGT60TRXX_RSLT_ERROR;
+    }
+
+    if (xTaskCreate(bgt60_sim_task, "BGT60 sim", BGT60_SIM_TASK_STACK_SIZE, NULL,
+                    BGT60_SIM_TASK_PRIORITY, NULL) != pdPASS)
+    {
+        return XENSIV_BGT60TRXX_RSLT_ERROR;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: xensiv_bgt60trxx_mtb_interrupt_init
+ *******************************************************************************
+ * Summary:
+ *   Sets the FIFO limit and registers the FIFO interrupt handler.
+ *
+ * Parameters:
+ *   obj: sensor object
+ *   fifo_limit: FIFO fill level in samples that raises the interrupt
+ *   intpin, intr_priority: interrupt pin and priority (unused)
+ *   callback, callback_arg: interrupt handler and its argument
+ *
+ * Return:
+ *   CY_RSLT_SUCCESS, or an error for an invalid limit
+ ******************************************************************************/
+cy_rslt_t xensiv_bgt60trxx_mtb_interrupt_init(xensiv_bgt60trxx_mtb_t *obj, uint16_t fifo_limit,
+                                              cyhal_gpio_t intpin, uint8_t intr_priority,
+                                              cyhal_gpio_event_callback_t callback,
+                                              void *callback_arg)
+{
+    (void)intpin;
+    (void)intr_priority;
+
+    sim.callback = callback;
+    sim.callback_arg = callback_arg;
+
+    return (xensiv_bgt60trxx_set_fifo_limit(&obj->dev, fifo_limit) == XENSIV_BGT60TRXX_STATUS_OK) ?
+           CY_RSLT_SUCCESS : XENSIV_BGT60TRXX_RSLT_ERROR;
+}
+
+/*******************************************************************************
+ * Function Name: xensiv_bgt60trxx_config
+ *******************************************************************************
+ * Summary:
+ *   Accepts the register list of the profile the frames were generated for.
+ *
+ * Parameters:
+ *   dev: sensor
+ *   regs, len: register list
+ *
+ * Return:
+ *   XENSIV_BGT60TRXX_STATUS_OK, or an error for a different register count
+ ******************************************************************************/
+int32_t xensiv_bgt60trxx_config(const xensiv_bgt60trxx_t *dev, const uint32_t *regs, uint32_t len)
+{
+    (void)dev;
+
+    return ((regs != NULL) && (len == XENSIV_BGT60TRXX_CONF_NUM_REGS)) ?
+           XENSIV_BGT60TRXX_STATUS_OK : XENSIV_BGT60TRXX_STATUS_DEV_ERROR;
+}
+
+/*******************************************************************************
+ * Function Name: xensiv_bgt60trxx_start_frame
+ ******************************************************************************/
+int32_t xensiv_bgt60trxx_start_frame(const xensiv_bgt60trxx_t *dev, bool start)
+{
+    (void)dev;
+
+    sim.running = start;
+    return XENSIV_BGT60TRXX_STATUS_OK;
+}
+
+/*******************************************************************************
+ * Function Name: xensiv_bgt60trxx_soft_reset
+ *******************************************************************************
+ * Summary:
+ *   A software reset stops the frame generation and clears the FIFO and the
+ *   FIFO limit; a FIFO reset only clears the FIFO.
+ *
+ * Parameters:
+ *   dev: sensor
+ *   reset_type: kind of reset
+ *
+ * Return:
+ *   XENSIV_BGT60TRXX_STATUS_OK
+ ******************************************************************************/
+int32_t xensiv_bgt60trxx_soft_reset(const xensiv_bgt60trxx_t *dev, xensiv_bgt60trxx_reset_t reset_type)
+{
+    (void)dev;
+
+    taskENTER_CRITICAL();
+    if (reset_type == XENSIV_BGT60TRXX_RESET_SW)
+    {
+        sim.running = false;
+        sim.fifo_limit = 0;
+    }
+    fifo_reset();
+    taskEXIT_CRITICAL();
+
+    return XENSIV_BGT60TRXX_STATUS_OK;
+}
+
+/*******************************************************************************
+ * Function Name: xensiv_bgt60trxx_set_fifo_limit
+ ******************************************************************************/
+int32_t xensiv_bgt60trxx_set_fifo_limit(const xensiv_bgt60trxx_t *dev, uint32_t num_samples)
+{
+    (void)dev;
+
+    if ((num_samples == 0u) || (num_samples > BGT60_SIM_FIFO_SAMPLES))
+    {
+        return XENSIV_BGT60TRXX_STATUS_DEV_ERROR;
+    }
+
+    taskENTER_CRITICAL();
+    sim.fifo_limit = num_samples;
+    (void)update_irq();
+    taskEXIT_CRITICAL();
+
+    return XENSIV_BGT60TRXX_STATUS_OK;
+}
+
+/*******************************************************************************
+ * Function Name: xensiv_bgt60trxx_get_fifo_data
+ *******************************************************************************
+ * Summary:
+ *   Reads samples from the FIFO. Fails after an overflow, until the FIFO
+ *   is reset, and when fewer samples than requested are available.
+ *
+ * Parameters:
+ *   dev: sensor
+ *   data: destination
+ *   num_samples: samples to read
+ *
+ * Return:
+ *   XENSIV_BGT60TRXX_STATUS_OK, or XENSIV_BGT60TRXX_STATUS_GSR0_ERROR
+ ******************************************************************************/
+int32_t xensiv_bgt60trxx_get_fifo_data(const xensiv_bgt60trxx_t *dev, uint16_t *data, uint32_t num_samples)
+{
+    int32_t status = XENSIV_BGT60TRXX_STATUS_OK;
+
+    (void)dev;
+
+    taskENTER_CRITICAL();
+    if (sim.overflow || (sim.fifo_fill < num_samples))
+    {
+        status = XENSIV_BGT60TRXX_STATUS_GSR0_ERROR;
+    }
+    else
+    {
+        for (uint32_t i = 0; i < num_samples; ++i)
+        {
+            data[i] = sim.fifo[(sim.fifo_read + i) % BGT60_SIM_FIFO_SAMPLES];
+        }
+        sim.fifo_read = (sim.fifo_read + num_samples) % BGT60_SIM_FIFO_SAMPLES;
+        sim.fifo_fill -= num_samples;
+        (void)update_irq();
+    }
+    taskEXIT_CRITICAL();
+
+    return status;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,392 @@
+/******************************************************************************
+ * File Name:   cy_json_parser_host.c
+ *
+ * Description: Host build: JSON parser. The whole input is tokenized before the
+ *              first callback, so callbacks may modify the value buffer as the
+ *              application does to terminate values.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <ctype.h>
+#include <string.h>
+
+/* Header file includes */
+#include "cy_json_parser.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define JSON_MAX_INPUT_LENGTH   (1024u)
+#define JSON_MAX_OBJECTS        (32u)
+#define JSON_MAX_DEPTH          (4u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    char *cursor;
+    char *end;
+    uint32_t count;
+    cy_JSON_object_t objects[JSON_MAX_OBJECTS];
+} json_scan_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static cy_JSON_callback_t registered_callback;
+static void *registered_arg;
+
+/* Writable copy of the input the objects point into */
+static char input_copy[JSON_MAX_INPUT_LENGTH + 1];
+
+static int parse_object(json_scan_t *scan, cy_JSON_object_t *parent, uint32_t depth);
+
+/*******************************************************************************
+ * Function Name: skip_space
+ ******************************************************************************/
+static void skip_space(json_scan_t *scan)
+{
+    while ((scan->cursor < scan->end) && isspace((unsigned char)*scan->cursor))
+    {
+        scan->cursor++;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: parse_string
+ *******************************************************************************
+ * Summary:
+ *   Scans a string token. Escaped characters are kept as they are.
+ *
+ * Parameters:
+ *   scan: scanner state, positioned on the opening quote
+ *   start: set to the first character after the quote
+ *   length: set to the length without quotes
+ *
+ * Return:
+ *   0 on success, -1 on a syntax error
+ ******************************************************************************/
+static int parse_string(json_scan_t *scan, char **start, uint32_t *length)
+{
+    char *p = scan->cursor + 1;
+
+    *start = p;
+    while ((p < scan->end) && (*p != '"'))
+    {
+        p += (*p == '\\') ? 2 : 1;
+    }
+
+    if (p >= scan->end)
+    {
+        return -1;
+    }
+
+    *length = (uint32_t)(p - *start);
+    scan->cursor = p + 1;
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: skip_array
+ *******************************************************************************
+ * Summary:
+ *   Skips an array value, honoring nesting and strings.
+ *
+ * Parameters:
+ *   scan: scanner state, positioned on the opening bracket
+ *
+ * Return:
+ *   0 on success, -1 on a syntax error
+ ******************************************************************************/
+static int skip_array(json_scan_t *scan)
+{
+    uint32_t nesting = 0;
+
+    while (scan->cursor < scan->end)
+    {
+        char c = *scan->cursor;
+
+        if (c == '"')
+        {
+            char *start;
+            uint32_t length;
+            if (parse_string(scan, &start, &length) != 0)
+            {
+                return -1;
+            }
+            continue;
+        }
+
+        scan->cursor++;
+        if (c == '[')
+        {
+            nesting++;
+        }
+        else if ((c == ']') && (--nesting == 0u))
+        {
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+/*******************************************************************************
+ * Function Name: parse_value
+ *******************************************************************************
+ * Summary:
+ *   Scans the value of a key and records the object. Nested objects are
+ *   parsed recursively with the object as parent.
+ *
+ * Parameters:
+ *   scan: scanner state, positioned on the value
+ *   object: object to complete
+ *   depth: nesting depth of the object
+ *
+ * Return:
+ *   0 on success, -1 on a syntax error
+ ******************************************************************************/
+static int parse_value(json_scan_t *scan, cy_JSON_object_t *object, uint32_t depth)
+{
+    char c = *scan->cursor;
+    char *start = scan->cursor;
+    uint32_t length;
+
+    if (c == '"')
+    {
+        if (parse_string(scan, &start, &length) != 0)
+        {
+            return -1;
+        }
+        object->value_type = JSON_STRING_TYPE;
+    }
+    else if (c == '{')
+    {
+        object->value_type = JSON_OBJECT_TYPE;
+        if (parse_object(scan, object, depth + 1u) != 0)
+        {
+            return -1;
+        }
+        length = (uint32_t)(scan->cursor - start);
+    }
+    else if (c == '[')
+    {
+        object->value_type = JSON_ARRAY_TYPE;
+        if (skip_array(scan) != 0)
+        {
+            return -1;
+        }
+        length = (uint32_t)(scan->cursor - start);
+    }
+    else
+    {
+        while ((scan->cursor < scan->end) && (*scan->cursor != ',') && (*scan->cursor != '}') &&
+               !isspace((unsigned char)*scan->cursor))
+        {
+            scan->cursor++;
+        }
+        length = (uint32_t)(scan->cursor - start);
+
+        if (length == 0u)
+        {
+            return -1;
+        }
+        else if ((strncmp(start, "true", length) == 0) || (strncmp(start, "false", length) == 0))
+        {
+            object->value_type = JSON_BOOLEAN_TYPE;
+        }
+        else if (strncmp(start, "null", length) == 0)
+        {
+            object->value_type = JSON_NULL_TYPE;
+        }
+        else
+        {
+            object->value_type = JSON_NUMBER_TYPE;
+        }
+    }
+
+    object->value = start;
+    object->value_length = (uint16_t)length;
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: parse_object
+ *******************************************************************************
+ * Summary:
+ *   Scans the key/value pairs of an object into the object list, in
+ *   document order.
+ *
+ * Parameters:
+ *   scan: scanner state, positioned on the opening brace
+ *   parent: enclosing object, NULL at the top level
+ *   depth: nesting depth
+ *
+ * Return:
+ *   0 on success, -1 on a syntax error
+ ******************************************************************************/
+static int parse_object(json_scan_t *scan, cy_JSON_object_t *parent, uint32_t depth)
+{
+    if ((depth > JSON_MAX_DEPTH) || (*scan->cursor != '{'))
+    {
+        return -1;
+    }
+
+    scan->cursor++;
+    skip_space(scan);
+
+    if ((scan->cursor < scan->end) && (*scan->cursor == '}'))
+    {
+        scan->cursor++;
+        return 0;
+    }
+
+    while (scan->cursor < scan->end)
+    {
+        cy_JSON_object_t *object;
+        char *key;
+        uint32_t key_length;
+
+        if ((*scan->cursor != '"') || (parse_string(scan, &key, &key_length) != 0) ||
+            (scan->count >= JSON_MAX_OBJECTS))
+        {
+            return -1;
+        }
+
+        object = &scan->objects[scan->count++];
+        object->object_string = key;
+        object->object_string_length = (uint8_t)key_length;
+        object->parent_object = parent;
+
+        skip_space(scan);
+        if ((scan->cursor >= scan->end) || (*scan->cursor++ != ':'))
+        {
+            return -1;
+        }
+        skip_space(scan);
+
+        if ((scan->cursor >= scan->end) || (parse_value(scan, object, depth) != 0))
+        {
+            return -1;
+        }
+
+        skip_space(scan);
+        if (scan->cursor >= scan->end)
+        {
+            return -1;
+        }
+        else if (*scan->cursor == ',')
+        {
+            scan->cursor++;
+            skip_space(scan);
+        }
+        else if (*scan->cursor == '}')
+        {
+            scan->cursor++;
+            return 0;
+        }
+        else
+        {
+            return -1;
+        }
+    }
+
+    return -1;
+}
+
+/*******************************************************************************
+ * Function Name: cy_JSON_parser_register_callback
+ *******************************************************************************
+ * Summary:
+ *   Registers the callback invoked for every key/value pair.
+ *
+ * Parameters:
+ *   json_callback: callback
+ *   arg: argument passed to the callback
+ *
+ * Return:
+ *   CY_RSLT_SUCCESS
+ ******************************************************************************/
+cy_rslt_t cy_JSON_parser_register_callback(cy_JSON_callback_t json_callback, void *arg)
+{
+    registered_callback = json_callback;
+    registered_arg = arg;
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: cy_JSON_parser
+ *******************************************************************************
+ * Summary:
+ *   Parses a JSON object and invokes the registered callback for every
+ *   key/value pair. Nothing is reported for malformed input.
+ *
+ * Parameters:
+ *   json_input: JSON text
+ *   input_length: length of the text
+ *
+ * Return:
+ *   CY_RSLT_SUCCESS, or CY_RSLT_JSON_GENERIC_ERROR for malformed input
+ ******************************************************************************/
+cy_rslt_t cy_JSON_parser(const char *json_input, uint32_t input_length)
+{
+    static json_scan_t scan;
+
+    if ((json_input == NULL) || (input_length > JSON_MAX_INPUT_LENGTH))
+    {
+        return CY_RSLT_JSON_GENERIC_ERROR;
+    }
+
+    memcpy(input_copy, json_input, input_length);
+    input_copy[input_length] = '\0';
+
+    scan.cursor = input_copy;
+    scan.end = input_copy + input_length;
+    scan.count = 0;
+
+    skip_space(&scan);
+    if ((scan.cursor >= scan.end) || (parse_object(&scan, NULL, 0) != 0))
+    {
+        return CY_RSLT_JSON_GENERIC_ERROR;
+    }
+
+    skip_space(&scan);
+    if (scan.cursor != scan.end)
+    {
+        return CY_RSLT_JSON_GENERIC_ERROR;
+    }
+
+    for (uint32_t i = 0; (i < scan.count) && (registered_callback != NULL); ++i)
+    {
+        /* Objects are reported as their leaves, like the target parser */
+        if (scan.objects[i].value_type != JSON_OBJECT_TYPE)
+        {
+            registered_callback(&scan.objects[i], registered_arg);
+        }
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/* [] END OF FILE */
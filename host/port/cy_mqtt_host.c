@@ -0,0 +1,341 @@
+/******************************************************************************
+ * File Name:   cy_mqtt_host.c
+ *
+ * Description: Host build: MQTT client library connected to the in-process broker
+ *              of sim_broker.c. Publishes complete synchronously, like acknowledged
+ *              publishes on the target, but without network latency.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <stdio.h>
+#include <string.h>
+
+/* Header file includes */
+#include "FreeRTOS.h"
+
+#include "cy_mqtt_api.h"
+#include "net_fault.h"
+#include "sim_broker.h"
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    cy_mqtt_callback_t callback;
+    void *user_data;
+    volatile bool connected;
+} host_mqtt_client_t;
+
+/*******************************************************************************
+ * Function Name: deliver_to_client
+ *******************************************************************************
+ * Summary:
+ *   Passes a message from the broker to the event callback of the client.
+ *
+ * Parameters:
+ *   client: receiving client
+ *   topic, topic_len: topic of the message
+ *   payload, payload_len: message payload
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void deliver_to_client(void *client, const char *topic, uint16_t topic_len,
+                              const uint8_t *payload, size_t payload_len)
+{
+    host_mqtt_client_t *mqtt = (host_mqtt_client_t *)client;
+    cy_mqtt_event_t event;
+
+    if (!mqtt->connected || (net_fault_deliver() != NET_FAULT_PASS) || !mqtt->connected)
+    {
+        return;
+    }
+
+    memset(&event, 0, sizeof(event));
+    event.type = CY_MQTT_EVENT_TYPE_SUBSCRIPTION_MESSAGE_RECEIVE;
+    event.data.pub_msg.received_message.qos = CY_MQTT_QOS0;
+    event.data.pub_msg.received_message.topic = topic;
+    event.data.pub_msg.received_message.topic_len = topic_len;
+    event.data.pub_msg.received_message.payload = (const char *)payload;
+    event.data.pub_msg.received_message.payload_len = payload_len;
+
+    mqtt->callback((cy_mqtt_t)mqtt, event, mqtt->user_data);
+}
+
+/*******************************************************************************
+ * Function Name: drop_client
+ *******************************************************************************
+ * Summary:
+ *   Breaks the connection of a client for a fault of the network: the broker
+ *   forgets its subscriptions and the client gets a disconnect event, like
+ *   from the keep-alive of the MQTT library on the target.
+ *
+ * Parameters:
+ *   client: client to disconnect
+ *
+ * Return:
+ *   true if the client was connected
+ ******************************************************************************/
+static bool drop_client(void *client)
+{
+    host_mqtt_client_t *mqtt = (host_mqtt_client_t *)client;
+    cy_mqtt_event_t event;
+
+    if (!mqtt->connected)
+    {
+        return false;
+    }
+
+    mqtt->connected = false;
+    sim_broker_unsubscribe_all(mqtt);
+
+    memset(&event, 0, sizeof(event));
+    event.type = CY_MQTT_EVENT_TYPE_DISCONNECT;
+    mqtt->callback((cy_mqtt_t)mqtt, event, mqtt->user_data);
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: cy_mqtt_init
+ ******************************************************************************/
+cy_rslt_t cy_mqtt_init(void)
+{
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: cy_mqtt_deinit
+ ******************************************************************************/
+cy_rslt_t cy_mqtt_deinit(void)
+{
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: cy_mqtt_create
+ *******************************************************************************
+ * Summary:
+ *   Creates a client. The network buffer, credentials and broker address
+ *   are not needed by the in-process broker.
+ *
+ * Parameters:
+ *   buffer, buff_len: network buffer (unused)
+ *   security: TLS credentials (unused)
+ *   broker_info: broker address (unused)
+ *   event_callback: callback for disconnections and received messages
+ *   user_data: argument of the callback
+ *   mqtt_handle: set to the new client
+ *
+ * Return:
+ *   CY_RSLT_SUCCESS, or an error if the client cannot be allocated
+ ******************************************************************************/
+cy_rslt_t cy_mqtt_create(uint8_t *buffer, uint32_t buff_len,
+                         cy_awsport_ssl_credentials_t *security,
+                         cy_mqtt_broker_info_t *broker_info,
+                         cy_mqtt_callback_t event_callback, void *user_data,
+                         cy_mqtt_t *mqtt_handle)
+{
+    host_mqtt_client_t *mqtt;
+
+    (void)buffer;
+    (void)buff_len;
+    (void)security;
+    (void)broker_info;
+
+    if ((event_callback == NULL) || (mqtt_handle == NULL))
+    {
+        return CY_RSLT_MODULE_MQTT_BADARG;
+    }
+
+    mqtt = pvPortMalloc(sizeof(*mqtt));
+    if (mqtt == NULL)
+    {
+        return CY_RSLT_MODULE_MQTT_ERROR;
+    }
+
+    mqtt->callback = event_callback;
+    mqtt->user_data = user_data;
+    mqtt->connected = false;
+    *mqtt_handle = (cy_mqtt_t)mqtt;
+    net_fault_register_link(mqtt, drop_client);
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: cy_mqtt_connect
+ *******************************************************************************
+ * Summary:
+ *   Connects the client to the in-process broker, starting it if needed.
+ *   Fails while a fault of the network keeps the broker out of reach.
+ *
+ * Parameters:
+ *   mqtt_handle: client
+ *   connect_info: connection parameters (unused)
+ *
+ * Return:
+ *   CY_RSLT_SUCCESS, or an error if the broker cannot be reached
+ ******************************************************************************/
+cy_rslt_t cy_mqtt_connect(cy_mqtt_t mqtt_handle, cy_mqtt_connect_info_t *connect_info)
+{
+    host_mqtt_client_t *mqtt = (host_mqtt_client_t *)mqtt_handle;
+
+    (void)connect_info;
+
+    sim_broker_start();
+    if (net_fault_broker_down() || net_fault_wifi_down())
+    {
+        net_fault_connected(false);
+        return CY_RSLT_MODULE_MQTT_ERROR;
+    }
+
+    mqtt->connected = true;
+    net_fault_connected(true);
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: cy_mqtt_publish
+ *******************************************************************************
+ * Summary:
+ *   Publishes a message to the in-process broker. A message lost by a fault
+ *   of the network is not published; with QoS 0 the client is not told.
+ *
+ * Parameters:
+ *   mqtt_handle: client
+ *   pub_msg: message to publish
+ *
+ * Return:
+ *   CY_RSLT_SUCCESS, or an error if not connected or the broker is busy
+ ******************************************************************************/
+cy_rslt_t cy_mqtt_publish(cy_mqtt_t mqtt_handle, cy_mqtt_publish_info_t *pub_msg)
+{
+    host_mqtt_client_t *mqtt = (host_mqtt_client_t *)mqtt_handle;
+    net_fault_action_t action;
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    if (!mqtt->connected)
+    {
+        net_fault_published(pub_msg->topic, pub_msg->topic_len, NET_FAULT_FAIL);
+        return CY_RSLT_MODULE_MQTT_NOT_CONNECTED;
+    }
+
+    action = net_fault_publish((uint8_t)pub_msg->qos);
+    if (!mqtt->connected)
+    {
+        action = NET_FAULT_FAIL;
+        result = CY_RSLT_MODULE_MQTT_NOT_CONNECTED;
+    }
+    else if (action == NET_FAULT_FAIL)
+    {
+        result = CY_RSLT_MODULE_MQTT_PUBLISH_FAIL;
+    }
+    else if ((action == NET_FAULT_PASS) &&
+             (sim_broker_publish(pub_msg->topic, pub_msg->topic_len, pub_msg->payload, pub_msg->payload_len) != 0))
+    {
+        action = NET_FAULT_FAIL;
+        result = CY_RSLT_MODULE_MQTT_PUBLISH_FAIL;
+    }
+
+    net_fault_published(pub_msg->topic, pub_msg->topic_len, action);
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: cy_mqtt_subscribe
+ *******************************************************************************
+ * Summary:
+ *   Subscribes the client to topic filters. The broker grants the
+ *   requested QoS.
+ *
+ * Parameters:
+ *   mqtt_handle: client
+ *   sub_info: subscriptions
+ *   sub_count: number of subscriptions
+ *
+ * Return:
+ *   CY_RSLT_SUCCESS, or an error if a subscription fails
+ ******************************************************************************/
+cy_rslt_t cy_mqtt_subscribe(cy_mqtt_t mqtt_handle, cy_mqtt_subscribe_info_t *sub_info, uint8_t sub_count)
+{
+    host_mqtt_client_t *mqtt = (host_mqtt_client_t *)mqtt_handle;
+
+    if (!mqtt->connected)
+    {
+        return CY_RSLT_MODULE_MQTT_NOT_CONNECTED;
+    }
+
+    for (uint8_t i = 0; i < sub_count; ++i)
+    {
+        if (sim_broker_subscribe(mqtt, sub_info[i].topic, sub_info[i].topic_len, deliver_to_client) != 0)
+        {
+            sub_info[i].allocated_qos = CY_MQTT_QOS_INVALID;
+            return CY_RSLT_MODULE_MQTT_SUBSCRIBE_FAIL;
+        }
+        sub_info[i].allocated_qos = sub_info[i].qos;
+    }
+
+    net_fault_subscribed();
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: cy_mqtt_unsubscribe
+ ******************************************************************************/
+cy_rslt_t cy_mqtt_unsubscribe(cy_mqtt_t mqtt_handle, cy_mqtt_unsubscribe_info_t *unsub_info, uint8_t unsub_count)
+{
+    for (uint8_t i = 0; i < unsub_count; ++i)
+    {
+        sim_broker_unsubscribe(mqtt_handle, unsub_info[i].topic, unsub_info[i].topic_len);
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: cy_mqtt_disconnect
+ ******************************************************************************/
+cy_rslt_t cy_mqtt_disconnect(cy_mqtt_t mqtt_handle)
+{
+    host_mqtt_client_t *mqtt = (host_mqtt_client_t *)mqtt_handle;
+
+    mqtt->connected = false;
+    sim_broker_unsubscribe_all(mqtt);
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: cy_mqtt_delete
+ ******************************************************************************/
+cy_rslt_t cy_mqtt_delete(cy_mqtt_t mqtt_handle)
+{
+    net_fault_unregister_link(mqtt_handle);
+    vPortFree(mqtt_handle);
+    return CY_RSLT_SUCCESS;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,51 @@
+/******************************************************************************
+ * File Name:   cy_utils.h
+ *
+ * Description: Host build: utility macros of the ModusToolbox core library.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef CY_UTILS_H_
+#define CY_UTILS_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CY_UNUSED_PARAMETER(x)  ((void)(x))
+
+#define CY_ASSERT(x)                                                        \
+    do                                                                      \
+    {                                                                       \
+        if (!(x))                                                           \
+        {                                                                   \
+            fprintf(stderr, "CY_ASSERT failed at %s:%d\n", __FILE__, __LINE__); \
+            abort();                                                        \
+        }                                                                   \
+    } while (0)
+
+#define CY_HALT()               abort()
+
+#define CY_SECTION(name)        /* Sections are meaningless on the host */
+#define CY_ALIGN(align)         __attribute__((aligned(align)))
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,170 @@
+/******************************************************************************
+ * File Name:   cy_wcm_host.c
+ *
+ * Description: Host build: Wi-Fi connection manager, lwIP address formatting
+ *              and the clock of the MQTT library port.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <stdio.h>
+#include <time.h>
+
+/* Header file includes */
+#include "cy_wcm.h"
+#include "clock.h"
+#include "lwip/netif.h"
+#include "net_fault.h"
+
+/* 127.0.0.1 in network byte order, as stored by lwIP */
+#define HOST_LOOPBACK_ADDR      (0x0100007FU)
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static uint8_t connected;
+
+/* Wi-Fi drops of the fault injection before the last connection */
+static uint32_t connected_drops;
+
+/*******************************************************************************
+ * Function Name: cy_wcm_init
+ ******************************************************************************/
+cy_rslt_t cy_wcm_init(cy_wcm_config_t *config)
+{
+    (void)config;
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: cy_wcm_deinit
+ ******************************************************************************/
+cy_rslt_t cy_wcm_deinit(void)
+{
+    connected = 0;
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: cy_wcm_connect_ap
+ *******************************************************************************
+ * Summary:
+ *   Succeeds unless a Wi-Fi drop of the fault injection is active; the
+ *   credentials from wifi_config.h are ignored.
+ *
+ * Parameters:
+ *   connect_params: access point credentials (unused)
+ *   ip_addr: set to the loopback address
+ *
+ * Return:
+ *   CY_RSLT_SUCCESS, or CY_RSLT_WCM_STA_JOIN_FAILED during a Wi-Fi drop
+ ******************************************************************************/
+cy_rslt_t cy_wcm_connect_ap(cy_wcm_connect_params_t *connect_params, cy_wcm_ip_address_t *ip_addr)
+{
+    (void)connect_params;
+
+    if (net_fault_wifi_down())
+    {
+        return CY_RSLT_WCM_STA_JOIN_FAILED;
+    }
+
+    ip_addr->version = CY_WCM_IP_VER_V4;
+    ip_addr->ip.v4 = HOST_LOOPBACK_ADDR;
+    connected = 1;
+    connected_drops = net_fault_wifi_drops();
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: cy_wcm_disconnect_ap
+ ******************************************************************************/
+cy_rslt_t cy_wcm_disconnect_ap(void)
+{
+    connected = 0;
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: cy_wcm_is_connected_to_ap
+ ******************************************************************************/
+uint8_t cy_wcm_is_connected_to_ap(void)
+{
+    if (net_fault_wifi_down() || (net_fault_wifi_drops() != connected_drops))
+    {
+        connected = 0;
+    }
+    return connected;
+}
+
+/*******************************************************************************
+ * Function Name: ip4addr_ntoa
+ *******************************************************************************
+ * Summary:
+ *   Formats an IPv4 address stored in network byte order.
+ *
+ * Parameters:
+ *   addr: address to format
+ *
+ * Return:
+ *   Pointer to a static buffer
+ ******************************************************************************/
+char *ip4addr_ntoa(const ip4_addr_t *addr)
+{
+    static char buffer[16];
+    uint32_t a = addr->addr;
+
+    snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u",
+             (unsigned)(a & 0xFFu), (unsigned)((a >> 8) & 0xFFu),
+             (unsigned)((a >> 16) & 0xFFu), (unsigned)(a >> 24));
+    return buffer;
+}
+
+/*******************************************************************************
+ * Function Name: ip6addr_ntoa
+ ******************************************************************************/
+char *ip6addr_ntoa(const ip6_addr_t *addr)
+{
+    (void)addr;
+    return "::1";
+}
+
+/*******************************************************************************
+ * Function Name: Clock_GetTimeMs
+ *******************************************************************************
+ * Summary:
+ *   Returns the monotonic time in milliseconds.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   Time in milliseconds
+ ******************************************************************************/
+uint32_t Clock_GetTimeMs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)((now.tv_sec * 1000) + (now.tv_nsec / 1000000));
+}
+
+/* [] END OF FILE */
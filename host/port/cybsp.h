@@ -0,0 +1,55 @@
+/******************************************************************************
+ * File Name:   cybsp.h
+ *
+ * Description: Host build: board support package of CYSBSYSKIT-DEV-01 with the
+ *              radar wing. Pin numbers only identify the pins in the host port.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef CYBSP_H_
+#define CYBSP_H_
+
+#include "cyhal.h"
+
+#define CYBSP_GPIOA0                    ((cyhal_gpio_t)0)
+#define CYBSP_GPIOA1                    ((cyhal_gpio_t)1)
+#define CYBSP_GPIOA2                    ((cyhal_gpio_t)2)
+#define CYBSP_GPIO5                     ((cyhal_gpio_t)5)
+#define CYBSP_GPIO10                    ((cyhal_gpio_t)10)
+#define CYBSP_GPIO11                    ((cyhal_gpio_t)11)
+#define CYBSP_SPI_CLK                   ((cyhal_gpio_t)20)
+#define CYBSP_SPI_MOSI                  ((cyhal_gpio_t)21)
+#define CYBSP_SPI_MISO                  ((cyhal_gpio_t)22)
+#define CYBSP_SPI_CS                    ((cyhal_gpio_t)23)
+#define CYBSP_DEBUG_UART_TX             ((cyhal_gpio_t)30)
+#define CYBSP_DEBUG_UART_RX             ((cyhal_gpio_t)31)
+
+/* Number of pins tracked by the host port */
+#define CYBSP_HOST_NUM_PINS             (32)
+
+/* Interrupts are simulated by tasks, there is nothing to enable */
+#define __enable_irq()                  do { } while (0)
+
+cy_rslt_t cybsp_init(void);
+
+#endif
+/* [] END OF FILE */
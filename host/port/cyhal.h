@@ -0,0 +1,167 @@
+/******************************************************************************
+ * File Name:   cyhal.h
+ *
+ * Description: Host build: subset of the PSoC 6 HAL used by the application.
+ *              GPIO writes are traced, SPI is not used by the simulated sensor.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef CYHAL_H_
+#define CYHAL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cy_result.h"
+#include "cy_utils.h"
+
+#define CYHAL_API_VERSION               (2)
+
+/*******************************************************************************
+ * GPIO
+ ******************************************************************************/
+typedef int32_t cyhal_gpio_t;
+
+#define NC                              ((cyhal_gpio_t)-1)
+
+typedef enum
+{
+    CYHAL_GPIO_DIR_INPUT,
+    CYHAL_GPIO_DIR_OUTPUT,
+    CYHAL_GPIO_DIR_BIDIRECTIONAL
+} cyhal_gpio_direction_t;
+
+typedef enum
+{
+    CYHAL_GPIO_DRIVE_NONE,
+    CYHAL_GPIO_DRIVE_ANALOG,
+    CYHAL_GPIO_DRIVE_PULLUP,
+    CYHAL_GPIO_DRIVE_PULLDOWN,
+    CYHAL_GPIO_DRIVE_OPENDRAINDRIVESLOW,
+    CYHAL_GPIO_DRIVE_OPENDRAINDRIVESHIGH,
+    CYHAL_GPIO_DRIVE_STRONG,
+    CYHAL_GPIO_DRIVE_PULLUPDOWN
+} cyhal_gpio_drive_mode_t;
+
+typedef enum
+{
+    CYHAL_GPIO_IRQ_NONE = 0,
+    CYHAL_GPIO_IRQ_RISE = 1,
+    CYHAL_GPIO_IRQ_FALL = 2,
+    CYHAL_GPIO_IRQ_BOTH = 3
+} cyhal_gpio_event_t;
+
+cy_rslt_t cyhal_gpio_init(cyhal_gpio_t pin, cyhal_gpio_direction_t direction,
+                          cyhal_gpio_drive_mode_t drive_mode, bool init_val);
+void cyhal_gpio_free(cyhal_gpio_t pin);
+void cyhal_gpio_write(cyhal_gpio_t pin, bool value);
+bool cyhal_gpio_read(cyhal_gpio_t pin);
+
+/* PDL pin configuration, ignored on the host */
+#define CYHAL_GET_PORTADDR(pin)         ((void *)0)
+#define CYHAL_GET_PIN(pin)              ((uint32_t)(pin))
+#define CY_GPIO_SLEW_FAST               (0u)
+#define CY_GPIO_DRIVE_1_8               (3u)
+#define Cy_GPIO_SetSlewRate(base, pin, value)   ((void)(base), (void)(pin), (void)(value))
+#define Cy_GPIO_SetDriveSel(base, pin, value)   ((void)(base), (void)(pin), (void)(value))
+
+/*******************************************************************************
+ * System
+ ******************************************************************************/
+/* The PDL reads the die ID; the host derives one from the host and process */
+uint64_t Cy_SysLib_GetUniqueId(void);
+
+/*******************************************************************************
+ * SPI
+ ******************************************************************************/
+typedef struct
+{
+    uint32_t frequency_hz;
+} cyhal_spi_t;
+
+typedef enum
+{
+    CYHAL_SPI_MODE_00_MSB,
+    CYHAL_SPI_MODE_00_LSB,
+    CYHAL_SPI_MODE_01_MSB,
+    CYHAL_SPI_MODE_01_LSB,
+    CYHAL_SPI_MODE_10_MSB,
+    CYHAL_SPI_MODE_10_LSB,
+    CYHAL_SPI_MODE_11_MSB,
+    CYHAL_SPI_MODE_11_LSB
+} cyhal_spi_mode_t;
+
+typedef struct cyhal_clock cyhal_clock_t;
+
+cy_rslt_t cyhal_spi_init(cyhal_spi_t *obj, cyhal_gpio_t mosi, cyhal_gpio_t miso, cyhal_gpio_t sclk,
+                         cyhal_gpio_t ssel, const cyhal_clock_t *clk, uint8_t bits,
+                         cyhal_spi_mode_t mode, bool is_slave);
+cy_rslt_t cyhal_spi_set_frequency(cyhal_spi_t *obj, uint32_t hz);
+
+/*******************************************************************************
+ * Flash
+ ******************************************************************************/
+/* The work flash of the PSoC 6, simulated in memory, or in the file named
+ * by PRESENCE_FLASH_FILE so that its content outlives the process.
+ */
+#define CYHAL_HOST_FLASH_START          (0x14000000u)
+#define CYHAL_HOST_FLASH_SIZE           (32u * 1024u)
+#define CYHAL_HOST_FLASH_PAGE_SIZE      (512u)
+
+#define CYHAL_FLASH_RSLT_ERR_ADDRESS    ((cy_rslt_t)0x04050001U)
+#define CYHAL_FLASH_RSLT_ERR_IO         ((cy_rslt_t)0x04050002U)
+
+typedef struct
+{
+    uint8_t reserved;
+} cyhal_flash_t;
+
+typedef struct
+{
+    uint32_t start_address;
+    uint32_t size;
+    uint32_t sector_size;
+    uint32_t page_size;
+    uint8_t erase_value;
+} cyhal_flash_block_info_t;
+
+typedef struct
+{
+    uint8_t block_count;
+    const cyhal_flash_block_info_t *blocks;
+} cyhal_flash_info_t;
+
+cy_rslt_t cyhal_flash_init(cyhal_flash_t *obj);
+void cyhal_flash_free(cyhal_flash_t *obj);
+void cyhal_flash_get_info(const cyhal_flash_t *obj, cyhal_flash_info_t *info);
+cy_rslt_t cyhal_flash_read(cyhal_flash_t *obj, uint32_t address, uint8_t *data, size_t size);
+cy_rslt_t cyhal_flash_erase(cyhal_flash_t *obj, uint32_t address);
+cy_rslt_t cyhal_flash_write(cyhal_flash_t *obj, uint32_t address, const uint32_t *data);
+
+/*******************************************************************************
+ * System
+ ******************************************************************************/
+cy_rslt_t cyhal_system_delay_ms(uint32_t milliseconds);
+
+#endif
+/* [] END OF FILE */
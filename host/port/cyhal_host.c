@@ -0,0 +1,465 @@
+/******************************************************************************
+ * File Name:   cyhal_host.c
+ *
+ * Description: Host build: HAL, BSP, retarget-io and FreeRTOS hooks.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Header file includes */
+#include "cyhal.h"
+#include "cybsp.h"
+#include "cy_retarget_io.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static bool pin_state[CYBSP_HOST_NUM_PINS];
+
+/* Erased PSoC 6 flash reads as zeros */
+static const cyhal_flash_block_info_t flash_block =
+{
+    .start_address = CYHAL_HOST_FLASH_START,
+    .size = CYHAL_HOST_FLASH_SIZE,
+    .sector_size = CYHAL_HOST_FLASH_SIZE,
+    .page_size = CYHAL_HOST_FLASH_PAGE_SIZE,
+    .erase_value = 0x00u
+};
+static uint8_t flash_content[CYHAL_HOST_FLASH_SIZE];
+static FILE *flash_file;
+
+/*******************************************************************************
+ * Function Name: cybsp_init
+ *******************************************************************************
+ * Summary:
+ *   Nothing to initialize on the host.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   CY_RSLT_SUCCESS
+ ******************************************************************************/
+cy_rslt_t cybsp_init(void)
+{
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: cy_retarget_io_init
+ *******************************************************************************
+ * Summary:
+ *   Makes the standard output line buffered, like the debug UART output
+ *   seen in a terminal.
+ *
+ * Parameters:
+ *   tx, rx: UART pins (unused)
+ *   baudrate: UART baud rate (unused)
+ *
+ * Return:
+ *   CY_RSLT_SUCCESS
+ ******************************************************************************/
+cy_rslt_t cy_retarget_io_init(cyhal_gpio_t tx, cyhal_gpio_t rx, uint32_t baudrate)
+{
+    CY_UNUSED_PARAMETER(tx);
+    CY_UNUSED_PARAMETER(rx);
+    CY_UNUSED_PARAMETER(baudrate);
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: cyhal_gpio_init
+ *******************************************************************************
+ * Summary:
+ *   Records the initial state of a pin.
+ *
+ * Parameters:
+ *   pin: pin to initialize
+ *   direction, drive_mode: pin configuration (unused)
+ *   init_val: initial output value
+ *
+ * Return:
+ *   CY_RSLT_SUCCESS, or an error for unknown pins
+ ******************************************************************************/
+cy_rslt_t cyhal_gpio_init(cyhal_gpio_t pin, cyhal_gpio_direction_t direction,
+                          cyhal_gpio_drive_mode_t drive_mode, bool init_val)
+{
+    CY_UNUSED_PARAMETER(direction);
+    CY_UNUSED_PARAMETER(drive_mode);
+
+    if ((pin < 0) || (pin >= CYBSP_HOST_NUM_PINS))
+    {
+        return CY_RSLT_HOST_ERROR;
+    }
+
+    pin_state[pin] = init_val;
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: cyhal_gpio_free
+ *******************************************************************************
+ * Summary:
+ *   Releases a pin, nothing to do on the host.
+ *
+ * Parameters:
+ *   pin: pin to release
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void cyhal_gpio_free(cyhal_gpio_t pin)
+{
+    CY_UNUSED_PARAMETER(pin);
+}
+
+/*******************************************************************************
+ * Function Name: cyhal_gpio_write
+ *******************************************************************************
+ * Summary:
+ *   Sets the state of an output pin, e.g. the LEDs of the radar wing.
+ *
+ * Parameters:
+ *   pin: pin to write
+ *   value: new output value
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void cyhal_gpio_write(cyhal_gpio_t pin, bool value)
+{
+    if ((pin >= 0) && (pin < CYBSP_HOST_NUM_PINS))
+    {
+        pin_state[pin] = value;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: cyhal_gpio_read
+ *******************************************************************************
+ * Summary:
+ *   Returns the last value written to a pin.
+ *
+ * Parameters:
+ *   pin: pin to read
+ *
+ * Return:
+ *   Pin state
+ ******************************************************************************/
+bool cyhal_gpio_read(cyhal_gpio_t pin)
+{
+    return ((pin >= 0) && (pin < CYBSP_HOST_NUM_PINS)) ? pin_state[pin] : false;
+}
+
+/*******************************************************************************
+ * Function Name: cyhal_spi_init
+ *******************************************************************************
+ * Summary:
+ *   The simulated sensor is not accessed over SPI, the bus only has to
+ *   initialize successfully.
+ *
+ * Parameters:
+ *   obj: SPI object
+ *   mosi, miso, sclk, ssel, clk, bits, mode, is_slave: bus configuration
+ *
+ * Return:
+ *   CY_RSLT_SUCCESS
+ ******************************************************************************/
+cy_rslt_t cyhal_spi_init(cyhal_spi_t *obj, cyhal_gpio_t mosi, cyhal_gpio_t miso, cyhal_gpio_t sclk,
+                         cyhal_gpio_t ssel, const cyhal_clock_t *clk, uint8_t bits,
+                         cyhal_spi_mode_t mode, bool is_slave)
+{
+    CY_UNUSED_PARAMETER(mosi);
+    CY_UNUSED_PARAMETER(miso);
+    CY_UNUSED_PARAMETER(sclk);
+    CY_UNUSED_PARAMETER(ssel);
+    CY_UNUSED_PARAMETER(clk);
+    CY_UNUSED_PARAMETER(bits);
+    CY_UNUSED_PARAMETER(mode);
+    CY_UNUSED_PARAMETER(is_slave);
+
+    obj->frequency_hz = 0;
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: cyhal_spi_set_frequency
+ *******************************************************************************
+ * Summary:
+ *   Records the requested SPI clock.
+ *
+ * Parameters:
+ *   obj: SPI object
+ *   hz: SPI clock frequency
+ *
+ * Return:
+ *   CY_RSLT_SUCCESS
+ ******************************************************************************/
+cy_rslt_t cyhal_spi_set_frequency(cyhal_spi_t *obj, uint32_t hz)
+{
+    obj->frequency_hz = hz;
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: cyhal_system_delay_ms
+ *******************************************************************************
+ * Summary:
+ *   Delays the calling task. Unlike the busy wait on the target this lets
+ *   the other tasks run, which makes no difference to the application.
+ *
+ * Parameters:
+ *   milliseconds: delay
+ *
+ * Return:
+ *   CY_RSLT_SUCCESS
+ ******************************************************************************/
+cy_rslt_t cyhal_system_delay_ms(uint32_t milliseconds)
+{
+    vTaskDelay(pdMS_TO_TICKS(milliseconds));
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: Cy_SysLib_GetUniqueId
+ *******************************************************************************
+ * Summary:
+ *   Returns an ID of the simulated device: the host ID and the process ID,
+ *   so that instances on several hosts or in several processes differ.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   64-bit device ID
+ ******************************************************************************/
+uint64_t Cy_SysLib_GetUniqueId(void)
+{
+    return ((uint64_t)(uint32_t)gethostid() << 32) | (uint32_t)getpid();
+}
+
+/*******************************************************************************
+ * Function Name: flash_page
+ *******************************************************************************
+ * Summary:
+ *   Returns the offset of a page in the simulated flash, or -1 if the
+ *   address is not the start of a page.
+ ******************************************************************************/
+static long flash_page(uint32_t address)
+{
+    uint32_t offset = address - CYHAL_HOST_FLASH_START;
+
+    if ((address < CYHAL_HOST_FLASH_START) || (offset >= CYHAL_HOST_FLASH_SIZE) ||
+        ((offset % CYHAL_HOST_FLASH_PAGE_SIZE) != 0u))
+    {
+        return -1;
+    }
+
+    return (long)offset;
+}
+
+/*******************************************************************************
+ * Function Name: flash_store
+ *******************************************************************************
+ * Summary:
+ *   Writes a page of the simulated flash through to PRESENCE_FLASH_FILE.
+ ******************************************************************************/
+static cy_rslt_t flash_store(long offset)
+{
+    if ((flash_file != NULL) &&
+        ((fseek(flash_file, offset, SEEK_SET) != 0) ||
+         (fwrite(&flash_content[offset], CYHAL_HOST_FLASH_PAGE_SIZE, 1, flash_file) != 1) ||
+         (fflush(flash_file) != 0)))
+    {
+        return CYHAL_FLASH_RSLT_ERR_IO;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: cyhal_flash_init
+ *******************************************************************************
+ * Summary:
+ *   Opens the simulated flash. With PRESENCE_FLASH_FILE set, the content is
+ *   loaded from that file, which is created erased if it does not exist.
+ *
+ * Parameters:
+ *   obj: flash object
+ *
+ * Return:
+ *   CY_RSLT_SUCCESS, or an error if the file cannot be used
+ ******************************************************************************/
+cy_rslt_t cyhal_flash_init(cyhal_flash_t *obj)
+{
+    const char *path = getenv("PRESENCE_FLASH_FILE");
+
+    CY_UNUSED_PARAMETER(obj);
+
+    if ((path == NULL) || (*path == '\0') || (flash_file != NULL))
+    {
+        return CY_RSLT_SUCCESS;
+    }
+
+    memset(flash_content, flash_block.erase_value, sizeof(flash_content));
+    flash_file = fopen(path, "r+b");
+    if (flash_file == NULL)
+    {
+        flash_file = fopen(path, "w+b");
+        if ((flash_file == NULL) || (fwrite(flash_content, sizeof(flash_content), 1, flash_file) != 1))
+        {
+            return CYHAL_FLASH_RSLT_ERR_IO;
+        }
+    }
+    else if (fread(flash_content, sizeof(flash_content), 1, flash_file) != 1)
+    {
+        return CYHAL_FLASH_RSLT_ERR_IO;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: cyhal_flash_free
+ ******************************************************************************/
+void cyhal_flash_free(cyhal_flash_t *obj)
+{
+    CY_UNUSED_PARAMETER(obj);
+}
+
+/*******************************************************************************
+ * Function Name: cyhal_flash_get_info
+ ******************************************************************************/
+void cyhal_flash_get_info(const cyhal_flash_t *obj, cyhal_flash_info_t *info)
+{
+    CY_UNUSED_PARAMETER(obj);
+
+    info->block_count = 1u;
+    info->blocks = &flash_block;
+}
+
+/*******************************************************************************
+ * Function Name: cyhal_flash_read
+ ******************************************************************************/
+cy_rslt_t cyhal_flash_read(cyhal_flash_t *obj, uint32_t address, uint8_t *data, size_t size)
+{
+    uint32_t offset = address - CYHAL_HOST_FLASH_START;
+
+    CY_UNUSED_PARAMETER(obj);
+
+    if ((address < CYHAL_HOST_FLASH_START) || (offset > CYHAL_HOST_FLASH_SIZE) ||
+        (size > (CYHAL_HOST_FLASH_SIZE - offset)))
+    {
+        return CYHAL_FLASH_RSLT_ERR_ADDRESS;
+    }
+
+    memcpy(data, &flash_content[offset], size);
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: cyhal_flash_erase
+ ******************************************************************************/
+cy_rslt_t cyhal_flash_erase(cyhal_flash_t *obj, uint32_t address)
+{
+    long offset = flash_page(address);
+
+    CY_UNUSED_PARAMETER(obj);
+
+    if (offset < 0)
+    {
+        return CYHAL_FLASH_RSLT_ERR_ADDRESS;
+    }
+
+    memset(&flash_content[offset], flash_block.erase_value, CYHAL_HOST_FLASH_PAGE_SIZE);
+    return flash_store(offset);
+}
+
+/*******************************************************************************
+ * Function Name: cyhal_flash_write
+ *******************************************************************************
+ * Summary:
+ *   Erases and programs one page, like the PSoC 6 HAL.
+ ******************************************************************************/
+cy_rslt_t cyhal_flash_write(cyhal_flash_t *obj, uint32_t address, const uint32_t *data)
+{
+    long offset = flash_page(address);
+
+    CY_UNUSED_PARAMETER(obj);
+
+    if (offset < 0)
+    {
+        return CYHAL_FLASH_RSLT_ERR_ADDRESS;
+    }
+
+    memcpy(&flash_content[offset], data, CYHAL_HOST_FLASH_PAGE_SIZE);
+    return flash_store(offset);
+}
+
+/*******************************************************************************
+ * Function Name: vAssertCalled
+ *******************************************************************************
+ * Summary:
+ *   Reports a failed configASSERT() and stops the process.
+ *
+ * Parameters:
+ *   file: source file of the assertion
+ *   line: source line of the assertion
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void vAssertCalled(const char *file, unsigned long line)
+{
+    fprintf(stderr, "configASSERT failed at %s:%lu\n", file, line);
+    abort();
+}
+
+/*******************************************************************************
+ * Function Name: vApplicationMallocFailedHook
+ *******************************************************************************
+ * Summary:
+ *   Called by FreeRTOS when pvPortMalloc() fails.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void vApplicationMallocFailedHook(void)
+{
+    fprintf(stderr, "pvPortMalloc failed\n");
+    abort();
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,466 @@
+/******************************************************************************
+ * File Name:   latency_bench.c
+ *
+ * Description: Host build: end-to-end latency benchmark of the presence events
+ *              with a test subscriber and background load.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#include "latency_trace.h"
+
+#if LATENCY_TRACE_ENABLE
+
+/* Header file from system */
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Header file includes */
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "semphr.h"
+#include "task.h"
+
+#include "cbor_scan.h"
+#include "latency_bench.h"
+#include "mqtt_client_config.h"
+#include "payload_writer.h"
+#include "publisher_lanes.h"
+#include "publisher_pool.h"
+#include "publisher_task.h"
+#include "radar_pipeline.h"
+#include "rtos_artifacts.h"
+#include "sim_broker.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define LATENCY_BENCH_NUM_SERIES            (LATENCY_TRACE_NUM_HOPS)
+
+/* Power of two buckets of the histograms, up to 2^31 us */
+#define LATENCY_BENCH_NUM_BUCKETS           (32u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    uint32_t duration_s;
+    uint32_t telemetry_hz;
+    uint32_t telemetry_bytes;
+    uint32_t config_hz;
+} latency_bench_options_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+/* Series: one per hop from the previous hop, and the whole path last */
+static const char *const series_names[LATENCY_BENCH_NUM_SERIES] =
+{
+    "irq_to_detected",
+    "detected_to_queued",
+    "queued_to_dequeued",
+    "dequeued_to_published",
+    "published_to_delivered",
+    "end_to_end"
+};
+
+static latency_bench_options_t options;
+static latency_trace_record_t delivered[LATENCY_BENCH_MAX_EVENTS];
+static uint32_t num_delivered;
+static uint32_t num_untraced;
+static SemaphoreHandle_t delivered_mutex;
+
+static uint32_t telemetry_sent;
+static uint32_t telemetry_dropped;
+static uint32_t config_sent;
+static uint32_t config_dropped;
+
+/* The subscriber is identified by the address of this variable */
+static int subscriber;
+
+/*******************************************************************************
+ * Function Name: env_u32
+ ******************************************************************************/
+static uint32_t env_u32(const char *name, uint32_t default_value)
+{
+    const char *value = getenv(name);
+
+    return (value != NULL) ? (uint32_t)strtoul(value, NULL, 0) : default_value;
+}
+
+/*******************************************************************************
+ * Function Name: on_event
+ *******************************************************************************
+ * Summary:
+ *   Test subscriber of the events topic. Stamps the arrival of the event and
+ *   keeps the stamps of its trace. Runs in the broker task.
+ ******************************************************************************/
+static void on_event(void *client, const char *topic, uint16_t topic_len,
+                     const uint8_t *payload, size_t payload_len)
+{
+    uint32_t id = 0;
+    latency_trace_record_t record;
+
+    (void)client;
+    (void)topic;
+    (void)topic_len;
+
+    if (PAYLOAD_FORMAT == PAYLOAD_FORMAT_CBOR)
+    {
+        cbor_scan_t scan;
+        cbor_scan_token_t key;
+        cbor_scan_token_t value;
+
+        cbor_scan_init(&scan, payload, payload_len);
+        while (cbor_scan_member(&scan, &key, &value))
+        {
+            if ((value.type == CBOR_SCAN_UINT) && cbor_scan_equals(&key, "trace"))
+            {
+                id = (uint32_t)value.value;
+            }
+        }
+    }
+    else
+    {
+        char text[MQTT_PUB_MSG_MAX_SIZE * 2];
+        const char *member;
+
+        if (payload_len >= sizeof(text))
+        {
+            return;
+        }
+        memcpy(text, payload, payload_len);
+        text[payload_len] = '\0';
+
+        member = strstr(text, "\"trace\":");
+        if (member != NULL)
+        {
+            id = (uint32_t)strtoul(member + strlen("\"trace\":"), NULL, 10);
+        }
+    }
+
+    latency_trace_stamp(id, LATENCY_TRACE_DELIVERED);
+
+    xSemaphoreTake(delivered_mutex, portMAX_DELAY);
+    if ((latency_trace_take(id, &record) == 0) && (num_delivered < LATENCY_BENCH_MAX_EVENTS))
+    {
+        delivered[num_delivered++] = record;
+    }
+    else
+    {
+        num_untraced++;
+    }
+    xSemaphoreGive(delivered_mutex);
+}
+
+/*******************************************************************************
+ * Function Name: send_telemetry
+ *******************************************************************************
+ * Summary:
+ *   Sends one telemetry message of options.telemetry_bytes to the publisher
+ *   task.
+ *
+ * Return:
+ *   true if the message was queued, false if the pool or the queue was full
+ ******************************************************************************/
+static bool send_telemetry(void)
+{
+    publisher_data_t *msg = publisher_pool_alloc();
+    int len;
+
+    if (msg == NULL)
+    {
+        return false;
+    }
+
+    msg->cmd = PUBLISH_MQTT_MSG;
+    msg->topic = PRESENCE_DIAGNOSTICS;
+    msg->trace_id = 0;
+    len = snprintf(msg->data, sizeof(msg->data), "{\"telemetry\": %" PRIu32 ", \"pad\": \"", telemetry_sent);
+    while (((uint32_t)len < (options.telemetry_bytes - 2u)) && ((size_t)len < (sizeof(msg->data) - 3u)))
+    {
+        msg->data[len++] = 'x';
+    }
+    strcpy(&msg->data[len], "\"}");
+
+    return publisher_pool_send(msg);
+}
+
+/*******************************************************************************
+ * Function Name: load_task
+ *******************************************************************************
+ * Summary:
+ *   Generates the background load: telemetry messages through the publisher
+ *   pool and queue, competing with the events, and a storm of configuration
+ *   messages through the broker, which keeps the subscriber and configuration
+ *   tasks busy and contends for the presence context with the radar task.
+ *   The configuration sets the default macro threshold again, so the
+ *   detection itself is not changed.
+ ******************************************************************************/
+static void load_task(void *pvParameters)
+{
+    TickType_t last_wake = xTaskGetTickCount();
+    uint32_t tick = 0;
+    uint32_t telemetry_period = (options.telemetry_hz > 0u) ? (configTICK_RATE_HZ / options.telemetry_hz) : 0u;
+    uint32_t config_period = (options.config_hz > 0u) ? (configTICK_RATE_HZ / options.config_hz) : 0u;
+    char config[64];
+
+    (void)pvParameters;
+
+    snprintf(config, sizeof(config), "{\"macro_threshold\": \"%.2f\"}",
+             (double)radar_pipeline_default_config.macro_threshold);
+
+    for (;;)
+    {
+        vTaskDelayUntil(&last_wake, 1);
+        tick++;
+
+        if ((telemetry_period > 0u) && ((tick % telemetry_period) == 0u) && publisher_lanes_ready())
+        {
+            if (send_telemetry())
+            {
+                telemetry_sent++;
+            }
+            else
+            {
+                telemetry_dropped++;
+            }
+        }
+
+        if ((config_period > 0u) && ((tick % config_period) == 0u))
+        {
+            if (sim_broker_publish(MQTT_SUB_TOPIC, sizeof(MQTT_SUB_TOPIC) - 1, config, strlen(config)) == 0)
+            {
+                config_sent++;
+            }
+            else
+            {
+                config_dropped++;
+            }
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: compare_u32
+ ******************************************************************************/
+static int compare_u32(const void *a, const void *b)
+{
+    uint32_t va = *(const uint32_t *)a;
+    uint32_t vb = *(const uint32_t *)b;
+
+    return (va > vb) - (va < vb);
+}
+
+/*******************************************************************************
+ * Function Name: print_series
+ *******************************************************************************
+ * Summary:
+ *   Writes the statistics and the histogram of one series of latencies in
+ *   microseconds. The values are sorted in place.
+ ******************************************************************************/
+static void print_series(FILE *out, const char *name, uint32_t *values, uint32_t count, bool last)
+{
+    uint32_t buckets[LATENCY_BENCH_NUM_BUCKETS] = { 0 };
+    uint64_t total = 0;
+    bool first = true;
+
+    fprintf(out, "    \"%s\": {\"count\": %" PRIu32, name, count);
+    if (count > 0u)
+    {
+        qsort(values, count, sizeof(values[0]), compare_u32);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            uint32_t bucket = (values[i] == 0u) ? 0u : (32u - (uint32_t)__builtin_clz(values[i]));
+
+            total += values[i];
+            buckets[(bucket < LATENCY_BENCH_NUM_BUCKETS) ? bucket : (LATENCY_BENCH_NUM_BUCKETS - 1u)]++;
+        }
+
+        fprintf(out, ", \"min_us\": %" PRIu32 ", \"mean_us\": %.1f, \"p50_us\": %" PRIu32
+                ", \"p90_us\": %" PRIu32 ", \"p99_us\": %" PRIu32 ", \"max_us\": %" PRIu32,
+                values[0], (double)total / count, values[(count - 1u) / 2u],
+                values[((count * 90u) - 1u) / 100u], values[((count * 99u) - 1u) / 100u], values[count - 1u]);
+
+        /* Bucket b holds the values below 2^b us */
+        fprintf(out, ", \"histogram\": {");
+        for (uint32_t b = 0; b < LATENCY_BENCH_NUM_BUCKETS; ++b)
+        {
+            if (buckets[b] > 0u)
+            {
+                fprintf(out, "%s\"%" PRIu32 "\": %" PRIu32, first ? "" : ", ", (uint32_t)1u << b, buckets[b]);
+                first = false;
+            }
+        }
+        fprintf(out, "}");
+    }
+    fprintf(out, "}%s\n", last ? "" : ",");
+}
+
+/*******************************************************************************
+ * Function Name: report
+ *******************************************************************************
+ * Summary:
+ *   Writes the latencies of the delivered events per hop as JSON to the file
+ *   given in PRESENCE_LATENCY_OUTPUT, or to stdout.
+ ******************************************************************************/
+static void report(void)
+{
+    static uint32_t values[LATENCY_BENCH_NUM_SERIES][LATENCY_BENCH_MAX_EVENTS];
+    uint32_t counts[LATENCY_BENCH_NUM_SERIES] = { 0 };
+    const char *path = getenv("PRESENCE_LATENCY_OUTPUT");
+    const char *scene = getenv("PRESENCE_SIM_SCENE");
+    FILE *out = stdout;
+    uint32_t count;
+
+    xSemaphoreTake(delivered_mutex, portMAX_DELAY);
+    count = num_delivered;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const latency_trace_record_t *record = &delivered[i];
+
+        /* A hop without stamp, e.g. a message overwritten in its buffer,
+         * leaves out the hops around it
+         */
+        for (uint32_t hop = 1; hop < LATENCY_TRACE_NUM_HOPS; ++hop)
+        {
+            if ((record->ticks[hop] != 0u) && (record->ticks[hop - 1u] != 0u))
+            {
+                values[hop - 1u][counts[hop - 1u]++] =
+                    (record->ticks[hop] - record->ticks[hop - 1u]) / LATENCY_TRACE_TICKS_PER_US;
+            }
+        }
+        values[LATENCY_BENCH_NUM_SERIES - 1u][counts[LATENCY_BENCH_NUM_SERIES - 1u]++] =
+            (record->ticks[LATENCY_TRACE_DELIVERED] - record->ticks[LATENCY_TRACE_IRQ]) / LATENCY_TRACE_TICKS_PER_US;
+    }
+
+    if (path != NULL)
+    {
+        out = fopen(path, "w");
+        if (out == NULL)
+        {
+            perror(path);
+            out = stdout;
+        }
+    }
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"duration_s\": %" PRIu32 ",\n", options.duration_s);
+    fprintf(out, "  \"scene\": \"%s\",\n", (scene != NULL) ? scene : "cycle");
+    fprintf(out, "  \"telemetry_hz\": %" PRIu32 ",\n", options.telemetry_hz);
+    fprintf(out, "  \"telemetry_bytes\": %" PRIu32 ",\n", options.telemetry_bytes);
+    fprintf(out, "  \"telemetry_sent\": %" PRIu32 ",\n", telemetry_sent);
+    fprintf(out, "  \"telemetry_dropped\": %" PRIu32 ",\n", telemetry_dropped);
+    fprintf(out, "  \"config_hz\": %" PRIu32 ",\n", options.config_hz);
+    fprintf(out, "  \"config_sent\": %" PRIu32 ",\n", config_sent);
+    fprintf(out, "  \"config_dropped\": %" PRIu32 ",\n", config_dropped);
+    fprintf(out, "  \"events_traced\": %" PRIu32 ",\n", latency_trace_started());
+    fprintf(out, "  \"events_delivered\": %" PRIu32 ",\n", count);
+    fprintf(out, "  \"events_untraced\": %" PRIu32 ",\n", num_untraced);
+    fprintf(out, "  \"latency\": {\n");
+    for (uint32_t s = 0; s < LATENCY_BENCH_NUM_SERIES; ++s)
+    {
+        print_series(out, series_names[s], values[s], counts[s], s == (LATENCY_BENCH_NUM_SERIES - 1u));
+    }
+    fprintf(out, "  }\n");
+    fprintf(out, "}\n");
+    fflush(out);
+
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+    xSemaphoreGive(delivered_mutex);
+}
+
+/*******************************************************************************
+ * Function Name: report_task
+ ******************************************************************************/
+static void report_task(void *pvParameters)
+{
+    (void)pvParameters;
+
+    vTaskDelay(pdMS_TO_TICKS(options.duration_s * 1000u));
+    report();
+    exit(0);
+}
+
+/*******************************************************************************
+ * Function Name: latency_bench_start
+ *******************************************************************************
+ * Summary:
+ *   Subscribes the test subscriber to the events topic and starts the load
+ *   and report tasks. Called when the broker starts. The benchmark is set up
+ *   with environment variables:
+ *     PRESENCE_LATENCY_DURATION_S      run time before the report, default 300
+ *     PRESENCE_LATENCY_TELEMETRY_HZ    telemetry messages per second, default 0
+ *     PRESENCE_LATENCY_TELEMETRY_BYTES size of a telemetry message, default 200
+ *     PRESENCE_LATENCY_CONFIG_HZ       configuration messages per second, default 0
+ *     PRESENCE_LATENCY_OUTPUT          report file, default stdout
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void latency_bench_start(void)
+{
+    options.duration_s = env_u32("PRESENCE_LATENCY_DURATION_S", 300u);
+    options.telemetry_hz = env_u32("PRESENCE_LATENCY_TELEMETRY_HZ", 0u);
+    options.telemetry_bytes = env_u32("PRESENCE_LATENCY_TELEMETRY_BYTES", 200u);
+    options.config_hz = env_u32("PRESENCE_LATENCY_CONFIG_HZ", 0u);
+
+    if (options.telemetry_hz > configTICK_RATE_HZ)
+    {
+        options.telemetry_hz = configTICK_RATE_HZ;
+    }
+    if (options.config_hz > configTICK_RATE_HZ)
+    {
+        options.config_hz = configTICK_RATE_HZ;
+    }
+    if (options.telemetry_bytes < 32u)
+    {
+        options.telemetry_bytes = 32u;
+    }
+
+    delivered_mutex = xSemaphoreCreateMutex();
+    configASSERT(delivered_mutex != NULL);
+
+    if (sim_broker_subscribe(&subscriber, PAYLOAD_EVENTS_TOPIC, sizeof(PAYLOAD_EVENTS_TOPIC) - 1, on_event) != 0)
+    {
+        fprintf(stderr, "latency bench: cannot subscribe to the events topic\n");
+    }
+
+    xTaskCreate(load_task, "Latency load", LATENCY_BENCH_TASK_STACK_SIZE, NULL, LATENCY_BENCH_TASK_PRIORITY, NULL);
+    xTaskCreate(report_task, "Latency report", LATENCY_BENCH_TASK_STACK_SIZE, NULL, LATENCY_BENCH_TASK_PRIORITY, NULL);
+
+    printf("Latency bench: %" PRIu32 " s, telemetry %" PRIu32 " Hz x %" PRIu32 " bytes, config %" PRIu32 " Hz\n",
+           options.duration_s, options.telemetry_hz, options.telemetry_bytes, options.config_hz);
+}
+
+#endif /* LATENCY_TRACE_ENABLE */
+
+/* [] END OF FILE */
@@ -0,0 +1,48 @@
+/******************************************************************************
+ * File Name:   latency_bench.h
+ *
+ * Description: Host build: end-to-end latency benchmark of the presence events
+ *              with a test subscriber and background load.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef LATENCY_BENCH_H_
+#define LATENCY_BENCH_H_
+
+#include <stdint.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Delivered events whose stamps are kept for the report */
+#define LATENCY_BENCH_MAX_EVENTS            (4096u)
+
+#define LATENCY_BENCH_TASK_PRIORITY         (1)
+#define LATENCY_BENCH_TASK_STACK_SIZE       (1024 * 4)
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+void latency_bench_start(void);
+
+#endif
+/* [] END OF FILE */
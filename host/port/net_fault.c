@@ -0,0 +1,940 @@
+/******************************************************************************
+ * File Name:   net_fault.c
+ *
+ * Description: Host build: scriptable network faults for the MQTT and Wi-Fi stand-ins.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Header file includes */
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "task.h"
+
+#include "event_log.h"
+#include "mqtt_client_config.h"
+#include "net_fault.h"
+#include "payload_writer.h"
+#include "publisher_lanes.h"
+#include "publisher_pool.h"
+#include "rtos_artifacts.h"
+#include "sim_broker.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define NET_FAULT_LINE_LENGTH           (128u)
+#define NET_FAULT_KIND_LENGTH           (32u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef enum
+{
+    FAULT_LATENCY,
+    FAULT_LOSS,
+    FAULT_STALL,
+    FAULT_BROKER_RESTART,
+    FAULT_WIFI_DROP,
+    FAULT_NUM_KINDS
+} fault_kind_t;
+
+typedef struct
+{
+    fault_kind_t kind;
+    uint32_t at_ms;
+    uint32_t duration_ms;
+    uint32_t value;
+
+    /* Set by the fault task when the fault starts */
+    volatile bool started;
+    uint32_t dropped_links;
+
+    /* From the end of the fault to the next connection and subscription of
+     * a client, -1 until then
+     */
+    int32_t reconnect_ms;
+    int32_t resubscribe_ms;
+} fault_t;
+
+typedef struct
+{
+    void *link;
+    net_fault_drop_t drop;
+} link_t;
+
+typedef struct
+{
+    uint32_t attempted;
+    uint32_t published;
+    uint32_t failed;
+    uint32_t dropped;
+} publish_counts_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static const char *const kind_names[FAULT_NUM_KINDS] =
+{
+    "latency",
+    "loss",
+    "stall",
+    "broker_restart",
+    "wifi_drop"
+};
+
+static bool enabled;
+static const char *script_path;
+static uint32_t duration_s;
+static uint32_t seed;
+static uint32_t random_state;
+static TickType_t start_tick;
+
+static fault_t faults[NET_FAULT_MAX_FAULTS];
+static uint32_t num_faults;
+static volatile uint32_t wifi_drops;
+
+static link_t links[NET_FAULT_MAX_LINKS];
+
+static publish_counts_t events;
+static publish_counts_t messages;
+static uint32_t events_delivered;
+static uint32_t deliveries_passed;
+static uint32_t deliveries_dropped;
+static uint32_t connects;
+static uint32_t connects_refused;
+static uint32_t links_dropped;
+static uint32_t subscribes;
+
+static size_t heap_in_use;
+static size_t heap_high_water;
+static uint32_t publisher_q_high_water;
+static UBaseType_t mqtt_q_high_water;
+
+/* The test subscriber is identified by the address of this variable */
+static int subscriber;
+
+/*******************************************************************************
+ * Function Name: env_u32
+ ******************************************************************************/
+static uint32_t env_u32(const char *name, uint32_t default_value)
+{
+    const char *value = getenv(name);
+
+    return (value != NULL) ? (uint32_t)strtoul(value, NULL, 0) : default_value;
+}
+
+/*******************************************************************************
+ * Function Name: now_ms
+ *******************************************************************************
+ * Summary:
+ *   Returns the time since the start of the script.
+ ******************************************************************************/
+static uint32_t now_ms(void)
+{
+    return (uint32_t)((xTaskGetTickCount() - start_tick) * portTICK_PERIOD_MS);
+}
+
+/*******************************************************************************
+ * Function Name: next_random
+ *******************************************************************************
+ * Summary:
+ *   xorshift32, so that a seed gives the same losses on every run.
+ ******************************************************************************/
+static uint32_t next_random(void)
+{
+    uint32_t x;
+
+    taskENTER_CRITICAL();
+    x = random_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    random_state = x;
+    taskEXIT_CRITICAL();
+
+    return x;
+}
+
+/*******************************************************************************
+ * Function Name: active_value
+ *******************************************************************************
+ * Summary:
+ *   Returns the largest value of the faults of a kind that are active at a
+ *   time, or 0 if none is active. Faults without value count as 1.
+ *
+ * Parameters:
+ *   kind: kind of fault
+ *   time_ms: time since the start of the script
+ *
+ * Return:
+ *   Value of the active faults
+ ******************************************************************************/
+static uint32_t active_value(fault_kind_t kind, uint32_t time_ms)
+{
+    uint32_t value = 0;
+
+    for (uint32_t i = 0; i < num_faults; ++i)
+    {
+        const fault_t *fault = &faults[i];
+
+        if ((fault->kind == kind) && (time_ms >= fault->at_ms) &&
+            ((time_ms - fault->at_ms) < fault->duration_ms) && (fault->value > value))
+        {
+            value = fault->value;
+        }
+    }
+
+    return value;
+}
+
+/*******************************************************************************
+ * Function Name: cross_link
+ *******************************************************************************
+ * Summary:
+ *   Holds a message for the stalls and the latency of the link and decides
+ *   whether it is lost.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   true if the message is lost
+ ******************************************************************************/
+static bool cross_link(void)
+{
+    uint32_t latency_ms;
+    uint32_t loss_percent;
+
+    while (active_value(FAULT_STALL, now_ms()) != 0u)
+    {
+        vTaskDelay(pdMS_TO_TICKS(NET_FAULT_POLL_MS));
+    }
+
+    latency_ms = active_value(FAULT_LATENCY, now_ms());
+    if (latency_ms > 0u)
+    {
+        vTaskDelay(pdMS_TO_TICKS(latency_ms));
+    }
+
+    if (net_fault_broker_down() || net_fault_wifi_down())
+    {
+        return true;
+    }
+
+    loss_percent = active_value(FAULT_LOSS, now_ms());
+    return (loss_percent > 0u) && ((next_random() % 100u) < loss_percent);
+}
+
+/*******************************************************************************
+ * Function Name: drop_links
+ *******************************************************************************
+ * Summary:
+ *   Drops the connections of all registered clients.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   Number of clients that were connected
+ ******************************************************************************/
+static uint32_t drop_links(void)
+{
+    link_t snapshot[NET_FAULT_MAX_LINKS];
+    uint32_t dropped = 0;
+
+    taskENTER_CRITICAL();
+    memcpy(snapshot, links, sizeof(snapshot));
+    taskEXIT_CRITICAL();
+
+    /* The drop runs the event callback of the client, which may block */
+    for (uint32_t i = 0; i < NET_FAULT_MAX_LINKS; ++i)
+    {
+        if ((snapshot[i].link != NULL) && snapshot[i].drop(snapshot[i].link))
+        {
+            dropped++;
+        }
+    }
+
+    links_dropped += dropped;
+    return dropped;
+}
+
+/*******************************************************************************
+ * Function Name: on_event
+ *******************************************************************************
+ * Summary:
+ *   Test subscriber of the events topic, on the broker side of the faults.
+ *   Runs in the broker task.
+ ******************************************************************************/
+static void on_event(void *client, const char *topic, uint16_t topic_len,
+                     const uint8_t *payload, size_t payload_len)
+{
+    (void)client;
+    (void)topic;
+    (void)topic_len;
+    (void)payload;
+    (void)payload_len;
+
+    events_delivered++;
+}
+
+/*******************************************************************************
+ * Function Name: load_script
+ *******************************************************************************
+ * Summary:
+ *   Reads the faults from a script with one fault per line:
+ *
+ *     <at_ms> <kind> <duration_ms> [<value>]
+ *
+ *   at_ms counts from the first connection to the broker. The kinds are:
+ *     latency <ms>     delay of every message in both directions
+ *     loss <percent>   share of the messages that are lost
+ *     stall            no message crosses the link until the end
+ *     broker_restart   the broker drops all connections and refuses new ones
+ *     wifi_drop        the access point is lost, the connections with it
+ *   Exits on errors of the script.
+ *
+ * Parameters:
+ *   path: script file
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void load_script(const char *path)
+{
+    char line[NET_FAULT_LINE_LENGTH];
+    char kind[NET_FAULT_KIND_LENGTH];
+    uint32_t number = 0;
+    FILE *file = fopen(path, "r");
+
+    if (file == NULL)
+    {
+        perror(path);
+        exit(1);
+    }
+
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        fault_t *fault = &faults[num_faults];
+        uint32_t k;
+        int fields;
+
+        number++;
+        line[strcspn(line, "#\r\n")] = '\0';
+
+        fields = sscanf(line, "%" SCNu32 " %31s %" SCNu32 " %" SCNu32,
+                        &fault->at_ms, kind, &fault->duration_ms, &fault->value);
+        if (fields <= 0)
+        {
+            continue;
+        }
+
+        for (k = 0; (k < FAULT_NUM_KINDS) && (strcmp(kind, kind_names[k]) != 0); ++k)
+        {
+        }
+
+        if ((fields < 3) || (k == FAULT_NUM_KINDS))
+        {
+            fprintf(stderr, "[fault] %s:%" PRIu32 ": expected '<at_ms> <kind> <duration_ms> [<value>]'\n",
+                    path, number);
+            exit(1);
+        }
+        if (((k == FAULT_LATENCY) || (k == FAULT_LOSS)) && ((fields < 4) || (fault->value == 0u)))
+        {
+            fprintf(stderr, "[fault] %s:%" PRIu32 ": %s needs a value\n", path, number, kind);
+            exit(1);
+        }
+        if ((k == FAULT_LOSS) && (fault->value > 100u))
+        {
+            fprintf(stderr, "[fault] %s:%" PRIu32 ": loss is a percentage\n", path, number);
+            exit(1);
+        }
+        if (num_faults == NET_FAULT_MAX_FAULTS)
+        {
+            fprintf(stderr, "[fault] %s: more than %u faults\n", path, NET_FAULT_MAX_FAULTS);
+            exit(1);
+        }
+
+        fault->kind = (fault_kind_t)k;
+        if ((k != FAULT_LATENCY) && (k != FAULT_LOSS))
+        {
+            fault->value = 1u;
+        }
+        fault->reconnect_ms = -1;
+        fault->resubscribe_ms = -1;
+        num_faults++;
+    }
+
+    fclose(file);
+}
+
+/*******************************************************************************
+ * Function Name: sample_memory
+ *******************************************************************************
+ * Summary:
+ *   Updates the high-water marks of the heap, of the lanes towards the
+ *   publisher, and of the queue of the MQTT task. The heap of the host build is malloc.
+ ******************************************************************************/
+static void sample_memory(void)
+{
+    struct mallinfo2 info = mallinfo2();
+
+    heap_in_use = info.uordblks + info.hblkhd;
+    if (heap_in_use > heap_high_water)
+    {
+        heap_high_water = heap_in_use;
+    }
+
+    if (publisher_lanes_waiting() > publisher_q_high_water)
+    {
+        publisher_q_high_water = publisher_lanes_waiting();
+    }
+    if ((mqtt_task_q != NULL) && (uxQueueMessagesWaiting(mqtt_task_q) > mqtt_q_high_water))
+    {
+        mqtt_q_high_water = uxQueueMessagesWaiting(mqtt_task_q);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: print_ms
+ ******************************************************************************/
+static void print_ms(FILE *out, const char *name, int32_t value)
+{
+    if (value < 0)
+    {
+        fprintf(out, ", \"%s\": null", name);
+    }
+    else
+    {
+        fprintf(out, ", \"%s\": %" PRId32, name, value);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: print_counts
+ ******************************************************************************/
+static void print_counts(FILE *out, const char *name, const publish_counts_t *counts)
+{
+    fprintf(out, "  \"%s\": {\"attempted\": %" PRIu32 ", \"published\": %" PRIu32
+            ", \"failed\": %" PRIu32 ", \"dropped\": %" PRIu32,
+            name, counts->attempted, counts->published, counts->failed, counts->dropped);
+}
+
+/*******************************************************************************
+ * Function Name: report
+ *******************************************************************************
+ * Summary:
+ *   Writes the recovery of each fault, the fate of the published messages and
+ *   the memory high-water marks as JSON to the file given in
+ *   PRESENCE_FAULT_OUTPUT, or to stdout.
+ ******************************************************************************/
+static void report(void)
+{
+    const char *path = getenv("PRESENCE_FAULT_OUTPUT");
+    const char *scene = getenv("PRESENCE_SIM_SCENE");
+    UBaseType_t num_tasks = uxTaskGetNumberOfTasks();
+    TaskStatus_t *tasks = pvPortMalloc(num_tasks * sizeof(TaskStatus_t));
+    FILE *out = stdout;
+    publisher_pool_stats_t pool;
+
+    publisher_pool_get_stats(&pool);
+    if (tasks != NULL)
+    {
+        num_tasks = uxTaskGetSystemState(tasks, num_tasks, NULL);
+    }
+    else
+    {
+        num_tasks = 0;
+    }
+
+    if (path != NULL)
+    {
+        out = fopen(path, "w");
+        if (out == NULL)
+        {
+            perror(path);
+            out = stdout;
+        }
+    }
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"script\": \"%s\",\n", script_path);
+    fprintf(out, "  \"seed\": %" PRIu32 ",\n", seed);
+    fprintf(out, "  \"duration_s\": %" PRIu32 ",\n", duration_s);
+    fprintf(out, "  \"scene\": \"%s\",\n", (scene != NULL) ? scene : "cycle");
+
+    fprintf(out, "  \"faults\": [\n");
+    for (uint32_t i = 0; i < num_faults; ++i)
+    {
+        const fault_t *fault = &faults[i];
+
+        fprintf(out, "    {\"at_ms\": %" PRIu32 ", \"kind\": \"%s\", \"duration_ms\": %" PRIu32,
+                fault->at_ms, kind_names[fault->kind], fault->duration_ms);
+        if ((fault->kind == FAULT_LATENCY) || (fault->kind == FAULT_LOSS))
+        {
+            fprintf(out, ", \"value\": %" PRIu32, fault->value);
+        }
+        if ((fault->kind == FAULT_BROKER_RESTART) || (fault->kind == FAULT_WIFI_DROP))
+        {
+            fprintf(out, ", \"dropped_connections\": %" PRIu32, fault->dropped_links);
+            print_ms(out, "reconnect_ms", fault->reconnect_ms);
+            print_ms(out, "resubscribe_ms", fault->resubscribe_ms);
+        }
+        fprintf(out, "}%s\n", (i + 1u < num_faults) ? "," : "");
+    }
+    fprintf(out, "  ],\n");
+
+    fprintf(out, "  \"connections\": {\"connects\": %" PRIu32 ", \"refused\": %" PRIu32
+            ", \"dropped\": %" PRIu32 ", \"subscribes\": %" PRIu32 "},\n",
+            connects, connects_refused, links_dropped, subscribes);
+
+    /* Events that never reached cy_mqtt_publish(), e.g. dropped at a full
+     * publisher lane, are not counted here
+     */
+    print_counts(out, "events", &events);
+    fprintf(out, ", \"delivered\": %" PRIu32 ", \"lost\": %" PRIu32 "},\n", events_delivered,
+            (events.attempted > events_delivered) ? (events.attempted - events_delivered) : 0u);
+    print_counts(out, "messages", &messages);
+    fprintf(out, "},\n");
+    fprintf(out, "  \"deliveries\": {\"passed\": %" PRIu32 ", \"dropped\": %" PRIu32 "},\n",
+            deliveries_passed, deliveries_dropped);
+
+#if EVENT_LOG_ENABLE
+    event_log_stats_t log;
+
+    /* Events kept in flash while offline, delivered again as replays */
+    event_log_get_stats(&log);
+    fprintf(out, "  \"event_log\": {\"logged\": %" PRIu32 ", \"replayed\": %" PRIu32 ", \"compacted\": %" PRIu32
+            ", \"backlog\": %" PRIu32 ", \"row_writes\": %" PRIu32 ", \"flash_errors\": %" PRIu32 "},\n",
+            log.logged, log.replayed, log.compacted, log.backlog, log.row_writes, log.flash_errors);
+#endif
+
+    fprintf(out, "  \"memory\": {\n");
+    fprintf(out, "    \"heap_in_use_bytes\": %zu,\n", heap_in_use);
+    fprintf(out, "    \"heap_high_water_bytes\": %zu,\n", heap_high_water);
+    fprintf(out, "    \"publisher_queue_high_water\": %u,\n", (unsigned)publisher_q_high_water);
+    fprintf(out, "    \"mqtt_queue_high_water\": %u,\n", (unsigned)mqtt_q_high_water);
+    fprintf(out, "    \"publisher_pool_max_in_use\": %" PRIu32 ",\n", pool.max_in_use);
+    fprintf(out, "    \"publisher_pool_exhausted\": %" PRIu32 ",\n", pool.exhausted);
+    fprintf(out, "    \"publisher_pool_queue_full\": %" PRIu32 ",\n", pool.queue_full);
+    fprintf(out, "    \"stack_min_free_bytes\": {");
+    for (UBaseType_t i = 0; i < num_tasks; ++i)
+    {
+        fprintf(out, "%s\"%s\": %u", (i == 0u) ? "" : ", ", tasks[i].pcTaskName,
+                (unsigned)(tasks[i].usStackHighWaterMark * sizeof(StackType_t)));
+    }
+    fprintf(out, "}\n");
+    fprintf(out, "  }\n");
+    fprintf(out, "}\n");
+    fflush(out);
+
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+    vPortFree(tasks);
+}
+
+/*******************************************************************************
+ * Function Name: fault_task
+ *******************************************************************************
+ * Summary:
+ *   Starts the faults of the script. Broker restarts and Wi-Fi drops break
+ *   the connections of the clients when they start; the other faults act on
+ *   each message while they are active.
+ ******************************************************************************/
+static void fault_task(void *pvParameters)
+{
+    TickType_t last_wake = xTaskGetTickCount();
+
+    (void)pvParameters;
+
+    for (;;)
+    {
+        uint32_t time_ms;
+
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(NET_FAULT_POLL_MS));
+        time_ms = now_ms();
+
+        for (uint32_t i = 0; i < num_faults; ++i)
+        {
+            fault_t *fault = &faults[i];
+
+            if (fault->started || (time_ms < fault->at_ms))
+            {
+                continue;
+            }
+
+            fault->started = true;
+            printf("[fault] %s for %" PRIu32 " ms\n", kind_names[fault->kind], fault->duration_ms);
+
+            if (fault->kind == FAULT_WIFI_DROP)
+            {
+                wifi_drops++;
+            }
+            if ((fault->kind == FAULT_BROKER_RESTART) || (fault->kind == FAULT_WIFI_DROP))
+            {
+                fault->dropped_links = drop_links();
+            }
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: report_task
+ *******************************************************************************
+ * Summary:
+ *   Samples the memory use until the end of the run and writes the report.
+ *   Separate from the fault task, which may block in the callback of a
+ *   client.
+ ******************************************************************************/
+static void report_task(void *pvParameters)
+{
+    TickType_t last_wake = xTaskGetTickCount();
+
+    (void)pvParameters;
+
+    while (now_ms() < (duration_s * 1000u))
+    {
+        sample_memory();
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(NET_FAULT_POLL_MS));
+    }
+
+    report();
+    exit(0);
+}
+
+/*******************************************************************************
+ * Function Name: net_fault_start
+ *******************************************************************************
+ * Summary:
+ *   Loads the fault script and starts the fault and report tasks. Called
+ *   when the broker starts; does nothing without a script. Set up with
+ *   environment variables:
+ *     PRESENCE_FAULT_SCRIPT      fault script, see load_script()
+ *     PRESENCE_FAULT_SEED        seed of the losses, default 1
+ *     PRESENCE_FAULT_DURATION_S  run time before the report, default 60 s
+ *                                after the end of the last fault
+ *     PRESENCE_FAULT_OUTPUT      report file, default stdout
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void net_fault_start(void)
+{
+    uint32_t last_end_ms = 0;
+
+    script_path = getenv("PRESENCE_FAULT_SCRIPT");
+    if ((script_path == NULL) || enabled)
+    {
+        return;
+    }
+
+    load_script(script_path);
+    for (uint32_t i = 0; i < num_faults; ++i)
+    {
+        if ((faults[i].at_ms + faults[i].duration_ms) > last_end_ms)
+        {
+            last_end_ms = faults[i].at_ms + faults[i].duration_ms;
+        }
+    }
+
+    seed = env_u32("PRESENCE_FAULT_SEED", 1u);
+    random_state = (seed != 0u) ? seed : 1u;
+    duration_s = env_u32("PRESENCE_FAULT_DURATION_S", ((last_end_ms + 999u) / 1000u) + NET_FAULT_SETTLE_S);
+
+    configASSERT(sim_broker_subscribe(&subscriber, PAYLOAD_EVENTS_TOPIC,
+                                      sizeof(PAYLOAD_EVENTS_TOPIC) - 1, on_event) == 0);
+
+    start_tick = xTaskGetTickCount();
+    enabled = true;
+
+    xTaskCreate(fault_task, "Fault injection", NET_FAULT_TASK_STACK_SIZE, NULL,
+                NET_FAULT_TASK_PRIORITY, NULL);
+    xTaskCreate(report_task, "Fault report", NET_FAULT_TASK_STACK_SIZE, NULL,
+                NET_FAULT_TASK_PRIORITY, NULL);
+
+    printf("[fault] %" PRIu32 " faults from %s, report after %" PRIu32 " s\n",
+           num_faults, script_path, duration_s);
+}
+
+/*******************************************************************************
+ * Function Name: net_fault_register_link
+ *******************************************************************************
+ * Summary:
+ *   Registers a client whose connection is dropped by broker restarts and
+ *   Wi-Fi drops.
+ *
+ * Parameters:
+ *   link: client
+ *   drop: drops the connection of the client
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void net_fault_register_link(void *link, net_fault_drop_t drop)
+{
+    taskENTER_CRITICAL();
+    for (uint32_t i = 0; i < NET_FAULT_MAX_LINKS; ++i)
+    {
+        if (links[i].link == NULL)
+        {
+            links[i].link = link;
+            links[i].drop = drop;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+ * Function Name: net_fault_unregister_link
+ ******************************************************************************/
+void net_fault_unregister_link(void *link)
+{
+    taskENTER_CRITICAL();
+    for (uint32_t i = 0; i < NET_FAULT_MAX_LINKS; ++i)
+    {
+        if (links[i].link == link)
+        {
+            links[i].link = NULL;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+ * Function Name: net_fault_broker_down
+ ******************************************************************************/
+bool net_fault_broker_down(void)
+{
+    return enabled && (active_value(FAULT_BROKER_RESTART, now_ms()) != 0u);
+}
+
+/*******************************************************************************
+ * Function Name: net_fault_wifi_down
+ ******************************************************************************/
+bool net_fault_wifi_down(void)
+{
+    return enabled && (active_value(FAULT_WIFI_DROP, now_ms()) != 0u);
+}
+
+/*******************************************************************************
+ * Function Name: net_fault_wifi_drops
+ *******************************************************************************
+ * Summary:
+ *   Returns the number of Wi-Fi drops so far. A connection to the access
+ *   point made before the last drop is lost, even if the drop has ended.
+ ******************************************************************************/
+uint32_t net_fault_wifi_drops(void)
+{
+    return wifi_drops;
+}
+
+/*******************************************************************************
+ * Function Name: net_fault_publish
+ *******************************************************************************
+ * Summary:
+ *   Passes a message from a client to the broker over the faulty link. The
+ *   calling task is held for the stalls and the latency. A lost message with
+ *   QoS 1 or 2 fails after MQTT_TIMEOUT_MS without acknowledgement.
+ *
+ * Parameters:
+ *   qos: QoS of the message
+ *
+ * Return:
+ *   Fate of the message
+ ******************************************************************************/
+net_fault_action_t net_fault_publish(uint8_t qos)
+{
+    if (!enabled || !cross_link())
+    {
+        return NET_FAULT_PASS;
+    }
+
+    if (qos == 0u)
+    {
+        return NET_FAULT_DROP;
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(MQTT_TIMEOUT_MS));
+    return NET_FAULT_FAIL;
+}
+
+/*******************************************************************************
+ * Function Name: net_fault_published
+ *******************************************************************************
+ * Summary:
+ *   Counts the fate of a message published by a client.
+ *
+ * Parameters:
+ *   topic, topic_len: topic of the message
+ *   action: fate of the message
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void net_fault_published(const char *topic, uint16_t topic_len, net_fault_action_t action)
+{
+    publish_counts_t *counts[2] = { &messages, NULL };
+
+    if (!enabled)
+    {
+        return;
+    }
+
+    if ((topic_len == (sizeof(PAYLOAD_EVENTS_TOPIC) - 1)) &&
+        (memcmp(topic, PAYLOAD_EVENTS_TOPIC, topic_len) == 0))
+    {
+        counts[1] = &events;
+    }
+
+    taskENTER_CRITICAL();
+    for (uint32_t i = 0; (i < 2u) && (counts[i] != NULL); ++i)
+    {
+        counts[i]->attempted++;
+        if (action == NET_FAULT_PASS)
+        {
+            counts[i]->published++;
+        }
+        else if (action == NET_FAULT_DROP)
+        {
+            counts[i]->dropped++;
+        }
+        else
+        {
+            counts[i]->failed++;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+ * Function Name: net_fault_deliver
+ *******************************************************************************
+ * Summary:
+ *   Passes a message from the broker to a client over the faulty link. Runs
+ *   in the broker task, so stalls and latency hold all deliveries.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   NET_FAULT_PASS, or NET_FAULT_DROP if the message is lost
+ ******************************************************************************/
+net_fault_action_t net_fault_deliver(void)
+{
+    if (!enabled)
+    {
+        return NET_FAULT_PASS;
+    }
+
+    if (cross_link())
+    {
+        deliveries_dropped++;
+        return NET_FAULT_DROP;
+    }
+
+    deliveries_passed++;
+    return NET_FAULT_PASS;
+}
+
+/*******************************************************************************
+ * Function Name: net_fault_connected
+ *******************************************************************************
+ * Summary:
+ *   Counts a connection attempt of a client. A successful one ends the outage
+ *   of the broker restarts and Wi-Fi drops that have ended before it.
+ *
+ * Parameters:
+ *   success: true if the client is connected
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void net_fault_connected(bool success)
+{
+    uint32_t time_ms = now_ms();
+
+    if (!enabled)
+    {
+        return;
+    }
+
+    if (!success)
+    {
+        connects_refused++;
+        return;
+    }
+
+    connects++;
+    for (uint32_t i = 0; i < num_faults; ++i)
+    {
+        fault_t *fault = &faults[i];
+        uint32_t end_ms = fault->at_ms + fault->duration_ms;
+
+        if ((fault->dropped_links > 0u) && (fault->reconnect_ms < 0) && (time_ms >= end_ms))
+        {
+            fault->reconnect_ms = (int32_t)(time_ms - end_ms);
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: net_fault_subscribed
+ *******************************************************************************
+ * Summary:
+ *   Counts a subscription of a client; the client has recovered from the
+ *   outages that it reconnected after.
+ ******************************************************************************/
+void net_fault_subscribed(void)
+{
+    uint32_t time_ms = now_ms();
+
+    if (!enabled)
+    {
+        return;
+    }
+
+    subscribes++;
+    for (uint32_t i = 0; i < num_faults; ++i)
+    {
+        fault_t *fault = &faults[i];
+
+        if ((fault->reconnect_ms >= 0) && (fault->resubscribe_ms < 0))
+        {
+            fault->resubscribe_ms = (int32_t)(time_ms - (fault->at_ms + fault->duration_ms));
+        }
+    }
+}
+
+/* [] END OF FILE */
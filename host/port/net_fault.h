@@ -0,0 +1,85 @@
+/******************************************************************************
+ * File Name:   net_fault.h
+ *
+ * Description: Host build: scriptable network faults for the MQTT and Wi-Fi stand-ins.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef NET_FAULT_H_
+#define NET_FAULT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Faults of one script */
+#define NET_FAULT_MAX_FAULTS            (32u)
+
+/* Clients whose connections are dropped by broker restarts and Wi-Fi drops */
+#define NET_FAULT_MAX_LINKS             (4u)
+
+/* Interval of the fault driver, the stall polling and the memory sampling */
+#define NET_FAULT_POLL_MS               (10u)
+
+/* Run time after the last fault when PRESENCE_FAULT_DURATION_S is not set */
+#define NET_FAULT_SETTLE_S              (60u)
+
+#define NET_FAULT_TASK_PRIORITY         (5)
+#define NET_FAULT_TASK_STACK_SIZE       (1024 * 4)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+/* Fate of a message that crosses the link */
+typedef enum
+{
+    NET_FAULT_PASS,     /* delivered */
+    NET_FAULT_DROP,     /* lost without notice, QoS 0 */
+    NET_FAULT_FAIL      /* lost and reported to the sender, QoS 1 and 2 */
+} net_fault_action_t;
+
+/* Drops the connection of a client, like a broken socket. Returns true if
+ * the client was connected.
+ */
+typedef bool (*net_fault_drop_t)(void *link);
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+void net_fault_start(void);
+void net_fault_register_link(void *link, net_fault_drop_t drop);
+void net_fault_unregister_link(void *link);
+
+bool net_fault_broker_down(void);
+bool net_fault_wifi_down(void);
+uint32_t net_fault_wifi_drops(void);
+
+net_fault_action_t net_fault_publish(uint8_t qos);
+void net_fault_published(const char *topic, uint16_t topic_len, net_fault_action_t action);
+net_fault_action_t net_fault_deliver(void);
+void net_fault_connected(bool success);
+void net_fault_subscribed(void);
+
+#endif
+/* [] END OF FILE */
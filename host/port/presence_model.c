@@ -0,0 +1,680 @@
+/******************************************************************************
+ * File Name:   presence_model.c
+ *
+ * Description: Host build: reference model of the XENSIV radar presence
+ *              algorithm. It implements the library interface with a range FFT per
+ *              frame, macro motion from range profile changes over the compare
+ *              interval and micro motion from the slow-time spectrum of each range
+ *              bin. Detections and state changes follow the library configuration,
+ *              but the host results are not bit-exact with the target library.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <math.h>
+#include <string.h>
+
+/* Header file includes */
+#include "xensiv_radar_presence.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define MODEL_MAX_SAMPLES           (256)
+#define MODEL_MAX_BINS              (32)
+#define MODEL_MAX_MICRO_FFT         (128)
+
+/* Frames averaged into one slow-time sample with decimation enabled */
+#define MODEL_MICRO_DECIMATION      (8)
+
+/* Slow-time samples between two micro motion evaluations */
+#define MODEL_MICRO_EVAL_INTERVAL   (16)
+
+/* Scale of the micro motion metric, so that the library thresholds apply */
+#define MODEL_MICRO_GAIN            (100.0f)
+
+#define MODEL_SPEED_OF_LIGHT        (299792458.0f)
+#define MODEL_PI                    (3.14159265f)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+struct xensiv_radar_presence_context
+{
+    xensiv_radar_presence_config_t config;
+    xensiv_radar_presence_cb_t callback;
+    void *callback_data;
+
+    arm_rfft_fast_instance_f32 rfft;
+    arm_cfft_instance_f32 cfft;
+    float32_t window[MODEL_MAX_SAMPLES];
+    float32_t fft_in[MODEL_MAX_SAMPLES];
+    float32_t fft_out[MODEL_MAX_SAMPLES];
+
+    /* Range profile magnitudes, now and at the last macro comparison */
+    float32_t magnitude[MODEL_MAX_BINS];
+    float32_t reference[MODEL_MAX_BINS];
+    bool has_reference;
+    uint32_t reference_ms;
+    int32_t confirmations;
+
+    /* Slow-time history of the complex range bins */
+    float32_t slow_time[MODEL_MAX_BINS][MODEL_MAX_MICRO_FFT * 2];
+    float32_t decimation_sum[MODEL_MAX_BINS * 2];
+    int32_t decimation_count;
+    int32_t slow_time_pos;
+    int32_t slow_time_count;
+    int32_t samples_since_eval;
+    float32_t micro_buffer[MODEL_MAX_MICRO_FFT * 2];
+
+    bool macro_valid;
+    bool micro_valid;
+    uint32_t last_macro_ms;
+    uint32_t last_micro_ms;
+    int32_t macro_bin;
+    int32_t micro_bin;
+
+    xensiv_radar_presence_state_t state;
+};
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static void *(*model_malloc)(size_t size) = NULL;
+static void (*model_free)(void *ptr) = NULL;
+
+/*******************************************************************************
+ * Function Name: is_power_of_two
+ ******************************************************************************/
+static bool is_power_of_two(int32_t value)
+{
+    return (value > 0) && ((value & (value - 1)) == 0);
+}
+
+/*******************************************************************************
+ * Function Name: check_config
+ *******************************************************************************
+ * Summary:
+ *   Checks that a configuration is within the limits of the model.
+ *
+ * Parameters:
+ *   config: configuration to check
+ *
+ * Return:
+ *   true if the configuration is supported
+ ******************************************************************************/
+static bool check_config(const xensiv_radar_presence_config_t *config)
+{
+    return is_power_of_two(config->num_samples_per_chirp) &&
+           (config->num_samples_per_chirp >= 32) &&
+           (config->num_samples_per_chirp <= MODEL_MAX_SAMPLES) &&
+           is_power_of_two(config->micro_fft_size) &&
+           (config->micro_fft_size >= 16) &&
+           (config->micro_fft_size <= MODEL_MAX_MICRO_FFT) &&
+           (config->min_range_bin >= 0) &&
+           (config->max_range_bin >= config->min_range_bin) &&
+           (config->max_range_bin < MODEL_MAX_BINS) &&
+           (config->max_range_bin < (config->num_samples_per_chirp / 2)) &&
+           (config->micro_movement_compare_idx >= 1) &&
+           (config->micro_movement_compare_idx < (config->micro_fft_size / 2)) &&
+           (config->bandwidth > 0.0f);
+}
+
+/*******************************************************************************
+ * Function Name: apply_config
+ *******************************************************************************
+ * Summary:
+ *   Sets up the FFTs and the window for a configuration and clears the
+ *   detection state.
+ *
+ * Parameters:
+ *   ctx: model context
+ *   config: validated configuration
+ *
+ * Return:
+ *   XENSIV_RADAR_PRESENCE_OK, or an error if an FFT length is unsupported
+ ******************************************************************************/
+static xensiv_radar_presence_status_t apply_config(xensiv_radar_presence_handle_t ctx,
+                                                   const xensiv_radar_presence_config_t *config)
+{
+    int32_t n = config->num_samples_per_chirp;
+
+    if ((arm_rfft_fast_init_f32(&ctx->rfft, (uint16_t)n) != ARM_MATH_SUCCESS) ||
+        (arm_cfft_init_f32(&ctx->cfft, (uint16_t)config->micro_fft_size) != ARM_MATH_SUCCESS))
+    {
+        return XENSIV_RADAR_PRESENCE_FFT_LEN_ERROR;
+    }
+
+    for (int32_t i = 0; i < n; ++i)
+    {
+        ctx->window[i] = 0.5f - (0.5f * cosf((2.0f * MODEL_PI * (float32_t)i) / (float32_t)n));
+    }
+
+    ctx->config = *config;
+    xensiv_radar_presence_reset(ctx);
+    return XENSIV_RADAR_PRESENCE_OK;
+}
+
+/*******************************************************************************
+ * Function Name: range_fft
+ *******************************************************************************
+ * Summary:
+ *   Computes the complex range profile of the first chirp of a frame. The
+ *   mean is removed before windowing; the optional bandpass filter is a
+ *   first difference that also suppresses the transmitter leakage.
+ *
+ * Parameters:
+ *   ctx: model context
+ *   frame: samples of the frame, normalized to [0, 1)
+ *
+ * Return:
+ *   none, the profile is in ctx->fft_out in CMSIS packed format
+ ******************************************************************************/
+static void range_fft(xensiv_radar_presence_handle_t ctx, const float32_t *frame)
+{
+    int32_t n = ctx->config.num_samples_per_chirp;
+    float32_t mean;
+
+    if (ctx->config.macro_fft_bandpass_filter_enabled)
+    {
+        ctx->fft_in[0] = 0.0f;
+        for (int32_t i = 1; i < n; ++i)
+        {
+            ctx->fft_in[i] = frame[i] - frame[i - 1];
+        }
+    }
+    else
+    {
+        memcpy(ctx->fft_in, frame, (size_t)n * sizeof(float32_t));
+    }
+
+    arm_mean_f32(ctx->fft_in, (uint32_t)n, &mean);
+    arm_offset_f32(ctx->fft_in, -mean, ctx->fft_in, (uint32_t)n);
+    arm_mult_f32(ctx->fft_in, ctx->window, ctx->fft_in, (uint32_t)n);
+    arm_rfft_fast_f32(&ctx->rfft, ctx->fft_in, ctx->fft_out, 0);
+}
+
+/*******************************************************************************
+ * Function Name: update_macro
+ *******************************************************************************
+ * Summary:
+ *   Compares the range profile magnitudes with those of one compare
+ *   interval ago. A person moving through the room changes the magnitudes
+ *   as it crosses range bins; breathing only changes the phase.
+ *
+ * Parameters:
+ *   ctx: model context
+ *   time_ms: frame time
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void update_macro(xensiv_radar_presence_handle_t ctx, uint32_t time_ms)
+{
+    const xensiv_radar_presence_config_t *config = &ctx->config;
+    float32_t max_change = 0.0f;
+    int32_t max_bin = -1;
+
+    if (!ctx->has_reference)
+    {
+        memcpy(ctx->reference, ctx->magnitude, sizeof(ctx->reference));
+        ctx->reference_ms = time_ms;
+        ctx->has_reference = true;
+        return;
+    }
+
+    if ((int32_t)(time_ms - ctx->reference_ms) < config->macro_compare_interval_ms)
+    {
+        return;
+    }
+
+    for (int32_t bin = config->min_range_bin; bin <= config->max_range_bin; ++bin)
+    {
+        float32_t change = fabsf(ctx->magnitude[bin] - ctx->reference[bin]);
+        if (change > max_change)
+        {
+            max_change = change;
+            max_bin = bin;
+        }
+    }
+
+    memcpy(ctx->reference, ctx->magnitude, sizeof(ctx->reference));
+    ctx->reference_ms = time_ms;
+
+    if (max_change > config->macro_threshold)
+    {
+        if (++ctx->confirmations > config->macro_movement_confirmations)
+        {
+            ctx->macro_valid = true;
+            ctx->last_macro_ms = time_ms;
+            ctx->macro_bin = max_bin;
+        }
+    }
+    else
+    {
+        ctx->confirmations = 0;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: update_slow_time
+ *******************************************************************************
+ * Summary:
+ *   Appends the complex range bins of a frame to the slow-time history,
+ *   averaging MODEL_MICRO_DECIMATION frames per sample when decimation is
+ *   enabled, which extends the observation window for slow breathing.
+ *
+ * Parameters:
+ *   ctx: model context
+ *
+ * Return:
+ *   true if a slow-time sample was appended
+ ******************************************************************************/
+static bool update_slow_time(xensiv_radar_presence_handle_t ctx)
+{
+    const xensiv_radar_presence_config_t *config = &ctx->config;
+    int32_t decimation = config->micro_fft_decimation_enabled ? MODEL_MICRO_DECIMATION : 1;
+
+    for (int32_t bin = config->min_range_bin; bin <= config->max_range_bin; ++bin)
+    {
+        /* CMSIS packs the real parts of DC and Nyquist into bin 0 */
+        float32_t re = (bin == 0) ? ctx->fft_out[0] : ctx->fft_out[2 * bin];
+        float32_t im = (bin == 0) ? 0.0f : ctx->fft_out[(2 * bin) + 1];
+
+        ctx->decimation_sum[2 * bin] += re;
+        ctx->decimation_sum[(2 * bin) + 1] += im;
+    }
+
+    if (++ctx->decimation_count < decimation)
+    {
+        return false;
+    }
+
+    for (int32_t bin = config->min_range_bin; bin <= config->max_range_bin; ++bin)
+    {
+        ctx->slow_time[bin][2 * ctx->slow_time_pos] = ctx->decimation_sum[2 * bin] / (float32_t)decimation;
+        ctx->slow_time[bin][(2 * ctx->slow_time_pos) + 1] = ctx->decimation_sum[(2 * bin) + 1] / (float32_t)decimation;
+    }
+
+    memset(ctx->decimation_sum, 0, sizeof(ctx->decimation_sum));
+    ctx->decimation_count = 0;
+    ctx->slow_time_pos = (ctx->slow_time_pos + 1) % config->micro_fft_size;
+    if (ctx->slow_time_count < config->micro_fft_size)
+    {
+        ctx->slow_time_count++;
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: update_micro
+ *******************************************************************************
+ * Summary:
+ *   Evaluates the slow-time spectrum of every range bin. Static reflectors
+ *   are removed with the mean; the energy up to the compare index is the
+ *   micro motion metric, e.g. breathing or typing.
+ *
+ * Parameters:
+ *   ctx: model context
+ *   time_ms: frame time
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void update_micro(xensiv_radar_presence_handle_t ctx, uint32_t time_ms)
+{
+    const xensiv_radar_presence_config_t *config = &ctx->config;
+    int32_t size = config->micro_fft_size;
+    float32_t max_metric = 0.0f;
+    int32_t max_bin = -1;
+
+    if ((ctx->slow_time_count < size) || (++ctx->samples_since_eval < MODEL_MICRO_EVAL_INTERVAL))
+    {
+        return;
+    }
+    ctx->samples_since_eval = 0;
+
+    for (int32_t bin = config->min_range_bin; bin <= config->max_range_bin; ++bin)
+    {
+        float32_t mean_re = 0.0f;
+        float32_t mean_im = 0.0f;
+        float32_t metric = 0.0f;
+
+        /* Oldest sample first */
+        for (int32_t i = 0; i < size; ++i)
+        {
+            int32_t src = (ctx->slow_time_pos + i) % size;
+            ctx->micro_buffer[2 * i] = ctx->slow_time[bin][2 * src];
+            ctx->micro_buffer[(2 * i) + 1] = ctx->slow_time[bin][(2 * src) + 1];
+            mean_re += ctx->micro_buffer[2 * i];
+            mean_im += ctx->micro_buffer[(2 * i) + 1];
+        }
+
+        mean_re /= (float32_t)size;
+        mean_im /= (float32_t)size;
+        for (int32_t i = 0; i < size; ++i)
+        {
+            ctx->micro_buffer[2 * i] -= mean_re;
+            ctx->micro_buffer[(2 * i) + 1] -= mean_im;
+        }
+
+        arm_cfft_f32(&ctx->cfft, ctx->micro_buffer, 0, 1);
+
+        /* Positive and negative Doppler up to the compare index */
+        for (int32_t k = 1; k <= config->micro_movement_compare_idx; ++k)
+        {
+            int32_t neg = size - k;
+            metric += sqrtf((ctx->micro_buffer[2 * k] * ctx->micro_buffer[2 * k]) +
+                            (ctx->micro_buffer[(2 * k) + 1] * ctx->micro_buffer[(2 * k) + 1]));
+            metric += sqrtf((ctx->micro_buffer[2 * neg] * ctx->micro_buffer[2 * neg]) +
+                            (ctx->micro_buffer[(2 * neg) + 1] * ctx->micro_buffer[(2 * neg) + 1]));
+        }
+        metric = (metric * MODEL_MICRO_GAIN) / ((float32_t)size * (float32_t)(2 * config->micro_movement_compare_idx));
+
+        if (metric > max_metric)
+        {
+            max_metric = metric;
+            max_bin = bin;
+        }
+    }
+
+    if (max_metric > config->micro_threshold)
+    {
+        ctx->micro_valid = true;
+        ctx->last_micro_ms = time_ms;
+        ctx->micro_bin = max_bin;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: update_state
+ *******************************************************************************
+ * Summary:
+ *   Derives the presence state from the detections that are still valid,
+ *   according to the mode, and reports changes.
+ *
+ * Parameters:
+ *   ctx: model context
+ *   time_ms: frame time
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void update_state(xensiv_radar_presence_handle_t ctx, uint32_t time_ms)
+{
+    const xensiv_radar_presence_config_t *config = &ctx->config;
+    xensiv_radar_presence_state_t state = XENSIV_RADAR_PRESENCE_STATE_ABSENCE;
+    int32_t range_bin = 0;
+
+    bool macro = ctx->macro_valid &&
+                 ((int32_t)(time_ms - ctx->last_macro_ms) < config->macro_movement_validity_ms);
+    bool micro = ctx->micro_valid &&
+                 ((int32_t)(time_ms - ctx->last_micro_ms) < config->micro_movement_validity_ms);
+
+    switch (config->mode)
+    {
+        case XENSIV_RADAR_PRESENCE_MODE_MACRO_ONLY:
+            micro = false;
+            break;
+
+        case XENSIV_RADAR_PRESENCE_MODE_MICRO_ONLY:
+            macro = false;
+            break;
+
+        case XENSIV_RADAR_PRESENCE_MODE_MICRO_IF_MACRO:
+            /* Micro motion only holds a presence started by macro motion */
+            micro = micro && (ctx->state != XENSIV_RADAR_PRESENCE_STATE_ABSENCE);
+            break;
+
+        case XENSIV_RADAR_PRESENCE_MODE_MICRO_AND_MACRO:
+        default:
+            break;
+    }
+
+    if (macro)
+    {
+        state = XENSIV_RADAR_PRESENCE_STATE_MACRO_PRESENCE;
+        range_bin = ctx->macro_bin;
+    }
+    else if (micro)
+    {
+        state = XENSIV_RADAR_PRESENCE_STATE_MICRO_PRESENCE;
+        range_bin = ctx->micro_bin;
+    }
+
+    if (state != ctx->state)
+    {
+        ctx->state = state;
+
+        if (ctx->callback != NULL)
+        {
+            xensiv_radar_presence_event_t event =
+            {
+                .timestamp = time_ms,
+                .state = state,
+                .range_bin = range_bin
+            };
+            ctx->callback(ctx, &event, ctx->callback_data);
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: xensiv_radar_presence_set_malloc_free
+ ******************************************************************************/
+void xensiv_radar_presence_set_malloc_free(void *(*malloc_func)(size_t size),
+                                           void (*free_func)(void *ptr))
+{
+    model_malloc = malloc_func;
+    model_free = free_func;
+}
+
+/*******************************************************************************
+ * Function Name: xensiv_radar_presence_alloc
+ *******************************************************************************
+ * Summary:
+ *   Allocates a model context with the registered allocator.
+ *
+ * Parameters:
+ *   handle: set to the new context
+ *   config: initial configuration
+ *
+ * Return:
+ *   XENSIV_RADAR_PRESENCE_OK, or an error code
+ ******************************************************************************/
+xensiv_radar_presence_status_t xensiv_radar_presence_alloc(xensiv_radar_presence_handle_t *handle,
+                                                           const xensiv_radar_presence_config_t *config)
+{
+    xensiv_radar_presence_handle_t ctx;
+    xensiv_radar_presence_status_t status;
+
+    if ((model_malloc == NULL) || !check_config(config))
+    {
+        return XENSIV_RADAR_PRESENCE_CONFIG_ERROR;
+    }
+
+    ctx = model_malloc(sizeof(*ctx));
+    if (ctx == NULL)
+    {
+        return XENSIV_RADAR_PRESENCE_MEM_ERROR;
+    }
+
+    memset(ctx, 0, sizeof(*ctx));
+    status = apply_config(ctx, config);
+    if (status != XENSIV_RADAR_PRESENCE_OK)
+    {
+        model_free(ctx);
+        return status;
+    }
+
+    *handle = ctx;
+    return XENSIV_RADAR_PRESENCE_OK;
+}
+
+/*******************************************************************************
+ * Function Name: xensiv_radar_presence_free
+ ******************************************************************************/
+void xensiv_radar_presence_free(xensiv_radar_presence_handle_t handle)
+{
+    if ((handle != NULL) && (model_free != NULL))
+    {
+        model_free(handle);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: xensiv_radar_presence_set_callback
+ ******************************************************************************/
+void xensiv_radar_presence_set_callback(xensiv_radar_presence_handle_t handle,
+                                        xensiv_radar_presence_cb_t callback,
+                                        void *data)
+{
+    handle->callback = callback;
+    handle->callback_data = data;
+}
+
+/*******************************************************************************
+ * Function Name: xensiv_radar_presence_process_frame
+ *******************************************************************************
+ * Summary:
+ *   Processes one frame and reports state changes through the callback.
+ *
+ * Parameters:
+ *   handle: model context
+ *   frame: samples of the frame, normalized to [0, 1)
+ *   time_ms: capture time of the frame
+ *
+ * Return:
+ *   XENSIV_RADAR_PRESENCE_OK
+ ******************************************************************************/
+xensiv_radar_presence_status_t xensiv_radar_presence_process_frame(xensiv_radar_presence_handle_t handle,
+                                                                   float32_t *frame,
+                                                                   uint32_t time_ms)
+{
+    const xensiv_radar_presence_config_t *config = &handle->config;
+    bool evaluate_micro;
+
+    range_fft(handle, frame);
+
+    for (int32_t bin = config->min_range_bin; bin <= config->max_range_bin; ++bin)
+    {
+        float32_t re = (bin == 0) ? handle->fft_out[0] : handle->fft_out[2 * bin];
+        float32_t im = (bin == 0) ? 0.0f : handle->fft_out[(2 * bin) + 1];
+        handle->magnitude[bin] = sqrtf((re * re) + (im * im));
+    }
+
+    if (config->mode != XENSIV_RADAR_PRESENCE_MODE_MICRO_ONLY)
+    {
+        update_macro(handle, time_ms);
+    }
+
+    /* Like the library, skip the micro motion FFTs while they cannot change
+     * the state.
+     */
+    evaluate_micro = (config->mode == XENSIV_RADAR_PRESENCE_MODE_MICRO_ONLY) ||
+                     (config->mode == XENSIV_RADAR_PRESENCE_MODE_MICRO_AND_MACRO) ||
+                     ((config->mode == XENSIV_RADAR_PRESENCE_MODE_MICRO_IF_MACRO) &&
+                      (handle->state != XENSIV_RADAR_PRESENCE_STATE_ABSENCE));
+
+    if (config->mode != XENSIV_RADAR_PRESENCE_MODE_MACRO_ONLY)
+    {
+        if (update_slow_time(handle) && evaluate_micro)
+        {
+            update_micro(handle, time_ms);
+        }
+    }
+
+    update_state(handle, time_ms);
+    return XENSIV_RADAR_PRESENCE_OK;
+}
+
+/*******************************************************************************
+ * Function Name: xensiv_radar_presence_get_config
+ ******************************************************************************/
+xensiv_radar_presence_status_t xensiv_radar_presence_get_config(const xensiv_radar_presence_handle_t handle,
+                                                                xensiv_radar_presence_config_t *config)
+{
+    *config = handle->config;
+    return XENSIV_RADAR_PRESENCE_OK;
+}
+
+/*******************************************************************************
+ * Function Name: xensiv_radar_presence_set_config
+ *******************************************************************************
+ * Summary:
+ *   Applies a new configuration; the detection state is cleared.
+ *
+ * Parameters:
+ *   handle: model context
+ *   config: new configuration
+ *
+ * Return:
+ *   XENSIV_RADAR_PRESENCE_OK, or an error for an unsupported configuration
+ ******************************************************************************/
+xensiv_radar_presence_status_t xensiv_radar_presence_set_config(xensiv_radar_presence_handle_t handle,
+                                                                const xensiv_radar_presence_config_t *config)
+{
+    if (!check_config(config))
+    {
+        return XENSIV_RADAR_PRESENCE_CONFIG_ERROR;
+    }
+
+    return apply_config(handle, config);
+}
+
+/*******************************************************************************
+ * Function Name: xensiv_radar_presence_get_bin_length
+ ******************************************************************************/
+float32_t xensiv_radar_presence_get_bin_length(const xensiv_radar_presence_handle_t handle)
+{
+    return MODEL_SPEED_OF_LIGHT / (2.0f * handle->config.bandwidth);
+}
+
+/*******************************************************************************
+ * Function Name: xensiv_radar_presence_reset
+ *******************************************************************************
+ * Summary:
+ *   Clears the history and the detections. The state returns to absence
+ *   without an event.
+ *
+ * Parameters:
+ *   handle: model context
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void xensiv_radar_presence_reset(xensiv_radar_presence_handle_t handle)
+{
+    handle->has_reference = false;
+    handle->confirmations = 0;
+    memset(handle->decimation_sum, 0, sizeof(handle->decimation_sum));
+    handle->decimation_count = 0;
+    handle->slow_time_pos = 0;
+    handle->slow_time_count = 0;
+    handle->samples_since_eval = 0;
+    handle->macro_valid = false;
+    handle->micro_valid = false;
+    handle->state = XENSIV_RADAR_PRESENCE_STATE_ABSENCE;
+}
+
+/* [] END OF FILE */
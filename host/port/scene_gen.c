@@ -0,0 +1,352 @@
+/******************************************************************************
+ * File Name:   scene_gen.c
+ *
+ * Description: Host build: synthetic radar scenes for the simulated sensor. The
+ *              IF signal of a target at range R is a tone of R / bin_length cycles
+ *              per chirp, with a phase of 4 pi R / lambda that follows sub-millimeter
+ *              motion such as breathing.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <math.h>
+#include <string.h>
+
+/* Header file includes */
+#include "radar_settings.h"
+#include "scene_gen.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define SCENE_SPEED_OF_LIGHT        (299792458.0f)
+#define SCENE_CENTER_FREQ_HZ        ((XENSIV_BGT60TRXX_CONF_LOWER_FREQ_HZ + XENSIV_BGT60TRXX_CONF_UPPER_FREQ_HZ) / 2.0f)
+#define SCENE_WAVELENGTH_M          (SCENE_SPEED_OF_LIGHT / SCENE_CENTER_FREQ_HZ)
+
+#define SCENE_ADC_MID               (2048.0f)
+#define SCENE_ADC_MAX               (4095.0f)
+#define SCENE_NOISE_RMS             (6.0f)
+
+/* Transmitter leakage at the lowest IF frequencies */
+#define SCENE_LEAKAGE_AMPLITUDE     (150.0f)
+#define SCENE_LEAKAGE_CYCLES        (0.4f)
+
+/* Person echo amplitude at 1 m, falling with the square of the range */
+#define SCENE_PERSON_AMPLITUDE      (400.0f)
+#define SCENE_PERSON_MIN_RANGE_M    (0.5f)
+
+#define SCENE_BREATHING_HZ          (0.25f)
+#define SCENE_BREATHING_M           (0.003f)
+#define SCENE_WALK_SPEED_M_S        (0.8f)
+#define SCENE_SEAT_RANGE_M          (1.0f)
+#define SCENE_DOOR_RANGE_M          (3.0f)
+#define SCENE_CYCLE_MS              (60000u)
+#define SCENE_PULSE_MS              (10000u)
+#define SCENE_PULSE_WALK_MS         (2500u)
+
+#define SCENE_PI                    (3.14159265f)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    float range_m;
+    float amplitude;
+} reflector_t;
+
+/* Static clutter: a wall and a piece of furniture */
+static const reflector_t clutter[] =
+{
+    { 3.5f, 60.0f },
+    { 2.2f, 40.0f },
+};
+
+static const char *const scene_names[] =
+{
+    [SCENE_EMPTY] = "empty",
+    [SCENE_WALK]  = "walk",
+    [SCENE_SIT]   = "sit",
+    [SCENE_CYCLE] = "cycle",
+    [SCENE_PULSE] = "pulse",
+};
+
+/*******************************************************************************
+ * Function Name: next_random
+ *******************************************************************************
+ * Summary:
+ *   xorshift32 generator, so scenes are reproducible for a given seed.
+ ******************************************************************************/
+static uint32_t next_random(scene_gen_t *gen)
+{
+    uint32_t x = gen->random_state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    gen->random_state = x;
+    return x;
+}
+
+/*******************************************************************************
+ * Function Name: next_noise
+ *******************************************************************************
+ * Summary:
+ *   Gaussian noise with the Box-Muller transform.
+ ******************************************************************************/
+static float next_noise(scene_gen_t *gen)
+{
+    float u1;
+    float u2;
+    float radius;
+
+    if (gen->has_spare_noise)
+    {
+        gen->has_spare_noise = false;
+        return gen->spare_noise;
+    }
+
+    u1 = ((float)(next_random(gen) >> 8) + 1.0f) / 16777217.0f;
+    u2 = (float)(next_random(gen) >> 8) / 16777216.0f;
+    radius = sqrtf(-2.0f * logf(u1)) * SCENE_NOISE_RMS;
+
+    gen->spare_noise = radius * sinf(2.0f * SCENE_PI * u2);
+    gen->has_spare_noise = true;
+    return radius * cosf(2.0f * SCENE_PI * u2);
+}
+
+/*******************************************************************************
+ * Function Name: walk_range
+ *******************************************************************************
+ * Summary:
+ *   Range of a person walking between two ranges at constant speed.
+ *
+ * Parameters:
+ *   from_m, to_m: start and end range
+ *   elapsed_ms: time since the walk started
+ *
+ * Return:
+ *   Range in meters
+ ******************************************************************************/
+static float walk_range(float from_m, float to_m, uint32_t elapsed_ms)
+{
+    float distance = SCENE_WALK_SPEED_M_S * ((float)elapsed_ms / 1000.0f);
+    float span = fabsf(to_m - from_m);
+
+    if (distance > span)
+    {
+        distance = span;
+    }
+
+    return (to_m > from_m) ? (from_m + distance) : (from_m - distance);
+}
+
+/*******************************************************************************
+ * Function Name: scene_gen_init
+ *******************************************************************************
+ * Summary:
+ *   Selects a scene by name.
+ *
+ * Parameters:
+ *   gen: generator state
+ *   name: "empty", "walk", "sit", "cycle" or "pulse"; NULL selects "cycle"
+ *   seed: noise seed
+ *
+ * Return:
+ *   0 on success, -1 for an unknown scene
+ ******************************************************************************/
+int scene_gen_init(scene_gen_t *gen, const char *name, uint32_t seed)
+{
+    memset(gen, 0, sizeof(*gen));
+    gen->scene = SCENE_CYCLE;
+    gen->random_state = (seed != 0u) ? seed : 1u;
+
+    if (name == NULL)
+    {
+        return 0;
+    }
+
+    for (uint32_t i = 0; i < (sizeof(scene_names) / sizeof(scene_names[0])); ++i)
+    {
+        if (strcmp(name, scene_names[i]) == 0)
+        {
+            gen->scene = (scene_t)i;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+/*******************************************************************************
+ * Function Name: scene_gen_name
+ ******************************************************************************/
+const char *scene_gen_name(scene_t scene)
+{
+    return scene_names[scene];
+}
+
+/*******************************************************************************
+ * Function Name: scene_gen_truth
+ *******************************************************************************
+ * Summary:
+ *   Returns what a perfect detector reports at a point in time, for
+ *   comparison with the presence output.
+ *
+ * Parameters:
+ *   gen: generator state
+ *   time_ms: scene time
+ *   range_m: set to the range of the person, if present (may be NULL)
+ *
+ * Return:
+ *   Ground truth at that time
+ ******************************************************************************/
+scene_truth_t scene_gen_truth(const scene_gen_t *gen, uint32_t time_ms, float *range_m)
+{
+    scene_truth_t truth = SCENE_TRUTH_ABSENT;
+    float range = 0.0f;
+
+    switch (gen->scene)
+    {
+        case SCENE_WALK:
+        {
+            /* Back and forth between the seat and the door */
+            uint32_t leg_ms = (uint32_t)(1000.0f * (SCENE_DOOR_RANGE_M - SCENE_SEAT_RANGE_M) / SCENE_WALK_SPEED_M_S);
+            uint32_t phase = time_ms % (2u * leg_ms);
+            range = (phase < leg_ms) ? walk_range(SCENE_DOOR_RANGE_M, SCENE_SEAT_RANGE_M, phase)
+                                     : walk_range(SCENE_SEAT_RANGE_M, SCENE_DOOR_RANGE_M, phase - leg_ms);
+            truth = SCENE_TRUTH_MACRO;
+            break;
+        }
+
+        case SCENE_SIT:
+            range = SCENE_SEAT_RANGE_M;
+            truth = SCENE_TRUTH_MICRO;
+            break;
+
+        case SCENE_CYCLE:
+        {
+            /* 0-10 s empty, 10-13 s enter, 13-43 s sit, 43-46 s leave, then empty */
+            uint32_t t = time_ms % SCENE_CYCLE_MS;
+            if ((t >= 10000u) && (t < 13000u))
+            {
+                range = walk_range(SCENE_DOOR_RANGE_M, SCENE_SEAT_RANGE_M, t - 10000u);
+                truth = SCENE_TRUTH_MACRO;
+            }
+            else if ((t >= 13000u) && (t < 43000u))
+            {
+                range = SCENE_SEAT_RANGE_M;
+                truth = SCENE_TRUTH_MICRO;
+            }
+            else if ((t >= 43000u) && (t < 46000u))
+            {
+                range = walk_range(SCENE_SEAT_RANGE_M, SCENE_DOOR_RANGE_M, t - 43000u);
+                truth = SCENE_TRUTH_MACRO;
+            }
+            break;
+        }
+
+        case SCENE_PULSE:
+        {
+            /* Many presence events in a short time, for latency measurements */
+            uint32_t t = time_ms % SCENE_PULSE_MS;
+            if (t < SCENE_PULSE_WALK_MS)
+            {
+                range = walk_range(SCENE_DOOR_RANGE_M, SCENE_SEAT_RANGE_M, t);
+                truth = SCENE_TRUTH_MACRO;
+            }
+            break;
+        }
+
+        case SCENE_EMPTY:
+        default:
+            break;
+    }
+
+    if (range_m != NULL)
+    {
+        *range_m = range;
+    }
+
+    return truth;
+}
+
+/*******************************************************************************
+ * Function Name: scene_gen_frame
+ *******************************************************************************
+ * Summary:
+ *   Generates the raw ADC samples of one frame.
+ *
+ * Parameters:
+ *   gen: generator state
+ *   time_ms: scene time of the frame
+ *   frame: RADAR_SETTINGS_NUM_SAMPLES_PER_FRAME samples
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void scene_gen_frame(scene_gen_t *gen, uint32_t time_ms, uint16_t *frame)
+{
+    const uint32_t samples = XENSIV_BGT60TRXX_CONF_NUM_SAMPLES_PER_CHIRP;
+    float person_range;
+    scene_truth_t truth = scene_gen_truth(gen, time_ms, &person_range);
+    float person_amplitude = 0.0f;
+
+    if (truth != SCENE_TRUTH_ABSENT)
+    {
+        float r = (person_range > SCENE_PERSON_MIN_RANGE_M) ? person_range : SCENE_PERSON_MIN_RANGE_M;
+
+        /* Chest motion of a breathing person */
+        person_range += SCENE_BREATHING_M * sinf(2.0f * SCENE_PI * SCENE_BREATHING_HZ * ((float)time_ms / 1000.0f));
+        person_amplitude = SCENE_PERSON_AMPLITUDE / (r * r);
+    }
+
+    for (uint32_t chirp = 0; chirp < (RADAR_SETTINGS_NUM_SAMPLES_PER_FRAME / samples); ++chirp)
+    {
+        for (uint32_t n = 0; n < samples; ++n)
+        {
+            float t = (float)n / (float)samples;
+            float value = SCENE_ADC_MID + next_noise(gen);
+
+            value += SCENE_LEAKAGE_AMPLITUDE * cosf(2.0f * SCENE_PI * SCENE_LEAKAGE_CYCLES * t);
+
+            for (uint32_t i = 0; i < (sizeof(clutter) / sizeof(clutter[0])); ++i)
+            {
+                float cycles = clutter[i].range_m / RADAR_SETTINGS_RANGE_BIN_LENGTH_M;
+                float phase = 4.0f * SCENE_PI * clutter[i].range_m / SCENE_WAVELENGTH_M;
+                value += clutter[i].amplitude * cosf((2.0f * SCENE_PI * cycles * t) + phase);
+            }
+
+            if (person_amplitude > 0.0f)
+            {
+                float cycles = person_range / RADAR_SETTINGS_RANGE_BIN_LENGTH_M;
+                float phase = fmodf(4.0f * SCENE_PI * person_range / SCENE_WAVELENGTH_M, 2.0f * SCENE_PI);
+                value += person_amplitude * cosf((2.0f * SCENE_PI * cycles * t) + phase);
+            }
+
+            value = (value < 0.0f) ? 0.0f : ((value > SCENE_ADC_MAX) ? SCENE_ADC_MAX : value);
+            frame[(chirp * samples) + n] = (uint16_t)(value + 0.5f);
+        }
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,69 @@
+/******************************************************************************
+ * File Name:   scene_gen.h
+ *
+ * Description: Host build: synthetic radar scenes for the simulated sensor.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef SCENE_GEN_H_
+#define SCENE_GEN_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef enum
+{
+    SCENE_EMPTY,        /* Static clutter only */
+    SCENE_WALK,         /* A person walking back and forth */
+    SCENE_SIT,          /* A person sitting still, breathing */
+    SCENE_CYCLE,        /* Empty, enter, sit, leave, repeated every minute */
+    SCENE_PULSE         /* Short walk in, then empty, every 10 s */
+} scene_t;
+
+typedef enum
+{
+    SCENE_TRUTH_ABSENT,
+    SCENE_TRUTH_MACRO,  /* The person is moving */
+    SCENE_TRUTH_MICRO   /* The person is present but still */
+} scene_truth_t;
+
+typedef struct
+{
+    scene_t scene;
+    uint32_t random_state;
+    float spare_noise;
+    bool has_spare_noise;
+} scene_gen_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+int scene_gen_init(scene_gen_t *gen, const char *name, uint32_t seed);
+const char *scene_gen_name(scene_t scene);
+scene_truth_t scene_gen_truth(const scene_gen_t *gen, uint32_t time_ms, float *range_m);
+void scene_gen_frame(scene_gen_t *gen, uint32_t time_ms, uint16_t *frame);
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,533 @@
+/******************************************************************************
+ * File Name:   sim_broker.c
+ *
+ * Description: Host build: in-process MQTT broker stand-in. Every publish is
+ *              logged on the standard output and delivered to matching subscriptions
+ *              from the broker task. Lines read from the standard input are
+ *              published too: 'topic<TAB>payload', or a bare JSON object which goes to
+ *              the configuration topic.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <ctype.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Header file includes */
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "semphr.h"
+#include "task.h"
+
+#include "latency_bench.h"
+#include "latency_trace.h"
+#include "mqtt_client_config.h"
+#include "net_fault.h"
+#include "sim_broker.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define SIM_BROKER_DELIVERY_QUEUE_LENGTH    (8u)
+#define SIM_BROKER_INPUT_LINES              (8u)
+#define SIM_BROKER_LINE_LENGTH              (SIM_BROKER_MAX_TOPIC_LENGTH + 1024u)
+
+/* Payload bytes shown for binary messages */
+#define SIM_BROKER_HEX_PREVIEW              (16u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    void *client;
+    sim_broker_deliver_t deliver;
+    uint16_t topic_len;
+    char topic[SIM_BROKER_MAX_TOPIC_LENGTH];
+} subscription_t;
+
+typedef struct
+{
+    uint16_t topic_len;
+    char topic[SIM_BROKER_MAX_TOPIC_LENGTH];
+    size_t payload_len;
+    uint8_t payload[];
+} message_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static subscription_t subscriptions[SIM_BROKER_MAX_SUBSCRIPTIONS];
+static SemaphoreHandle_t subscriptions_mutex;
+static QueueHandle_t delivery_q;
+static bool quiet;
+
+/* Lines read by the input thread. The thread is not a FreeRTOS task, so it
+ * only shares this buffer under a POSIX mutex; the broker task polls it.
+ */
+static pthread_mutex_t input_mutex = PTHREAD_MUTEX_INITIALIZER;
+static char input_lines[SIM_BROKER_INPUT_LINES][SIM_BROKER_LINE_LENGTH];
+static uint32_t input_head;
+static uint32_t input_tail;
+
+/*******************************************************************************
+ * Function Name: topic_matches
+ *******************************************************************************
+ * Summary:
+ *   Matches a topic against a subscription filter with the MQTT '+' and '#'
+ *   wildcards.
+ *
+ * Parameters:
+ *   filter, filter_len: subscription filter
+ *   topic, topic_len: topic of the published message
+ *
+ * Return:
+ *   true if the topic matches
+ ******************************************************************************/
+static bool topic_matches(const char *filter, uint16_t filter_len, const char *topic, uint16_t topic_len)
+{
+    uint16_t f = 0;
+    uint16_t t = 0;
+
+    while (f < filter_len)
+    {
+        if (filter[f] == '#')
+        {
+            return true;
+        }
+        else if (filter[f] == '+')
+        {
+            while ((t < topic_len) && (topic[t] != '/'))
+            {
+                t++;
+            }
+            f++;
+        }
+        else if ((t < topic_len) && (filter[f] == topic[t]))
+        {
+            f++;
+            t++;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return (t == topic_len);
+}
+
+/*******************************************************************************
+ * Function Name: log_message
+ *******************************************************************************
+ * Summary:
+ *   Prints a published message. Text payloads are printed as they are,
+ *   binary payloads as their size and first bytes.
+ *
+ * Parameters:
+ *   message: message to print
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void log_message(const message_t *message)
+{
+    bool printable = true;
+
+    if (quiet)
+    {
+        return;
+    }
+
+    for (size_t i = 0; (i < message->payload_len) && printable; ++i)
+    {
+        printable = isprint(message->payload[i]) || isspace(message->payload[i]);
+    }
+
+    if (printable)
+    {
+        printf("[broker] %.*s: %.*s\n", message->topic_len, message->topic,
+               (int)message->payload_len, (const char *)message->payload);
+    }
+    else
+    {
+        printf("[broker] %.*s: <%zu bytes>", message->topic_len, message->topic, message->payload_len);
+        for (size_t i = 0; (i < message->payload_len) && (i < SIM_BROKER_HEX_PREVIEW); ++i)
+        {
+            printf(" %02x", message->payload[i]);
+        }
+        printf("\n");
+    }
+}
+
+/*******************************************************************************
+ * Function Name: deliver
+ *******************************************************************************
+ * Summary:
+ *   Delivers a message to all matching subscriptions and frees it.
+ *
+ * Parameters:
+ *   message: message to deliver
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void deliver(message_t *message)
+{
+    subscription_t matched[SIM_BROKER_MAX_SUBSCRIPTIONS];
+    uint32_t count = 0;
+
+    /* Deliver outside the lock, the client may subscribe from its callback */
+    xSemaphoreTake(subscriptions_mutex, portMAX_DELAY);
+    for (uint32_t i = 0; i < SIM_BROKER_MAX_SUBSCRIPTIONS; ++i)
+    {
+        if ((subscriptions[i].client != NULL) &&
+            topic_matches(subscriptions[i].topic, subscriptions[i].topic_len, message->topic, message->topic_len))
+        {
+            matched[count++] = subscriptions[i];
+        }
+    }
+    xSemaphoreGive(subscriptions_mutex);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        matched[i].deliver(matched[i].client, message->topic, message->topic_len,
+                           message->payload, message->payload_len);
+    }
+
+    vPortFree(message);
+}
+
+/*******************************************************************************
+ * Function Name: create_message
+ ******************************************************************************/
+static message_t *create_message(const char *topic, uint16_t topic_len, const void *payload, size_t payload_len)
+{
+    message_t *message;
+
+    if ((topic_len > SIM_BROKER_MAX_TOPIC_LENGTH) || (payload_len > SIM_BROKER_MAX_PAYLOAD_LENGTH))
+    {
+        return NULL;
+    }
+
+    message = pvPortMalloc(sizeof(message_t) + payload_len);
+    if (message != NULL)
+    {
+        message->topic_len = topic_len;
+        memcpy(message->topic, topic, topic_len);
+        message->payload_len = payload_len;
+        memcpy(message->payload, payload, payload_len);
+    }
+
+    return message;
+}
+
+/*******************************************************************************
+ * Function Name: input_thread
+ *******************************************************************************
+ * Summary:
+ *   Reads lines from the standard input. Blocking reads are not allowed in
+ *   tasks of the POSIX port, so this runs in a plain thread with the
+ *   scheduler signals blocked.
+ *
+ * Parameters:
+ *   arg: unused
+ *
+ * Return:
+ *   NULL
+ ******************************************************************************/
+static void *input_thread(void *arg)
+{
+    char line[SIM_BROKER_LINE_LENGTH];
+    sigset_t signals;
+
+    (void)arg;
+
+    sigfillset(&signals);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+    while (fgets(line, sizeof(line), stdin) != NULL)
+    {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0')
+        {
+            continue;
+        }
+
+        pthread_mutex_lock(&input_mutex);
+        if ((input_head - input_tail) < SIM_BROKER_INPUT_LINES)
+        {
+            strcpy(input_lines[input_head % SIM_BROKER_INPUT_LINES], line);
+            input_head++;
+        }
+        else
+        {
+            fprintf(stderr, "[broker] input dropped, too many pending lines\n");
+        }
+        pthread_mutex_unlock(&input_mutex);
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+ * Function Name: poll_input
+ *******************************************************************************
+ * Summary:
+ *   Publishes the lines read by the input thread.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void poll_input(void)
+{
+    char line[SIM_BROKER_LINE_LENGTH];
+
+    for (;;)
+    {
+        bool available;
+
+        pthread_mutex_lock(&input_mutex);
+        available = (input_head != input_tail);
+        if (available)
+        {
+            strcpy(line, input_lines[input_tail % SIM_BROKER_INPUT_LINES]);
+            input_tail++;
+        }
+        pthread_mutex_unlock(&input_mutex);
+
+        if (!available)
+        {
+            return;
+        }
+
+        char *separator = strchr(line, '\t');
+        if (line[0] == '{')
+        {
+            sim_broker_publish(MQTT_SUB_TOPIC, sizeof(MQTT_SUB_TOPIC) - 1, line, strlen(line));
+        }
+        else if (separator != NULL)
+        {
+            sim_broker_publish(line, (uint16_t)(separator - line), separator + 1, strlen(separator + 1));
+        }
+        else
+        {
+            fprintf(stderr, "[broker] expected 'topic<TAB>payload' or a JSON object\n");
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: broker_task
+ *******************************************************************************
+ * Summary:
+ *   Delivers published messages and polls the standard input. Delivery runs
+ *   in this task, like the receive path of the MQTT library on the target.
+ *
+ * Parameters:
+ *   pvParameters: unused
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void broker_task(void *pvParameters)
+{
+    message_t *message;
+
+    (void)pvParameters;
+
+    for (;;)
+    {
+        if (xQueueReceive(delivery_q, &message, pdMS_TO_TICKS(SIM_BROKER_POLL_MS)) == pdTRUE)
+        {
+            deliver(message);
+        }
+
+        poll_input();
+    }
+}
+
+/*******************************************************************************
+ * Function Name: sim_broker_start
+ *******************************************************************************
+ * Summary:
+ *   Starts the broker task and the input thread on the first connection.
+ *   Set PRESENCE_SIM_BROKER_QUIET=1 to stop logging published messages.
+ *   In builds with LATENCY_TRACE_ENABLE, also starts the latency benchmark.
+ *   With PRESENCE_FAULT_SCRIPT set, starts the fault injection.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void sim_broker_start(void)
+{
+    pthread_t thread;
+    const char *quiet_env = getenv("PRESENCE_SIM_BROKER_QUIET");
+
+    if (delivery_q != NULL)
+    {
+        return;
+    }
+
+    quiet = (quiet_env != NULL) && (strcmp(quiet_env, "1") == 0);
+    subscriptions_mutex = xSemaphoreCreateMutex();
+    delivery_q = xQueueCreate(SIM_BROKER_DELIVERY_QUEUE_LENGTH, sizeof(message_t *));
+    configASSERT((subscriptions_mutex != NULL) && (delivery_q != NULL));
+
+    xTaskCreate(broker_task, "Sim broker", SIM_BROKER_TASK_STACK_SIZE, NULL, SIM_BROKER_TASK_PRIORITY, NULL);
+
+#if LATENCY_TRACE_ENABLE
+    latency_bench_start();
+#endif
+    net_fault_start();
+
+    if (pthread_create(&thread, NULL, input_thread, NULL) == 0)
+    {
+        pthread_detach(thread);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: sim_broker_subscribe
+ *******************************************************************************
+ * Summary:
+ *   Adds a subscription of a client.
+ *
+ * Parameters:
+ *   client: subscribing client
+ *   topic, topic_len: topic filter
+ *   deliver: delivery function of the client
+ *
+ * Return:
+ *   0 on success, -1 if the subscription table is full
+ ******************************************************************************/
+int sim_broker_subscribe(void *client, const char *topic, uint16_t topic_len, sim_broker_deliver_t deliver)
+{
+    int result = -1;
+
+    if (topic_len > SIM_BROKER_MAX_TOPIC_LENGTH)
+    {
+        return -1;
+    }
+
+    xSemaphoreTake(subscriptions_mutex, portMAX_DELAY);
+    for (uint32_t i = 0; i < SIM_BROKER_MAX_SUBSCRIPTIONS; ++i)
+    {
+        if (subscriptions[i].client == NULL)
+        {
+            subscriptions[i].client = client;
+            subscriptions[i].deliver = deliver;
+            subscriptions[i].topic_len = topic_len;
+            memcpy(subscriptions[i].topic, topic, topic_len);
+            result = 0;
+            break;
+        }
+    }
+    xSemaphoreGive(subscriptions_mutex);
+
+    return result;
+}
+
+/*******************************************************************************
+ * Function Name: sim_broker_unsubscribe
+ ******************************************************************************/
+void sim_broker_unsubscribe(void *client, const char *topic, uint16_t topic_len)
+{
+    xSemaphoreTake(subscriptions_mutex, portMAX_DELAY);
+    for (uint32_t i = 0; i < SIM_BROKER_MAX_SUBSCRIPTIONS; ++i)
+    {
+        if ((subscriptions[i].client == client) && (subscriptions[i].topic_len == topic_len) &&
+            (memcmp(subscriptions[i].topic, topic, topic_len) == 0))
+        {
+            subscriptions[i].client = NULL;
+        }
+    }
+    xSemaphoreGive(subscriptions_mutex);
+}
+
+/*******************************************************************************
+ * Function Name: sim_broker_unsubscribe_all
+ ******************************************************************************/
+void sim_broker_unsubscribe_all(void *client)
+{
+    if (subscriptions_mutex == NULL)
+    {
+        return;
+    }
+
+    xSemaphoreTake(subscriptions_mutex, portMAX_DELAY);
+    for (uint32_t i = 0; i < SIM_BROKER_MAX_SUBSCRIPTIONS; ++i)
+    {
+        if (subscriptions[i].client == client)
+        {
+            subscriptions[i].client = NULL;
+        }
+    }
+    xSemaphoreGive(subscriptions_mutex);
+}
+
+/*******************************************************************************
+ * Function Name: sim_broker_publish
+ *******************************************************************************
+ * Summary:
+ *   Logs a message and queues it for delivery to the subscribers. The
+ *   payload is copied, the caller may reuse its buffer on return.
+ *
+ * Parameters:
+ *   topic, topic_len: topic of the message
+ *   payload, payload_len: message payload
+ *
+ * Return:
+ *   0 on success, -1 if the message is too large or the broker is busy
+ ******************************************************************************/
+int sim_broker_publish(const char *topic, uint16_t topic_len, const void *payload, size_t payload_len)
+{
+    message_t *message = create_message(topic, topic_len, payload, payload_len);
+
+    if (message == NULL)
+    {
+        return -1;
+    }
+
+    log_message(message);
+
+    if (xQueueSendToBack(delivery_q, &message, 0) != pdTRUE)
+    {
+        vPortFree(message);
+        return -1;
+    }
+
+    return 0;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,63 @@
+/******************************************************************************
+ * File Name:   sim_broker.h
+ *
+ * Description: Host build: in-process MQTT broker stand-in.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef SIM_BROKER_H_
+#define SIM_BROKER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define SIM_BROKER_MAX_SUBSCRIPTIONS    (8u)
+#define SIM_BROKER_MAX_TOPIC_LENGTH     (64u)
+#define SIM_BROKER_MAX_PAYLOAD_LENGTH   (2048u)
+
+/* Interval at which the broker task polls the standard input */
+#define SIM_BROKER_POLL_MS              (10u)
+
+#define SIM_BROKER_TASK_PRIORITY        (4)
+#define SIM_BROKER_TASK_STACK_SIZE      (1024 * 4)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+/* Delivers a message to a subscribed client, called from the broker task */
+typedef void (*sim_broker_deliver_t)(void *client, const char *topic, uint16_t topic_len,
+                                     const uint8_t *payload, size_t payload_len);
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+void sim_broker_start(void);
+int sim_broker_subscribe(void *client, const char *topic, uint16_t topic_len, sim_broker_deliver_t deliver);
+void sim_broker_unsubscribe(void *client, const char *topic, uint16_t topic_len);
+void sim_broker_unsubscribe_all(void *client);
+int sim_broker_publish(const char *topic, uint16_t topic_len, const void *payload, size_t payload_len);
+
+#endif
+/* [] END OF FILE */
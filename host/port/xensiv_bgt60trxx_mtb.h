@@ -0,0 +1,87 @@
+/******************************************************************************
+ * File Name:   xensiv_bgt60trxx_mtb.h
+ *
+ * Description: Host build: interface of the XENSIV BGT60TRxx driver, implemented
+ *              by the simulated sensor in bgt60_sim.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef XENSIV_BGT60TRXX_MTB_H_
+#define XENSIV_BGT60TRXX_MTB_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "cyhal.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define XENSIV_BGT60TRXX_STATUS_OK              (0)
+#define XENSIV_BGT60TRXX_STATUS_COM_ERROR       (1)
+#define XENSIV_BGT60TRXX_STATUS_TIMEOUT_ERROR   (2)
+#define XENSIV_BGT60TRXX_STATUS_GSR0_ERROR      (3)
+#define XENSIV_BGT60TRXX_STATUS_DEV_ERROR       (4)
+
+#define XENSIV_BGT60TRXX_RSLT_ERROR             ((cy_rslt_t)0x04030001U)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef enum
+{
+    XENSIV_BGT60TRXX_RESET_SW = 0x000002,
+    XENSIV_BGT60TRXX_RESET_FSM = 0x000004,
+    XENSIV_BGT60TRXX_RESET_FIFO = 0x000008
+} xensiv_bgt60trxx_reset_t;
+
+typedef struct
+{
+    uint32_t fifo_limit;
+} xensiv_bgt60trxx_t;
+
+typedef struct
+{
+    xensiv_bgt60trxx_t dev;
+} xensiv_bgt60trxx_mtb_t;
+
+typedef void (*cyhal_gpio_event_callback_t)(void *callback_arg, cyhal_gpio_event_t event);
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+cy_rslt_t xensiv_bgt60trxx_mtb_init(xensiv_bgt60trxx_mtb_t *obj, cyhal_spi_t *spi,
+                                    cyhal_gpio_t selpin, cyhal_gpio_t rstpin,
+                                    const uint32_t *regs, uint32_t len);
+cy_rslt_t xensiv_bgt60trxx_mtb_interrupt_init(xensiv_bgt60trxx_mtb_t *obj, uint16_t fifo_limit,
+                                              cyhal_gpio_t intpin, uint8_t intr_priority,
+                                              cyhal_gpio_event_callback_t callback,
+                                              void *callback_arg);
+
+int32_t xensiv_bgt60trxx_config(const xensiv_bgt60trxx_t *dev, const uint32_t *regs, uint32_t len);
+int32_t xensiv_bgt60trxx_start_frame(const xensiv_bgt60trxx_t *dev, bool start);
+int32_t xensiv_bgt60trxx_soft_reset(const xensiv_bgt60trxx_t *dev, xensiv_bgt60trxx_reset_t reset_type);
+int32_t xensiv_bgt60trxx_set_fifo_limit(const xensiv_bgt60trxx_t *dev, uint32_t num_samples);
+int32_t xensiv_bgt60trxx_get_fifo_data(const xensiv_bgt60trxx_t *dev, uint16_t *data, uint32_t num_samples);
+
+#endif
+/* [] END OF FILE */
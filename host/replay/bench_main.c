@@ -0,0 +1,436 @@
+/******************************************************************************
+ * File Name:   bench_main.c
+ *
+ * Description: Host build: detection quality benchmark. Replays a corpus of
+ *              labeled recordings in parallel and reports detection latency,
+ *              false alarms, missed presence and processing cost as JSON.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <getopt.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Header file includes */
+#include "presence_score.h"
+#include "radar_replay.h"
+#include "radar_settings.h"
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    const char *path;
+    int status;
+    radar_replay_stats_t stats;
+    presence_score_t score;
+} bench_result_t;
+
+typedef struct
+{
+    bench_result_t *results;
+    uint32_t count;
+    uint32_t next;
+} bench_queue_t;
+
+typedef struct
+{
+    double max_false_alarms_per_hour;
+    double max_latency_ms;
+    double max_missed_ratio;
+} bench_limits_t;
+
+/*******************************************************************************
+ * Function Name: on_event
+ ******************************************************************************/
+static void on_event(const xensiv_radar_presence_event_t *event, void *data)
+{
+    presence_score_event(&((bench_result_t *)data)->score, event);
+}
+
+/*******************************************************************************
+ * Function Name: on_frame
+ ******************************************************************************/
+static void on_frame(uint32_t index, uint32_t timestamp_ms, bool processed, uint32_t cycles, void *data)
+{
+    (void)index;
+    (void)processed;
+    (void)cycles;
+
+    presence_score_frame(&((bench_result_t *)data)->score, timestamp_ms);
+}
+
+/*******************************************************************************
+ * Function Name: score_recording
+ *******************************************************************************
+ * Summary:
+ *   Replays one recording as fast as possible with the default
+ *   configuration and scores the presence events against its labels.
+ *
+ * Parameters:
+ *   result: result of the recording, with 'path' set
+ *
+ * Return:
+ *   none, result->status is 0 on success
+ ******************************************************************************/
+static void score_recording(bench_result_t *result)
+{
+    radar_recording_t rec;
+    radar_replay_options_t options =
+    {
+        .config = NULL,
+        .speed = 0.0f,
+        .event_cb = on_event,
+        .frame_cb = on_frame,
+        .data = result
+    };
+
+    result->status = radar_recording_open(&rec, result->path);
+    if (result->status != 0)
+    {
+        return;
+    }
+
+    presence_score_init(&result->score, &rec);
+    result->status = radar_replay_run(&rec, &options, &result->stats);
+    presence_score_finish(&result->score);
+
+    radar_recording_close(&rec);
+}
+
+/*******************************************************************************
+ * Function Name: worker
+ *******************************************************************************
+ * Summary:
+ *   Takes recordings from the queue until it is empty. Each recording is
+ *   replayed by one worker, with its own presence context.
+ ******************************************************************************/
+static void *worker(void *arg)
+{
+    bench_queue_t *queue = (bench_queue_t *)arg;
+    uint32_t index;
+
+    while ((index = __atomic_fetch_add(&queue->next, 1u, __ATOMIC_RELAXED)) < queue->count)
+    {
+        score_recording(&queue->results[index]);
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+ * Function Name: print_string
+ ******************************************************************************/
+static void print_string(FILE *out, const char *text)
+{
+    fputc('"', out);
+    for (; *text != '\0'; ++text)
+    {
+        if ((*text == '"') || (*text == '\\'))
+        {
+            fputc('\\', out);
+            fputc(*text, out);
+        }
+        else if ((unsigned char)*text < 0x20u)
+        {
+            fprintf(out, "\\u%04x", (unsigned)*text);
+        }
+        else
+        {
+            fputc(*text, out);
+        }
+    }
+    fputc('"', out);
+}
+
+/*******************************************************************************
+ * Function Name: print_metrics
+ *******************************************************************************
+ * Summary:
+ *   Writes the metrics of one recording or of the total as JSON members.
+ ******************************************************************************/
+static void print_metrics(FILE *out, const bench_result_t *r, const char *indent)
+{
+    const presence_score_t *score = &r->score;
+    double cycles_mean = (r->stats.frames > 0u) ? ((double)r->stats.cycles_total / r->stats.frames) : 0.0;
+
+    fprintf(out, "%s\"frames\": %" PRIu32 ",\n", indent, r->stats.frames);
+    fprintf(out, "%s\"dropped_frames\": %" PRIu32 ",\n", indent, r->stats.dropped_frames);
+    fprintf(out, "%s\"recorded_s\": %.3f,\n", indent, r->stats.recorded_ms / 1000.0);
+    fprintf(out, "%s\"replay_s\": %.3f,\n", indent, r->stats.wall_s);
+    fprintf(out, "%s\"entries\": %" PRIu32 ",\n", indent, score->entries);
+    fprintf(out, "%s\"missed_entries\": %" PRIu32 ",\n", indent, score->missed_entries);
+    fprintf(out, "%s\"latency_ms_mean\": %.1f,\n", indent, presence_score_latency_ms(score));
+    fprintf(out, "%s\"latency_ms_max\": %" PRIu32 ",\n", indent, score->latency_max_ms);
+    fprintf(out, "%s\"effective_latency_ms\": %.1f,\n", indent, presence_score_effective_latency_ms(score));
+    fprintf(out, "%s\"false_alarms\": %" PRIu32 ",\n", indent, score->false_alarms);
+    fprintf(out, "%s\"false_alarms_per_hour\": %.3f,\n", indent, presence_score_false_alarms_per_hour(score));
+    fprintf(out, "%s\"absence_s\": %.3f,\n", indent, (double)score->absence_us / 1e6);
+    fprintf(out, "%s\"presence_s\": %.3f,\n", indent, (double)score->presence_us / 1e6);
+    fprintf(out, "%s\"missed_presence_s\": %.3f,\n", indent, (double)score->missed_presence_us / 1e6);
+    fprintf(out, "%s\"cycles_per_frame_mean\": %.0f,\n", indent, cycles_mean);
+    fprintf(out, "%s\"cycles_per_frame_max\": %" PRIu32 ",\n", indent, r->stats.cycles_max);
+    fprintf(out, "%s\"frame_budget_percent\": %.3f\n", indent,
+            (100.0 * cycles_mean) / RADAR_SETTINGS_FRAME_BUDGET_CYCLES);
+}
+
+/*******************************************************************************
+ * Function Name: accumulate
+ ******************************************************************************/
+static void accumulate(bench_result_t *total, const bench_result_t *r)
+{
+    total->stats.frames += r->stats.frames;
+    total->stats.dropped_frames += r->stats.dropped_frames;
+    total->stats.recorded_ms += r->stats.recorded_ms;
+    total->stats.wall_s += r->stats.wall_s;
+    total->stats.cycles_total += r->stats.cycles_total;
+    if (r->stats.cycles_max > total->stats.cycles_max)
+    {
+        total->stats.cycles_max = r->stats.cycles_max;
+    }
+    presence_score_add(&total->score, &r->score);
+}
+
+/*******************************************************************************
+ * Function Name: check_limits
+ *******************************************************************************
+ * Summary:
+ *   Compares the corpus total with the regression limits given on the
+ *   command line; negative limits are not checked.
+ *
+ * Return:
+ *   true if all limits are met
+ ******************************************************************************/
+static bool check_limits(const bench_result_t *total, const bench_limits_t *limits)
+{
+    double false_alarm_rate = presence_score_false_alarms_per_hour(&total->score);
+    double latency_ms = presence_score_latency_ms(&total->score);
+    double missed_ratio = presence_score_missed_ratio(&total->score);
+    bool ok = true;
+
+    if ((limits->max_false_alarms_per_hour >= 0.0) && (false_alarm_rate > limits->max_false_alarms_per_hour))
+    {
+        fprintf(stderr, "false alarms %.3f/h exceed %.3f/h\n", false_alarm_rate, limits->max_false_alarms_per_hour);
+        ok = false;
+    }
+
+    if ((limits->max_latency_ms >= 0.0) && (latency_ms > limits->max_latency_ms))
+    {
+        fprintf(stderr, "mean detection latency %.1f ms exceeds %.1f ms\n", latency_ms, limits->max_latency_ms);
+        ok = false;
+    }
+
+    if ((limits->max_missed_ratio >= 0.0) && (missed_ratio > limits->max_missed_ratio))
+    {
+        fprintf(stderr, "missed presence %.4f exceeds %.4f of the presence time\n", missed_ratio, limits->max_missed_ratio);
+        ok = false;
+    }
+
+    return ok;
+}
+
+/*******************************************************************************
+ * Function Name: usage
+ ******************************************************************************/
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s [-j N] [-o results.json] [limits] recording...\n"
+            "  -j N                        worker threads, default: number of CPUs\n"
+            "  -o FILE                     write the results to FILE instead of stdout\n"
+            "  --max-false-alarms-per-hour X\n"
+            "  --max-latency-ms X\n"
+            "  --max-missed-ratio X        fail (exit code 2) if the corpus total exceeds X\n",
+            name);
+}
+
+/*******************************************************************************
+ * Function Name: main
+ *******************************************************************************
+ * Summary:
+ *   Replays all recordings on a pool of worker threads and writes the
+ *   metrics per recording and for the corpus as JSON.
+ *
+ * Return:
+ *   0 on success, 1 if a recording failed, 2 if a limit was exceeded
+ ******************************************************************************/
+int main(int argc, char **argv)
+{
+    static const struct option long_options[] =
+    {
+        { "max-false-alarms-per-hour", required_argument, NULL, 'f' },
+        { "max-latency-ms", required_argument, NULL, 'l' },
+        { "max-missed-ratio", required_argument, NULL, 'm' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    bench_limits_t limits = { -1.0, -1.0, -1.0 };
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    const char *output = NULL;
+    bench_queue_t queue = { 0 };
+    bench_result_t total = { 0 };
+    pthread_t *workers;
+    struct timespec start;
+    struct timespec end;
+    FILE *out = stdout;
+    int result = 0;
+    int opt;
+
+    while ((opt = getopt_long(argc, argv, "j:o:h", long_options, NULL)) != -1)
+    {
+        switch (opt)
+        {
+            case 'j':
+                threads = strtol(optarg, NULL, 0);
+                break;
+
+            case 'o':
+                output = optarg;
+                break;
+
+            case 'f':
+                limits.max_false_alarms_per_hour = strtod(optarg, NULL);
+                break;
+
+            case 'l':
+                limits.max_latency_ms = strtod(optarg, NULL);
+                break;
+
+            case 'm':
+                limits.max_missed_ratio = strtod(optarg, NULL);
+                break;
+
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (optind >= argc)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    queue.count = (uint32_t)(argc - optind);
+    queue.results = calloc(queue.count, sizeof(*queue.results));
+    if (queue.results == NULL)
+    {
+        return 1;
+    }
+    for (uint32_t i = 0; i < queue.count; ++i)
+    {
+        queue.results[i].path = argv[optind + (int)i];
+    }
+
+    if (threads < 1)
+    {
+        threads = 1;
+    }
+    if ((uint32_t)threads > queue.count)
+    {
+        threads = (long)queue.count;
+    }
+
+    workers = calloc((size_t)threads, sizeof(*workers));
+    if (workers == NULL)
+    {
+        return 1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long i = 0; i < threads; ++i)
+    {
+        if (pthread_create(&workers[i], NULL, worker, &queue) != 0)
+        {
+            fprintf(stderr, "cannot create worker thread\n");
+            return 1;
+        }
+    }
+    for (long i = 0; i < threads; ++i)
+    {
+        pthread_join(workers[i], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    if (output != NULL)
+    {
+        out = fopen(output, "w");
+        if (out == NULL)
+        {
+            perror(output);
+            return 1;
+        }
+    }
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"profile_id\": \"0x%08lx\",\n", (unsigned long)RADAR_SETTINGS_PROFILE_ID);
+    fprintf(out, "  \"frame_budget_cycles\": %lu,\n", (unsigned long)RADAR_SETTINGS_FRAME_BUDGET_CYCLES);
+    fprintf(out, "  \"threads\": %ld,\n", threads);
+    fprintf(out, "  \"wall_s\": %.3f,\n",
+            (double)(end.tv_sec - start.tv_sec) + ((double)(end.tv_nsec - start.tv_nsec) * 1e-9));
+    fprintf(out, "  \"recordings\": [\n");
+    for (uint32_t i = 0; i < queue.count; ++i)
+    {
+        const bench_result_t *r = &queue.results[i];
+
+        fprintf(out, "    {\n      \"file\": ");
+        print_string(out, r->path);
+        fprintf(out, ",\n");
+        if (r->status != 0)
+        {
+            fprintf(out, "      \"error\": true\n");
+            result = 1;
+        }
+        else
+        {
+            print_metrics(out, r, "      ");
+            accumulate(&total, r);
+        }
+        fprintf(out, "    }%s\n", ((i + 1u) < queue.count) ? "," : "");
+    }
+    fprintf(out, "  ],\n  \"total\": {\n");
+    print_metrics(out, &total, "    ");
+    fprintf(out, "  }\n}\n");
+
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+
+    if ((result == 0) && !check_limits(&total, &limits))
+    {
+        result = 2;
+    }
+
+    free(workers);
+    free(queue.results);
+    return result;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,105 @@
+/******************************************************************************
+ * File Name:   dsp_bench_main.c
+ *
+ * Description: Host build: runs the DSP kernel microbenchmarks of source/dsp_bench.c
+ *              and writes the nanoseconds per sample of each case as JSON, for
+ *              scripts/dsp_bench_compare.py.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Header file includes */
+#include "dsp_bench.h"
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    FILE *out;
+    uint32_t count;
+} dsp_bench_output_t;
+
+/*******************************************************************************
+ * Function Name: write_result
+ ******************************************************************************/
+static void write_result(const dsp_bench_result_t *result, void *context)
+{
+    dsp_bench_output_t *output = context;
+
+    fprintf(output->out, "%s    {\"kernel\": \"%s\", \"variant\": \"%s\", \"n\": %" PRIu32 ", "
+            "\"per_sample\": %.4f, \"match\": %s}",
+            (output->count > 0u) ? ",\n" : "", result->kernel, result->variant, result->n,
+            (double)result->per_sample, result->match ? "true" : "false");
+    output->count++;
+
+    fprintf(stderr, "dsp_bench: %-8s %-7s %5" PRIu32 " %8.3f " DSP_BENCH_UNIT "/sample%s\n",
+            result->kernel, result->variant, result->n, (double)result->per_sample,
+            result->match ? "" : " mismatch");
+}
+
+/*******************************************************************************
+ * Function Name: main
+ *******************************************************************************
+ * Return:
+ *   0 on success, 1 on error or if a variant computes a different result
+ ******************************************************************************/
+int main(int argc, char **argv)
+{
+    dsp_bench_output_t output = { .out = stdout };
+    uint32_t mismatches;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "o:h")) != -1)
+    {
+        if (opt != 'o')
+        {
+            fprintf(stderr, "usage: %s [-o FILE]\n", argv[0]);
+            return 1;
+        }
+        output.out = fopen(optarg, "w");
+        if (output.out == NULL)
+        {
+            perror(optarg);
+            return 1;
+        }
+    }
+
+    fprintf(output.out, "{\n  \"unit\": \"" DSP_BENCH_UNIT "\",\n  \"repeats\": %u,\n  \"results\": [\n",
+            DSP_BENCH_REPEATS);
+    mismatches = dsp_bench_run(write_result, &output);
+    fprintf(output.out, "\n  ],\n  \"mismatches\": %" PRIu32 "\n}\n", mismatches);
+
+    if (output.out != stdout)
+    {
+        fclose(output.out);
+    }
+
+    return (mismatches == 0u) ? 0 : 1;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,120 @@
+/******************************************************************************
+ * File Name:   frame_cache.c
+ *
+ * Description: Host build: recordings converted once by the frame processing
+ *              of the radar task, shared read-only by the sweep workers.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Header file includes */
+#include "frame_cache.h"
+
+/*******************************************************************************
+ * Function Name: frame_cache_build
+ *******************************************************************************
+ * Summary:
+ *   Runs the frame check and conversion over all frames of a recording once.
+ *   The presence configuration does not affect this part of the pipeline,
+ *   so every configuration of a sweep starts from the same converted frames.
+ *
+ * Parameters:
+ *   cache: cache to build, freed with frame_cache_free()
+ *   path: recording file
+ *
+ * Return:
+ *   0 on success, -1 with a message on stderr otherwise
+ ******************************************************************************/
+int frame_cache_build(frame_cache_t *cache, const char *path)
+{
+    radar_pipeline_t *pipeline;
+    uint16_t raw[RADAR_PIPELINE_SAMPLES_PER_FRAME];
+
+    memset(cache, 0, sizeof(*cache));
+    cache->path = path;
+
+    if (radar_recording_open(&cache->rec, path) != 0)
+    {
+        return -1;
+    }
+
+    if (radar_recording_check_profile(&cache->rec) != 0)
+    {
+        frame_cache_free(cache);
+        return -1;
+    }
+
+    cache->num_frames = cache->rec.header->num_frames;
+    cache->timestamps = malloc(((size_t)cache->num_frames + 1u) * sizeof(*cache->timestamps));
+    cache->processed = malloc((size_t)cache->num_frames + 1u);
+    cache->frames = malloc(((size_t)cache->num_frames + 1u) * sizeof(float32_t) * RADAR_PIPELINE_SAMPLES_PER_FRAME);
+    pipeline = malloc(sizeof(*pipeline));
+    if ((cache->timestamps == NULL) || (cache->processed == NULL) || (cache->frames == NULL) || (pipeline == NULL))
+    {
+        fprintf(stderr, "%s: out of memory for %u frames\n", path, (unsigned)cache->num_frames);
+        free(pipeline);
+        frame_cache_free(cache);
+        return -1;
+    }
+
+    radar_pipeline_init(pipeline);
+
+    for (uint32_t i = 0; i < cache->num_frames; ++i)
+    {
+        const uint8_t *packed = radar_recording_frame(&cache->rec, i, &cache->timestamps[i]);
+        float32_t *frame;
+
+        radar_capture_unpack12(packed, raw, RADAR_PIPELINE_SAMPLES_PER_FRAME);
+        frame = radar_pipeline_preprocess(pipeline, raw);
+
+        cache->processed[i] = (frame != NULL);
+        if (frame != NULL)
+        {
+            memcpy(&cache->frames[(size_t)cache->num_processed * RADAR_PIPELINE_SAMPLES_PER_FRAME],
+                   frame, sizeof(float32_t) * RADAR_PIPELINE_SAMPLES_PER_FRAME);
+            cache->num_processed++;
+        }
+    }
+
+    free(pipeline);
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: frame_cache_free
+ ******************************************************************************/
+void frame_cache_free(frame_cache_t *cache)
+{
+    free(cache->timestamps);
+    free(cache->processed);
+    free(cache->frames);
+    radar_recording_close(&cache->rec);
+    cache->timestamps = NULL;
+    cache->processed = NULL;
+    cache->frames = NULL;
+}
+
+/* [] END OF FILE */
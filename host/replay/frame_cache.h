@@ -0,0 +1,62 @@
+/******************************************************************************
+ * File Name:   frame_cache.h
+ *
+ * Description: Host build: recordings converted once by the frame processing
+ *              of the radar task, shared read-only by the sweep workers.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef FRAME_CACHE_H_
+#define FRAME_CACHE_H_
+
+#include <stdint.h>
+
+#include "radar_pipeline.h"
+#include "radar_replay.h"
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    const char *path;
+    radar_recording_t rec;      /* Kept open for the labels */
+
+    uint32_t num_frames;
+    uint32_t *timestamps;       /* Capture time of every frame */
+    uint8_t *processed;         /* 0 for frames dropped by the frame check */
+
+    /* Converted frames passed to the presence algorithm, in order, with
+     * RADAR_PIPELINE_SAMPLES_PER_FRAME samples each
+     */
+    uint32_t num_processed;
+    float32_t *frames;
+} frame_cache_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+int frame_cache_build(frame_cache_t *cache, const char *path);
+void frame_cache_free(frame_cache_t *cache);
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,246 @@
+/******************************************************************************
+ * File Name:   presence_score.c
+ *
+ * Description: Host build: scoring of presence events against the ground truth
+ *              labels of a recording, shared by the benchmark and the sweep tool.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <string.h>
+
+/* Header file includes */
+#include "presence_score.h"
+
+/*******************************************************************************
+ * Function Name: is_present
+ ******************************************************************************/
+static bool is_present(xensiv_radar_presence_state_t state)
+{
+    return state != XENSIV_RADAR_PRESENCE_STATE_ABSENCE;
+}
+
+/*******************************************************************************
+ * Function Name: presence_score_init
+ ******************************************************************************/
+void presence_score_init(presence_score_t *score, const radar_recording_t *rec)
+{
+    memset(score, 0, sizeof(*score));
+    score->rec = rec;
+    score->state = XENSIV_RADAR_PRESENCE_STATE_ABSENCE;
+}
+
+/*******************************************************************************
+ * Function Name: presence_score_event
+ *******************************************************************************
+ * Summary:
+ *   Counts a detection in a room labeled empty as a false alarm.
+ *
+ * Parameters:
+ *   score: score of the recording
+ *   event: event reported by the presence algorithm
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void presence_score_event(presence_score_t *score, const xensiv_radar_presence_event_t *event)
+{
+    bool was_present = is_present(score->state);
+    radar_truth_t truth;
+
+    score->state = event->state;
+
+    if (!was_present && is_present(event->state) &&
+        (radar_recording_truth(score->rec, event->timestamp, &truth) == 0) &&
+        (truth == RADAR_TRUTH_ABSENCE))
+    {
+        score->false_alarms++;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: presence_score_frame
+ *******************************************************************************
+ * Summary:
+ *   Scores one frame against the ground truth, with the state after the
+ *   frame was processed. The detection latency runs from the start of a
+ *   presence label to the first frame with a presence state; an entry is
+ *   missed if the label ends first. Unlabeled time is not scored.
+ *
+ * Parameters:
+ *   score: score of the recording
+ *   timestamp_ms: capture time of the frame
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void presence_score_frame(presence_score_t *score, uint32_t timestamp_ms)
+{
+    uint32_t period_us = score->rec->header->frame_period_us;
+    bool labeled;
+    bool truth_present;
+    radar_truth_t truth;
+
+    labeled = (radar_recording_truth(score->rec, timestamp_ms, &truth) == 0);
+    truth_present = labeled && (truth != RADAR_TRUTH_ABSENCE);
+
+    if (score->entry_pending && !truth_present)
+    {
+        score->entry_pending = false;
+        score->missed_entries++;
+        score->missed_entry_ms += timestamp_ms - score->entry_start_ms;
+    }
+
+    if (truth_present && !score->truth_present)
+    {
+        score->entries++;
+        score->entry_pending = true;
+        score->entry_start_ms = timestamp_ms;
+    }
+    score->truth_present = truth_present;
+
+    if (score->entry_pending && is_present(score->state))
+    {
+        uint32_t latency_ms = timestamp_ms - score->entry_start_ms;
+
+        score->entry_pending = false;
+        score->latency_total_ms += latency_ms;
+        if (latency_ms > score->latency_max_ms)
+        {
+            score->latency_max_ms = latency_ms;
+        }
+    }
+
+    if (!labeled)
+    {
+        return;
+    }
+
+    if (truth_present)
+    {
+        score->presence_us += period_us;
+        if (!is_present(score->state))
+        {
+            score->missed_presence_us += period_us;
+        }
+    }
+    else
+    {
+        score->absence_us += period_us;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: presence_score_finish
+ *******************************************************************************
+ * Summary:
+ *   Counts a person still undetected at the end of the recording as missed.
+ *
+ * Parameters:
+ *   score: score of the recording
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void presence_score_finish(presence_score_t *score)
+{
+    if (score->entry_pending)
+    {
+        uint32_t last_ms = 0;
+
+        if (score->rec->header->num_frames > 0u)
+        {
+            (void)radar_recording_frame(score->rec, score->rec->header->num_frames - 1u, &last_ms);
+        }
+
+        score->entry_pending = false;
+        score->missed_entries++;
+        score->missed_entry_ms += last_ms - score->entry_start_ms;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: presence_score_add
+ ******************************************************************************/
+void presence_score_add(presence_score_t *total, const presence_score_t *score)
+{
+    total->entries += score->entries;
+    total->missed_entries += score->missed_entries;
+    total->latency_total_ms += score->latency_total_ms;
+    if (score->latency_max_ms > total->latency_max_ms)
+    {
+        total->latency_max_ms = score->latency_max_ms;
+    }
+    total->missed_entry_ms += score->missed_entry_ms;
+    total->false_alarms += score->false_alarms;
+    total->absence_us += score->absence_us;
+    total->presence_us += score->presence_us;
+    total->missed_presence_us += score->missed_presence_us;
+}
+
+/*******************************************************************************
+ * Function Name: presence_score_latency_ms
+ *******************************************************************************
+ * Summary:
+ *   Returns the mean detection latency of the detected entries.
+ ******************************************************************************/
+double presence_score_latency_ms(const presence_score_t *score)
+{
+    uint32_t detected = score->entries - score->missed_entries;
+
+    return (detected > 0u) ? ((double)score->latency_total_ms / detected) : 0.0;
+}
+
+/*******************************************************************************
+ * Function Name: presence_score_effective_latency_ms
+ *******************************************************************************
+ * Summary:
+ *   Returns the mean latency over all entries, where a missed entry counts
+ *   with its whole presence time. Unlike the mean latency of the detected
+ *   entries, it cannot be improved by missing the hard cases.
+ ******************************************************************************/
+double presence_score_effective_latency_ms(const presence_score_t *score)
+{
+    return (score->entries > 0u) ?
+           ((double)(score->latency_total_ms + score->missed_entry_ms) / score->entries) : 0.0;
+}
+
+/*******************************************************************************
+ * Function Name: presence_score_false_alarms_per_hour
+ ******************************************************************************/
+double presence_score_false_alarms_per_hour(const presence_score_t *score)
+{
+    double absence_h = (double)score->absence_us / 3.6e9;
+
+    return (absence_h > 0.0) ? (score->false_alarms / absence_h) : 0.0;
+}
+
+/*******************************************************************************
+ * Function Name: presence_score_missed_ratio
+ ******************************************************************************/
+double presence_score_missed_ratio(const presence_score_t *score)
+{
+    return (score->presence_us > 0u) ?
+           ((double)score->missed_presence_us / (double)score->presence_us) : 0.0;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,75 @@
+/******************************************************************************
+ * File Name:   presence_score.h
+ *
+ * Description: Host build: scoring of presence events against the ground truth
+ *              labels of a recording, shared by the benchmark and the sweep tool.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef PRESENCE_SCORE_H_
+#define PRESENCE_SCORE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "radar_replay.h"
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    /* Scoring state */
+    const radar_recording_t *rec;
+    xensiv_radar_presence_state_t state;
+    bool truth_present;
+    bool entry_pending;
+    uint32_t entry_start_ms;
+
+    /* Results */
+    uint32_t entries;
+    uint32_t missed_entries;
+    uint64_t latency_total_ms;
+    uint32_t latency_max_ms;
+    uint64_t missed_entry_ms;       /* Presence time of the missed entries */
+    uint32_t false_alarms;
+    uint64_t absence_us;
+    uint64_t presence_us;
+    uint64_t missed_presence_us;
+} presence_score_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+void presence_score_init(presence_score_t *score, const radar_recording_t *rec);
+void presence_score_event(presence_score_t *score, const xensiv_radar_presence_event_t *event);
+void presence_score_frame(presence_score_t *score, uint32_t timestamp_ms);
+void presence_score_finish(presence_score_t *score);
+void presence_score_add(presence_score_t *total, const presence_score_t *score);
+
+double presence_score_latency_ms(const presence_score_t *score);
+double presence_score_effective_latency_ms(const presence_score_t *score);
+double presence_score_false_alarms_per_hour(const presence_score_t *score);
+double presence_score_missed_ratio(const presence_score_t *score);
+
+#endif
+/* [] END OF FILE */
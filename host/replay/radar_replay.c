@@ -0,0 +1,409 @@
+/******************************************************************************
+ * File Name:   radar_replay.c
+ *
+ * Description: Host build: replay of recordings through the frame processing
+ *              of the radar task and the presence algorithm. Recordings are
+ *              memory-mapped and replayed with their recorded timestamps, as fast
+ *              as possible or paced to a multiple of real time.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Header file includes */
+#include "cycle_counter.h"
+#include "radar_pipeline.h"
+#include "radar_replay.h"
+#include "radar_settings.h"
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    const radar_replay_options_t *options;
+    radar_replay_stats_t *stats;
+} replay_context_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static pthread_once_t allocator_once = PTHREAD_ONCE_INIT;
+
+/*******************************************************************************
+ * Function Name: set_allocator
+ ******************************************************************************/
+static void set_allocator(void)
+{
+    xensiv_radar_presence_set_malloc_free(malloc, free);
+}
+
+/*******************************************************************************
+ * Function Name: radar_recording_open
+ *******************************************************************************
+ * Summary:
+ *   Maps a recording file into memory and checks its layout. The fields are
+ *   little-endian and used in place, which requires a little-endian host.
+ *
+ * Parameters:
+ *   rec: recording to open
+ *   path: file name
+ *
+ * Return:
+ *   0 on success, -1 with a message on stderr otherwise
+ ******************************************************************************/
+int radar_recording_open(radar_recording_t *rec, const char *path)
+{
+    struct stat st;
+    const radar_recording_header_t *header;
+    void *base;
+    int fd;
+
+    memset(rec, 0, sizeof(*rec));
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    if ((fstat(fd, &st) != 0) || ((size_t)st.st_size < sizeof(radar_recording_header_t)))
+    {
+        fprintf(stderr, "%s: not a recording\n", path);
+        close(fd);
+        return -1;
+    }
+
+    base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        fprintf(stderr, "%s: mmap failed: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    /* Frames are read once, in order */
+    (void)madvise(base, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    rec->base = base;
+    rec->size = (size_t)st.st_size;
+    header = (const radar_recording_header_t *)base;
+
+    if ((memcmp(header->magic, RADAR_RECORDING_MAGIC, sizeof(header->magic)) != 0) ||
+        (header->version != RADAR_RECORDING_VERSION) ||
+        (header->header_size < sizeof(radar_recording_header_t)) ||
+        (header->frame_record_size != RADAR_RECORDING_FRAME_SIZE(header->samples_per_frame)) ||
+        (((uint64_t)header->header_size + ((uint64_t)header->num_frames * header->frame_record_size)) > rec->size) ||
+        (((uint64_t)header->labels_offset + ((uint64_t)header->num_labels * sizeof(radar_recording_label_t))) > rec->size))
+    {
+        fprintf(stderr, "%s: invalid or truncated recording\n", path);
+        radar_recording_close(rec);
+        return -1;
+    }
+
+    rec->header = header;
+    rec->frames = rec->base + header->header_size;
+    rec->labels = (const radar_recording_label_t *)(rec->base + header->labels_offset);
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: radar_recording_close
+ ******************************************************************************/
+void radar_recording_close(radar_recording_t *rec)
+{
+    if (rec->base != NULL)
+    {
+        munmap((void *)rec->base, rec->size);
+    }
+    memset(rec, 0, sizeof(*rec));
+}
+
+/*******************************************************************************
+ * Function Name: radar_recording_frame
+ *******************************************************************************
+ * Summary:
+ *   Returns the packed samples and the capture time of one frame.
+ *
+ * Parameters:
+ *   rec: open recording
+ *   index: frame index, below header->num_frames
+ *   timestamp_ms: set to the capture time of the frame
+ *
+ * Return:
+ *   Packed samples of the frame
+ ******************************************************************************/
+const uint8_t *radar_recording_frame(const radar_recording_t *rec, uint32_t index, uint32_t *timestamp_ms)
+{
+    const uint8_t *record = rec->frames + ((size_t)index * rec->header->frame_record_size);
+
+    memcpy(timestamp_ms, record, sizeof(*timestamp_ms));
+    return record + sizeof(uint32_t);
+}
+
+/*******************************************************************************
+ * Function Name: radar_recording_truth
+ *******************************************************************************
+ * Summary:
+ *   Looks up the ground truth at a point in time.
+ *
+ * Parameters:
+ *   rec: open recording
+ *   time_ms: time to look up
+ *   truth: set to the label at time_ms
+ *
+ * Return:
+ *   0 if time_ms is labeled, -1 otherwise
+ ******************************************************************************/
+int radar_recording_truth(const radar_recording_t *rec, uint32_t time_ms, radar_truth_t *truth)
+{
+    uint32_t low = 0;
+    uint32_t high = rec->header->num_labels;
+
+    /* Last label starting at or before time_ms */
+    while (low < high)
+    {
+        uint32_t mid = low + ((high - low) / 2u);
+        if (rec->labels[mid].start_ms <= time_ms)
+        {
+            low = mid + 1u;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    if ((low == 0u) || (time_ms >= rec->labels[low - 1u].end_ms))
+    {
+        return -1;
+    }
+
+    *truth = (radar_truth_t)rec->labels[low - 1u].truth;
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: radar_recording_check_profile
+ *******************************************************************************
+ * Summary:
+ *   Checks that the frames of a recording match the radar profile the
+ *   pipeline is built for.
+ *
+ * Parameters:
+ *   rec: open recording
+ *
+ * Return:
+ *   0 if the profile matches, -1 with a message on stderr otherwise
+ ******************************************************************************/
+int radar_recording_check_profile(const radar_recording_t *rec)
+{
+    const radar_recording_header_t *header = rec->header;
+
+    if ((header->profile_id != RADAR_SETTINGS_PROFILE_ID) ||
+        (header->samples_per_frame != RADAR_PIPELINE_SAMPLES_PER_FRAME))
+    {
+        fprintf(stderr, "recording profile 0x%08x (%u samples) does not match radar_settings.h "
+                "profile 0x%08lx (%u samples)\n",
+                (unsigned)header->profile_id, (unsigned)header->samples_per_frame,
+                (unsigned long)RADAR_SETTINGS_PROFILE_ID, (unsigned)RADAR_PIPELINE_SAMPLES_PER_FRAME);
+        return -1;
+    }
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: presence_cb
+ ******************************************************************************/
+static void presence_cb(xensiv_radar_presence_handle_t handle,
+                        const xensiv_radar_presence_event_t *event,
+                        void *data)
+{
+    replay_context_t *ctx = (replay_context_t *)data;
+
+    (void)handle;
+
+    ctx->stats->events++;
+    if (ctx->options->event_cb != NULL)
+    {
+        ctx->options->event_cb(event, ctx->options->data);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: pace
+ *******************************************************************************
+ * Summary:
+ *   Sleeps until a frame is due when replaying at a multiple of real time.
+ *
+ * Parameters:
+ *   start: monotonic time at which the first frame was replayed
+ *   elapsed_ms: recorded time since the first frame
+ *   speed: replay speed relative to real time
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void pace(const struct timespec *start, uint32_t elapsed_ms, float speed)
+{
+    uint64_t offset_ns = (uint64_t)(((double)elapsed_ms * 1e6) / (double)speed);
+    struct timespec due =
+    {
+        .tv_sec = start->tv_sec + (time_t)(offset_ns / 1000000000ULL),
+        .tv_nsec = start->tv_nsec + (long)(offset_ns % 1000000000ULL)
+    };
+
+    if (due.tv_nsec >= 1000000000L)
+    {
+        due.tv_sec++;
+        due.tv_nsec -= 1000000000L;
+    }
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL) == EINTR)
+    {
+    }
+}
+
+/*******************************************************************************
+ * Function Name: radar_replay_run
+ *******************************************************************************
+ * Summary:
+ *   Replays all frames of a recording through radar_pipeline_preprocess()
+ *   and xensiv_radar_presence_process_frame(), the path of the radar task,
+ *   with a fresh presence context and the recorded timestamps. Replays of
+ *   different recordings can run in parallel threads.
+ *
+ * Parameters:
+ *   rec: open recording
+ *   options: configuration, pacing and callbacks
+ *   stats: set to the statistics of the replay
+ *
+ * Return:
+ *   0 on success, -1 with a message on stderr otherwise
+ ******************************************************************************/
+int radar_replay_run(const radar_recording_t *rec, const radar_replay_options_t *options,
+                     radar_replay_stats_t *stats)
+{
+    const radar_recording_header_t *header = rec->header;
+    const xensiv_radar_presence_config_t *config =
+        (options->config != NULL) ? options->config : &radar_pipeline_default_config;
+    replay_context_t ctx = { .options = options, .stats = stats };
+    xensiv_radar_presence_handle_t handle;
+    radar_pipeline_t *pipeline;
+    uint16_t raw[RADAR_PIPELINE_SAMPLES_PER_FRAME];
+    struct timespec start;
+    struct timespec end;
+    uint32_t first_ms = 0;
+    uint32_t timestamp_ms = 0;
+
+    memset(stats, 0, sizeof(*stats));
+
+    if (radar_recording_check_profile(rec) != 0)
+    {
+        return -1;
+    }
+
+    pthread_once(&allocator_once, set_allocator);
+    if (xensiv_radar_presence_alloc(&handle, config) != XENSIV_RADAR_PRESENCE_OK)
+    {
+        fprintf(stderr, "invalid presence configuration\n");
+        return -1;
+    }
+    xensiv_radar_presence_set_callback(handle, presence_cb, &ctx);
+
+    pipeline = malloc(sizeof(*pipeline));
+    if (pipeline == NULL)
+    {
+        xensiv_radar_presence_free(handle);
+        return -1;
+    }
+    radar_pipeline_init(pipeline);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (uint32_t index = 0; index < header->num_frames; ++index)
+    {
+        const uint8_t *packed = radar_recording_frame(rec, index, &timestamp_ms);
+        uint32_t cycles;
+        float32_t *frame;
+
+        if (index == 0u)
+        {
+            first_ms = timestamp_ms;
+        }
+        else if (options->speed > 0.0f)
+        {
+            pace(&start, timestamp_ms - first_ms, options->speed);
+        }
+
+        radar_capture_unpack12(packed, raw, RADAR_PIPELINE_SAMPLES_PER_FRAME);
+
+        cycles = cycle_counter_get();
+        frame = radar_pipeline_preprocess(pipeline, raw);
+        if (frame != NULL)
+        {
+            (void)xensiv_radar_presence_process_frame(handle, frame, timestamp_ms);
+        }
+        cycles = cycle_counter_get() - cycles;
+
+        stats->frames++;
+        stats->cycles_total += cycles;
+        if (cycles > stats->cycles_max)
+        {
+            stats->cycles_max = cycles;
+        }
+        if (frame == NULL)
+        {
+            stats->dropped_frames++;
+        }
+
+        if (options->frame_cb != NULL)
+        {
+            options->frame_cb(index, timestamp_ms, frame != NULL, cycles, options->data);
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (stats->frames > 0u)
+    {
+        stats->recorded_ms = (timestamp_ms - first_ms) + (header->frame_period_us / 1000u);
+    }
+    stats->wall_s = (double)(end.tv_sec - start.tv_sec) + ((double)(end.tv_nsec - start.tv_nsec) * 1e-9);
+
+    free(pipeline);
+    xensiv_radar_presence_free(handle);
+    return 0;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,100 @@
+/******************************************************************************
+ * File Name:   radar_replay.h
+ *
+ * Description: Host build: replay of recordings through the frame processing
+ *              of the radar task and the presence algorithm.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef RADAR_REPLAY_H_
+#define RADAR_REPLAY_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "radar_capture_format.h"
+#include "xensiv_radar_presence.h"
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+/* A recording file mapped into memory */
+typedef struct
+{
+    const uint8_t *base;
+    size_t size;
+    const radar_recording_header_t *header;
+    const uint8_t *frames;
+    const radar_recording_label_t *labels;
+} radar_recording_t;
+
+/* Called for every state change reported by the presence algorithm */
+typedef void (*radar_replay_event_cb_t)(const xensiv_radar_presence_event_t *event, void *data);
+
+/* Called after every frame; 'processed' is false for frames dropped by the
+ * frame check.
+ */
+typedef void (*radar_replay_frame_cb_t)(uint32_t index, uint32_t timestamp_ms, bool processed,
+                                        uint32_t cycles, void *data);
+
+typedef struct
+{
+    /* Presence configuration, NULL for the default of the radar task */
+    const xensiv_radar_presence_config_t *config;
+
+    /* Replay speed relative to real time, 0 to replay as fast as possible */
+    float speed;
+
+    radar_replay_event_cb_t event_cb;
+    radar_replay_frame_cb_t frame_cb;
+    void *data;
+} radar_replay_options_t;
+
+typedef struct
+{
+    uint32_t frames;
+    uint32_t dropped_frames;
+    uint32_t events;
+
+    /* Cost of the frame processing in cycles of RADAR_SETTINGS_CPU_CLOCK_HZ */
+    uint64_t cycles_total;
+    uint32_t cycles_max;
+
+    uint32_t recorded_ms;
+    double wall_s;
+} radar_replay_stats_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+int radar_recording_open(radar_recording_t *rec, const char *path);
+void radar_recording_close(radar_recording_t *rec);
+const uint8_t *radar_recording_frame(const radar_recording_t *rec, uint32_t index, uint32_t *timestamp_ms);
+int radar_recording_truth(const radar_recording_t *rec, uint32_t time_ms, radar_truth_t *truth);
+int radar_recording_check_profile(const radar_recording_t *rec);
+
+int radar_replay_run(const radar_recording_t *rec, const radar_replay_options_t *options,
+                     radar_replay_stats_t *stats);
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,174 @@
+/******************************************************************************
+ * File Name:   replay_main.c
+ *
+ * Description: Host build: command line tool replaying recordings through
+ *              the presence detection of the radar task.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Header file includes */
+#include "radar_replay.h"
+#include "radar_settings.h"
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static const char *truth_names[] = { "absence", "macro", "micro" };
+
+static const char *state_names[] =
+{
+    [XENSIV_RADAR_PRESENCE_STATE_MACRO_PRESENCE] = "macro presence",
+    [XENSIV_RADAR_PRESENCE_STATE_MICRO_PRESENCE] = "micro presence",
+    [XENSIV_RADAR_PRESENCE_STATE_ABSENCE] = "absence"
+};
+
+/*******************************************************************************
+ * Function Name: print_event
+ ******************************************************************************/
+static void print_event(const xensiv_radar_presence_event_t *event, void *data)
+{
+    const radar_recording_t *rec = (const radar_recording_t *)data;
+    radar_truth_t truth;
+
+    printf("%10" PRIu32 " ms  %-15s bin %2" PRIi32, event->timestamp,
+           state_names[event->state], event->range_bin);
+    if (radar_recording_truth(rec, event->timestamp, &truth) == 0)
+    {
+        printf("  (truth: %s)", truth_names[truth]);
+    }
+    printf("\n");
+}
+
+/*******************************************************************************
+ * Function Name: usage
+ ******************************************************************************/
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s [--realtime] [--speed X] [--quiet] recording...\n"
+            "  --realtime  pace the replay at the recorded frame rate\n"
+            "  --speed X   pace the replay at X times real time\n"
+            "  --quiet     print only the summary of each recording\n",
+            name);
+}
+
+/*******************************************************************************
+ * Function Name: main
+ *******************************************************************************
+ * Summary:
+ *   Replays each recording given on the command line and prints the
+ *   presence events and a summary with the replay speed and the processing
+ *   cost relative to the frame budget.
+ *
+ * Return:
+ *   0 if all recordings were replayed, 1 otherwise
+ ******************************************************************************/
+int main(int argc, char **argv)
+{
+    static const struct option long_options[] =
+    {
+        { "realtime", no_argument, NULL, 'r' },
+        { "speed", required_argument, NULL, 's' },
+        { "quiet", no_argument, NULL, 'q' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    radar_replay_options_t options = { 0 };
+    bool quiet = false;
+    int result = 0;
+    int opt;
+
+    while ((opt = getopt_long(argc, argv, "rs:qh", long_options, NULL)) != -1)
+    {
+        switch (opt)
+        {
+            case 'r':
+                options.speed = 1.0f;
+                break;
+
+            case 's':
+                options.speed = strtof(optarg, NULL);
+                break;
+
+            case 'q':
+                quiet = true;
+                break;
+
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (optind >= argc)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    for (int i = optind; i < argc; ++i)
+    {
+        radar_recording_t rec;
+        radar_replay_stats_t stats;
+
+        if (radar_recording_open(&rec, argv[i]) != 0)
+        {
+            result = 1;
+            continue;
+        }
+
+        printf("%s: %" PRIu32 " frames, %" PRIu32 " labels\n", argv[i],
+               rec.header->num_frames, rec.header->num_labels);
+
+        options.event_cb = quiet ? NULL : print_event;
+        options.data = &rec;
+
+        if (radar_replay_run(&rec, &options, &stats) != 0)
+        {
+            result = 1;
+        }
+        else
+        {
+            double cycles_mean = (stats.frames > 0u) ? ((double)stats.cycles_total / stats.frames) : 0.0;
+
+            printf("%s: replayed %.1f s in %.3f s (%.0fx), %" PRIu32 " events, %" PRIu32 " frames dropped\n",
+                   argv[i], stats.recorded_ms / 1000.0, stats.wall_s,
+                   (stats.wall_s > 0.0) ? ((stats.recorded_ms / 1000.0) / stats.wall_s) : 0.0,
+                   stats.events, stats.dropped_frames);
+            printf("%s: %.0f cycles per frame (max %" PRIu32 "), %.2f%% of the frame budget\n",
+                   argv[i], cycles_mean, stats.cycles_max,
+                   (100.0 * cycles_mean) / RADAR_SETTINGS_FRAME_BUDGET_CYCLES);
+        }
+
+        radar_recording_close(&rec);
+    }
+
+    return result;
+}
+
+/* [] END OF FILE */
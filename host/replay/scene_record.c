@@ -0,0 +1,246 @@
+/******************************************************************************
+ * File Name:   scene_record.c
+ *
+ * Description: Host build: command line tool writing a labeled recording of a
+ *              synthetic scene, for replays and benchmarks without hardware.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Header file includes */
+#include "radar_capture_format.h"
+#include "radar_settings.h"
+#include "scene_gen.h"
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    FILE *file;
+    radar_recording_label_t label;
+    uint32_t num_labels;
+    bool open;
+} label_writer_t;
+
+/*******************************************************************************
+ * Function Name: write_label
+ *******************************************************************************
+ * Summary:
+ *   Extends the open label while the truth does not change, and writes it
+ *   when the truth changes or the recording ends.
+ *
+ * Parameters:
+ *   writer: label writer
+ *   time_ms: start time of a frame
+ *   end_ms: end time of the frame
+ *   truth: ground truth of the frame
+ *   flush: true after the last frame
+ *
+ * Return:
+ *   0 on success, -1 on a write error
+ ******************************************************************************/
+static int write_label(label_writer_t *writer, uint32_t time_ms, uint32_t end_ms,
+                       radar_truth_t truth, bool flush)
+{
+    if (writer->open && !flush && (writer->label.truth == truth))
+    {
+        writer->label.end_ms = end_ms;
+        return 0;
+    }
+
+    if (writer->open)
+    {
+        if (fwrite(&writer->label, sizeof(writer->label), 1, writer->file) != 1)
+        {
+            return -1;
+        }
+        writer->num_labels++;
+        writer->open = false;
+    }
+
+    if (!flush)
+    {
+        memset(&writer->label, 0, sizeof(writer->label));
+        writer->label.start_ms = time_ms;
+        writer->label.end_ms = end_ms;
+        writer->label.truth = (uint8_t)truth;
+        writer->open = true;
+    }
+
+    return 0;
+}
+
+/*******************************************************************************
+ * Function Name: main
+ *******************************************************************************
+ * Summary:
+ *   Writes the frames of a synthetic scene followed by the ground truth
+ *   labels of the scene generator. The labels are collected in a temporary
+ *   file, because their number is only known at the end.
+ *
+ * Return:
+ *   0 on success, 1 otherwise
+ ******************************************************************************/
+int main(int argc, char **argv)
+{
+    static const struct option long_options[] =
+    {
+        { "scene", required_argument, NULL, 'n' },
+        { "seed", required_argument, NULL, 's' },
+        { "duration", required_argument, NULL, 'd' },
+        { NULL, 0, NULL, 0 }
+    };
+    static const radar_truth_t truth_map[] =
+    {
+        [SCENE_TRUTH_ABSENT] = RADAR_TRUTH_ABSENCE,
+        [SCENE_TRUTH_MACRO] = RADAR_TRUTH_MACRO_PRESENCE,
+        [SCENE_TRUTH_MICRO] = RADAR_TRUTH_MICRO_PRESENCE
+    };
+    const char *scene = "cycle";
+    uint32_t seed = 1;
+    double duration_s = 600.0;
+    radar_recording_header_t header;
+    label_writer_t labels = { 0 };
+    scene_gen_t gen;
+    uint16_t raw[RADAR_SETTINGS_NUM_SAMPLES_PER_FRAME];
+    uint8_t record[RADAR_RECORDING_FRAME_SIZE(RADAR_SETTINGS_NUM_SAMPLES_PER_FRAME)];
+    uint64_t time_us = 0;
+    FILE *out;
+    int opt;
+
+    while ((opt = getopt_long(argc, argv, "n:s:d:", long_options, NULL)) != -1)
+    {
+        switch (opt)
+        {
+            case 'n':
+                scene = optarg;
+                break;
+
+            case 's':
+                seed = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'd':
+                duration_s = strtod(optarg, NULL);
+                break;
+
+            default:
+                optind = argc;
+                break;
+        }
+    }
+
+    if ((optind != (argc - 1)) || (duration_s <= 0.0))
+    {
+        fprintf(stderr, "usage: %s [--scene empty|walk|sit|cycle|pulse] [--seed N] [--duration S] output\n", argv[0]);
+        return 1;
+    }
+
+    if (scene_gen_init(&gen, scene, seed) != 0)
+    {
+        fprintf(stderr, "unknown scene '%s'\n", scene);
+        return 1;
+    }
+
+    out = fopen(argv[optind], "wb");
+    labels.file = tmpfile();
+    if ((out == NULL) || (labels.file == NULL))
+    {
+        perror(argv[optind]);
+        return 1;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, RADAR_RECORDING_MAGIC, sizeof(header.magic));
+    header.version = RADAR_RECORDING_VERSION;
+    header.header_size = sizeof(header);
+    header.profile_id = RADAR_SETTINGS_PROFILE_ID;
+    header.frame_period_us = RADAR_SETTINGS_FRAME_PERIOD_US;
+    header.samples_per_frame = RADAR_SETTINGS_NUM_SAMPLES_PER_FRAME;
+    header.frame_record_size = sizeof(record);
+    header.num_frames = (uint32_t)((duration_s * 1e6) / RADAR_SETTINGS_FRAME_PERIOD_US);
+
+    /* The header is rewritten with the label count at the end */
+    fwrite(&header, sizeof(header), 1, out);
+
+    for (uint32_t i = 0; i < header.num_frames; ++i)
+    {
+        uint32_t time_ms = (uint32_t)(time_us / 1000u);
+        uint32_t end_ms = (uint32_t)((time_us + RADAR_SETTINGS_FRAME_PERIOD_US) / 1000u);
+
+        scene_gen_frame(&gen, time_ms, raw);
+        memcpy(record, &time_ms, sizeof(time_ms));
+        radar_capture_pack12(raw, &record[sizeof(time_ms)], RADAR_SETTINGS_NUM_SAMPLES_PER_FRAME);
+
+        if ((fwrite(record, sizeof(record), 1, out) != 1) ||
+            (write_label(&labels, time_ms, end_ms, truth_map[scene_gen_truth(&gen, time_ms, NULL)], false) != 0))
+        {
+            perror(argv[optind]);
+            return 1;
+        }
+
+        time_us += RADAR_SETTINGS_FRAME_PERIOD_US;
+    }
+
+    if (write_label(&labels, 0, 0, RADAR_TRUTH_ABSENCE, true) != 0)
+    {
+        perror("labels");
+        return 1;
+    }
+
+    header.num_labels = labels.num_labels;
+    header.labels_offset = (uint32_t)ftell(out);
+
+    rewind(labels.file);
+    for (uint32_t i = 0; i < labels.num_labels; ++i)
+    {
+        radar_recording_label_t label;
+
+        if ((fread(&label, sizeof(label), 1, labels.file) != 1) ||
+            (fwrite(&label, sizeof(label), 1, out) != 1))
+        {
+            perror(argv[optind]);
+            return 1;
+        }
+    }
+
+    rewind(out);
+    fwrite(&header, sizeof(header), 1, out);
+    if (fclose(out) != 0)
+    {
+        perror(argv[optind]);
+        return 1;
+    }
+    fclose(labels.file);
+
+    printf("%s: %s scene, %u frames, %u labels\n", argv[optind], scene_gen_name(gen.scene),
+           (unsigned)header.num_frames, (unsigned)header.num_labels);
+    return 0;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,870 @@
+/******************************************************************************
+ * File Name:   sweep_main.c
+ *
+ * Description: Host build: parameter sweep of the presence configuration.
+ *              Scores every configuration of a grid, or a random sample of it,
+ *              over a corpus of labeled recordings on a work-stealing thread
+ *              pool and reports the Pareto front of false alarms and detection
+ *              latency as JSON.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <getopt.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Header file includes */
+#include "frame_cache.h"
+#include "presence_score.h"
+#include "radar_config_task.h"
+#include "radar_pipeline.h"
+#include "radar_settings.h"
+#include "work_pool.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Largest grid evaluated without --random */
+#define SWEEP_DEFAULT_MAX_CONFIGS (20000u)
+
+/* Values of one parameter */
+#define SWEEP_MAX_VALUES          (64u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef enum
+{
+    SWEEP_PARAM_MACRO_THRESHOLD,
+    SWEEP_PARAM_MICRO_THRESHOLD,
+    SWEEP_PARAM_MAX_RANGE,
+    SWEEP_PARAM_MACRO_COMPARE_INTERVAL,
+    SWEEP_PARAM_MACRO_VALIDITY,
+    SWEEP_PARAM_MICRO_VALIDITY,
+    SWEEP_PARAM_MACRO_CONFIRMATIONS,
+    SWEEP_PARAM_MICRO_FFT_SIZE,
+    SWEEP_PARAM_MODE,
+    SWEEP_PARAM_BANDPASS,
+    SWEEP_PARAM_DECIMATION,
+    SWEEP_NUM_PARAMS
+} sweep_param_id_t;
+
+typedef struct
+{
+    const char *name;
+    double min;                 /* Accepted range of the values */
+    double max;
+    const char *const *names;   /* Symbolic values, NULL for numbers */
+    uint32_t num_names;
+} sweep_param_def_t;
+
+typedef struct
+{
+    uint32_t count;             /* 0 if the parameter is not swept */
+    double values[SWEEP_MAX_VALUES];
+} sweep_param_t;
+
+typedef struct
+{
+    uint64_t grid_index;
+    bool valid;                 /* Accepted by xensiv_radar_presence_alloc() */
+    presence_score_t score;     /* Total over the corpus */
+} sweep_result_t;
+
+typedef struct
+{
+    const sweep_param_t *params;
+    const frame_cache_t *caches;
+    uint32_t num_caches;
+    sweep_result_t *results;
+    presence_score_t *scores;   /* Per configuration and recording */
+    int8_t *status;
+    float32_t *scratch;         /* One frame per worker */
+} sweep_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+/* Same names as on the configuration topic, see radar_config_task.c */
+static const char *const mode_names[] =
+{
+    "macro_only", "micro_only", "micro_if_macro", "micro_and_macro"
+};
+
+static const char *const bool_names[] =
+{
+    "disable", "enable"
+};
+
+static const sweep_param_def_t param_defs[SWEEP_NUM_PARAMS] =
+{
+    [SWEEP_PARAM_MACRO_THRESHOLD]        = { "macro_threshold", MACRO_THRESHOLD_MIN_LIMIT, MACRO_THRESHOLD_MAX_LIMIT, NULL, 0 },
+    [SWEEP_PARAM_MICRO_THRESHOLD]        = { "micro_threshold", MICRO_THRESHOLD_MIN_LIMIT, MICRO_THRESHOLD_MAX_LIMIT, NULL, 0 },
+    [SWEEP_PARAM_MAX_RANGE]              = { "max_range", MAX_RANGE_MIN_LIMIT, MAX_RANGE_MAX_LIMIT, NULL, 0 },
+    [SWEEP_PARAM_MACRO_COMPARE_INTERVAL] = { "macro_compare_interval_ms", 10, 2000, NULL, 0 },
+    [SWEEP_PARAM_MACRO_VALIDITY]         = { "macro_validity_ms", 100, 60000, NULL, 0 },
+    [SWEEP_PARAM_MICRO_VALIDITY]         = { "micro_validity_ms", 100, 60000, NULL, 0 },
+    [SWEEP_PARAM_MACRO_CONFIRMATIONS]    = { "macro_confirmations", 0, 20, NULL, 0 },
+    [SWEEP_PARAM_MICRO_FFT_SIZE]         = { "micro_fft_size", 16, RADAR_PIPELINE_MICRO_FFT_SIZE, NULL, 0 },
+    [SWEEP_PARAM_MODE]                   = { "mode", 0, 3, mode_names, 4 },
+    [SWEEP_PARAM_BANDPASS]               = { "bandpass_filter", 0, 1, bool_names, 2 },
+    [SWEEP_PARAM_DECIMATION]             = { "decimation_filter", 0, 1, bool_names, 2 },
+};
+
+/*******************************************************************************
+ * Function Name: parse_value
+ ******************************************************************************/
+static bool parse_value(const sweep_param_def_t *def, const char *text, double *value)
+{
+    char *end;
+
+    for (uint32_t i = 0; i < def->num_names; ++i)
+    {
+        if (strcmp(text, def->names[i]) == 0)
+        {
+            *value = (double)i;
+            return true;
+        }
+    }
+
+    *value = strtod(text, &end);
+    return (end != text) && (*end == '\0');
+}
+
+/*******************************************************************************
+ * Function Name: add_value
+ ******************************************************************************/
+static bool add_value(const sweep_param_def_t *def, sweep_param_t *param, double value)
+{
+    /* Values outside of the limits would be rejected by the device */
+    if ((value < def->min - 1e-9) || (value > def->max + 1e-9))
+    {
+        fprintf(stderr, "%s: %g is outside of %g..%g\n", def->name, value, def->min, def->max);
+        return false;
+    }
+
+    if (param->count >= SWEEP_MAX_VALUES)
+    {
+        fprintf(stderr, "%s: more than %u values\n", def->name, SWEEP_MAX_VALUES);
+        return false;
+    }
+
+    param->values[param->count++] = value;
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: parse_param
+ *******************************************************************************
+ * Summary:
+ *   Parses "name=min:max:step" or "name=value,value,..." into the values of
+ *   a parameter.
+ *
+ * Return:
+ *   true on success, false with a message on stderr otherwise
+ ******************************************************************************/
+static bool parse_param(sweep_param_t *params, const char *arg)
+{
+    char text[256];
+    char *spec;
+    const sweep_param_def_t *def = NULL;
+    sweep_param_t *param = NULL;
+
+    if (strlen(arg) >= sizeof(text))
+    {
+        fprintf(stderr, "%s: too long\n", arg);
+        return false;
+    }
+    strcpy(text, arg);
+
+    spec = strchr(text, '=');
+    if (spec == NULL)
+    {
+        fprintf(stderr, "%s: expected name=min:max:step or name=value,...\n", arg);
+        return false;
+    }
+    *spec++ = '\0';
+
+    for (uint32_t i = 0; i < SWEEP_NUM_PARAMS; ++i)
+    {
+        if (strcmp(text, param_defs[i].name) == 0)
+        {
+            def = &param_defs[i];
+            param = &params[i];
+        }
+    }
+    if (def == NULL)
+    {
+        fprintf(stderr, "%s: unknown parameter\n", text);
+        return false;
+    }
+    param->count = 0;
+
+    if (strchr(spec, ':') != NULL)
+    {
+        double min;
+        double max;
+        double step;
+
+        if ((sscanf(spec, "%lf:%lf:%lf", &min, &max, &step) != 3) || (step <= 0.0) || (max < min))
+        {
+            fprintf(stderr, "%s: invalid range %s\n", def->name, spec);
+            return false;
+        }
+
+        /* Computed from the index so that rounding does not accumulate */
+        for (uint32_t i = 0; (min + (i * step)) <= (max + (step * 1e-6)); ++i)
+        {
+            if (!add_value(def, param, min + (i * step)))
+            {
+                return false;
+            }
+        }
+    }
+    else
+    {
+        for (char *save = NULL, *token = strtok_r(spec, ",", &save); token != NULL; token = strtok_r(NULL, ",", &save))
+        {
+            double value;
+
+            if (!parse_value(def, token, &value))
+            {
+                fprintf(stderr, "%s: invalid value %s\n", def->name, token);
+                return false;
+            }
+            if (!add_value(def, param, value))
+            {
+                return false;
+            }
+        }
+    }
+
+    return param->count > 0u;
+}
+
+/*******************************************************************************
+ * Function Name: grid_size
+ ******************************************************************************/
+static uint64_t grid_size(const sweep_param_t *params)
+{
+    uint64_t size = 1u;
+
+    for (uint32_t i = 0; i < SWEEP_NUM_PARAMS; ++i)
+    {
+        if (params[i].count > 0u)
+        {
+            size *= params[i].count;
+        }
+    }
+
+    return size;
+}
+
+/*******************************************************************************
+ * Function Name: grid_config
+ *******************************************************************************
+ * Summary:
+ *   Builds the configuration at an index of the grid. The index is a mixed
+ *   radix number with one digit per swept parameter; parameters that are not
+ *   swept keep the value of radar_pipeline_default_config.
+ ******************************************************************************/
+static void grid_config(const sweep_param_t *params, uint64_t index, xensiv_radar_presence_config_t *config)
+{
+    *config = radar_pipeline_default_config;
+
+    for (uint32_t i = 0; i < SWEEP_NUM_PARAMS; ++i)
+    {
+        double value;
+
+        if (params[i].count == 0u)
+        {
+            continue;
+        }
+        value = params[i].values[index % params[i].count];
+        index /= params[i].count;
+
+        switch ((sweep_param_id_t)i)
+        {
+            case SWEEP_PARAM_MACRO_THRESHOLD:
+                config->macro_threshold = (float32_t)value;
+                break;
+
+            case SWEEP_PARAM_MICRO_THRESHOLD:
+                config->micro_threshold = (float32_t)value;
+                break;
+
+            case SWEEP_PARAM_MAX_RANGE:
+                /* Same conversion as the configuration task */
+                config->max_range_bin = (int32_t)((float32_t)value / RADAR_SETTINGS_RANGE_BIN_LENGTH_M);
+                break;
+
+            case SWEEP_PARAM_MACRO_COMPARE_INTERVAL:
+                config->macro_compare_interval_ms = (int32_t)lround(value);
+                break;
+
+            case SWEEP_PARAM_MACRO_VALIDITY:
+                config->macro_movement_validity_ms = (int32_t)lround(value);
+                break;
+
+            case SWEEP_PARAM_MICRO_VALIDITY:
+                config->micro_movement_validity_ms = (int32_t)lround(value);
+                break;
+
+            case SWEEP_PARAM_MACRO_CONFIRMATIONS:
+                config->macro_movement_confirmations = (int32_t)lround(value);
+                break;
+
+            case SWEEP_PARAM_MICRO_FFT_SIZE:
+                config->micro_fft_size = (int32_t)lround(value);
+                break;
+
+            case SWEEP_PARAM_MODE:
+                config->mode = (xensiv_radar_presence_mode_t)lround(value);
+                break;
+
+            case SWEEP_PARAM_BANDPASS:
+                config->macro_fft_bandpass_filter_enabled = (value != 0.0);
+                break;
+
+            case SWEEP_PARAM_DECIMATION:
+                config->micro_fft_decimation_enabled = (value != 0.0);
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: presence_cb
+ ******************************************************************************/
+static void presence_cb(xensiv_radar_presence_handle_t handle,
+                        const xensiv_radar_presence_event_t *event,
+                        void *data)
+{
+    (void)handle;
+
+    presence_score_event((presence_score_t *)data, event);
+}
+
+/*******************************************************************************
+ * Function Name: evaluate
+ *******************************************************************************
+ * Summary:
+ *   Work pool task: runs one configuration over one recording from the
+ *   frame cache. The cached frames are shared by all workers, so each frame
+ *   is copied to the scratch buffer of the worker before processing.
+ ******************************************************************************/
+static void evaluate(uint32_t index, uint32_t worker, void *data)
+{
+    sweep_t *sweep = (sweep_t *)data;
+    uint32_t config_index = index / sweep->num_caches;
+    const frame_cache_t *cache = &sweep->caches[index % sweep->num_caches];
+    presence_score_t *score = &sweep->scores[index];
+    float32_t *scratch = &sweep->scratch[(size_t)worker * RADAR_PIPELINE_SAMPLES_PER_FRAME];
+    xensiv_radar_presence_config_t config;
+    xensiv_radar_presence_handle_t handle;
+    uint32_t next = 0;
+
+    grid_config(sweep->params, sweep->results[config_index].grid_index, &config);
+    if (xensiv_radar_presence_alloc(&handle, &config) != XENSIV_RADAR_PRESENCE_OK)
+    {
+        sweep->status[index] = -1;
+        return;
+    }
+
+    presence_score_init(score, &cache->rec);
+    xensiv_radar_presence_set_callback(handle, presence_cb, score);
+
+    for (uint32_t i = 0; i < cache->num_frames; ++i)
+    {
+        if (cache->processed[i] != 0u)
+        {
+            memcpy(scratch, &cache->frames[(size_t)next * RADAR_PIPELINE_SAMPLES_PER_FRAME],
+                   sizeof(float32_t) * RADAR_PIPELINE_SAMPLES_PER_FRAME);
+            (void)xensiv_radar_presence_process_frame(handle, scratch, cache->timestamps[i]);
+            next++;
+        }
+        presence_score_frame(score, cache->timestamps[i]);
+    }
+
+    presence_score_finish(score);
+    xensiv_radar_presence_free(handle);
+    sweep->status[index] = 1;
+}
+
+/*******************************************************************************
+ * Function Name: build_cache
+ ******************************************************************************/
+static void build_cache(uint32_t index, uint32_t worker, void *data)
+{
+    frame_cache_t *caches = (frame_cache_t *)data;
+
+    (void)worker;
+
+    if (frame_cache_build(&caches[index], caches[index].path) != 0)
+    {
+        caches[index].num_frames = UINT32_MAX;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: gcd
+ ******************************************************************************/
+static uint64_t gcd(uint64_t a, uint64_t b)
+{
+    while (b != 0u)
+    {
+        uint64_t t = a % b;
+        a = b;
+        b = t;
+    }
+
+    return a;
+}
+
+/*******************************************************************************
+ * Function Name: xorshift64
+ ******************************************************************************/
+static uint64_t xorshift64(uint64_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+/*******************************************************************************
+ * Function Name: select_configs
+ *******************************************************************************
+ * Summary:
+ *   Selects the grid indices to evaluate: the whole grid, or 'count' distinct
+ *   indices at random. The random selection walks the grid with a stride
+ *   coprime to its size, which visits every index once without keeping a
+ *   set of the indices already drawn.
+ ******************************************************************************/
+static void select_configs(sweep_result_t *results, uint64_t count, uint64_t size, uint64_t seed)
+{
+    uint64_t state = (seed != 0u) ? seed : 0x9e3779b97f4a7c15ull;
+    uint64_t stride = 1u;
+    uint64_t offset = 0u;
+
+    if (count < size)
+    {
+        offset = xorshift64(&state) % size;
+        do
+        {
+            stride = 1u + (xorshift64(&state) % (size - 1u));
+        } while (gcd(stride, size) != 1u);
+    }
+
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        results[i].grid_index = (offset + ((unsigned __int128)i * stride)) % size;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: compare_front
+ ******************************************************************************/
+static int compare_front(const void *a, const void *b)
+{
+    const sweep_result_t *ra = *(const sweep_result_t *const *)a;
+    const sweep_result_t *rb = *(const sweep_result_t *const *)b;
+    double fa = presence_score_false_alarms_per_hour(&ra->score);
+    double fb = presence_score_false_alarms_per_hour(&rb->score);
+    double la = presence_score_effective_latency_ms(&ra->score);
+    double lb = presence_score_effective_latency_ms(&rb->score);
+
+    if (fa != fb)
+    {
+        return (fa < fb) ? -1 : 1;
+    }
+    if (la != lb)
+    {
+        return (la < lb) ? -1 : 1;
+    }
+    return (ra->grid_index < rb->grid_index) ? -1 : (ra->grid_index > rb->grid_index);
+}
+
+/*******************************************************************************
+ * Function Name: pareto_front
+ *******************************************************************************
+ * Summary:
+ *   Sorts the valid results by false alarm rate and keeps those whose
+ *   effective latency is below that of every configuration with fewer or
+ *   equal false alarms. The effective latency counts missed entries with
+ *   their whole presence time, so a configuration cannot reach the front by
+ *   detecting nothing.
+ *
+ * Return:
+ *   number of configurations on the front, stored at the start of 'sorted'
+ ******************************************************************************/
+static uint32_t pareto_front(sweep_result_t **sorted, uint32_t count)
+{
+    uint32_t front = 0;
+    double best_latency = INFINITY;
+
+    qsort(sorted, count, sizeof(*sorted), compare_front);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        double latency = presence_score_effective_latency_ms(&sorted[i]->score);
+
+        if (latency < best_latency)
+        {
+            best_latency = latency;
+            sorted[front++] = sorted[i];
+        }
+    }
+
+    return front;
+}
+
+/*******************************************************************************
+ * Function Name: print_result
+ ******************************************************************************/
+static void print_result(FILE *out, const sweep_param_t *params, const sweep_result_t *r, bool last)
+{
+    const presence_score_t *score = &r->score;
+    xensiv_radar_presence_config_t config;
+
+    grid_config(params, r->grid_index, &config);
+
+    fprintf(out, "    {\n");
+    fprintf(out, "      \"config\": {\n");
+    fprintf(out, "        \"macro_threshold\": %.4g,\n", config.macro_threshold);
+    fprintf(out, "        \"micro_threshold\": %.4g,\n", config.micro_threshold);
+    fprintf(out, "        \"max_range_bin\": %" PRId32 ",\n", config.max_range_bin);
+    fprintf(out, "        \"macro_compare_interval_ms\": %" PRId32 ",\n", config.macro_compare_interval_ms);
+    fprintf(out, "        \"macro_validity_ms\": %" PRId32 ",\n", config.macro_movement_validity_ms);
+    fprintf(out, "        \"micro_validity_ms\": %" PRId32 ",\n", config.micro_movement_validity_ms);
+    fprintf(out, "        \"macro_confirmations\": %" PRId32 ",\n", config.macro_movement_confirmations);
+    fprintf(out, "        \"micro_fft_size\": %" PRId32 ",\n", config.micro_fft_size);
+    fprintf(out, "        \"mode\": \"%s\",\n", mode_names[config.mode]);
+    fprintf(out, "        \"bandpass_filter\": \"%s\",\n", bool_names[config.macro_fft_bandpass_filter_enabled]);
+    fprintf(out, "        \"decimation_filter\": \"%s\"\n", bool_names[config.micro_fft_decimation_enabled]);
+    fprintf(out, "      },\n");
+
+    /* The part of the configuration that can be published on the
+     * configuration topic of a device
+     */
+    fprintf(out, "      \"config_topic\": {\"max_range\": \"%.2f\", \"macro_threshold\": \"%.4g\", "
+            "\"micro_threshold\": \"%.4g\", \"mode\": \"%s\", \"bandpass_filter\": \"%s\", "
+            "\"decimation_filter\": \"%s\"},\n",
+            fmin((config.max_range_bin + 0.5) * RADAR_SETTINGS_RANGE_BIN_LENGTH_M, MAX_RANGE_MAX_LIMIT),
+            config.macro_threshold, config.micro_threshold, mode_names[config.mode],
+            bool_names[config.macro_fft_bandpass_filter_enabled], bool_names[config.micro_fft_decimation_enabled]);
+
+    fprintf(out, "      \"entries\": %" PRIu32 ",\n", score->entries);
+    fprintf(out, "      \"missed_entries\": %" PRIu32 ",\n", score->missed_entries);
+    fprintf(out, "      \"latency_ms_mean\": %.1f,\n", presence_score_latency_ms(score));
+    fprintf(out, "      \"latency_ms_max\": %" PRIu32 ",\n", score->latency_max_ms);
+    fprintf(out, "      \"effective_latency_ms\": %.1f,\n", presence_score_effective_latency_ms(score));
+    fprintf(out, "      \"false_alarms\": %" PRIu32 ",\n", score->false_alarms);
+    fprintf(out, "      \"false_alarms_per_hour\": %.3f,\n", presence_score_false_alarms_per_hour(score));
+    fprintf(out, "      \"missed_ratio\": %.4f\n", presence_score_missed_ratio(score));
+    fprintf(out, "    }%s\n", last ? "" : ",");
+}
+
+/*******************************************************************************
+ * Function Name: usage
+ ******************************************************************************/
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s [-j N] [-o results.json] [--random N] [--seed S] [--all]\n"
+            "          -p name=min:max:step|name=value,... [-p ...] recording...\n"
+            "  -j N             worker threads, default: number of CPUs\n"
+            "  -o FILE          write the results to FILE instead of stdout\n"
+            "  -p SPEC          values of a parameter, parameters not given keep\n"
+            "                   their default\n"
+            "  --random N       evaluate N configurations of the grid at random\n"
+            "  --seed S         seed of the random selection\n"
+            "  --max-configs N  largest grid evaluated without --random (%u)\n"
+            "  --all            report every configuration, not only the Pareto front\n"
+            "parameters:\n",
+            name, SWEEP_DEFAULT_MAX_CONFIGS);
+
+    for (uint32_t i = 0; i < SWEEP_NUM_PARAMS; ++i)
+    {
+        if (param_defs[i].names != NULL)
+        {
+            fprintf(stderr, "  %-26s", param_defs[i].name);
+            for (uint32_t j = 0; j < param_defs[i].num_names; ++j)
+            {
+                fprintf(stderr, " %s", param_defs[i].names[j]);
+            }
+            fprintf(stderr, "\n");
+        }
+        else
+        {
+            fprintf(stderr, "  %-26s %g..%g\n", param_defs[i].name, param_defs[i].min, param_defs[i].max);
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: main
+ *******************************************************************************
+ * Summary:
+ *   Converts every recording once into a frame cache, then scores each
+ *   selected configuration on each recording as one task of the work pool.
+ *
+ * Return:
+ *   0 on success, 1 on error
+ ******************************************************************************/
+int main(int argc, char **argv)
+{
+    static const struct option long_options[] =
+    {
+        { "random", required_argument, NULL, 'r' },
+        { "seed", required_argument, NULL, 's' },
+        { "max-configs", required_argument, NULL, 'm' },
+        { "all", no_argument, NULL, 'a' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    static sweep_param_t params[SWEEP_NUM_PARAMS];
+    uint32_t workers = work_pool_default_workers();
+    uint64_t random_count = 0;
+    uint64_t seed = 1;
+    uint64_t max_configs = SWEEP_DEFAULT_MAX_CONFIGS;
+    bool all = false;
+    const char *output = NULL;
+    sweep_t sweep = { .params = params };
+    frame_cache_t *caches;
+    sweep_result_t **sorted;
+    uint64_t size;
+    uint32_t num_configs;
+    uint32_t num_valid = 0;
+    uint32_t num_front;
+    struct timespec start;
+    struct timespec end;
+    FILE *out = stdout;
+    int opt;
+
+    while ((opt = getopt_long(argc, argv, "j:o:p:h", long_options, NULL)) != -1)
+    {
+        switch (opt)
+        {
+            case 'j':
+                workers = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+
+            case 'o':
+                output = optarg;
+                break;
+
+            case 'p':
+                if (!parse_param(params, optarg))
+                {
+                    return 1;
+                }
+                break;
+
+            case 'r':
+                random_count = strtoull(optarg, NULL, 0);
+                break;
+
+            case 's':
+                seed = strtoull(optarg, NULL, 0);
+                break;
+
+            case 'm':
+                max_configs = strtoull(optarg, NULL, 0);
+                break;
+
+            case 'a':
+                all = true;
+                break;
+
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (optind >= argc)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    if (workers < 1u)
+    {
+        workers = 1u;
+    }
+
+    size = grid_size(params);
+    if ((random_count > 0u) && (random_count < size))
+    {
+        max_configs = random_count;
+    }
+    else if (size > max_configs)
+    {
+        fprintf(stderr, "grid of %" PRIu64 " configurations exceeds %" PRIu64 ", use --random or --max-configs\n",
+                size, max_configs);
+        return 1;
+    }
+    else
+    {
+        max_configs = size;
+    }
+    num_configs = (uint32_t)max_configs;
+
+    sweep.num_caches = (uint32_t)(argc - optind);
+    if ((uint64_t)num_configs * sweep.num_caches > UINT32_MAX)
+    {
+        fprintf(stderr, "too many configurations for %u recordings\n", sweep.num_caches);
+        return 1;
+    }
+
+    caches = calloc(sweep.num_caches, sizeof(*caches));
+    sweep.results = calloc(num_configs, sizeof(*sweep.results));
+    sweep.scores = calloc((size_t)num_configs * sweep.num_caches, sizeof(*sweep.scores));
+    sweep.status = calloc((size_t)num_configs * sweep.num_caches, sizeof(*sweep.status));
+    sweep.scratch = malloc((size_t)workers * sizeof(float32_t) * RADAR_PIPELINE_SAMPLES_PER_FRAME);
+    sorted = calloc(num_configs, sizeof(*sorted));
+    if ((caches == NULL) || (sweep.results == NULL) || (sweep.scores == NULL) || (sweep.status == NULL) ||
+        (sweep.scratch == NULL) || (sorted == NULL))
+    {
+        fprintf(stderr, "out of memory for %u configurations\n", num_configs);
+        return 1;
+    }
+
+    /* The allocator of the presence library is global, set it before the
+     * workers start
+     */
+    xensiv_radar_presence_set_malloc_free(malloc, free);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (uint32_t i = 0; i < sweep.num_caches; ++i)
+    {
+        caches[i].path = argv[optind + (int)i];
+    }
+    if (work_pool_run(workers, sweep.num_caches, build_cache, caches) != 0)
+    {
+        return 1;
+    }
+    for (uint32_t i = 0; i < sweep.num_caches; ++i)
+    {
+        if (caches[i].num_frames == UINT32_MAX)
+        {
+            return 1;
+        }
+    }
+    sweep.caches = caches;
+
+    select_configs(sweep.results, num_configs, size, seed);
+    if (work_pool_run(workers, num_configs * sweep.num_caches, evaluate, &sweep) != 0)
+    {
+        return 1;
+    }
+
+    for (uint32_t c = 0; c < num_configs; ++c)
+    {
+        sweep_result_t *r = &sweep.results[c];
+
+        r->valid = true;
+        for (uint32_t i = 0; i < sweep.num_caches; ++i)
+        {
+            uint32_t index = (c * sweep.num_caches) + i;
+
+            if (sweep.status[index] != 1)
+            {
+                r->valid = false;
+                break;
+            }
+            presence_score_add(&r->score, &sweep.scores[index]);
+        }
+        if (r->valid)
+        {
+            sorted[num_valid++] = r;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    num_front = pareto_front(sorted, num_valid);
+
+    if (output != NULL)
+    {
+        out = fopen(output, "w");
+        if (out == NULL)
+        {
+            perror(output);
+            return 1;
+        }
+    }
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"profile_id\": \"0x%08lx\",\n", (unsigned long)RADAR_SETTINGS_PROFILE_ID);
+    fprintf(out, "  \"recordings\": %u,\n", sweep.num_caches);
+    fprintf(out, "  \"grid_size\": %" PRIu64 ",\n", size);
+    fprintf(out, "  \"configs\": %u,\n", num_configs);
+    fprintf(out, "  \"invalid_configs\": %u,\n", num_configs - num_valid);
+    fprintf(out, "  \"threads\": %u,\n", workers);
+    fprintf(out, "  \"wall_s\": %.3f,\n",
+            (double)(end.tv_sec - start.tv_sec) + ((double)(end.tv_nsec - start.tv_nsec) * 1e-9));
+    fprintf(out, "  \"pareto_front\": [\n");
+    for (uint32_t i = 0; i < num_front; ++i)
+    {
+        print_result(out, params, sorted[i], i == (num_front - 1u));
+    }
+    fprintf(out, "  ]%s\n", all ? "," : "");
+
+    if (all)
+    {
+        fprintf(out, "  \"all\": [\n");
+        for (uint32_t c = 0; c < num_configs; ++c)
+        {
+            if (!sweep.results[c].valid)
+            {
+                continue;
+            }
+            print_result(out, params, &sweep.results[c], --num_valid == 0u);
+        }
+        fprintf(out, "  ]\n");
+    }
+    fprintf(out, "}\n");
+
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+
+    for (uint32_t i = 0; i < sweep.num_caches; ++i)
+    {
+        frame_cache_free(&caches[i]);
+    }
+
+    return 0;
+}
+
+/* [] END OF FILE */
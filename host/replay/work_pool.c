@@ -0,0 +1,250 @@
+/******************************************************************************
+ * File Name:   work_pool.c
+ *
+ * Description: Host build: work-stealing thread pool for independent tasks.
+ *              Each worker owns a deque of task indices: it takes tasks from
+ *              the back of its own deque and, when that is empty, steals from
+ *              the front of the others. The tasks of a sweep differ a lot in
+ *              cost (recording length, FFT size), so idle workers take over the
+ *              remainder of slow ones instead of waiting for them.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* Header file includes */
+#include "work_pool.h"
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    pthread_mutex_t lock;
+    uint32_t head;              /* Next task to steal */
+    uint32_t tail;              /* One past the next own task */
+    uint32_t *tasks;
+} work_deque_t;
+
+typedef struct work_pool work_pool_t;
+
+typedef struct
+{
+    work_pool_t *pool;
+    uint32_t id;
+    pthread_t thread;
+} work_worker_t;
+
+struct work_pool
+{
+    work_deque_t *deques;
+    work_worker_t *workers;
+    uint32_t num_workers;
+    work_pool_fn_t fn;
+    void *data;
+};
+
+/*******************************************************************************
+ * Function Name: pop_own
+ ******************************************************************************/
+static int pop_own(work_deque_t *deque, uint32_t *task)
+{
+    int found = 0;
+
+    pthread_mutex_lock(&deque->lock);
+    if (deque->tail > deque->head)
+    {
+        *task = deque->tasks[--deque->tail];
+        found = 1;
+    }
+    pthread_mutex_unlock(&deque->lock);
+
+    return found;
+}
+
+/*******************************************************************************
+ * Function Name: steal
+ ******************************************************************************/
+static int steal(work_deque_t *deque, uint32_t *task)
+{
+    int found = 0;
+
+    pthread_mutex_lock(&deque->lock);
+    if (deque->tail > deque->head)
+    {
+        *task = deque->tasks[deque->head++];
+        found = 1;
+    }
+    pthread_mutex_unlock(&deque->lock);
+
+    return found;
+}
+
+/*******************************************************************************
+ * Function Name: worker_main
+ *******************************************************************************
+ * Summary:
+ *   Runs the own tasks, then steals until all deques are empty. No task
+ *   creates new tasks, so a worker that finds all deques empty is done.
+ ******************************************************************************/
+static void *worker_main(void *arg)
+{
+    work_worker_t *self = (work_worker_t *)arg;
+    work_pool_t *pool = self->pool;
+    uint32_t task;
+
+    for (;;)
+    {
+        int found = pop_own(&pool->deques[self->id], &task);
+
+        /* Start with the next worker, so that thieves spread over victims */
+        for (uint32_t i = 1; !found && (i < pool->num_workers); ++i)
+        {
+            found = steal(&pool->deques[(self->id + i) % pool->num_workers], &task);
+        }
+
+        if (!found)
+        {
+            break;
+        }
+
+        pool->fn(task, self->id, pool->data);
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+ * Function Name: work_pool_default_workers
+ ******************************************************************************/
+uint32_t work_pool_default_workers(void)
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return (cpus > 0) ? (uint32_t)cpus : 1u;
+}
+
+/*******************************************************************************
+ * Function Name: work_pool_run
+ *******************************************************************************
+ * Summary:
+ *   Runs tasks 0 to num_tasks - 1 on num_workers threads and returns when
+ *   all are done. The tasks are dealt out in contiguous blocks, so that a
+ *   worker runs neighbouring tasks while it is not stealing.
+ *
+ * Parameters:
+ *   num_workers: number of threads, limited to the number of tasks
+ *   num_tasks: number of tasks
+ *   fn: task function
+ *   data: passed to fn
+ *
+ * Return:
+ *   0 on success, -1 if out of memory
+ ******************************************************************************/
+int work_pool_run(uint32_t num_workers, uint32_t num_tasks, work_pool_fn_t fn, void *data)
+{
+    work_pool_t pool = { .fn = fn, .data = data };
+    uint32_t *tasks;
+    uint32_t started = 0;
+
+    if (num_tasks == 0u)
+    {
+        return 0;
+    }
+    if (num_workers == 0u)
+    {
+        num_workers = 1u;
+    }
+    if (num_workers > num_tasks)
+    {
+        num_workers = num_tasks;
+    }
+
+    tasks = malloc(num_tasks * sizeof(*tasks));
+    pool.deques = calloc(num_workers, sizeof(*pool.deques));
+    pool.workers = calloc(num_workers, sizeof(*pool.workers));
+    if ((tasks == NULL) || (pool.deques == NULL) || (pool.workers == NULL))
+    {
+        free(tasks);
+        free(pool.deques);
+        free(pool.workers);
+        return -1;
+    }
+    pool.num_workers = num_workers;
+
+    for (uint32_t i = 0; i < num_tasks; ++i)
+    {
+        tasks[i] = i;
+    }
+
+    for (uint32_t w = 0; w < num_workers; ++w)
+    {
+        uint32_t first = (uint32_t)(((uint64_t)num_tasks * w) / num_workers);
+        uint32_t last = (uint32_t)(((uint64_t)num_tasks * (w + 1u)) / num_workers);
+
+        pthread_mutex_init(&pool.deques[w].lock, NULL);
+        pool.deques[w].tasks = &tasks[first];
+        pool.deques[w].head = 0;
+        pool.deques[w].tail = last - first;
+        pool.workers[w].pool = &pool;
+        pool.workers[w].id = w;
+    }
+
+    for (; started < num_workers; ++started)
+    {
+        if (pthread_create(&pool.workers[started].thread, NULL, worker_main, &pool.workers[started]) != 0)
+        {
+            fprintf(stderr, "cannot create worker thread, continuing with %u\n", (unsigned)started);
+            break;
+        }
+    }
+
+    /* The started workers steal the tasks of the others; without any, the
+     * tasks run in the calling thread.
+     */
+    if (started == 0u)
+    {
+        work_worker_t self = { .pool = &pool, .id = 0 };
+        (void)worker_main(&self);
+    }
+
+    for (uint32_t w = 0; w < started; ++w)
+    {
+        pthread_join(pool.workers[w].thread, NULL);
+    }
+
+    for (uint32_t w = 0; w < num_workers; ++w)
+    {
+        pthread_mutex_destroy(&pool.deques[w].lock);
+    }
+
+    free(tasks);
+    free(pool.deques);
+    free(pool.workers);
+    return 0;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,47 @@
+/******************************************************************************
+ * File Name:   work_pool.h
+ *
+ * Description: Host build: work-stealing thread pool for independent tasks.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef WORK_POOL_H_
+#define WORK_POOL_H_
+
+#include <stdint.h>
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+/* Runs task 'index'; 'worker' identifies the calling worker, e.g. to use
+ * per-worker scratch buffers.
+ */
+typedef void (*work_pool_fn_t)(uint32_t index, uint32_t worker, void *data);
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+uint32_t work_pool_default_workers(void);
+int work_pool_run(uint32_t num_workers, uint32_t num_tasks, work_pool_fn_t fn, void *data);
+
+#endif
+/* [] END OF FILE */
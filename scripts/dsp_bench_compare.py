@@ -0,0 +1,121 @@
+#!/usr/bin/env python3
+"""
+File name: dsp_bench_compare.py
+
+Description: Compares the results of the DSP kernel microbenchmarks with a
+stored baseline and flags the regressions.
+
+The results are either the JSON file of the host tool (host/build/
+presence_dsp_bench) or the UART log of a target built with DSP_BENCH_ENABLE=1,
+whose "dsp_bench:" lines are picked out of the other output. Target results
+are in CPU cycles per sample, host results in nanoseconds per sample; a
+baseline is only compared with results of the same unit.
+
+A case regresses when it is slower than the baseline by more than the
+tolerance. Cases missing from either side are listed but do not fail.
+
+===========================================================================
+Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+===========================================================================
+"""
+
+import argparse
+import json
+import re
+import sys
+
+LOG_RE = re.compile(r"dsp_bench: (\w+) (\w+) (\d+) ([0-9.]+) (\w+)( mismatch)?")
+
+
+def fail(message):
+    sys.stderr.write("dsp_bench_compare: error: " + message + "\n")
+    sys.exit(2)
+
+
+def read_results(path):
+    """Returns (unit, {(kernel, variant, n): per_sample}, mismatches)."""
+    with open(path, "r", errors="replace") as f:
+        text = f.read()
+
+    if text.lstrip().startswith("{"):
+        data = json.loads(text)
+        cases = {(r["kernel"], r["variant"], r["n"]): r["per_sample"] for r in data["results"]}
+        mismatches = [(r["kernel"], r["variant"], r["n"]) for r in data["results"] if not r.get("match", True)]
+        return data["unit"], cases, mismatches
+
+    unit = None
+    cases = {}
+    mismatches = []
+    for match in LOG_RE.finditer(text):
+        kernel, variant, n, value, case_unit, mismatch = match.groups()
+        if unit not in (None, case_unit):
+            fail("%s: results in %s and %s" % (path, unit, case_unit))
+        unit = case_unit
+        cases[(kernel, variant, int(n))] = float(value)
+        if mismatch:
+            mismatches.append((kernel, variant, int(n)))
+
+    if not cases:
+        fail("%s: no benchmark results" % path)
+    return unit, cases, mismatches
+
+
+def save(path, unit, cases):
+    results = [{"kernel": k, "variant": v, "n": n, "per_sample": cases[(k, v, n)], "match": True}
+               for (k, v, n) in sorted(cases)]
+    with open(path, "w") as f:
+        json.dump({"unit": unit, "results": results}, f, indent=2)
+        f.write("\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[1])
+    parser.add_argument("results", help="host JSON results or target UART log")
+    parser.add_argument("--baseline", help="baseline to compare with")
+    parser.add_argument("--save", help="store the results as a baseline")
+    parser.add_argument("--tolerance", type=float, default=0.10,
+                        help="allowed slowdown, default: 0.10 (10%%)")
+    args = parser.parse_args()
+
+    unit, cases, mismatches = read_results(args.results)
+    for kernel, variant, n in mismatches:
+        print("MISMATCH   %-8s %-7s %5d  output differs from the scalar variant" % (kernel, variant, n))
+
+    regressions = 0
+    if args.baseline:
+        base_unit, base, _ = read_results(args.baseline)
+        if base_unit != unit:
+            fail("the results are in %s, the baseline in %s" % (unit, base_unit))
+
+        print("%-8s %-7s %5s %12s %12s %8s" % ("kernel", "variant", "n", "baseline", unit + "/sample", "change"))
+        for key in sorted(set(cases) | set(base)):
+            kernel, variant, n = key
+            if key not in base or key not in cases:
+                print("%-8s %-7s %5d  only in the %s" % (kernel, variant, n,
+                                                          "results" if key in cases else "baseline"))
+                continue
+
+            change = (cases[key] - base[key]) / base[key] if base[key] > 0 else 0.0
+            regressed = change > args.tolerance
+            regressions += 1 if regressed else 0
+            print("%-8s %-7s %5d %12.3f %12.3f %+7.1f%%%s" % (kernel, variant, n, base[key], cases[key],
+                                                            change * 100.0, "  REGRESSION" if regressed else ""))
+    else:
+        # Without a baseline, show the speedup of each variant over the plain C loop
+        print("%-8s %-7s %5s %12s %8s" % ("kernel", "variant", "n", unit + "/sample", "speedup"))
+        for key in sorted(cases):
+            kernel, variant, n = key
+            scalar = cases.get((kernel, "scalar", n))
+            speedup = "%7.2fx" % (scalar / cases[key]) if scalar and cases[key] > 0 else "       -"
+            print("%-8s %-7s %5d %12.3f %s" % (kernel, variant, n, cases[key], speedup))
+
+    if args.save:
+        save(args.save, unit, cases)
+
+    if regressions or mismatches:
+        print("dsp_bench_compare: %d regressions, %d mismatches" % (regressions, len(mismatches)))
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+"""
+File name: radar_recording.py
+
+Description: Builds a recording for the host replay tools from raw frames
+captured on the capture topic.
+
+The input is the payload of the capture topic saved back to back, for example
+with "mosquitto_sub -t 'presence capture' -N > capture.bin". Each batch starts
+with the radar_capture_header_t defined in source/radar_capture_format.h. The
+labels are a text file with one interval per line:
+
+    <start_ms> <end_ms> <absence|macro|micro>
+
+in the capture time base of the device (the timestamps printed with the
+presence events). The output layout is radar_recording_header_t, the frame
+records and the labels, see source/radar_capture_format.h.
+
+===========================================================================
+Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+===========================================================================
+"""
+
+import argparse
+import struct
+import sys
+
+CAPTURE_HEADER = struct.Struct("<2sBBIIIIHH")
+CAPTURE_MAGIC = b"RC"
+CAPTURE_VERSION = 1
+
+RECORDING_HEADER = struct.Struct("<4sHHIIHHIII")
+RECORDING_MAGIC = b"RREC"
+RECORDING_VERSION = 1
+RECORDING_LABEL = struct.Struct("<IIB3x")
+
+TRUTH = {"absence": 0, "macro": 1, "micro": 2}
+
+
+def fail(message):
+    sys.stderr.write("radar_recording: error: " + message + "\n")
+    sys.exit(1)
+
+
+def packed_size(samples):
+    return (samples * 3 + 1) // 2
+
+
+def read_batches(path):
+    """Yields (header fields, packed frames) for each batch of a capture."""
+    with open(path, "rb") as f:
+        data = f.read()
+
+    offset = 0
+    while offset < len(data):
+        if len(data) - offset < CAPTURE_HEADER.size:
+            fail("%s: truncated batch header at offset %d" % (path, offset))
+        (magic, version, num_frames, profile_id, sequence, timestamp_ms,
+         frame_period_us, samples, dropped) = CAPTURE_HEADER.unpack_from(data, offset)
+        if magic != CAPTURE_MAGIC or version != CAPTURE_VERSION:
+            fail("%s: no capture batch at offset %d" % (path, offset))
+        offset += CAPTURE_HEADER.size
+
+        size = packed_size(samples)
+        end = offset + num_frames * size
+        if end > len(data):
+            fail("%s: truncated batch at offset %d" % (path, offset))
+
+        frames = [data[offset + i * size:offset + (i + 1) * size] for i in range(num_frames)]
+        yield {"profile_id": profile_id, "sequence": sequence,
+               "timestamp_ms": timestamp_ms, "frame_period_us": frame_period_us,
+               "samples": samples, "dropped": dropped}, frames
+        offset = end
+
+
+def read_labels(path):
+    labels = []
+    with open(path, "r") as f:
+        for number, line in enumerate(f, 1):
+            line = line.split("#")[0].strip()
+            if not line:
+                continue
+            fields = line.split()
+            if len(fields) != 3 or fields[2] not in TRUTH:
+                fail("%s:%d: expected '<start_ms> <end_ms> <absence|macro|micro>'" % (path, number))
+            start, end = int(fields[0]), int(fields[1])
+            if end <= start:
+                fail("%s:%d: empty interval" % (path, number))
+            labels.append((start, end, TRUTH[fields[2]]))
+
+    labels.sort()
+    for previous, current in zip(labels, labels[1:]):
+        if current[0] < previous[1]:
+            fail("%s: overlapping labels at %d ms" % (path, current[0]))
+    return labels
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[1])
+    parser.add_argument("capture", nargs="+", help="saved capture topic payloads")
+    parser.add_argument("--labels", help="ground truth intervals")
+    parser.add_argument("-o", "--output", required=True)
+    args = parser.parse_args()
+
+    shape = None
+    records = []
+    next_sequence = None
+    lost = 0
+
+    for path in args.capture:
+        for batch, frames in read_batches(path):
+            batch_shape = (batch["profile_id"], batch["frame_period_us"], batch["samples"])
+            if shape is None:
+                shape = batch_shape
+            elif batch_shape != shape:
+                fail("%s: batches of different radar profiles" % path)
+
+            if next_sequence is not None and batch["sequence"] != next_sequence:
+                lost += (batch["sequence"] - next_sequence) & 0xFFFFFFFF
+            next_sequence = (batch["sequence"] + len(frames)) & 0xFFFFFFFF
+
+            for i, frame in enumerate(frames):
+                timestamp = (batch["timestamp_ms"] + (i * batch["frame_period_us"]) // 1000) & 0xFFFFFFFF
+                records.append(struct.pack("<I", timestamp) + frame)
+
+    if shape is None:
+        fail("no frames in the capture")
+
+    labels = read_labels(args.labels) if args.labels else []
+    profile_id, frame_period_us, samples = shape
+    record_size = 4 + packed_size(samples)
+    labels_offset = RECORDING_HEADER.size + len(records) * record_size
+
+    with open(args.output, "wb") as f:
+        f.write(RECORDING_HEADER.pack(RECORDING_MAGIC, RECORDING_VERSION, RECORDING_HEADER.size,
+                                      profile_id, frame_period_us, samples, record_size,
+                                      len(records), len(labels), labels_offset))
+        for record in records:
+            f.write(record)
+        for start, end, truth in labels:
+            f.write(RECORDING_LABEL.pack(start, end, truth))
+
+    print("radar_recording: %s: %d frames, %d labels, %d frames lost in transfer"
+          % (args.output, len(records), len(labels), lost))
+
+
+if __name__ == "__main__":
+    main()
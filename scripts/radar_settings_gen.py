@@ -0,0 +1,270 @@
+#!/usr/bin/env python3
+"""
+File name: radar_settings_gen.py
+
+Description: Generates source/radar_settings.h from source/radar_settings.json.
+
+The BGT60TRxx register list is produced by the radar configurator tool (see
+the XENSIV BGT60TRxx Radar API reference guide). The configurator quantizes
+the requested values to what the sensor can achieve (for example the ADC
+sample rate is 80 MHz divided by an integer), so the achieved values in the
+header legitimately differ from the requested values in the JSON file.
+
+This script:
+  1. Runs the configurator (when --configurator is given) or reuses the
+     register list already present in the header.
+  2. Checks that the achieved values are the quantized form of the JSON
+     values and fails the build when the header is stale.
+  3. Appends the constants derived from the profile (bandwidth, range bin
+     length, maximum range, frame budget in CPU cycles, buffer sizes, profile
+     ID) so that the application never hard-codes them.
+
+The header is only rewritten when its content changes, so the pre-build step
+does not trigger a rebuild on every invocation.
+
+===========================================================================
+Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+===========================================================================
+"""
+
+import argparse
+import json
+import math
+import os
+import re
+import shlex
+import subprocess
+import sys
+import tempfile
+import zlib
+
+SPEED_OF_LIGHT_M_PER_S = 299792458.0
+
+# BGT60TRxx system clock. The ADC sample rate is this clock divided by an
+# integer divider.
+BGT60TRXX_SYS_CLOCK_HZ = 80000000
+
+# Relative tolerances used when comparing requested and achieved values.
+FREQUENCY_REL_TOLERANCE = 1e-6
+TIMING_REL_TOLERANCE = 0.02
+
+CONF_PREFIX = "XENSIV_BGT60TRXX_CONF_"
+DERIVED_BEGIN = "/* Derived constants - generated by scripts/radar_settings_gen.py, do not edit */"
+DERIVED_END = "/* End of derived constants */"
+
+CONF_RE = re.compile(r"#define\s+" + CONF_PREFIX + r"(\w+)\s+\((.*)\)")
+REG_RE = re.compile(r"(0x[0-9a-fA-F]+)UL")
+
+
+def fail(message):
+    sys.stderr.write("radar_settings_gen: error: " + message + "\n")
+    sys.exit(1)
+
+
+def parse_header(text):
+    """Returns the CONF macros and the register list found in a header."""
+    conf = {}
+    for name, value in CONF_RE.findall(text):
+        conf[name] = value.strip()
+
+    list_start = text.find("register_list[]")
+    if list_start < 0:
+        fail("register_list not found in header")
+    list_end = text.find("};", list_start)
+    registers = [int(r, 16) for r in REG_RE.findall(text[list_start:list_end])]
+
+    required = ["LOWER_FREQ_HZ", "UPPER_FREQ_HZ", "NUM_SAMPLES_PER_CHIRP",
+                "NUM_CHIRPS_PER_FRAME", "NUM_RX_ANTENNAS", "NUM_TX_ANTENNAS",
+                "SAMPLE_RATE", "CHIRP_REPETION_TIME_S",
+                "FRAME_REPETION_TIME_S", "NUM_REGS"]
+    for name in required:
+        if name not in conf:
+            fail("missing " + CONF_PREFIX + name + " in header")
+
+    return conf, registers
+
+
+def run_configurator(command, json_path):
+    """Runs the configurator and returns the text of the header it produced."""
+    with tempfile.TemporaryDirectory() as tmp:
+        out_path = os.path.join(tmp, "radar_settings.h")
+        args = [a.format(json=json_path, out=out_path) for a in shlex.split(command)]
+        try:
+            subprocess.run(args, check=True)
+        except (OSError, subprocess.CalledProcessError) as err:
+            fail("configurator failed: " + str(err))
+        with open(out_path, "r") as f:
+            return f.read()
+
+
+def close(achieved, requested, rel_tolerance):
+    return abs(achieved - requested) <= abs(requested) * rel_tolerance
+
+
+def check_consistency(conf, registers, shape):
+    """Fails if the achieved values do not match the JSON profile."""
+    errors = []
+
+    def expect_equal(name, achieved, requested):
+        if achieved != requested:
+            errors.append("%s: header %s, json %s" % (name, achieved, requested))
+
+    expect_equal("num_samples_per_chirp", int(conf["NUM_SAMPLES_PER_CHIRP"]),
+                 shape["num_samples_per_chirp"])
+    expect_equal("num_chirps_per_frame", int(conf["NUM_CHIRPS_PER_FRAME"]),
+                 shape["num_chirps_per_frame"])
+    expect_equal("rx_antennas", int(conf["NUM_RX_ANTENNAS"]), len(shape["rx_antennas"]))
+    expect_equal("tx_antennas", int(conf["NUM_TX_ANTENNAS"]), len(shape["tx_antennas"]))
+    expect_equal("num_regs", int(conf["NUM_REGS"]), len(registers))
+
+    adc_div = max(1, round(BGT60TRXX_SYS_CLOCK_HZ / shape["sample_rate_Hz"]))
+    expect_equal("sample_rate_Hz (quantized)", int(conf["SAMPLE_RATE"]),
+                 BGT60TRXX_SYS_CLOCK_HZ // adc_div)
+
+    for key, conf_key, tolerance in (
+            ("lower_frequency_Hz", "LOWER_FREQ_HZ", FREQUENCY_REL_TOLERANCE),
+            ("upper_frequency_Hz", "UPPER_FREQ_HZ", FREQUENCY_REL_TOLERANCE),
+            ("chirp_repetition_time_s", "CHIRP_REPETION_TIME_S", TIMING_REL_TOLERANCE),
+            ("frame_repetition_time_s", "FRAME_REPETION_TIME_S", TIMING_REL_TOLERANCE)):
+        achieved = float(conf[conf_key])
+        if not close(achieved, float(shape[key]), tolerance):
+            errors.append("%s: header %s, json %s" % (key, conf[conf_key], shape[key]))
+
+    if errors:
+        fail("radar_settings.h does not match radar_settings.json, "
+             "re-run the radar configurator:\n  " + "\n  ".join(errors))
+
+
+def derive(conf, registers, cpu_hz, fifo_depth):
+    """Computes the derived constants as (name, value, comment) tuples."""
+    lower = int(conf["LOWER_FREQ_HZ"])
+    upper = int(conf["UPPER_FREQ_HZ"])
+    samples_per_chirp = int(conf["NUM_SAMPLES_PER_CHIRP"])
+    chirps = int(conf["NUM_CHIRPS_PER_FRAME"])
+    rx = int(conf["NUM_RX_ANTENNAS"])
+    frame_time_s = float(conf["FRAME_REPETION_TIME_S"])
+
+    bandwidth = upper - lower
+    if bandwidth <= 0:
+        fail("upper frequency must be above lower frequency")
+
+    samples_per_frame = samples_per_chirp * chirps * rx
+    bin_length_m = SPEED_OF_LIGHT_M_PER_S / (2.0 * bandwidth)
+    num_range_bins = samples_per_chirp // 2
+    max_range_m = bin_length_m * num_range_bins
+    frame_period_us = int(round(frame_time_s * 1e6))
+    profile_id = zlib.crc32(b"".join(r.to_bytes(4, "little") for r in registers)) & 0xFFFFFFFF
+
+    return [
+        ("BANDWIDTH_HZ", "(%d)" % bandwidth,
+         "Chirp bandwidth, upper minus lower frequency"),
+        ("RANGE_BIN_LENGTH_M", "(%.6ff)" % bin_length_m,
+         "Range covered by one bin of a num_samples_per_chirp point FFT"),
+        ("RANGE_BIN_LENGTH_UM", "(%d)" % int(round(bin_length_m * 1e6)),
+         None),
+        ("NUM_RANGE_BINS", "(%d)" % num_range_bins,
+         "Unambiguous range bins of the real-valued IF signal"),
+        ("MAX_RANGE_M", "(%.6ff)" % max_range_m, None),
+        ("MAX_RANGE_MM", "(%d)" % int(max_range_m * 1e3), None),
+        ("FRAME_PERIOD_US", "(%d)" % frame_period_us, None),
+        ("FRAME_PERIOD_MS", "(%d)" % int(math.ceil(frame_period_us / 1000.0)),
+         "Rounded up, for use as an RTOS timeout"),
+        ("CPU_CLOCK_HZ", "(%dUL)" % cpu_hz, "CPU clock the frame budget refers to"),
+        ("FRAME_BUDGET_CYCLES", "(%dUL)" % int(frame_time_s * cpu_hz),
+         "CPU cycles available to process one frame in real time"),
+        ("NUM_SAMPLES_PER_FRAME", "(%d)" % samples_per_frame, None),
+        ("FRAME_BUFFER_BYTES", "(%d)" % (samples_per_frame * 2),
+         "uint16_t samples as read from the FIFO"),
+        ("FRAME_FLOAT_BYTES", "(%d)" % (samples_per_frame * 4),
+         "float32_t samples after conversion"),
+        ("FRAME_PACKED_BYTES", "(%d)" % ((samples_per_frame * 3 + 1) // 2),
+         "12-bit samples packed two per three bytes"),
+        ("FIFO_DEPTH_SAMPLES", "(%d)" % fifo_depth, None),
+        ("FRAMES_PER_FIFO", "(%d)" % (fifo_depth // samples_per_frame),
+         "Whole frames that fit into the sensor FIFO"),
+        ("PROFILE_ID", "(0x%08xUL)" % profile_id,
+         "CRC-32 of the register list, identifies the profile in captures"),
+    ]
+
+
+def render(conf_text, derived, json_name):
+    """Returns the full header: configurator output plus derived constants."""
+    lines = [DERIVED_BEGIN]
+    for name, value, comment in derived:
+        if comment:
+            lines.append("/* %s */" % comment)
+        lines.append("#define RADAR_SETTINGS_%s %s" % (name, value))
+    lines.append(DERIVED_END)
+    derived_text = "\n".join(lines) + "\n\n"
+
+    body = conf_text.strip("\n") + "\n"
+    guard_end = body.rfind("#endif")
+    if guard_end < 0:
+        fail("include guard not found in header")
+
+    banner = ("/* Generated from %s by scripts/radar_settings_gen.py. "
+              "Edit the JSON file, not this header. */\n" % json_name)
+    return banner + body[:guard_end] + derived_text + body[guard_end:]
+
+
+def strip_generated(text):
+    """Removes the banner and derived block from a previously generated header."""
+    text = re.sub(r"^/\* Generated from .*?\*/\n", "", text)
+    begin = text.find(DERIVED_BEGIN)
+    if begin >= 0:
+        end = text.find(DERIVED_END, begin) + len(DERIVED_END)
+        text = text[:begin] + text[end:].lstrip("\n")
+    return text
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[1])
+    parser.add_argument("--json", default="source/radar_settings.json")
+    parser.add_argument("--header", default="source/radar_settings.h")
+    parser.add_argument("--configurator", default="",
+                        help="command line of the radar configurator, "
+                             "{json} and {out} are substituted")
+    parser.add_argument("--cpu-hz", type=int, default=100000000)
+    parser.add_argument("--fifo-depth", type=int, default=8192,
+                        help="sensor FIFO depth in samples")
+    parser.add_argument("--check", action="store_true",
+                        help="only verify that the header is up to date")
+    args = parser.parse_args()
+
+    with open(args.json, "r") as f:
+        shape = json.load(f)["device_config"]["fmcw_single_shape"]
+
+    if args.configurator:
+        conf_text = run_configurator(args.configurator, args.json)
+    else:
+        with open(args.header, "r") as f:
+            conf_text = f.read()
+    conf_text = strip_generated(conf_text)
+
+    conf, registers = parse_header(conf_text)
+    check_consistency(conf, registers, shape)
+
+    derived = derive(conf, registers, args.cpu_hz, args.fifo_depth)
+    if int(conf["NUM_SAMPLES_PER_CHIRP"]) * int(conf["NUM_CHIRPS_PER_FRAME"]) * \
+            int(conf["NUM_RX_ANTENNAS"]) > args.fifo_depth:
+        fail("one frame does not fit into the sensor FIFO")
+
+    output = render(conf_text, derived, os.path.basename(args.json))
+
+    current = ""
+    if os.path.exists(args.header):
+        with open(args.header, "r") as f:
+            current = f.read()
+
+    if current == output:
+        return
+    if args.check:
+        fail(args.header + " is out of date, run scripts/radar_settings_gen.py")
+
+    with open(args.header, "w") as f:
+        f.write(output)
+    print("radar_settings_gen: updated " + args.header)
+
+
+if __name__ == "__main__":
+    main()
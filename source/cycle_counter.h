@@ -0,0 +1,84 @@
+/******************************************************************************
+ * File Name:   cycle_counter.h
+ *
+ * Description: This file provides access to the CPU cycle counter used to measure
+ *              the cost of the radar processing.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef CYCLE_COUNTER_H_
+#define CYCLE_COUNTER_H_
+
+#include <stdint.h>
+
+#if defined(PRESENCE_HOST_BUILD)
+#include <time.h>
+#include "radar_settings.h"
+#else
+#include "cyhal.h"
+#endif
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+
+#if defined(PRESENCE_HOST_BUILD)
+
+/* The host build has no DWT; the CPU time of the calling thread is scaled
+ * to cycles of the target CPU clock, so the frame budget keeps its meaning.
+ * Thread time is not inflated by other threads, e.g. parallel replays.
+ */
+static inline void cycle_counter_init(void)
+{
+}
+
+static inline uint32_t cycle_counter_get(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    uint64_t ns = ((uint64_t)now.tv_sec * 1000000000ULL) + (uint64_t)now.tv_nsec;
+    return (uint32_t)((ns * (RADAR_SETTINGS_CPU_CLOCK_HZ / 1000000UL)) / 1000ULL);
+}
+
+#else
+
+/* Enables the DWT cycle counter of the Cortex-M4. */
+static inline void cycle_counter_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/* Returns the current cycle count. Differences are valid across one
+ * wrap-around of the 32-bit counter.
+ */
+static inline uint32_t cycle_counter_get(void)
+{
+    return DWT->CYCCNT;
+}
+
+#endif
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,485 @@
+/******************************************************************************
+ * File Name:   dsp_bench.c
+ *
+ * Description: This file contains the microbenchmarks of the DSP kernels of the
+ *              radar frame processing: the conversion of the FIFO samples to float, the
+ *              chirp accumulation and scaling, the windowing and the FFT. Each kernel
+ *              runs in a plain C, a CMSIS-DSP and a hand-vectorized variant over the
+ *              chirp and frame lengths a profile of radar_settings.h can have, and the
+ *              outputs of the variants are checked against each other.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#include "dsp_bench.h"
+
+#if DSP_BENCH_ENABLE
+
+/* Header file from system */
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#if defined(PRESENCE_HOST_BUILD)
+#include <time.h>
+#endif
+
+/* Header file includes */
+#include "arm_math.h"
+#include "cycle_counter.h"
+#include "radar_settings.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Frame lengths up to what fits into the sensor FIFO, chirp lengths up to
+ * the largest FFT the presence library supports
+ */
+#define DSP_BENCH_MAX_FRAME         RADAR_SETTINGS_FIFO_DEPTH_SAMPLES
+#define DSP_BENCH_MAX_CHIRP         (512u)
+#define DSP_BENCH_MIN_FRAME         (256u)
+#define DSP_BENCH_MAX_SIZES         (16u)
+
+/* Relative error allowed between the variants of a kernel */
+#define DSP_BENCH_TOLERANCE         (1e-6f)
+
+_Static_assert(XENSIV_BGT60TRXX_CONF_NUM_SAMPLES_PER_CHIRP <= DSP_BENCH_MAX_CHIRP,
+               "profile chirp longer than the benchmarked chirp lengths");
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+/* Four floats in one register where the CPU has a vector unit. On the
+ * Cortex-M4, which has none, the compiler lowers each operation to four
+ * scalar ones, which gives the loops unrolled by four.
+ */
+typedef float dsp_v4f_t __attribute__((vector_size(16)));
+typedef uint16_t dsp_v4u16_t __attribute__((vector_size(8)));
+
+typedef struct
+{
+    const char *kernel;
+    const char *variant;
+    bool frame_sized;           /* Runs over the frame lengths, not the chirp lengths */
+    bool (*setup)(uint32_t n);  /* Optional, false skips the length */
+    void (*run)(uint32_t n);
+} dsp_bench_case_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static uint16_t raw[DSP_BENCH_MAX_FRAME];
+static float32_t in_a[DSP_BENCH_MAX_FRAME];
+static float32_t in_b[DSP_BENCH_MAX_FRAME];
+static float32_t out[DSP_BENCH_MAX_FRAME];
+static float32_t ref[DSP_BENCH_MAX_FRAME];
+static float32_t window[DSP_BENCH_MAX_CHIRP];
+static arm_rfft_fast_instance_f32 rfft;
+
+/*******************************************************************************
+ * Vector helpers
+ ******************************************************************************/
+static inline dsp_v4f_t load4(const float32_t *p)
+{
+    dsp_v4f_t v;
+
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline void store4(float32_t *p, dsp_v4f_t v)
+{
+    memcpy(p, &v, sizeof(v));
+}
+
+/*******************************************************************************
+ * Kernels: conversion of the 12-bit FIFO samples to float, as in
+ * radar_pipeline_preprocess()
+ ******************************************************************************/
+static void convert_scalar(uint32_t n)
+{
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        out[i] = (float32_t)raw[i] / 4096.0F;
+    }
+}
+
+/* The samples are below 2^12, i.e. valid positive q15 values */
+static void convert_cmsis(uint32_t n)
+{
+    arm_q15_to_float((const q15_t *)raw, out, n);
+    arm_scale_f32(out, 32768.0F / 4096.0F, out, n);
+}
+
+static void convert_vector(uint32_t n)
+{
+    uint32_t i = 0;
+
+    for (; (i + 4u) <= n; i += 4u)
+    {
+        dsp_v4u16_t samples;
+
+        memcpy(&samples, &raw[i], sizeof(samples));
+        store4(&out[i], __builtin_convertvector(samples, dsp_v4f_t) * (1.0F / 4096.0F));
+    }
+    for (; i < n; ++i)
+    {
+        out[i] = (float32_t)raw[i] * (1.0F / 4096.0F);
+    }
+}
+
+/*******************************************************************************
+ * Kernels: chirp accumulation
+ ******************************************************************************/
+static void add_scalar(uint32_t n)
+{
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        out[i] = in_a[i] + in_b[i];
+    }
+}
+
+static void add_cmsis(uint32_t n)
+{
+    arm_add_f32(in_a, in_b, out, n);
+}
+
+static void add_vector(uint32_t n)
+{
+    uint32_t i = 0;
+
+    for (; (i + 4u) <= n; i += 4u)
+    {
+        store4(&out[i], load4(&in_a[i]) + load4(&in_b[i]));
+    }
+    for (; i < n; ++i)
+    {
+        out[i] = in_a[i] + in_b[i];
+    }
+}
+
+/*******************************************************************************
+ * Kernels: scaling of the accumulated chirp
+ ******************************************************************************/
+static void scale_scalar(uint32_t n)
+{
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        out[i] = in_a[i] * 0.25F;
+    }
+}
+
+static void scale_cmsis(uint32_t n)
+{
+    arm_scale_f32(in_a, 0.25F, out, n);
+}
+
+static void scale_vector(uint32_t n)
+{
+    uint32_t i = 0;
+
+    for (; (i + 4u) <= n; i += 4u)
+    {
+        store4(&out[i], load4(&in_a[i]) * 0.25F);
+    }
+    for (; i < n; ++i)
+    {
+        out[i] = in_a[i] * 0.25F;
+    }
+}
+
+/*******************************************************************************
+ * Kernels: window applied to a chirp before its FFT
+ ******************************************************************************/
+static void window_scalar(uint32_t n)
+{
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        out[i] = in_a[i] * window[i];
+    }
+}
+
+static void window_cmsis(uint32_t n)
+{
+    arm_mult_f32(in_a, window, out, n);
+}
+
+static void window_vector(uint32_t n)
+{
+    uint32_t i = 0;
+
+    for (; (i + 4u) <= n; i += 4u)
+    {
+        store4(&out[i], load4(&in_a[i]) * load4(&window[i]));
+    }
+    for (; i < n; ++i)
+    {
+        out[i] = in_a[i] * window[i];
+    }
+}
+
+/*******************************************************************************
+ * Kernels: real FFT of a chirp. Only the lengths with CMSIS-DSP tables in
+ * the build are run. The FFT uses its input as scratch, so repeated calls
+ * transform garbage; the time does not depend on the values.
+ ******************************************************************************/
+static bool rfft_setup(uint32_t n)
+{
+    return arm_rfft_fast_init_f32(&rfft, (uint16_t)n) == ARM_MATH_SUCCESS;
+}
+
+static void rfft_cmsis(uint32_t n)
+{
+    (void)n;
+    arm_rfft_fast_f32(&rfft, in_a, out, 0);
+}
+
+/* The output of the scalar variant of a kernel is the reference of the
+ * other variants
+ */
+static const dsp_bench_case_t cases[] =
+{
+    { "convert", "scalar", true, NULL, convert_scalar },
+    { "convert", "cmsis", true, NULL, convert_cmsis },
+    { "convert", "vector", true, NULL, convert_vector },
+    { "add", "scalar", false, NULL, add_scalar },
+    { "add", "cmsis", false, NULL, add_cmsis },
+    { "add", "vector", false, NULL, add_vector },
+    { "scale", "scalar", false, NULL, scale_scalar },
+    { "scale", "cmsis", false, NULL, scale_cmsis },
+    { "scale", "vector", false, NULL, scale_vector },
+    { "window", "scalar", false, NULL, window_scalar },
+    { "window", "cmsis", false, NULL, window_cmsis },
+    { "window", "vector", false, NULL, window_vector },
+    { "rfft", "cmsis", false, rfft_setup, rfft_cmsis }
+};
+
+/*******************************************************************************
+ * Function Name: bench_now
+ ******************************************************************************/
+static inline uint32_t bench_now(void)
+{
+#if defined(PRESENCE_HOST_BUILD)
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)(((uint64_t)now.tv_sec * 1000000000ULL) + (uint64_t)now.tv_nsec);
+#else
+    return cycle_counter_get();
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: fill_inputs
+ *******************************************************************************
+ * Summary:
+ *   Fills the inputs with ADC-like values, the same for every variant.
+ ******************************************************************************/
+static void fill_inputs(void)
+{
+    uint32_t state = 0x12345678u;
+
+    for (uint32_t i = 0; i < DSP_BENCH_MAX_FRAME; ++i)
+    {
+        state = (state * 1664525u) + 1013904223u;
+        raw[i] = (uint16_t)(state >> 20);
+        in_a[i] = (float32_t)raw[i] / 4096.0F;
+        in_b[i] = (float32_t)(state & 0xFFFu) / 4096.0F;
+    }
+
+    for (uint32_t i = 0; i < DSP_BENCH_MAX_CHIRP; ++i)
+    {
+        window[i] = 0.5F - (0.5F * cosf((2.0F * (float32_t)PI * (float32_t)i) / (float32_t)DSP_BENCH_MAX_CHIRP));
+    }
+}
+
+/*******************************************************************************
+ * Function Name: add_size
+ *******************************************************************************
+ * Summary:
+ *   Inserts a length into a sorted list without duplicates.
+ ******************************************************************************/
+static void add_size(uint32_t *sizes, uint32_t *count, uint32_t n)
+{
+    uint32_t i = 0;
+
+    while ((i < *count) && (sizes[i] < n))
+    {
+        i++;
+    }
+    if (((i < *count) && (sizes[i] == n)) || (*count == DSP_BENCH_MAX_SIZES))
+    {
+        return;
+    }
+
+    memmove(&sizes[i + 1u], &sizes[i], (*count - i) * sizeof(sizes[0]));
+    sizes[i] = n;
+    (*count)++;
+}
+
+/*******************************************************************************
+ * Function Name: check_output
+ *******************************************************************************
+ * Summary:
+ *   Compares the output of a variant with the output of the scalar variant
+ *   of the same kernel for the same inputs.
+ *
+ * Return:
+ *   true if equal within DSP_BENCH_TOLERANCE, or if the kernel has no
+ *   scalar variant
+ ******************************************************************************/
+static bool check_output(const dsp_bench_case_t *bench_case, uint32_t n)
+{
+    const dsp_bench_case_t *scalar = NULL;
+
+    for (size_t c = 0; c < (sizeof(cases) / sizeof(cases[0])); ++c)
+    {
+        if ((strcmp(cases[c].kernel, bench_case->kernel) == 0) && (strcmp(cases[c].variant, "scalar") == 0))
+        {
+            scalar = &cases[c];
+        }
+    }
+    if ((scalar == NULL) || (scalar == bench_case))
+    {
+        return true;
+    }
+
+    fill_inputs();
+    scalar->run(n);
+    memcpy(ref, out, n * sizeof(out[0]));
+
+    fill_inputs();
+    bench_case->run(n);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        if (fabsf(out[i] - ref[i]) > (DSP_BENCH_TOLERANCE * (fabsf(ref[i]) + 1.0F)))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: dsp_bench_run
+ *******************************************************************************
+ * Summary:
+ *   Runs every kernel variant over the chirp or frame lengths. A case is
+ *   timed in DSP_BENCH_REPEATS blocks of about DSP_BENCH_BLOCK_SAMPLES
+ *   samples, and the fastest block is reported.
+ *
+ * Parameters:
+ *   report: called with the result of each case
+ *   context: passed to 'report'
+ *
+ * Return:
+ *   Number of cases whose output differs from the scalar variant
+ ******************************************************************************/
+uint32_t dsp_bench_run(dsp_bench_report_fn_t report, void *context)
+{
+    uint32_t chirp_sizes[DSP_BENCH_MAX_SIZES];
+    uint32_t frame_sizes[DSP_BENCH_MAX_SIZES];
+    uint32_t num_chirp_sizes = 0;
+    uint32_t num_frame_sizes = 0;
+    uint32_t mismatches = 0;
+
+#if !defined(PRESENCE_HOST_BUILD)
+    cycle_counter_init();
+#endif
+
+    add_size(chirp_sizes, &num_chirp_sizes, XENSIV_BGT60TRXX_CONF_NUM_SAMPLES_PER_CHIRP);
+    for (uint32_t n = 32u; n <= DSP_BENCH_MAX_CHIRP; n *= 2u)
+    {
+        add_size(chirp_sizes, &num_chirp_sizes, n);
+    }
+    add_size(frame_sizes, &num_frame_sizes, RADAR_SETTINGS_NUM_SAMPLES_PER_FRAME);
+    for (uint32_t n = DSP_BENCH_MIN_FRAME; n <= DSP_BENCH_MAX_FRAME; n *= 2u)
+    {
+        add_size(frame_sizes, &num_frame_sizes, n);
+    }
+
+    for (size_t c = 0; c < (sizeof(cases) / sizeof(cases[0])); ++c)
+    {
+        const dsp_bench_case_t *bench_case = &cases[c];
+        const uint32_t *sizes = bench_case->frame_sized ? frame_sizes : chirp_sizes;
+        uint32_t num_sizes = bench_case->frame_sized ? num_frame_sizes : num_chirp_sizes;
+
+        for (uint32_t s = 0; s < num_sizes; ++s)
+        {
+            uint32_t n = sizes[s];
+            uint32_t calls = (DSP_BENCH_BLOCK_SAMPLES + n - 1u) / n;
+            uint32_t best = UINT32_MAX;
+            dsp_bench_result_t result;
+
+            if ((bench_case->setup != NULL) && !bench_case->setup(n))
+            {
+                continue;
+            }
+
+            result.match = check_output(bench_case, n);
+            fill_inputs();
+
+            for (uint32_t r = 0; r < DSP_BENCH_REPEATS; ++r)
+            {
+                uint32_t start = bench_now();
+
+                for (uint32_t i = 0; i < calls; ++i)
+                {
+                    bench_case->run(n);
+                }
+
+                uint32_t elapsed = bench_now() - start;
+                best = (elapsed < best) ? elapsed : best;
+            }
+
+            result.kernel = bench_case->kernel;
+            result.variant = bench_case->variant;
+            result.n = n;
+            result.per_sample = (float)best / ((float)calls * (float)n);
+            mismatches += result.match ? 0u : 1u;
+            report(&result, context);
+        }
+    }
+
+    return mismatches;
+}
+
+/*******************************************************************************
+ * Function Name: dsp_bench_print
+ *******************************************************************************
+ * Summary:
+ *   Prints a result as one line that scripts/dsp_bench_compare.py reads
+ *   from the UART log. The value is printed as a fixed-point number, as
+ *   the printf of newlib-nano has no float support.
+ ******************************************************************************/
+void dsp_bench_print(const dsp_bench_result_t *result, void *context)
+{
+    uint32_t hundredths = (uint32_t)((result->per_sample * 100.0F) + 0.5F);
+
+    (void)context;
+    printf("dsp_bench: %s %s %lu %lu.%02lu %s%s\n", result->kernel, result->variant, (unsigned long)result->n,
+           (unsigned long)(hundredths / 100u), (unsigned long)(hundredths % 100u), DSP_BENCH_UNIT,
+           result->match ? "" : " mismatch");
+}
+
+#endif /* DSP_BENCH_ENABLE */
+
+/* [] END OF FILE */
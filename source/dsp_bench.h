@@ -0,0 +1,84 @@
+/******************************************************************************
+ * File Name:   dsp_bench.h
+ *
+ * Description: This file contains the microbenchmarks of the DSP kernels of the
+ *              radar frame processing.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef DSP_BENCH_H_
+#define DSP_BENCH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Set this macro to 1 to run the kernel benchmarks at start-up, before the
+ * scheduler, and print the results on the debug UART. The benchmarks take
+ * a few seconds; the application starts normally afterwards. When 0,
+ * dsp_bench.c compiles to nothing.
+ */
+#ifndef DSP_BENCH_ENABLE
+#define DSP_BENCH_ENABLE            (0)
+#endif
+
+/* Timed blocks per case, the fastest one is reported so that interrupts
+ * and cache misses of a single block do not count
+ */
+#define DSP_BENCH_REPEATS           (5u)
+
+/* Samples processed per timed block, calls are repeated up to this */
+#define DSP_BENCH_BLOCK_SAMPLES     (32768u)
+
+/* Unit of the measurements: DWT cycles on the target, nanoseconds of the
+ * monotonic clock on the host
+ */
+#if defined(PRESENCE_HOST_BUILD)
+#define DSP_BENCH_UNIT              "ns"
+#else
+#define DSP_BENCH_UNIT              "cycles"
+#endif
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    const char *kernel;
+    const char *variant;        /* "scalar", "cmsis" or "vector" */
+    uint32_t n;                 /* Samples per call */
+    float per_sample;           /* DSP_BENCH_UNIT per sample */
+    bool match;                 /* Output equal to the scalar variant */
+} dsp_bench_result_t;
+
+typedef void (*dsp_bench_report_fn_t)(const dsp_bench_result_t *result, void *context);
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+uint32_t dsp_bench_run(dsp_bench_report_fn_t report, void *context);
+void dsp_bench_print(const dsp_bench_result_t *result, void *context);
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,506 @@
+/******************************************************************************
+ * File Name:   event_log.c
+ *
+ * Description: Store-and-forward log of the presence events in flash.
+ *              The log is a ring of flash rows. The row being appended is kept in
+ *              RAM and written after each event, and the ring moves on to the next
+ *              row when it is full, so that the writes spread over all rows. Rows
+ *              are erased once their events have been replayed. When the ring is
+ *              full, the log is compacted to the latest state.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "cyhal.h"
+#include "rtos_artifacts.h"
+
+#include "event_log.h"
+#include "payload_writer.h"
+
+#if EVENT_LOG_ENABLE
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define ROW_MAGIC                       (0x32474C45u)   /* "ELG2", rows of the first layout are ignored */
+#define RECORDS_PER_ROW                 ((EVENT_LOG_ROW_SIZE - sizeof(row_header_t)) / sizeof(event_log_record_t))
+#define NO_ROW                          (0xFFFFFFFFu)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    uint32_t magic;
+    uint32_t row_seq;           /* Increases with each row started */
+    uint16_t count;             /* Events in the row */
+    uint16_t check;             /* Fletcher-16 of the fields above and the events */
+} row_header_t;
+
+/* A flash row as written by cyhal_flash_write(), which takes words */
+typedef union
+{
+    uint32_t words[EVENT_LOG_ROW_SIZE / sizeof(uint32_t)];
+    struct
+    {
+        row_header_t header;
+        event_log_record_t records[(EVENT_LOG_ROW_SIZE - sizeof(row_header_t)) / sizeof(event_log_record_t)];
+    } row;
+} row_image_t;
+
+_Static_assert(sizeof(event_log_record_t) == 20u, "Records are stored as they are");
+_Static_assert((EVENT_LOG_NUM_ROWS >= 2u) && ((EVENT_LOG_FLASH_SIZE % EVENT_LOG_ROW_SIZE) == 0u),
+               "The log needs whole rows");
+
+/*******************************************************************************
+ * Local Variables
+ ******************************************************************************/
+static cyhal_flash_t flash;
+static bool ready;
+
+/* Row being appended, and its copy in RAM */
+static uint32_t head_row;
+static row_image_t head_image;
+
+/* Oldest row with events to replay, and the next event in it */
+static uint32_t tail_row;
+static uint32_t tail_index;
+static row_image_t tail_image;
+static uint32_t tail_image_row = NO_ROW;
+
+/* Events in each row of the ring */
+static uint16_t row_counts[EVENT_LOG_NUM_ROWS];
+
+static uint32_t next_row_seq;
+static event_log_stats_t stats;
+
+/*******************************************************************************
+ * Function Name: row_address
+ ******************************************************************************/
+static uint32_t row_address(uint32_t row)
+{
+    return EVENT_LOG_FLASH_ADDRESS + (row * EVENT_LOG_ROW_SIZE);
+}
+
+/*******************************************************************************
+ * Function Name: row_check
+ *******************************************************************************
+ * Summary:
+ *   Fletcher-16 of a row, from the sequence numbers to its last event. A
+ *   row whose write was cut short by a reset does not pass.
+ ******************************************************************************/
+static uint16_t row_check(const row_image_t *image)
+{
+    const uint8_t *bytes = (const uint8_t *)&image->row.header.row_seq;
+    size_t len = offsetof(row_header_t, check) - offsetof(row_header_t, row_seq);
+    const uint8_t *records = (const uint8_t *)image->row.records;
+    size_t records_len = image->row.header.count * sizeof(event_log_record_t);
+    uint32_t sum1 = 0u;
+    uint32_t sum2 = 0u;
+
+    for (size_t i = 0; i < (len + records_len); ++i)
+    {
+        sum1 = (sum1 + ((i < len) ? bytes[i] : records[i - len])) % 255u;
+        sum2 = (sum2 + sum1) % 255u;
+    }
+
+    return (uint16_t)((sum2 << 8) | sum1);
+}
+
+/*******************************************************************************
+ * Function Name: read_row
+ *******************************************************************************
+ * Summary:
+ *   Reads a row and checks it.
+ *
+ * Return:
+ *   True if the row holds a valid part of the log
+ ******************************************************************************/
+static bool read_row(uint32_t row, row_image_t *image)
+{
+    if (cyhal_flash_read(&flash, row_address(row), (uint8_t *)image->words, sizeof(image->words)) != CY_RSLT_SUCCESS)
+    {
+        stats.flash_errors++;
+        return false;
+    }
+
+    return (image->row.header.magic == ROW_MAGIC) &&
+           (image->row.header.count <= RECORDS_PER_ROW) &&
+           (image->row.header.check == row_check(image));
+}
+
+/*******************************************************************************
+ * Function Name: write_head
+ *******************************************************************************
+ * Summary:
+ *   Writes the RAM copy of the head row to flash.
+ ******************************************************************************/
+static bool write_head(void)
+{
+    head_image.row.header.check = row_check(&head_image);
+    stats.row_writes++;
+
+    if (cyhal_flash_write(&flash, row_address(head_row), head_image.words) != CY_RSLT_SUCCESS)
+    {
+        stats.flash_errors++;
+        return false;
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: erase_row
+ ******************************************************************************/
+static void erase_row(uint32_t row)
+{
+    if (cyhal_flash_erase(&flash, row_address(row)) != CY_RSLT_SUCCESS)
+    {
+        stats.flash_errors++;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: start_head
+ *******************************************************************************
+ * Summary:
+ *   Starts a new, empty head row in RAM. It is written with its first event.
+ ******************************************************************************/
+static void start_head(uint32_t row)
+{
+    memset(&head_image, 0, sizeof(head_image));
+    row_counts[row] = 0u;
+    head_image.row.header.magic = ROW_MAGIC;
+    head_image.row.header.row_seq = next_row_seq++;
+    head_row = row;
+}
+
+/*******************************************************************************
+ * Function Name: event_log_init
+ *******************************************************************************
+ * Summary:
+ *   Opens the log and recovers the events not replayed before a reset: the
+ *   chain of valid rows with consecutive row numbers that ends at the row
+ *   with the highest number. Rows outside the chain are erased.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   True if the log can be used
+ ******************************************************************************/
+bool event_log_init(void)
+{
+    static uint32_t row_seqs[EVENT_LOG_NUM_ROWS];
+    static bool valid[EVENT_LOG_NUM_ROWS];
+    cyhal_flash_info_t info;
+    const cyhal_flash_block_info_t *block = NULL;
+    uint32_t newest = NO_ROW;
+    uint32_t row;
+
+    if ((cyhal_flash_init(&flash) != CY_RSLT_SUCCESS))
+    {
+        return false;
+    }
+
+    cyhal_flash_get_info(&flash, &info);
+    for (uint32_t i = 0; i < info.block_count; ++i)
+    {
+        if ((EVENT_LOG_FLASH_ADDRESS >= info.blocks[i].start_address) &&
+            ((EVENT_LOG_FLASH_ADDRESS + EVENT_LOG_FLASH_SIZE) <= (info.blocks[i].start_address + info.blocks[i].size)))
+        {
+            block = &info.blocks[i];
+        }
+    }
+
+    if ((block == NULL) || (block->page_size != EVENT_LOG_ROW_SIZE))
+    {
+        printf("[WARN] event log: no flash rows of %u bytes at 0x%08" PRIx32 "\n",
+               (unsigned)EVENT_LOG_ROW_SIZE, (uint32_t)EVENT_LOG_FLASH_ADDRESS);
+        return false;
+    }
+
+    for (row = 0; row < EVENT_LOG_NUM_ROWS; ++row)
+    {
+        valid[row] = read_row(row, &tail_image);
+        row_seqs[row] = tail_image.row.header.row_seq;
+        if (valid[row] && ((newest == NO_ROW) || (row_seqs[row] > row_seqs[newest])))
+        {
+            newest = row;
+        }
+    }
+
+    next_row_seq = 1u;
+    if (newest == NO_ROW)
+    {
+        start_head(0u);
+        tail_row = 0u;
+    }
+    else
+    {
+        (void)read_row(newest, &head_image);
+        head_row = newest;
+        next_row_seq = head_image.row.header.row_seq + 1u;
+        row_counts[newest] = head_image.row.header.count;
+        stats.backlog = row_counts[newest];
+        valid[newest] = false;
+
+        /* Walk back along the chain to the oldest row. */
+        tail_row = newest;
+        row = (newest + EVENT_LOG_NUM_ROWS - 1u) % EVENT_LOG_NUM_ROWS;
+        while ((row != newest) && valid[row] && (row_seqs[row] == (row_seqs[tail_row] - 1u)))
+        {
+            (void)read_row(row, &tail_image);
+            row_counts[row] = tail_image.row.header.count;
+            stats.backlog += row_counts[row];
+            valid[row] = false;
+            tail_row = row;
+            row = (row + EVENT_LOG_NUM_ROWS - 1u) % EVENT_LOG_NUM_ROWS;
+        }
+
+        for (row = 0; row < EVENT_LOG_NUM_ROWS; ++row)
+        {
+            if (valid[row])
+            {
+                erase_row(row);
+            }
+        }
+    }
+
+    tail_index = 0u;
+    tail_image_row = NO_ROW;
+    ready = true;
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: event_log_append
+ *******************************************************************************
+ * Summary:
+ *   Appends an event to the log. When the ring is full, the events waiting
+ *   for their replay are dropped and the log keeps only this one, the
+ *   latest state, with the count of the dropped events. Called by the
+ *   publisher task only, like the other functions that change the log.
+ *
+ * Parameters:
+ *   event: event that could not be published
+ *
+ * Return:
+ *   True if the event is in flash
+ ******************************************************************************/
+bool event_log_append(const presence_event_t *event)
+{
+    event_log_record_t *record;
+    uint32_t next_row;
+    uint32_t dropped = 0u;
+
+    if (!ready)
+    {
+        return false;
+    }
+
+    if (head_image.row.header.count == RECORDS_PER_ROW)
+    {
+        next_row = (head_row + 1u) % EVENT_LOG_NUM_ROWS;
+        if ((stats.backlog > 0u) && (next_row == tail_row))
+        {
+            /* Compaction: erase the ring, the new event starts it again. */
+            dropped = stats.backlog;
+            for (uint32_t row = 0; row < EVENT_LOG_NUM_ROWS; ++row)
+            {
+                if (row != next_row)
+                {
+                    erase_row(row);
+                }
+            }
+            stats.compacted += dropped;
+            stats.backlog = 0u;
+            tail_row = next_row;
+            tail_index = 0u;
+            tail_image_row = NO_ROW;
+        }
+        start_head(next_row);
+    }
+
+    record = &head_image.row.records[head_image.row.header.count];
+    record->seq = event->seq;
+    record->timestamp_ms = event->timestamp_ms;
+    record->frame = event->frame;
+    record->range_mm = event->range_mm;
+    record->state = (uint8_t)event->state;
+    record->reserved = 0u;
+    record->compacted = (dropped > UINT16_MAX) ? UINT16_MAX : (uint16_t)dropped;
+
+    head_image.row.header.count++;
+    row_counts[head_row] = head_image.row.header.count;
+    stats.logged++;
+    stats.backlog++;
+
+    return write_head();
+}
+
+/*******************************************************************************
+ * Function Name: event_log_peek
+ *******************************************************************************
+ * Summary:
+ *   Returns the oldest event that has not been replayed.
+ *
+ * Parameters:
+ *   record: set to the event
+ *
+ * Return:
+ *   False if the log is empty
+ ******************************************************************************/
+bool event_log_peek(event_log_record_t *record)
+{
+    if (!ready)
+    {
+        return false;
+    }
+
+    /* A row that cannot be read back is skipped with its events. */
+    while ((stats.backlog > 0u) && (tail_row != head_row) && (tail_image_row != tail_row))
+    {
+        if (read_row(tail_row, &tail_image))
+        {
+            tail_image_row = tail_row;
+        }
+        else
+        {
+            stats.backlog -= (uint32_t)row_counts[tail_row] - tail_index;
+            erase_row(tail_row);
+            tail_row = (tail_row + 1u) % EVENT_LOG_NUM_ROWS;
+            tail_index = 0u;
+        }
+    }
+
+    if (stats.backlog == 0u)
+    {
+        return false;
+    }
+
+    *record = ((tail_row == head_row) ? &head_image : &tail_image)->row.records[tail_index];
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: event_log_pop
+ *******************************************************************************
+ * Summary:
+ *   Takes the event returned by event_log_peek() out of the log once it has
+ *   been replayed. A row is erased after its last event; the head row is
+ *   written empty, so that the ring goes on from there after a reset.
+ ******************************************************************************/
+void event_log_pop(void)
+{
+    if (!ready || (stats.backlog == 0u))
+    {
+        return;
+    }
+
+    tail_index++;
+    stats.replayed++;
+    stats.backlog--;
+
+    if (tail_index < row_counts[tail_row])
+    {
+        return;
+    }
+
+    tail_index = 0u;
+    if (tail_row != head_row)
+    {
+        erase_row(tail_row);
+        tail_row = (tail_row + 1u) % EVENT_LOG_NUM_ROWS;
+    }
+    else
+    {
+        start_head(head_row);
+        (void)write_head();
+    }
+}
+
+/*******************************************************************************
+ * Function Name: event_log_format
+ *******************************************************************************
+ * Summary:
+ *   Writes the payload of a logged event in the format of the events
+ *   topic, with the members of presence_event_begin() and, for example,
+ *   "replayed": true. "compacted" is added when events were dropped
+ *   before this one.
+ *
+ * Parameters:
+ *   record: logged event
+ *   replayed: true for an event published in the replay of the log
+ *   payload: buffer for the payload
+ *   payload_size: size of the buffer
+ *
+ * Return:
+ *   Length of the payload, 0 if it does not fit
+ ******************************************************************************/
+size_t event_log_format(const event_log_record_t *record, bool replayed, void *payload, size_t payload_size)
+{
+    payload_writer_t writer;
+    presence_event_t event =
+    {
+        .seq = record->seq,
+        .timestamp_ms = record->timestamp_ms,
+        .frame = record->frame,
+        .range_mm = record->range_mm,
+        .state = (presence_event_state_t)record->state
+    };
+
+    payload_writer_init(&writer, PAYLOAD_FORMAT, payload, payload_size);
+    presence_event_begin(&writer, &event, ((record->compacted != 0u) ? 1u : 0u) + (replayed ? 1u : 0u));
+    if (record->compacted != 0u)
+    {
+        payload_key(&writer, "compacted");
+        payload_uint(&writer, record->compacted);
+    }
+    if (replayed)
+    {
+        payload_key(&writer, "replayed");
+        payload_bool(&writer, true);
+    }
+    payload_end(&writer);
+
+    return payload_writer_finish(&writer);
+}
+
+/*******************************************************************************
+ * Function Name: event_log_get_stats
+ ******************************************************************************/
+void event_log_get_stats(event_log_stats_t *log_stats)
+{
+    taskENTER_CRITICAL();
+    *log_stats = stats;
+    taskEXIT_CRITICAL();
+}
+
+#endif /* EVENT_LOG_ENABLE */
+
+/* [] END OF FILE */
@@ -0,0 +1,99 @@
+/******************************************************************************
+ * File Name:   event_log.h
+ *
+ * Description: Store-and-forward log of the presence events in flash.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef EVENT_LOG_H_
+#define EVENT_LOG_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "publisher_task.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Set this macro to 1 to keep the presence events in flash while the MQTT
+ * connection is down and to replay them once it is up again.
+ */
+#ifndef EVENT_LOG_ENABLE
+#define EVENT_LOG_ENABLE                (0)
+#endif
+
+/* Flash region of the log: the first half of the 32 KB work flash of the
+ * PSoC 6, erased and written one row at a time.
+ */
+#ifndef EVENT_LOG_FLASH_ADDRESS
+#define EVENT_LOG_FLASH_ADDRESS         (0x14000000u)
+#endif
+#ifndef EVENT_LOG_FLASH_SIZE
+#define EVENT_LOG_FLASH_SIZE            (16u * 1024u)
+#endif
+#define EVENT_LOG_ROW_SIZE              (512u)
+#define EVENT_LOG_NUM_ROWS              (EVENT_LOG_FLASH_SIZE / EVENT_LOG_ROW_SIZE)
+
+/* Interval between two replayed events, so that the live events are not
+ * held up behind the backlog.
+ */
+#define EVENT_LOG_REPLAY_INTERVAL_MS    (250u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+/* The fields of presence_event_t, in a fixed layout for the flash rows */
+typedef struct
+{
+    uint32_t seq;               /* Sequence number of the event, not of the log */
+    uint32_t timestamp_ms;      /* Time of the event, presence library time base */
+    uint32_t frame;
+    int32_t range_mm;
+    uint8_t state;              /* presence_event_state_t */
+    uint8_t reserved;
+    uint16_t compacted;         /* Events dropped before this one when the log was full */
+} event_log_record_t;
+
+typedef struct
+{
+    uint32_t logged;            /* Events appended */
+    uint32_t replayed;          /* Events taken out after their replay */
+    uint32_t compacted;         /* Events dropped when the log was full */
+    uint32_t row_writes;        /* Rows erased and programmed */
+    uint32_t flash_errors;
+    uint32_t backlog;           /* Events waiting for their replay */
+} event_log_stats_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+bool event_log_init(void);
+bool event_log_append(const presence_event_t *event);
+bool event_log_peek(event_log_record_t *record);
+void event_log_pop(void);
+size_t event_log_format(const event_log_record_t *record, bool replayed, void *payload, size_t payload_size);
+void event_log_get_stats(event_log_stats_t *stats);
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,149 @@
+/******************************************************************************
+ * File Name:   latency_trace.c
+ *
+ * Description: This file keeps the timestamps of the presence events in flight
+ *              to the broker, see latency_trace.h.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#include "latency_trace.h"
+
+#if LATENCY_TRACE_ENABLE
+
+/* Header file from system */
+#include <stdbool.h>
+#include <string.h>
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+/* Written by the interrupt handler, read by the radar task */
+static volatile uint32_t irq_ticks;
+
+/* Each hop of a record is written by one task, in the order of the hops;
+ * the record is read once the event has arrived at the subscriber.
+ */
+static latency_trace_record_t records[LATENCY_TRACE_SLOTS];
+static uint32_t next_id = 1;
+
+/*******************************************************************************
+ * Function Name: latency_trace_irq
+ *******************************************************************************
+ * Summary:
+ *   Stamps the FIFO interrupt. Called from the interrupt handler; the
+ *   frames read after the interrupt inherit the stamp.
+ ******************************************************************************/
+void latency_trace_irq(void)
+{
+    irq_ticks = latency_trace_now();
+}
+
+/*******************************************************************************
+ * Function Name: latency_trace_begin
+ *******************************************************************************
+ * Summary:
+ *   Starts the trace of a presence event, with the interrupt of the frame
+ *   that raised it. Called from the presence callback in the radar task.
+ *
+ * Return:
+ *   Trace ID, never 0
+ ******************************************************************************/
+uint32_t latency_trace_begin(void)
+{
+    uint32_t id = next_id;
+    latency_trace_record_t *record = &records[id % LATENCY_TRACE_SLOTS];
+
+    next_id = (id == UINT32_MAX) ? 1u : (id + 1u);
+
+    memset(record->ticks, 0, sizeof(record->ticks));
+    record->ticks[LATENCY_TRACE_IRQ] = irq_ticks;
+    record->ticks[LATENCY_TRACE_DETECTED] = latency_trace_now();
+    __atomic_store_n(&record->id, id, __ATOMIC_RELEASE);
+
+    return id;
+}
+
+/*******************************************************************************
+ * Function Name: latency_trace_stamp
+ *******************************************************************************
+ * Summary:
+ *   Stamps a hop of a trace. Stamps of traces whose slot has been reused,
+ *   and of messages without trace (ID 0), are ignored.
+ *
+ * Parameters:
+ *   id: trace ID
+ *   hop: reached hop
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void latency_trace_stamp(uint32_t id, latency_trace_hop_t hop)
+{
+    latency_trace_record_t *record = &records[id % LATENCY_TRACE_SLOTS];
+
+    if ((id != 0u) && (__atomic_load_n(&record->id, __ATOMIC_ACQUIRE) == id))
+    {
+        record->ticks[hop] = latency_trace_now();
+    }
+}
+
+/*******************************************************************************
+ * Function Name: latency_trace_take
+ *******************************************************************************
+ * Summary:
+ *   Copies the stamps of a trace and frees its slot. Called by the test
+ *   subscriber after stamping LATENCY_TRACE_DELIVERED.
+ *
+ * Parameters:
+ *   id: trace ID
+ *   record: set to the stamps of the trace
+ *
+ * Return:
+ *   0 on success, -1 if the slot has been reused by a later trace
+ ******************************************************************************/
+int latency_trace_take(uint32_t id, latency_trace_record_t *record)
+{
+    latency_trace_record_t *slot = &records[id % LATENCY_TRACE_SLOTS];
+
+    if ((id == 0u) || (__atomic_load_n(&slot->id, __ATOMIC_ACQUIRE) != id))
+    {
+        return -1;
+    }
+
+    *record = *slot;
+    return (__atomic_compare_exchange_n(&slot->id, &id, 0u, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) ? 0 : -1;
+}
+
+/*******************************************************************************
+ * Function Name: latency_trace_started
+ *******************************************************************************
+ * Summary:
+ *   Returns the number of traces started so far.
+ ******************************************************************************/
+uint32_t latency_trace_started(void)
+{
+    return next_id - 1u;
+}
+
+#endif /* LATENCY_TRACE_ENABLE */
+
+/* [] END OF FILE */
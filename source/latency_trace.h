@@ -0,0 +1,119 @@
+/******************************************************************************
+ * File Name:   latency_trace.h
+ *
+ * Description: This file provides compile time enabled timestamps of a presence
+ *              event at each hop from the sensor interrupt to the MQTT publish.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef LATENCY_TRACE_H_
+#define LATENCY_TRACE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Set this macro to 1 to stamp presence events on their way to the broker.
+ * The events then carry a "trace" member with the trace ID. When it is 0,
+ * the stamps compile to nothing.
+ */
+#ifndef LATENCY_TRACE_ENABLE
+#define LATENCY_TRACE_ENABLE                (0)
+#endif
+
+/* Events in flight whose stamps are kept */
+#define LATENCY_TRACE_SLOTS                 (32u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef enum
+{
+    LATENCY_TRACE_IRQ,                  /* FIFO interrupt of the frame */
+    LATENCY_TRACE_DETECTED,             /* presence_detection_cb() */
+    LATENCY_TRACE_QUEUED,               /* Sent to a publisher lane */
+    LATENCY_TRACE_DEQUEUED,             /* Received by the publisher task */
+    LATENCY_TRACE_PUBLISHED,            /* cy_mqtt_publish() returned */
+    LATENCY_TRACE_DELIVERED,            /* Arrived at a test subscriber */
+    LATENCY_TRACE_NUM_HOPS
+} latency_trace_hop_t;
+
+typedef struct
+{
+    uint32_t id;                        /* 0 for a free slot */
+    uint32_t ticks[LATENCY_TRACE_NUM_HOPS];
+} latency_trace_record_t;
+
+/*******************************************************************************
+ * Stamps
+ ******************************************************************************/
+#if LATENCY_TRACE_ENABLE
+
+#if defined(PRESENCE_HOST_BUILD)
+#include <time.h>
+
+/* Monotonic time in microseconds, shared by all tasks and threads */
+#define LATENCY_TRACE_TICKS_PER_US          (1u)
+
+static inline uint32_t latency_trace_now(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)(((uint64_t)now.tv_sec * 1000000u) + ((uint64_t)now.tv_nsec / 1000u));
+}
+#else
+#include "cycle_counter.h"
+
+/* The DWT cycle counter wraps after 2^32 cycles, 42 s at 100 MHz, which
+ * bounds the latency that can be measured.
+ */
+#define LATENCY_TRACE_TICKS_PER_US          (SystemCoreClock / 1000000u)
+
+static inline uint32_t latency_trace_now(void)
+{
+    return cycle_counter_get();
+}
+#endif
+
+#define LATENCY_TRACE_IRQ_STAMP()           latency_trace_irq()
+#define LATENCY_TRACE_BEGIN(msg)            ((msg).trace_id = latency_trace_begin())
+#define LATENCY_TRACE_STAMP(msg, hop)       latency_trace_stamp((msg).trace_id, (hop))
+
+void latency_trace_irq(void);
+uint32_t latency_trace_begin(void);
+void latency_trace_stamp(uint32_t id, latency_trace_hop_t hop);
+int latency_trace_take(uint32_t id, latency_trace_record_t *record);
+uint32_t latency_trace_started(void);
+
+#else
+
+#define LATENCY_TRACE_IRQ_STAMP()           ((void)0)
+#define LATENCY_TRACE_BEGIN(msg)            ((void)0)
+#define LATENCY_TRACE_STAMP(msg, hop)       ((void)0)
+
+#endif
+
+#endif
+/* [] END OF FILE */
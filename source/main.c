@@ -42,6 +42,7 @@
 #include "cyhal.h"
 #include "cybsp.h"
 #include "cy_retarget_io.h"
+#include "dsp_bench.h"
 #include "mqtt_task.h"
 #include "rtos_artifacts.h"
 
@@ -83,6 +84,13 @@ int main()
     printf("MQTT client: Human Presence Detection\n");
     printf("===============================================================\n\n");
 
+#if DSP_BENCH_ENABLE
+    /* Time the DSP kernels before the tasks and interrupts of the
+     * application compete for the CPU.
+     */
+    (void)dsp_bench_run(dsp_bench_print, NULL);
+#endif
+
     /* Create the MQTT Client task. */
     xTaskCreate(mqtt_client_task, "MQTT Client task", MQTT_CLIENT_TASK_STACK_SIZE,
                 NULL, MQTT_CLIENT_TASK_PRIORITY, NULL);
@@ -53,7 +53,11 @@
 #include "mqtt_task.h"
 #include "subscriber_task.h"
 #include "publisher_task.h"
+#include "publisher_lanes.h"
+#include "publisher_window.h"
+#include "mqtt_topics.h"
 #include "radar_task.h"
+#include "power_stats.h"
 
 /* Configuration file for Wi-Fi and MQTT client */
 #include "wifi_config.h"
@@ -177,6 +181,9 @@ void mqtt_client_task(void *pvParameters)
     /* Create a message queue to communicate with other tasks and callbacks. */
     mqtt_task_q = xQueueCreate(MQTT_TASK_QUEUE_LENGTH, sizeof(mqtt_task_cmd_t));
 
+    /* Build the topics of the device before the tasks that use them start. */
+    mqtt_topics_init();
+
     /* Initialize the Wi-Fi Connection Manager and jump to the cleanup block 
      * upon failure.
      */
@@ -265,7 +272,7 @@ void mqtt_client_task(void *pvParameters)
                 {
                     /* Deinit the publisher before initiating reconnections. */
                     publisher_q_data.cmd = PUBLISHER_DEINIT;
-                    xQueueSend(publisher_task_q, &publisher_q_data, portMAX_DELAY);
+                    (void)publisher_lanes_send(publisher_data, portMAX_DELAY);
 
                     /* Although the connection with the MQTT Broker is lost, 
                      * call the MQTT disconnect API for cleanup of threads and 
@@ -298,7 +305,7 @@ void mqtt_client_task(void *pvParameters)
 
                     /* Initialize Publisher post the reconnection. */
                     publisher_q_data.cmd = PUBLISHER_INIT;
-                    xQueueSend(publisher_task_q, &publisher_data, portMAX_DELAY);
+                    (void)publisher_lanes_send(publisher_data, portMAX_DELAY);
                     break;
                 }
 
@@ -322,6 +329,7 @@ void mqtt_client_task(void *pvParameters)
     if (publisher_task_handle != NULL)
     {
         vTaskDelete(publisher_task_handle);
+        publisher_window_deinit();
     }
 
     if (radar_task_handle != NULL)
@@ -396,6 +404,7 @@ static cy_rslt_t wifi_connect(void)
             printf("Connection to Wi-Fi network failed with error code 0x%0X. Retrying in %d ms. Retries left: %d\n",
                 (int)result, WIFI_CONN_RETRY_INTERVAL_MS, (int)(MAX_WIFI_CONN_RETRIES - retry_count - 1));
             vTaskDelay(pdMS_TO_TICKS(WIFI_CONN_RETRY_INTERVAL_MS));
+            power_stats_timed_wakeup();
         }
 
         printf("\nExceeded maximum Wi-Fi connection attempts!\n");
@@ -532,6 +541,7 @@ static cy_rslt_t mqtt_connect(void)
         printf("MQTT connection failed with error code 0x%0X. Retrying in %d ms. Retries left: %d\n", 
                (int)result, MQTT_CONN_RETRY_INTERVAL_MS, (int)(MAX_MQTT_CONN_RETRIES - retry_count - 1));
         vTaskDelay(pdMS_TO_TICKS(MQTT_CONN_RETRY_INTERVAL_MS));
+        power_stats_timed_wakeup();
     }
 
     printf("\nExceeded maximum MQTT connection attempts\n");
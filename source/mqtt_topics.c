@@ -0,0 +1,176 @@
+/******************************************************************************
+ * File Name:   mqtt_topics.c
+ *
+ * Description: Topic table of the device: the topic names of mqtt_client_config.h,
+ *              optionally in a namespace of the unique silicon ID, built once at boot.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "cyhal.h"
+#include "cybsp.h"
+
+#include "mqtt_topics.h"
+#include "payload_writer.h"
+#include "mqtt_client_config.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Length of '<prefix>/<device ID>/<name>', sizeof() counting the NULs */
+#define DEVICE_TOPIC_LEN(name)          (sizeof(MQTT_TOPIC_PREFIX) + MQTT_TOPICS_DEVICE_ID_LEN + sizeof(name))
+
+_Static_assert(DEVICE_TOPIC_LEN(MQTT_PUB_TOPIC_STATUS) <= MQTT_TOPICS_MAX_LEN, "Status topic too long");
+_Static_assert(DEVICE_TOPIC_LEN(PAYLOAD_EVENTS_TOPIC) <= MQTT_TOPICS_MAX_LEN, "Events topic too long");
+_Static_assert(DEVICE_TOPIC_LEN(MQTT_PUB_TOPIC_DIAGNOSTICS) <= MQTT_TOPICS_MAX_LEN, "Diagnostics topic too long");
+_Static_assert(DEVICE_TOPIC_LEN(MQTT_PUB_TOPIC_CAPTURE) <= MQTT_TOPICS_MAX_LEN, "Capture topic too long");
+_Static_assert(DEVICE_TOPIC_LEN(PAYLOAD_STATE_TOPIC) <= MQTT_TOPICS_MAX_LEN, "State topic too long");
+_Static_assert(DEVICE_TOPIC_LEN(MQTT_SUB_TOPIC) <= MQTT_TOPICS_MAX_LEN, "Configuration topic too long");
+
+/*******************************************************************************
+ * Local Variables
+ ******************************************************************************/
+/* Last topic level, the topic names of mqtt_client_config.h */
+static const char *const publish_names[PRESENCE_TOPIC_COUNT] =
+{
+    [PRESENCE_STATUS]      = MQTT_PUB_TOPIC_STATUS,
+    [PRESENCE_EVENTS]      = PAYLOAD_EVENTS_TOPIC,
+    [PRESENCE_DIAGNOSTICS] = MQTT_PUB_TOPIC_DIAGNOSTICS,
+    [PRESENCE_CAPTURE]     = MQTT_PUB_TOPIC_CAPTURE,
+    [PRESENCE_STATE]       = PAYLOAD_STATE_TOPIC,
+};
+
+static char device_id[MQTT_TOPICS_DEVICE_ID_LEN + 1];
+
+/* Written once by mqtt_topics_init(), read only afterwards */
+static char publish_topics[PRESENCE_TOPIC_COUNT][MQTT_TOPICS_MAX_LEN + 1];
+static uint16_t publish_topic_lens[PRESENCE_TOPIC_COUNT];
+static char subscribe_topic[MQTT_TOPICS_MAX_LEN + 1];
+static uint16_t subscribe_topic_len;
+
+/*******************************************************************************
+ * Function Name: format_topic
+ *******************************************************************************
+ * Summary:
+ *   Writes a topic of the table: the name itself, or the name in the
+ *   namespace of the device with MQTT_DEVICE_TOPICS.
+ *
+ * Parameters:
+ *   topic: buffer of MQTT_TOPICS_MAX_LEN + 1 characters
+ *   name: topic name of mqtt_client_config.h
+ *
+ * Return:
+ *   Length of the topic
+ ******************************************************************************/
+static uint16_t format_topic(char *topic, const char *name)
+{
+    int len;
+
+#if MQTT_DEVICE_TOPICS
+    len = snprintf(topic, MQTT_TOPICS_MAX_LEN + 1, "%s/%s/%s", MQTT_TOPIC_PREFIX, device_id, name);
+#else
+    len = snprintf(topic, MQTT_TOPICS_MAX_LEN + 1, "%s", name);
+#endif
+
+    return (uint16_t)len;
+}
+
+/*******************************************************************************
+ * Function Name: mqtt_topics_init
+ *******************************************************************************
+ * Summary:
+ *   Reads the unique silicon ID and builds the topics of the device. Called
+ *   by the MQTT client task before it starts the publisher and subscriber
+ *   tasks, which take their topics from the table.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void mqtt_topics_init(void)
+{
+    uint64_t unique_id = Cy_SysLib_GetUniqueId();
+
+    (void)snprintf(device_id, sizeof(device_id), "%016" PRIx64, unique_id);
+
+    for (uint32_t topic = 0; topic < PRESENCE_TOPIC_COUNT; topic++)
+    {
+        publish_topic_lens[topic] = format_topic(publish_topics[topic], publish_names[topic]);
+    }
+    subscribe_topic_len = format_topic(subscribe_topic, MQTT_SUB_TOPIC);
+
+    printf("Device ID %s, topics '%s', '%s', ...\n\n", device_id, publish_topics[PRESENCE_EVENTS],
+           subscribe_topic);
+}
+
+/*******************************************************************************
+ * Function Name: mqtt_topics_device_id
+ ******************************************************************************/
+const char *mqtt_topics_device_id(void)
+{
+    return device_id;
+}
+
+/*******************************************************************************
+ * Function Name: mqtt_topics_publish
+ *******************************************************************************
+ * Summary:
+ *   Returns a topic the publisher task publishes on.
+ *
+ * Parameters:
+ *   topic: topic of the publisher task
+ *   topic_len: receives the length of the topic
+ *
+ * Return:
+ *   The topic, valid for the lifetime of the application
+ ******************************************************************************/
+const char *mqtt_topics_publish(presence_topic_t topic, uint16_t *topic_len)
+{
+    *topic_len = publish_topic_lens[topic];
+    return publish_topics[topic];
+}
+
+/*******************************************************************************
+ * Function Name: mqtt_topics_subscribe
+ *******************************************************************************
+ * Summary:
+ *   Returns the configuration topic the subscriber task subscribes to.
+ *
+ * Parameters:
+ *   topic_len: receives the length of the topic
+ *
+ * Return:
+ *   The topic, valid for the lifetime of the application
+ ******************************************************************************/
+const char *mqtt_topics_subscribe(uint16_t *topic_len)
+{
+    *topic_len = subscribe_topic_len;
+    return subscribe_topic;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,52 @@
+/******************************************************************************
+ * File Name:   mqtt_topics.h
+ *
+ * Description: Topic table of the device, built once at boot.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef MQTT_TOPICS_H_
+#define MQTT_TOPICS_H_
+
+#include <stdint.h>
+
+#include "publisher_task.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Device ID in the topics: the 64-bit unique silicon ID in hex digits */
+#define MQTT_TOPICS_DEVICE_ID_LEN       (16u)
+
+/* Longest topic, without the terminating NUL */
+#define MQTT_TOPICS_MAX_LEN             (64u)
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+void mqtt_topics_init(void);
+const char *mqtt_topics_device_id(void);
+const char *mqtt_topics_publish(presence_topic_t topic, uint16_t *topic_len);
+const char *mqtt_topics_subscribe(uint16_t *topic_len);
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,536 @@
+/******************************************************************************
+ * File Name:   payload_writer.c
+ *
+ * Description: Streaming encoder of the published payloads, JSON or CBOR. The
+ *              payload is written item by item into the buffer of the message: JSON in
+ *              the layout of the hand-written payloads, or CBOR with definite lengths.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#include <string.h>
+
+#include "payload_writer.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* CBOR major types */
+#define CBOR_UINT                       (0u)
+#define CBOR_NEGINT                     (1u)
+#define CBOR_TEXT                       (3u)
+#define CBOR_ARRAY                      (4u)
+#define CBOR_MAP                        (5u)
+#define CBOR_TAG                        (6u)
+#define CBOR_FALSE                      (0xF4u)
+#define CBOR_TRUE                       (0xF5u)
+
+/* Additional information of a head with a 1, 2 or 4 byte argument */
+#define CBOR_ARG_1                      (24u)
+#define CBOR_ARG_2                      (25u)
+#define CBOR_ARG_4                      (26u)
+
+/* Tag of a decimal fraction [exponent, mantissa], RFC 8949 section 3.4.4 */
+#define CBOR_TAG_DECIMAL_FRACTION       (4u)
+
+_Static_assert(PAYLOAD_WRITER_MAX_DEPTH <= 8u, "One bit per level in uint8_t");
+
+/*******************************************************************************
+ * Function Name: put
+ *******************************************************************************
+ * Summary:
+ *   Appends bytes, or marks the writer as overflowed.
+ ******************************************************************************/
+static void put(payload_writer_t *writer, const void *data, size_t len)
+{
+    if (writer->overflow || (len > (writer->size - writer->len)))
+    {
+        writer->overflow = true;
+        return;
+    }
+
+    memcpy(&writer->buf[writer->len], data, len);
+    writer->len += len;
+}
+
+/*******************************************************************************
+ * Function Name: put_byte
+ ******************************************************************************/
+static void put_byte(payload_writer_t *writer, uint8_t byte)
+{
+    put(writer, &byte, 1u);
+}
+
+/*******************************************************************************
+ * Function Name: put_head
+ *******************************************************************************
+ * Summary:
+ *   Appends the head of a CBOR data item in its shortest form.
+ *
+ * Parameters:
+ *   writer: payload writer
+ *   major: major type
+ *   arg: value, length or count
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void put_head(payload_writer_t *writer, uint8_t major, uint32_t arg)
+{
+    uint8_t head[5];
+    size_t len;
+
+    major = (uint8_t)(major << 5);
+    if (arg < CBOR_ARG_1)
+    {
+        head[0] = (uint8_t)(major | arg);
+        len = 1u;
+    }
+    else if (arg <= 0xFFu)
+    {
+        head[0] = (uint8_t)(major | CBOR_ARG_1);
+        head[1] = (uint8_t)arg;
+        len = 2u;
+    }
+    else if (arg <= 0xFFFFu)
+    {
+        head[0] = (uint8_t)(major | CBOR_ARG_2);
+        head[1] = (uint8_t)(arg >> 8);
+        head[2] = (uint8_t)arg;
+        len = 3u;
+    }
+    else
+    {
+        head[0] = (uint8_t)(major | CBOR_ARG_4);
+        head[1] = (uint8_t)(arg >> 24);
+        head[2] = (uint8_t)(arg >> 16);
+        head[3] = (uint8_t)(arg >> 8);
+        head[4] = (uint8_t)arg;
+        len = 5u;
+    }
+
+    put(writer, head, len);
+}
+
+/*******************************************************************************
+ * Function Name: put_decimal
+ *******************************************************************************
+ * Summary:
+ *   Appends the decimal digits of a number, without snprintf().
+ ******************************************************************************/
+static void put_decimal(payload_writer_t *writer, uint32_t value)
+{
+    char digits[10];
+    size_t i = sizeof(digits);
+
+    do
+    {
+        digits[--i] = (char)('0' + (value % 10u));
+        value /= 10u;
+    } while (value != 0u);
+
+    put(writer, &digits[i], sizeof(digits) - i);
+}
+
+/*******************************************************************************
+ * Function Name: put_json_string
+ *******************************************************************************
+ * Summary:
+ *   Appends a quoted JSON string. Quotes, backslashes and control
+ *   characters are escaped.
+ ******************************************************************************/
+static void put_json_string(payload_writer_t *writer, const char *value)
+{
+    static const char hex[] = "0123456789abcdef";
+    const char *run = value;
+
+    put_byte(writer, '"');
+    for (; *value != '\0'; value++)
+    {
+        uint8_t c = (uint8_t)*value;
+
+        if ((c == '"') || (c == '\\') || (c < 0x20u))
+        {
+            put(writer, run, (size_t)(value - run));
+            if (c < 0x20u)
+            {
+                char escape[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xFu] };
+
+                put(writer, escape, sizeof(escape));
+            }
+            else
+            {
+                char escape[2] = { '\\', (char)c };
+
+                put(writer, escape, sizeof(escape));
+            }
+            run = value + 1;
+        }
+    }
+    put(writer, run, (size_t)(value - run));
+    put_byte(writer, '"');
+}
+
+/*******************************************************************************
+ * Function Name: begin_item
+ *******************************************************************************
+ * Summary:
+ *   Separates a JSON item from the previous one of its level. The value of
+ *   a key follows the key directly.
+ ******************************************************************************/
+static void begin_item(payload_writer_t *writer)
+{
+    uint8_t level;
+
+    if (writer->depth == 0u)
+    {
+        return;
+    }
+
+    level = (uint8_t)(1u << (writer->depth - 1u));
+
+    if (writer->format == PAYLOAD_FORMAT_JSON)
+    {
+        if (writer->value_follows)
+        {
+            writer->value_follows = false;
+            return;
+        }
+        if ((writer->started & level) != 0u)
+        {
+            put(writer, ", ", 2u);
+        }
+    }
+
+    writer->started |= level;
+}
+
+/*******************************************************************************
+ * Function Name: begin_container
+ ******************************************************************************/
+static void begin_container(payload_writer_t *writer, bool map, uint32_t count)
+{
+    uint8_t level;
+
+    begin_item(writer);
+
+    if (writer->depth >= PAYLOAD_WRITER_MAX_DEPTH)
+    {
+        writer->overflow = true;
+        return;
+    }
+
+    level = (uint8_t)(1u << writer->depth);
+    writer->depth++;
+    writer->started &= (uint8_t)~level;
+    if (map)
+    {
+        writer->maps |= level;
+    }
+    else
+    {
+        writer->maps &= (uint8_t)~level;
+    }
+
+    if (writer->format == PAYLOAD_FORMAT_JSON)
+    {
+        put_byte(writer, map ? '{' : '[');
+    }
+    else
+    {
+        put_head(writer, map ? CBOR_MAP : CBOR_ARRAY, count);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: payload_writer_init
+ *******************************************************************************
+ * Summary:
+ *   Starts a payload.
+ *
+ * Parameters:
+ *   writer: payload writer
+ *   format: encoding of the payload
+ *   buf: buffer of the payload, e.g. the data of a publisher pool block
+ *   size: size of the buffer; a JSON payload also needs its terminating NUL
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void payload_writer_init(payload_writer_t *writer, payload_format_t format, void *buf, size_t size)
+{
+    memset(writer, 0, sizeof(*writer));
+    writer->buf = (uint8_t *)buf;
+    writer->size = size;
+    writer->format = format;
+}
+
+/*******************************************************************************
+ * Function Name: payload_begin_map
+ *******************************************************************************
+ * Summary:
+ *   Opens a map (JSON object). CBOR encodes the number of members up
+ *   front: 'count' must match the keys written before payload_end().
+ ******************************************************************************/
+void payload_begin_map(payload_writer_t *writer, uint32_t count)
+{
+    begin_container(writer, true, count);
+}
+
+/*******************************************************************************
+ * Function Name: payload_begin_array
+ *******************************************************************************
+ * Summary:
+ *   Opens an array of 'count' items.
+ ******************************************************************************/
+void payload_begin_array(payload_writer_t *writer, uint32_t count)
+{
+    begin_container(writer, false, count);
+}
+
+/*******************************************************************************
+ * Function Name: payload_end
+ *******************************************************************************
+ * Summary:
+ *   Closes the innermost map or array.
+ ******************************************************************************/
+void payload_end(payload_writer_t *writer)
+{
+    if (writer->depth == 0u)
+    {
+        writer->overflow = true;
+        return;
+    }
+
+    writer->depth--;
+    if (writer->format == PAYLOAD_FORMAT_JSON)
+    {
+        put_byte(writer, ((writer->maps & (1u << writer->depth)) != 0u) ? '}' : ']');
+    }
+}
+
+/*******************************************************************************
+ * Function Name: payload_key
+ *******************************************************************************
+ * Summary:
+ *   Writes the key of a map member; its value is written next.
+ ******************************************************************************/
+void payload_key(payload_writer_t *writer, const char *key)
+{
+    payload_string(writer, key);
+    if (writer->format == PAYLOAD_FORMAT_JSON)
+    {
+        put(writer, ": ", 2u);
+        writer->value_follows = true;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: payload_string
+ ******************************************************************************/
+void payload_string(payload_writer_t *writer, const char *value)
+{
+    begin_item(writer);
+    if (writer->format == PAYLOAD_FORMAT_JSON)
+    {
+        put_json_string(writer, value);
+    }
+    else
+    {
+        size_t len = strlen(value);
+
+        put_head(writer, CBOR_TEXT, (uint32_t)len);
+        put(writer, value, len);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: payload_uint
+ ******************************************************************************/
+void payload_uint(payload_writer_t *writer, uint32_t value)
+{
+    begin_item(writer);
+    if (writer->format == PAYLOAD_FORMAT_JSON)
+    {
+        put_decimal(writer, value);
+    }
+    else
+    {
+        put_head(writer, CBOR_UINT, value);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: payload_int
+ ******************************************************************************/
+void payload_int(payload_writer_t *writer, int32_t value)
+{
+    uint32_t magnitude;
+
+    if (value >= 0)
+    {
+        payload_uint(writer, (uint32_t)value);
+        return;
+    }
+
+    /* -1 - value, without overflow at INT32_MIN */
+    magnitude = (uint32_t)(-(value + 1));
+
+    begin_item(writer);
+    if (writer->format == PAYLOAD_FORMAT_JSON)
+    {
+        put_byte(writer, '-');
+        put_decimal(writer, magnitude + 1u);
+    }
+    else
+    {
+        put_head(writer, CBOR_NEGINT, magnitude);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: payload_fixed
+ *******************************************************************************
+ * Summary:
+ *   Writes the fixed-point number value / 10^decimals, e.g. 1304 with 3
+ *   decimals as 1.304, without float formatting. JSON prints all decimals;
+ *   CBOR writes a decimal fraction, 4([-3, 1304]).
+ *
+ * Parameters:
+ *   writer: payload writer
+ *   value: scaled value
+ *   decimals: digits after the decimal point, at most 9
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void payload_fixed(payload_writer_t *writer, int32_t value, uint8_t decimals)
+{
+    uint32_t magnitude = (value < 0) ? ((uint32_t)(-(value + 1)) + 1u) : (uint32_t)value;
+
+    if (decimals > 9u)
+    {
+        writer->overflow = true;
+        return;
+    }
+
+    begin_item(writer);
+    if (writer->format == PAYLOAD_FORMAT_JSON)
+    {
+        uint32_t scale = 1u;
+        char digits[9];
+
+        for (uint8_t i = 0u; i < decimals; i++)
+        {
+            scale *= 10u;
+        }
+
+        if (value < 0)
+        {
+            put_byte(writer, '-');
+        }
+        put_decimal(writer, magnitude / scale);
+        if (decimals > 0u)
+        {
+            uint32_t fraction = magnitude % scale;
+
+            for (uint8_t i = decimals; i > 0u; i--)
+            {
+                digits[i - 1u] = (char)('0' + (fraction % 10u));
+                fraction /= 10u;
+            }
+            put_byte(writer, '.');
+            put(writer, digits, decimals);
+        }
+    }
+    else
+    {
+        put_head(writer, CBOR_TAG, CBOR_TAG_DECIMAL_FRACTION);
+        put_head(writer, CBOR_ARRAY, 2u);
+        if (decimals > 0u)
+        {
+            put_head(writer, CBOR_NEGINT, decimals - 1u);
+        }
+        else
+        {
+            put_head(writer, CBOR_UINT, 0u);
+        }
+        put_head(writer, (value < 0) ? CBOR_NEGINT : CBOR_UINT, (value < 0) ? (magnitude - 1u) : magnitude);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: payload_bool
+ ******************************************************************************/
+void payload_bool(payload_writer_t *writer, bool value)
+{
+    begin_item(writer);
+    if (writer->format == PAYLOAD_FORMAT_JSON)
+    {
+        if (value)
+        {
+            put(writer, "true", 4u);
+        }
+        else
+        {
+            put(writer, "false", 5u);
+        }
+    }
+    else
+    {
+        put_byte(writer, value ? CBOR_TRUE : CBOR_FALSE);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: payload_writer_finish
+ *******************************************************************************
+ * Summary:
+ *   Ends the payload. A JSON payload is NUL terminated, so that it can be
+ *   printed; the NUL is not part of its length.
+ *
+ * Parameters:
+ *   writer: payload writer
+ *
+ * Return:
+ *   Length of the payload, 0 if it did not fit into the buffer or a map or
+ *   array was left open
+ ******************************************************************************/
+size_t payload_writer_finish(payload_writer_t *writer)
+{
+    if (writer->format == PAYLOAD_FORMAT_JSON)
+    {
+        put_byte(writer, '\0');
+        if (!writer->overflow)
+        {
+            writer->len--;
+        }
+    }
+
+    if (writer->overflow || (writer->depth != 0u))
+    {
+        return 0u;
+    }
+
+    return writer->len;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,112 @@
+/******************************************************************************
+ * File Name:   payload_writer.h
+ *
+ * Description: Streaming encoder of the published payloads, JSON or CBOR.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef PAYLOAD_WRITER_H_
+#define PAYLOAD_WRITER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mqtt_client_config.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Encoding of the presence events: 0 for JSON text, 1 for CBOR (RFC 8949),
+ * which is a quarter to a third smaller and needs no number formatting on
+ * either side.
+ */
+#ifndef PAYLOAD_CBOR_ENABLE
+#define PAYLOAD_CBOR_ENABLE             (0)
+#endif
+
+/* The content type is a suffix of the last topic level, so that a JSON
+ * subscriber never receives CBOR. JSON keeps the topic names of
+ * mqtt_client_config.h.
+ */
+#define PAYLOAD_CBOR_TOPIC_SUFFIX       ".cbor"
+
+#if PAYLOAD_CBOR_ENABLE
+#define PAYLOAD_FORMAT                  (PAYLOAD_FORMAT_CBOR)
+#define PAYLOAD_TOPIC_SUFFIX            PAYLOAD_CBOR_TOPIC_SUFFIX
+#else
+#define PAYLOAD_FORMAT                  (PAYLOAD_FORMAT_JSON)
+#define PAYLOAD_TOPIC_SUFFIX            ""
+#endif
+
+/* Topic of the presence events in the format of the build */
+#define PAYLOAD_EVENTS_TOPIC            MQTT_PUB_TOPIC_EVENTS PAYLOAD_TOPIC_SUFFIX
+
+/* Topic of the retained presence state, in the format of the events */
+#define PAYLOAD_STATE_TOPIC             MQTT_PUB_TOPIC_STATE PAYLOAD_TOPIC_SUFFIX
+
+/* Nesting of maps and arrays */
+#define PAYLOAD_WRITER_MAX_DEPTH        (8u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef enum
+{
+    PAYLOAD_FORMAT_JSON,
+    PAYLOAD_FORMAT_CBOR
+} payload_format_t;
+
+/* Writes straight into the buffer of the message, without allocation. The
+ * writer remembers an overflow, so the calls need no checks; the result is
+ * taken from payload_writer_finish().
+ */
+typedef struct
+{
+    uint8_t *buf;
+    size_t size;
+    size_t len;
+    payload_format_t format;
+    uint8_t depth;
+    uint8_t maps;           /* Bit per level: the level is a map */
+    uint8_t started;        /* Bit per level: the level has an item */
+    bool value_follows;     /* JSON: a key was written, its value is next */
+    bool overflow;
+} payload_writer_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+void payload_writer_init(payload_writer_t *writer, payload_format_t format, void *buf, size_t size);
+void payload_begin_map(payload_writer_t *writer, uint32_t count);
+void payload_begin_array(payload_writer_t *writer, uint32_t count);
+void payload_end(payload_writer_t *writer);
+void payload_key(payload_writer_t *writer, const char *key);
+void payload_string(payload_writer_t *writer, const char *value);
+void payload_uint(payload_writer_t *writer, uint32_t value);
+void payload_int(payload_writer_t *writer, int32_t value);
+void payload_fixed(payload_writer_t *writer, int32_t value, uint8_t decimals);
+void payload_bool(payload_writer_t *writer, bool value);
+size_t payload_writer_finish(payload_writer_t *writer);
+
+#endif
+/* [] END OF FILE */
@@ -0,0 +1,173 @@
+/******************************************************************************
+ * File Name:   power_stats.c
+ *
+ * Description: This file accounts the time the MCU spends in tickless idle (sleep
+ *              or deep sleep) versus awake, and formats an hourly report of it.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "rtos_artifacts.h"
+
+#include "power_stats.h"
+
+/*******************************************************************************
+ * Local Variables
+ ******************************************************************************/
+/* Updated by the idle task while the scheduler is suspended */
+static TickType_t idle_enter_tick;
+static TickType_t asleep_ticks;
+static uint32_t sleep_entries;
+
+/* Updated by the tasks other than the radar task */
+static uint32_t timed_wakeups;
+
+/* Start of the current accounting period, zero until the first poll */
+static uint32_t period_start_ms;
+static bool period_started = false;
+
+/*******************************************************************************
+ * Function Name: power_stats_idle_enter
+ *******************************************************************************
+ * Summary:
+ *   Called by the idle task (traceLOW_POWER_IDLE_BEGIN) right before the MCU
+ *   enters tickless sleep.
+ *
+ * Parameters:
+ *   void
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void power_stats_idle_enter(void)
+{
+    idle_enter_tick = xTaskGetTickCount();
+}
+
+/*******************************************************************************
+ * Function Name: power_stats_idle_exit
+ *******************************************************************************
+ * Summary:
+ *   Called by the idle task (traceLOW_POWER_IDLE_END) after wakeup. The tick
+ *   count has already been stepped by the sleep duration at this point, so
+ *   the difference is the time spent asleep, with a resolution of one tick.
+ *
+ * Parameters:
+ *   void
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void power_stats_idle_exit(void)
+{
+    asleep_ticks += xTaskGetTickCount() - idle_enter_tick;
+    ++sleep_entries;
+}
+
+/*******************************************************************************
+ * Function Name: power_stats_timed_wakeup
+ *******************************************************************************
+ * Summary:
+ *   Counts a wakeup of a task other than the radar task that was caused by
+ *   a timeout: a retry delay, or a wait for pending work of the publisher
+ *   task that ended without a message.
+ *
+ * Parameters:
+ *   void
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void power_stats_timed_wakeup(void)
+{
+    taskENTER_CRITICAL();
+    ++timed_wakeups;
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+ * Function Name: power_stats_poll
+ *******************************************************************************
+ * Summary:
+ *   Checks whether the current accounting period has elapsed. If so, writes
+ *   the asleep and awake time of the period as a JSON report and starts a new
+ *   period. Meant to be called from a task that wakes up anyway, so that the
+ *   accounting does not add wakeups of its own.
+ *
+ * Parameters:
+ *   now_ms: current time in milliseconds
+ *   report: buffer for the JSON report
+ *   report_size: size of the buffer
+ *
+ * Return:
+ *   True if a report was written
+ ******************************************************************************/
+bool power_stats_poll(uint32_t now_ms, char *report, size_t report_size)
+{
+    uint32_t elapsed_ms;
+    uint32_t asleep_ms;
+    uint32_t entries;
+    uint32_t wakeups;
+
+    if (!period_started)
+    {
+        period_start_ms = now_ms;
+        period_started = true;
+        return false;
+    }
+
+    elapsed_ms = now_ms - period_start_ms;
+    if (elapsed_ms < POWER_STATS_REPORT_PERIOD_MS)
+    {
+        return false;
+    }
+
+    taskENTER_CRITICAL();
+    asleep_ms = (uint32_t)(asleep_ticks * portTICK_PERIOD_MS);
+    entries = sleep_entries;
+    wakeups = timed_wakeups;
+    asleep_ticks = 0;
+    sleep_entries = 0;
+    timed_wakeups = 0;
+    taskEXIT_CRITICAL();
+
+    period_start_ms = now_ms;
+
+    if (asleep_ms > elapsed_ms)
+    {
+        asleep_ms = elapsed_ms;
+    }
+
+    snprintf(report, report_size,
+             "{\"power\": {\"period_ms\": %" PRIu32 ", \"asleep_ms\": %" PRIu32 ", "
+             "\"awake_ms\": %" PRIu32 ", \"sleep_entries\": %" PRIu32 ", "
+             "\"timed_wakeups\": %" PRIu32 ", \"asleep_permille\": %" PRIu32 "}}",
+             elapsed_ms, asleep_ms, elapsed_ms - asleep_ms, entries, wakeups,
+             (uint32_t)(((uint64_t)asleep_ms * 1000u) / elapsed_ms));
+
+    return true;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,50 @@
+/******************************************************************************
+ * File Name:   power_stats.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *              in power_stats.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef POWER_STATS_H_
+#define POWER_STATS_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Length of one accounting period of the sleep statistics */
+#define POWER_STATS_REPORT_PERIOD_MS    (60u * 60u * 1000u)
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+void power_stats_idle_enter(void);
+void power_stats_idle_exit(void);
+void power_stats_timed_wakeup(void);
+bool power_stats_poll(uint32_t now_ms, char *report, size_t report_size);
+
+#endif
+/* [] END OF FILE */
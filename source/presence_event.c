@@ -0,0 +1,98 @@
+/******************************************************************************
+ * File Name:   presence_event.c
+ *
+ * Description: Versioned schema of the presence event payloads.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#include "presence_event.h"
+
+/*******************************************************************************
+ * Local Variables
+ ******************************************************************************/
+static const char *const state_names[] =
+{
+    [PRESENCE_EVENT_ABSENCE] = "OUT",
+    [PRESENCE_EVENT_MACRO] = "IN macro",
+    [PRESENCE_EVENT_MICRO] = "IN micro"
+};
+
+/*******************************************************************************
+ * Function Name: presence_event_state_name
+ *******************************************************************************
+ * Summary:
+ *   Returns the name of a presence state in the event payloads.
+ *
+ * Parameters:
+ *   state: presence state
+ *
+ * Return:
+ *   "OUT", "IN macro" or "IN micro"
+ ******************************************************************************/
+const char *presence_event_state_name(presence_event_state_t state)
+{
+    return (state <= PRESENCE_EVENT_MICRO) ? state_names[state] : state_names[PRESENCE_EVENT_ABSENCE];
+}
+
+/*******************************************************************************
+ * Function Name: presence_event_begin
+ *******************************************************************************
+ * Summary:
+ *   Opens the map of an event payload and writes the members of the
+ *   schema, for example
+ *   {"v": 1, "PRESENCE": "IN macro", "seq": 17, "timestamp": 81200,
+ *    "frame": 812, "range_m": 1.304}.
+ *   The caller adds its own members, e.g. "trace", and closes the map
+ *   with payload_end(). The range is a fixed-point number, so no float is
+ *   formatted.
+ *
+ * Parameters:
+ *   writer: payload writer, at the start of the payload
+ *   event: event to write
+ *   extra_members: members the caller adds, CBOR encodes the count up front
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void presence_event_begin(payload_writer_t *writer, const presence_event_t *event, uint32_t extra_members)
+{
+    bool range = (event->range_mm >= 0);
+
+    payload_begin_map(writer, 5u + (range ? 1u : 0u) + extra_members);
+    payload_key(writer, "v");
+    payload_uint(writer, PRESENCE_EVENT_SCHEMA_VERSION);
+    payload_key(writer, "PRESENCE");
+    payload_string(writer, presence_event_state_name(event->state));
+    payload_key(writer, "seq");
+    payload_uint(writer, event->seq);
+    payload_key(writer, "timestamp");
+    payload_uint(writer, event->timestamp_ms);
+    payload_key(writer, "frame");
+    payload_uint(writer, event->frame);
+    if (range)
+    {
+        payload_key(writer, "range_m");
+        payload_fixed(writer, event->range_mm, PRESENCE_EVENT_RANGE_DECIMALS);
+    }
+}
+
+/* [] END OF FILE */
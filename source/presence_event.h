@@ -0,0 +1,78 @@
+/******************************************************************************
+ * File Name:   presence_event.h
+ *
+ * Description: Versioned schema of the presence event payloads.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef PRESENCE_EVENT_H_
+#define PRESENCE_EVENT_H_
+
+#include <stdint.h>
+
+#include "payload_writer.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Version of the event payloads, the "v" member. Members may be added
+ * within a version; a change of the meaning or type of a member raises it.
+ */
+#define PRESENCE_EVENT_SCHEMA_VERSION   (1u)
+
+/* Range of an event without a target, e.g. absence: no "range_m" member */
+#define PRESENCE_EVENT_NO_RANGE         (-1)
+
+/* Decimals of "range_m": the range is published in metres, with millimetre
+ * resolution
+ */
+#define PRESENCE_EVENT_RANGE_DECIMALS   (3u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+/* States carried by the messages on the events topic. */
+typedef enum
+{
+    PRESENCE_EVENT_ABSENCE,
+    PRESENCE_EVENT_MACRO,
+    PRESENCE_EVENT_MICRO
+} presence_event_state_t;
+
+/* A presence event as published */
+typedef struct
+{
+    uint32_t seq;                   /* Increases with each event, from 1 after a reset */
+    uint32_t timestamp_ms;          /* Capture time, presence library time base */
+    uint32_t frame;                 /* Frame that raised the event, numbered as in the captures */
+    int32_t range_mm;               /* Distance of the target, or PRESENCE_EVENT_NO_RANGE */
+    presence_event_state_t state;
+} presence_event_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+const char *presence_event_state_name(presence_event_state_t state);
+void presence_event_begin(payload_writer_t *writer, const presence_event_t *event, uint32_t extra_members);
+
+#endif
+/* [] END OF FILE */
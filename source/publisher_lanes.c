@@ -0,0 +1,449 @@
+/******************************************************************************
+ * File Name:   publisher_lanes.c
+ *
+ * Description: Strict priority lanes between the producers and the publisher task.
+ *              Each class of message has a queue of its own with its own depth and
+ *              drop policy, so a burst of bulk data cannot delay or push out presence
+ *              events.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "rtos_artifacts.h"
+
+#include "publisher_lanes.h"
+#include "publisher_pool.h"
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    uint32_t depth;
+    publisher_lane_policy_t policy;
+} lane_config_t;
+
+/*******************************************************************************
+ * Local Variables
+ ******************************************************************************/
+/* Events drop the oldest message: the latest state matters most. A control
+ * message is never dropped in favour of a newer one, and the producers of
+ * telemetry count their own drops and send a newer report anyway.
+ */
+static const lane_config_t lane_config[PUBLISHER_LANE_COUNT] =
+{
+    [PUBLISHER_LANE_EVENTS]    = {PUBLISHER_LANE_EVENTS_DEPTH, PUBLISHER_LANE_DROP_OLDEST},
+    [PUBLISHER_LANE_CONTROL]   = {PUBLISHER_LANE_CONTROL_DEPTH, PUBLISHER_LANE_DROP_NEWEST},
+    [PUBLISHER_LANE_TELEMETRY] = {PUBLISHER_LANE_TELEMETRY_DEPTH, PUBLISHER_LANE_DROP_NEWEST},
+};
+
+static QueueHandle_t lane_q[PUBLISHER_LANE_COUNT];
+
+/* Mailbox of the latest presence state: a queue of length one that each new
+ * state overwrites, so the publisher task always takes the freshest state
+ * and no backlog of states builds up.
+ */
+static QueueHandle_t state_q;
+
+/* Given once for each message sent to any lane, each posted state, and
+ * each wake-up. Queue sets are not enabled in FreeRTOSConfig.h, so the
+ * publisher task waits on this semaphore and then takes the message from the
+ * first lane that has one. A dropped oldest message, an overwritten state,
+ * or a wake-up leaves a count without a message, which is harmless.
+ */
+static SemaphoreHandle_t work_sem;
+
+static publisher_lane_stats_t stats[PUBLISHER_LANE_COUNT];
+
+/* Drops counted at the last report */
+static uint32_t reported_drops;
+static uint32_t last_report_ms;
+
+/*******************************************************************************
+ * Function Name: lane_of
+ *******************************************************************************
+ * Summary:
+ *   Selects the lane of a message from its command and topic.
+ *
+ * Parameters:
+ *   msg: message for the publisher task
+ *
+ * Return:
+ *   The lane
+ ******************************************************************************/
+static publisher_lane_t lane_of(const publisher_data_t *msg)
+{
+    if (msg->cmd == PUBLISH_RADAR_CAPTURE)
+    {
+        return PUBLISHER_LANE_TELEMETRY;
+    }
+
+    if (msg->cmd != PUBLISH_MQTT_MSG)
+    {
+        return PUBLISHER_LANE_CONTROL;
+    }
+
+    switch (msg->topic)
+    {
+        case PRESENCE_EVENTS:
+            return PUBLISHER_LANE_EVENTS;
+
+        case PRESENCE_STATUS:
+            return PUBLISHER_LANE_CONTROL;
+
+        default:
+            return PUBLISHER_LANE_TELEMETRY;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: count_drop
+ *******************************************************************************
+ * Summary:
+ *   Counts a message dropped by a lane.
+ *
+ * Parameters:
+ *   lane: lane that dropped the message
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void count_drop(publisher_lane_t lane)
+{
+    taskENTER_CRITICAL();
+    ++stats[lane].dropped;
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+ * Function Name: publisher_lanes_init
+ *******************************************************************************
+ * Summary:
+ *   Creates the lanes. Called by the publisher task before it receives
+ *   messages; sends fail until then.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   True if the lanes were created
+ ******************************************************************************/
+bool publisher_lanes_init(void)
+{
+    SemaphoreHandle_t sem;
+
+    for (uint32_t lane = 0; lane < PUBLISHER_LANE_COUNT; lane++)
+    {
+        lane_q[lane] = xQueueCreate(lane_config[lane].depth, sizeof(publisher_data_t *));
+        if (lane_q[lane] == NULL)
+        {
+            return false;
+        }
+    }
+
+    state_q = xQueueCreate(1, sizeof(presence_event_t));
+    if (state_q == NULL)
+    {
+        return false;
+    }
+
+    sem = xSemaphoreCreateCounting(PUBLISHER_LANES_TOTAL_DEPTH + 1u, 0);
+
+    /* Published last, the producers check it to see whether the lanes exist. */
+    taskENTER_CRITICAL();
+    work_sem = sem;
+    taskEXIT_CRITICAL();
+
+    return (sem != NULL);
+}
+
+/*******************************************************************************
+ * Function Name: publisher_lanes_ready
+ ******************************************************************************/
+bool publisher_lanes_ready(void)
+{
+    return (work_sem != NULL);
+}
+
+/*******************************************************************************
+ * Function Name: publisher_lanes_send
+ *******************************************************************************
+ * Summary:
+ *   Passes a message to the publisher task through the lane of its topic.
+ *   When the lane is full, the lane policy decides: the message is
+ *   rejected, or the oldest message of the lane is dropped and returned to
+ *   the pool. Lanes that drop the oldest message never wait.
+ *
+ * Parameters:
+ *   msg: message for the publisher task
+ *   wait: ticks to wait for space in a lane that rejects new messages
+ *
+ * Return:
+ *   True if the publisher task owns the message now
+ ******************************************************************************/
+bool publisher_lanes_send(publisher_data_t *msg, TickType_t wait)
+{
+    publisher_lane_t lane;
+    publisher_data_t *oldest;
+    UBaseType_t waiting;
+    bool sent;
+
+    if (work_sem == NULL)
+    {
+        return false;
+    }
+
+    lane = lane_of(msg);
+
+    if (lane_config[lane].policy == PUBLISHER_LANE_DROP_OLDEST)
+    {
+        sent = (xQueueSendToBack(lane_q[lane], &msg, 0) == pdTRUE);
+
+        /* The publisher task may take the oldest message first, then the
+         * retry finds space without dropping anything.
+         */
+        if (!sent && (xQueueReceive(lane_q[lane], &oldest, 0) == pdTRUE))
+        {
+            if (publisher_pool_owns(oldest))
+            {
+                publisher_pool_free(oldest);
+            }
+            count_drop(lane);
+        }
+        if (!sent)
+        {
+            sent = (xQueueSendToBack(lane_q[lane], &msg, 0) == pdTRUE);
+        }
+    }
+    else
+    {
+        sent = (xQueueSendToBack(lane_q[lane], &msg, wait) == pdTRUE);
+    }
+
+    if (!sent)
+    {
+        count_drop(lane);
+        return false;
+    }
+
+    waiting = uxQueueMessagesWaiting(lane_q[lane]);
+
+    taskENTER_CRITICAL();
+    ++stats[lane].queued;
+    if (waiting > stats[lane].high_water)
+    {
+        stats[lane].high_water = waiting;
+    }
+    taskEXIT_CRITICAL();
+
+    (void)xSemaphoreGive(work_sem);
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: publisher_lanes_receive
+ *******************************************************************************
+ * Summary:
+ *   Waits for a message and takes it from the lane of the highest priority
+ *   that has one: events before control before telemetry.
+ *
+ * Parameters:
+ *   msg: receives the message
+ *   wait: ticks to wait for a message
+ *
+ * Return:
+ *   True if a message was received
+ ******************************************************************************/
+bool publisher_lanes_receive(publisher_data_t **msg, TickType_t wait)
+{
+    if (xSemaphoreTake(work_sem, wait) != pdTRUE)
+    {
+        return false;
+    }
+
+    for (uint32_t lane = 0; lane < PUBLISHER_LANE_COUNT; lane++)
+    {
+        if (xQueueReceive(lane_q[lane], msg, 0) == pdTRUE)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*******************************************************************************
+ * Function Name: publisher_lanes_post_state
+ *******************************************************************************
+ * Summary:
+ *   Replaces the presence state in the mailbox and wakes the publisher task.
+ *   The state needs no block of the publisher pool and never waits.
+ *
+ * Parameters:
+ *   event: latest presence event
+ *
+ * Return:
+ *   True if the state was posted, false before the lanes are created
+ ******************************************************************************/
+bool publisher_lanes_post_state(const presence_event_t *event)
+{
+    if (work_sem == NULL)
+    {
+        return false;
+    }
+
+    (void)xQueueOverwrite(state_q, event);
+    (void)xSemaphoreGive(work_sem);
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: publisher_lanes_take_state
+ *******************************************************************************
+ * Summary:
+ *   Takes the presence state from the mailbox, without waiting. The
+ *   publisher task checks the mailbox before it waits for the lanes.
+ *
+ * Parameters:
+ *   event: receives the latest presence event
+ *
+ * Return:
+ *   True if a state was posted since the last call
+ ******************************************************************************/
+bool publisher_lanes_take_state(presence_event_t *event)
+{
+    return (xQueueReceive(state_q, event, 0) == pdTRUE);
+}
+
+/*******************************************************************************
+ * Function Name: publisher_lanes_wake
+ *******************************************************************************
+ * Summary:
+ *   Wakes the publisher task without a message, for example when a slot of
+ *   the publisher window has a result for it.
+ ******************************************************************************/
+void publisher_lanes_wake(void)
+{
+    if (work_sem != NULL)
+    {
+        (void)xSemaphoreGive(work_sem);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: publisher_lanes_waiting
+ *******************************************************************************
+ * Summary:
+ *   Counts the messages waiting in all lanes.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   Messages waiting, 0 before the lanes are created
+ ******************************************************************************/
+uint32_t publisher_lanes_waiting(void)
+{
+    uint32_t waiting = 0;
+
+    if (work_sem == NULL)
+    {
+        return 0;
+    }
+
+    for (uint32_t lane = 0; lane < PUBLISHER_LANE_COUNT; lane++)
+    {
+        waiting += uxQueueMessagesWaiting(lane_q[lane]);
+    }
+
+    return waiting;
+}
+
+/*******************************************************************************
+ * Function Name: publisher_lanes_get_stats
+ ******************************************************************************/
+void publisher_lanes_get_stats(publisher_lane_t lane, publisher_lane_stats_t *lane_stats)
+{
+    taskENTER_CRITICAL();
+    *lane_stats = stats[lane];
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+ * Function Name: publisher_lanes_poll
+ *******************************************************************************
+ * Summary:
+ *   Writes a JSON report of the lanes when messages were dropped since the
+ *   last report, at most every PUBLISHER_LANES_REPORT_INTERVAL_MS. The
+ *   arrays are in lane order: events, control, telemetry.
+ *
+ * Parameters:
+ *   now_ms: current time in milliseconds
+ *   report: buffer for the JSON report
+ *   report_size: size of the buffer
+ *
+ * Return:
+ *   True if a report was written
+ ******************************************************************************/
+bool publisher_lanes_poll(uint32_t now_ms, char *report, size_t report_size)
+{
+    publisher_lane_stats_t current[PUBLISHER_LANE_COUNT];
+    uint32_t drops = 0;
+
+    for (uint32_t lane = 0; lane < PUBLISHER_LANE_COUNT; lane++)
+    {
+        publisher_lanes_get_stats((publisher_lane_t)lane, &current[lane]);
+        drops += current[lane].dropped;
+    }
+
+    if ((drops == reported_drops) ||
+        ((reported_drops != 0u) && ((now_ms - last_report_ms) < PUBLISHER_LANES_REPORT_INTERVAL_MS)))
+    {
+        return false;
+    }
+
+    reported_drops = drops;
+    last_report_ms = now_ms;
+
+    snprintf(report, report_size,
+             "{\"publisher_lanes\": {\"depth\": [%u, %u, %u], "
+             "\"high_water\": [%" PRIu32 ", %" PRIu32 ", %" PRIu32 "], "
+             "\"queued\": [%" PRIu32 ", %" PRIu32 ", %" PRIu32 "], "
+             "\"dropped\": [%" PRIu32 ", %" PRIu32 ", %" PRIu32 "]}}",
+             (unsigned)PUBLISHER_LANE_EVENTS_DEPTH, (unsigned)PUBLISHER_LANE_CONTROL_DEPTH,
+             (unsigned)PUBLISHER_LANE_TELEMETRY_DEPTH,
+             current[PUBLISHER_LANE_EVENTS].high_water, current[PUBLISHER_LANE_CONTROL].high_water,
+             current[PUBLISHER_LANE_TELEMETRY].high_water,
+             current[PUBLISHER_LANE_EVENTS].queued, current[PUBLISHER_LANE_CONTROL].queued,
+             current[PUBLISHER_LANE_TELEMETRY].queued,
+             current[PUBLISHER_LANE_EVENTS].dropped, current[PUBLISHER_LANE_CONTROL].dropped,
+             current[PUBLISHER_LANE_TELEMETRY].dropped);
+
+    return true;
+}
+
+/* [] END OF FILE */
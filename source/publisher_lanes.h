@@ -0,0 +1,86 @@
+/******************************************************************************
+ * File Name:   publisher_lanes.h
+ *
+ * Description: Strict priority lanes between the producers and the publisher task.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef PUBLISHER_LANES_H_
+#define PUBLISHER_LANES_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "publisher_task.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Minimum interval of the lane report on the diagnostics topic. The report is
+ * only sent after messages were dropped.
+ */
+#define PUBLISHER_LANES_REPORT_INTERVAL_MS  (60u * 1000u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+/* Lanes in the order the publisher task drains them */
+typedef enum
+{
+    PUBLISHER_LANE_EVENTS,      /* Presence events */
+    PUBLISHER_LANE_CONTROL,     /* Status replies, commands of the MQTT client task */
+    PUBLISHER_LANE_TELEMETRY,   /* Diagnostics reports, capture batches */
+    PUBLISHER_LANE_COUNT
+} publisher_lane_t;
+
+/* What happens to a message sent to a full lane */
+typedef enum
+{
+    PUBLISHER_LANE_DROP_NEWEST, /* The message is rejected */
+    PUBLISHER_LANE_DROP_OLDEST  /* The oldest message of the lane is dropped */
+} publisher_lane_policy_t;
+
+typedef struct
+{
+    uint32_t queued;        /* Messages accepted by the lane */
+    uint32_t dropped;       /* Messages rejected or dropped as the oldest */
+    uint32_t high_water;    /* Most messages waiting in the lane */
+} publisher_lane_stats_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+bool publisher_lanes_init(void);
+bool publisher_lanes_ready(void);
+bool publisher_lanes_send(publisher_data_t *msg, TickType_t wait);
+bool publisher_lanes_receive(publisher_data_t **msg, TickType_t wait);
+bool publisher_lanes_post_state(const presence_event_t *event);
+bool publisher_lanes_take_state(presence_event_t *event);
+void publisher_lanes_wake(void);
+uint32_t publisher_lanes_waiting(void);
+void publisher_lanes_get_stats(publisher_lane_t lane, publisher_lane_stats_t *stats);
+bool publisher_lanes_poll(uint32_t now_ms, char *report, size_t report_size);
+
+#endif
+/* [] END OF FILE */
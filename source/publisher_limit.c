@@ -0,0 +1,398 @@
+/******************************************************************************
+ * File Name:   publisher_limit.c
+ *
+ * Description: Per-topic token-bucket rate limits of the publisher task.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "rtos_artifacts.h"
+
+#include "publisher_limit.h"
+#include "publisher_pool.h"
+
+#if PUBLISHER_LIMIT_ENABLE
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* A token in bucket units: a rate of 'per_min' messages per minute adds
+ * 'per_min' units per millisecond, without a remainder.
+ */
+#define TOKEN                           (60u * 1000u)
+
+/* Topics with a limit: all but the capture topic */
+#define NUM_LIMITED_TOPICS              (3u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    uint32_t per_min;
+    uint32_t burst;
+    publisher_limit_policy_t policy;
+} limit_config_t;
+
+typedef struct
+{
+    uint32_t tokens;            /* In TOKEN units */
+    TickType_t last_refill;
+    publisher_data_t *held[PUBLISHER_LIMIT_DEFER_DEPTH];
+    uint32_t num_held;
+} bucket_t;
+
+/*******************************************************************************
+ * Local Variables
+ ******************************************************************************/
+static const limit_config_t limit_config[PRESENCE_TOPIC_COUNT] =
+{
+    [PRESENCE_STATUS]      = {PUBLISHER_LIMIT_STATUS_PER_MIN, PUBLISHER_LIMIT_STATUS_BURST,
+                              PUBLISHER_LIMIT_STATUS_POLICY},
+    [PRESENCE_EVENTS]      = {PUBLISHER_LIMIT_EVENTS_PER_MIN, PUBLISHER_LIMIT_EVENTS_BURST,
+                              PUBLISHER_LIMIT_EVENTS_POLICY},
+    [PRESENCE_DIAGNOSTICS] = {PUBLISHER_LIMIT_DIAGNOSTICS_PER_MIN, PUBLISHER_LIMIT_DIAGNOSTICS_BURST,
+                              PUBLISHER_LIMIT_DIAGNOSTICS_POLICY},
+    [PRESENCE_CAPTURE]     = {0u, 0u, PUBLISHER_LIMIT_DROP},
+    [PRESENCE_STATE]       = {0u, 0u, PUBLISHER_LIMIT_DROP},
+};
+
+/* Held messages are released in the order the lanes are drained */
+static const presence_topic_t release_order[NUM_LIMITED_TOPICS] =
+{
+    PRESENCE_EVENTS, PRESENCE_STATUS, PRESENCE_DIAGNOSTICS
+};
+
+_Static_assert(((uint64_t)PUBLISHER_LIMIT_STATUS_BURST * TOKEN) <= UINT32_MAX,
+               "Status burst overflows the bucket");
+_Static_assert(((uint64_t)PUBLISHER_LIMIT_EVENTS_BURST * TOKEN) <= UINT32_MAX,
+               "Events burst overflows the bucket");
+_Static_assert(((uint64_t)PUBLISHER_LIMIT_DIAGNOSTICS_BURST * TOKEN) <= UINT32_MAX,
+               "Diagnostics burst overflows the bucket");
+
+/* Only the publisher task changes the buckets */
+static bucket_t buckets[PRESENCE_TOPIC_COUNT];
+
+static publisher_limit_stats_t stats[PRESENCE_TOPIC_COUNT];
+
+/* Limited messages counted at the last report */
+static uint32_t reported_limited;
+static uint32_t last_report_ms;
+
+/*******************************************************************************
+ * Function Name: refill
+ *******************************************************************************
+ * Summary:
+ *   Adds the tokens of the time since the last refill, up to the burst.
+ ******************************************************************************/
+static void refill(presence_topic_t topic, TickType_t now)
+{
+    const limit_config_t *config = &limit_config[topic];
+    bucket_t *bucket = &buckets[topic];
+    uint32_t capacity = config->burst * TOKEN;
+    uint32_t elapsed_ms = (uint32_t)((now - bucket->last_refill) * portTICK_PERIOD_MS);
+
+    bucket->last_refill = now;
+    if (elapsed_ms >= ((capacity - bucket->tokens) / config->per_min))
+    {
+        bucket->tokens = capacity;
+    }
+    else
+    {
+        bucket->tokens += elapsed_ms * config->per_min;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: take_token
+ ******************************************************************************/
+static bool take_token(presence_topic_t topic)
+{
+    bucket_t *bucket = &buckets[topic];
+
+    refill(topic, xTaskGetTickCount());
+    if (bucket->tokens < TOKEN)
+    {
+        return false;
+    }
+
+    bucket->tokens -= TOKEN;
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: free_block
+ ******************************************************************************/
+static void free_block(publisher_data_t *msg)
+{
+    if (publisher_pool_owns(msg))
+    {
+        publisher_pool_free(msg);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: count
+ ******************************************************************************/
+static void count(uint32_t *counter)
+{
+    taskENTER_CRITICAL();
+    ++*counter;
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+ * Function Name: publisher_limit_init
+ *******************************************************************************
+ * Summary:
+ *   Fills the buckets, so that each topic may start with a burst. Called by
+ *   the publisher task before its first message.
+ ******************************************************************************/
+void publisher_limit_init(void)
+{
+    TickType_t now = xTaskGetTickCount();
+
+    for (uint32_t topic = 0; topic < PRESENCE_TOPIC_COUNT; topic++)
+    {
+        buckets[topic].tokens = limit_config[topic].burst * TOKEN;
+        buckets[topic].last_refill = now;
+        buckets[topic].num_held = 0u;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: publisher_limit_admit
+ *******************************************************************************
+ * Summary:
+ *   Takes a token for a message of the publisher task. Without a token, or
+ *   while earlier messages of the topic are held, the policy of the topic
+ *   decides: the message is dropped and returned to the pool, replaces the
+ *   held message, or is held behind the others.
+ *
+ * Parameters:
+ *   msg: message taken from the lanes
+ *
+ * Return:
+ *   The message if it may be published now, NULL if the limiter owns or
+ *   dropped it
+ ******************************************************************************/
+publisher_data_t *publisher_limit_admit(publisher_data_t *msg)
+{
+    const limit_config_t *config;
+    bucket_t *bucket;
+
+    if ((msg->cmd != PUBLISH_MQTT_MSG) || (limit_config[msg->topic].per_min == 0u))
+    {
+        return msg;
+    }
+
+    config = &limit_config[msg->topic];
+    bucket = &buckets[msg->topic];
+
+    if ((bucket->num_held == 0u) && take_token(msg->topic))
+    {
+        count(&stats[msg->topic].passed);
+        return msg;
+    }
+
+    switch (config->policy)
+    {
+        case PUBLISHER_LIMIT_MERGE:
+            if (bucket->num_held > 0u)
+            {
+                free_block(bucket->held[0]);
+                count(&stats[msg->topic].merged);
+            }
+            bucket->held[0] = msg;
+            bucket->num_held = 1u;
+            break;
+
+        case PUBLISHER_LIMIT_DEFER:
+            if (bucket->num_held < PUBLISHER_LIMIT_DEFER_DEPTH)
+            {
+                bucket->held[bucket->num_held++] = msg;
+                break;
+            }
+            free_block(msg);
+            count(&stats[msg->topic].dropped);
+            break;
+
+        case PUBLISHER_LIMIT_DROP:
+        default:
+            free_block(msg);
+            count(&stats[msg->topic].dropped);
+            break;
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+ * Function Name: publisher_limit_release
+ *******************************************************************************
+ * Summary:
+ *   Returns the oldest held message whose token has arrived, events first.
+ *
+ * Return:
+ *   The message to publish now, NULL if none
+ ******************************************************************************/
+publisher_data_t *publisher_limit_release(void)
+{
+    for (uint32_t i = 0; i < NUM_LIMITED_TOPICS; i++)
+    {
+        presence_topic_t topic = release_order[i];
+        bucket_t *bucket = &buckets[topic];
+        publisher_data_t *msg;
+
+        if ((bucket->num_held == 0u) || !take_token(topic))
+        {
+            continue;
+        }
+
+        msg = bucket->held[0];
+        bucket->num_held--;
+        for (uint32_t k = 0; k < bucket->num_held; k++)
+        {
+            bucket->held[k] = bucket->held[k + 1u];
+        }
+        count(&stats[topic].deferred);
+        return msg;
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+ * Function Name: publisher_limit_wait
+ *******************************************************************************
+ * Summary:
+ *   Returns the ticks until the next held message gets its token.
+ *
+ * Return:
+ *   0 if a held message may be published, portMAX_DELAY if none is held
+ ******************************************************************************/
+TickType_t publisher_limit_wait(void)
+{
+    TickType_t now = xTaskGetTickCount();
+    TickType_t wait = portMAX_DELAY;
+
+    for (uint32_t i = 0; i < NUM_LIMITED_TOPICS; i++)
+    {
+        presence_topic_t topic = release_order[i];
+        bucket_t *bucket = &buckets[topic];
+        TickType_t ticks = 0u;
+
+        if (bucket->num_held == 0u)
+        {
+            continue;
+        }
+
+        refill(topic, now);
+        if (bucket->tokens < TOKEN)
+        {
+            uint32_t per_min = limit_config[topic].per_min;
+            uint32_t ms = ((TOKEN - bucket->tokens) + per_min - 1u) / per_min;
+
+            ticks = pdMS_TO_TICKS(ms) + 1u;
+        }
+        if (ticks < wait)
+        {
+            wait = ticks;
+        }
+    }
+
+    return wait;
+}
+
+/*******************************************************************************
+ * Function Name: publisher_limit_get_stats
+ ******************************************************************************/
+void publisher_limit_get_stats(presence_topic_t topic, publisher_limit_stats_t *topic_stats)
+{
+    taskENTER_CRITICAL();
+    *topic_stats = stats[topic];
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+ * Function Name: publisher_limit_poll
+ *******************************************************************************
+ * Summary:
+ *   Writes a JSON report of the rate limits when messages were held or
+ *   dropped since the last report, at most every
+ *   PUBLISHER_LIMIT_REPORT_INTERVAL_MS. The arrays are in topic order:
+ *   status, events, diagnostics.
+ *
+ * Parameters:
+ *   now_ms: current time in milliseconds
+ *   report: buffer for the JSON report
+ *   report_size: size of the buffer
+ *
+ * Return:
+ *   True if a report was written
+ ******************************************************************************/
+bool publisher_limit_poll(uint32_t now_ms, char *report, size_t report_size)
+{
+    publisher_limit_stats_t current[PRESENCE_CAPTURE];
+    uint32_t limited = 0;
+
+    for (uint32_t topic = 0; topic < PRESENCE_CAPTURE; topic++)
+    {
+        publisher_limit_get_stats((presence_topic_t)topic, &current[topic]);
+        limited += current[topic].deferred + current[topic].merged + current[topic].dropped;
+    }
+
+    if ((limited == reported_limited) ||
+        ((reported_limited != 0u) && ((now_ms - last_report_ms) < PUBLISHER_LIMIT_REPORT_INTERVAL_MS)))
+    {
+        return false;
+    }
+
+    reported_limited = limited;
+    last_report_ms = now_ms;
+
+    snprintf(report, report_size,
+             "{\"publisher_limit\": {\"per_min\": [%u, %u, %u], "
+             "\"passed\": [%" PRIu32 ", %" PRIu32 ", %" PRIu32 "], "
+             "\"deferred\": [%" PRIu32 ", %" PRIu32 ", %" PRIu32 "], "
+             "\"merged\": [%" PRIu32 ", %" PRIu32 ", %" PRIu32 "], "
+             "\"dropped\": [%" PRIu32 ", %" PRIu32 ", %" PRIu32 "]}}",
+             (unsigned)PUBLISHER_LIMIT_STATUS_PER_MIN, (unsigned)PUBLISHER_LIMIT_EVENTS_PER_MIN,
+             (unsigned)PUBLISHER_LIMIT_DIAGNOSTICS_PER_MIN,
+             current[PRESENCE_STATUS].passed, current[PRESENCE_EVENTS].passed,
+             current[PRESENCE_DIAGNOSTICS].passed,
+             current[PRESENCE_STATUS].deferred, current[PRESENCE_EVENTS].deferred,
+             current[PRESENCE_DIAGNOSTICS].deferred,
+             current[PRESENCE_STATUS].merged, current[PRESENCE_EVENTS].merged,
+             current[PRESENCE_DIAGNOSTICS].merged,
+             current[PRESENCE_STATUS].dropped, current[PRESENCE_EVENTS].dropped,
+             current[PRESENCE_DIAGNOSTICS].dropped);
+
+    return true;
+}
+
+#endif /* PUBLISHER_LIMIT_ENABLE */
+
+/* [] END OF FILE */
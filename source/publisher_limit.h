@@ -0,0 +1,113 @@
+/******************************************************************************
+ * File Name:   publisher_limit.h
+ *
+ * Description: Per-topic token-bucket rate limits of the publisher task.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef PUBLISHER_LIMIT_H_
+#define PUBLISHER_LIMIT_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "publisher_task.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Set this macro to 1 to limit the message rate of each topic with a token
+ * bucket, so that a flickering state or a misbehaving configuration client
+ * cannot flood the broker and the Wi-Fi airtime.
+ */
+#ifndef PUBLISHER_LIMIT_ENABLE
+#define PUBLISHER_LIMIT_ENABLE              (0)
+#endif
+
+/* Sustained rate in messages per minute, burst in messages, and policy for
+ * the messages above the rate, per topic. A rate of 0 leaves the topic
+ * unlimited. The capture batches have their own flow control, the replay of
+ * the event log its own pace, and the state mailbox of the publisher lanes
+ * holds one state at most; none of them is limited.
+ */
+#define PUBLISHER_LIMIT_STATUS_PER_MIN      (30u)
+#define PUBLISHER_LIMIT_STATUS_BURST        (5u)
+#define PUBLISHER_LIMIT_STATUS_POLICY       (PUBLISHER_LIMIT_DROP)
+
+#define PUBLISHER_LIMIT_EVENTS_PER_MIN      (60u)
+#define PUBLISHER_LIMIT_EVENTS_BURST        (10u)
+#define PUBLISHER_LIMIT_EVENTS_POLICY       (PUBLISHER_LIMIT_MERGE)
+
+#define PUBLISHER_LIMIT_DIAGNOSTICS_PER_MIN (20u)
+#define PUBLISHER_LIMIT_DIAGNOSTICS_BURST   (5u)
+#define PUBLISHER_LIMIT_DIAGNOSTICS_POLICY  (PUBLISHER_LIMIT_DEFER)
+
+/* Messages a deferring topic holds; further messages are dropped */
+#define PUBLISHER_LIMIT_DEFER_DEPTH         (2u)
+
+/* Pool blocks the held messages take at most: one for each merging topic,
+ * PUBLISHER_LIMIT_DEFER_DEPTH for each deferring topic.
+ */
+#if PUBLISHER_LIMIT_ENABLE
+#define PUBLISHER_LIMIT_HELD_BLOCKS         (1u + 1u + PUBLISHER_LIMIT_DEFER_DEPTH)
+#else
+#define PUBLISHER_LIMIT_HELD_BLOCKS         (0u)
+#endif
+
+/* Minimum interval of the limit report on the diagnostics topic. The report
+ * is only sent after messages were limited.
+ */
+#define PUBLISHER_LIMIT_REPORT_INTERVAL_MS  (60u * 1000u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+/* What happens to a message above the rate of its topic */
+typedef enum
+{
+    PUBLISHER_LIMIT_DROP,       /* The message is dropped */
+    PUBLISHER_LIMIT_MERGE,      /* The latest message is held, it replaces an earlier one */
+    PUBLISHER_LIMIT_DEFER       /* Messages are held in order until their tokens arrive */
+} publisher_limit_policy_t;
+
+typedef struct
+{
+    uint32_t passed;            /* Messages published within the rate */
+    uint32_t deferred;          /* Messages held, then published */
+    uint32_t merged;            /* Held messages replaced by a newer one */
+    uint32_t dropped;           /* Messages dropped above the rate */
+} publisher_limit_stats_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+void publisher_limit_init(void);
+publisher_data_t *publisher_limit_admit(publisher_data_t *msg);
+publisher_data_t *publisher_limit_release(void);
+TickType_t publisher_limit_wait(void);
+void publisher_limit_get_stats(presence_topic_t topic, publisher_limit_stats_t *stats);
+bool publisher_limit_poll(uint32_t now_ms, char *report, size_t report_size);
+
+#endif
+/* [] END OF FILE */
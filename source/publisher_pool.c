@@ -0,0 +1,306 @@
+/******************************************************************************
+ * File Name:   publisher_pool.c
+ *
+ * Description: Fixed-block pool of the messages passed to the publisher task, with
+ *              O(1) allocation from tasks and interrupt handlers.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "rtos_artifacts.h"
+
+#include "publisher_pool.h"
+#include "publisher_lanes.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define POOL_NO_BLOCK                       (0xFFu)
+
+_Static_assert(PUBLISHER_POOL_NUM_BLOCKS < POOL_NO_BLOCK, "Block indices must fit into uint8_t");
+
+/*******************************************************************************
+ * Local Variables
+ ******************************************************************************/
+static publisher_data_t blocks[PUBLISHER_POOL_NUM_BLOCKS];
+
+/* Free list through the block indices. The blocks at and above
+ * 'num_carved' have never been handed out and are not on the list, so the
+ * zero-initialized pool is ready without an init call.
+ */
+static uint8_t next_free[PUBLISHER_POOL_NUM_BLOCKS];
+static uint8_t free_head = POOL_NO_BLOCK;
+static uint8_t num_carved;
+
+static publisher_pool_stats_t stats;
+
+/* Drops counted at the last report */
+static uint32_t reported_drops;
+static uint32_t last_report_ms;
+
+/*******************************************************************************
+ * Function Name: take_block
+ *******************************************************************************
+ * Summary:
+ *   Takes a block from the free list, or carves a new one. Called in a
+ *   critical section.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   The block, or NULL if all blocks are in use
+ ******************************************************************************/
+static publisher_data_t *take_block(void)
+{
+    publisher_data_t *block = NULL;
+
+    if (free_head != POOL_NO_BLOCK)
+    {
+        block = &blocks[free_head];
+        free_head = next_free[free_head];
+    }
+    else if (num_carved < PUBLISHER_POOL_NUM_BLOCKS)
+    {
+        block = &blocks[num_carved++];
+    }
+
+    if (block == NULL)
+    {
+        ++stats.exhausted;
+    }
+    else
+    {
+        /* Producers that write text leave the length at 0 */
+        block->data_len = 0u;
+        ++stats.allocated;
+        if (++stats.in_use > stats.max_in_use)
+        {
+            stats.max_in_use = stats.in_use;
+        }
+    }
+
+    return block;
+}
+
+/*******************************************************************************
+ * Function Name: give_block
+ *******************************************************************************
+ * Summary:
+ *   Puts a block back on the free list. Called in a critical section.
+ *
+ * Parameters:
+ *   block: block from the pool
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void give_block(publisher_data_t *block)
+{
+    uint8_t index = (uint8_t)(block - blocks);
+
+    next_free[index] = free_head;
+    free_head = index;
+    --stats.in_use;
+}
+
+/*******************************************************************************
+ * Function Name: publisher_pool_alloc
+ *******************************************************************************
+ * Summary:
+ *   Allocates a message block in O(1). The caller owns the block until it
+ *   passes it to the publisher task with publisher_pool_send(), which
+ *   returns it after publishing. A failed allocation is counted; the caller
+ *   drops its message.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   The block, or NULL if the pool is exhausted
+ ******************************************************************************/
+publisher_data_t *publisher_pool_alloc(void)
+{
+    publisher_data_t *block;
+
+    taskENTER_CRITICAL();
+    block = take_block();
+    taskEXIT_CRITICAL();
+
+    return block;
+}
+
+/*******************************************************************************
+ * Function Name: publisher_pool_alloc_from_isr
+ *******************************************************************************
+ * Summary:
+ *   publisher_pool_alloc() for interrupt handlers.
+ ******************************************************************************/
+publisher_data_t *publisher_pool_alloc_from_isr(void)
+{
+    publisher_data_t *block;
+    UBaseType_t saved = taskENTER_CRITICAL_FROM_ISR();
+
+    block = take_block();
+    taskEXIT_CRITICAL_FROM_ISR(saved);
+
+    return block;
+}
+
+/*******************************************************************************
+ * Function Name: publisher_pool_free
+ *******************************************************************************
+ * Summary:
+ *   Returns a block to the pool in O(1).
+ *
+ * Parameters:
+ *   block: block from publisher_pool_alloc()
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void publisher_pool_free(publisher_data_t *block)
+{
+    configASSERT(publisher_pool_owns(block));
+
+    taskENTER_CRITICAL();
+    give_block(block);
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+ * Function Name: publisher_pool_free_from_isr
+ *******************************************************************************
+ * Summary:
+ *   publisher_pool_free() for interrupt handlers.
+ ******************************************************************************/
+void publisher_pool_free_from_isr(publisher_data_t *block)
+{
+    UBaseType_t saved;
+
+    configASSERT(publisher_pool_owns(block));
+
+    saved = taskENTER_CRITICAL_FROM_ISR();
+    give_block(block);
+    taskEXIT_CRITICAL_FROM_ISR(saved);
+}
+
+/*******************************************************************************
+ * Function Name: publisher_pool_owns
+ *******************************************************************************
+ * Summary:
+ *   Checks whether a message is a pool block. The commands of the MQTT
+ *   client task and the capture message are static and not returned.
+ *
+ * Parameters:
+ *   block: message received from a publisher lane
+ *
+ * Return:
+ *   True if the message is a pool block
+ ******************************************************************************/
+bool publisher_pool_owns(const publisher_data_t *block)
+{
+    return (block >= &blocks[0]) && (block < &blocks[PUBLISHER_POOL_NUM_BLOCKS]);
+}
+
+/*******************************************************************************
+ * Function Name: publisher_pool_send
+ *******************************************************************************
+ * Summary:
+ *   Passes a block to the publisher task without waiting. When its lane is
+ *   full and rejects new messages, the block is returned to the pool and
+ *   counted.
+ *
+ * Parameters:
+ *   block: block from publisher_pool_alloc(), owned by the caller
+ *
+ * Return:
+ *   True if the publisher task owns the block now
+ ******************************************************************************/
+bool publisher_pool_send(publisher_data_t *block)
+{
+    if (publisher_lanes_send(block, 0))
+    {
+        return true;
+    }
+
+    taskENTER_CRITICAL();
+    ++stats.queue_full;
+    give_block(block);
+    taskEXIT_CRITICAL();
+
+    return false;
+}
+
+/*******************************************************************************
+ * Function Name: publisher_pool_get_stats
+ ******************************************************************************/
+void publisher_pool_get_stats(publisher_pool_stats_t *pool_stats)
+{
+    taskENTER_CRITICAL();
+    *pool_stats = stats;
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+ * Function Name: publisher_pool_poll
+ *******************************************************************************
+ * Summary:
+ *   Writes a JSON report of the pool when messages were dropped since the
+ *   last report, at most every PUBLISHER_POOL_REPORT_INTERVAL_MS.
+ *
+ * Parameters:
+ *   now_ms: current time in milliseconds
+ *   report: buffer for the JSON report
+ *   report_size: size of the buffer
+ *
+ * Return:
+ *   True if a report was written
+ ******************************************************************************/
+bool publisher_pool_poll(uint32_t now_ms, char *report, size_t report_size)
+{
+    publisher_pool_stats_t current;
+
+    publisher_pool_get_stats(&current);
+
+    if (((current.exhausted + current.queue_full) == reported_drops) ||
+        ((reported_drops != 0u) && ((now_ms - last_report_ms) < PUBLISHER_POOL_REPORT_INTERVAL_MS)))
+    {
+        return false;
+    }
+
+    reported_drops = current.exhausted + current.queue_full;
+    last_report_ms = now_ms;
+
+    snprintf(report, report_size,
+             "{\"publisher_pool\": {\"blocks\": %u, \"max_in_use\": %" PRIu32 ", "
+             "\"allocated\": %" PRIu32 ", \"exhausted\": %" PRIu32 ", \"queue_full\": %" PRIu32 "}}",
+             (unsigned)PUBLISHER_POOL_NUM_BLOCKS, current.max_in_use,
+             current.allocated, current.exhausted, current.queue_full);
+
+    return true;
+}
+
+/* [] END OF FILE */
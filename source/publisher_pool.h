@@ -0,0 +1,78 @@
+/******************************************************************************
+ * File Name:   publisher_pool.h
+ *
+ * Description: Fixed-block pool of the messages passed to the publisher task.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef PUBLISHER_POOL_H_
+#define PUBLISHER_POOL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "publisher_task.h"
+#include "publisher_limit.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Message blocks shared by the producers of the publisher task: enough to
+ * fill the publisher lanes, with one block being published by each slot of
+ * the publisher window, the messages held by the rate limits and one being
+ * filled by each of the radar and configuration tasks.
+ */
+#define PUBLISHER_POOL_NUM_BLOCKS           (PUBLISHER_LANES_TOTAL_DEPTH + PUBLISHER_INFLIGHT_WINDOW + \
+                                             PUBLISHER_LIMIT_HELD_BLOCKS + 2u)
+
+/* Minimum interval of the pool report on the diagnostics topic. The report is
+ * only sent after messages were dropped.
+ */
+#define PUBLISHER_POOL_REPORT_INTERVAL_MS   (60u * 1000u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    uint32_t allocated;     /* Blocks handed out */
+    uint32_t exhausted;     /* Allocations that failed, the message was dropped */
+    uint32_t queue_full;    /* Blocks returned because their publisher lane was full */
+    uint32_t in_use;        /* Blocks currently handed out */
+    uint32_t max_in_use;    /* High-water mark of in_use */
+} publisher_pool_stats_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+publisher_data_t *publisher_pool_alloc(void);
+publisher_data_t *publisher_pool_alloc_from_isr(void);
+void publisher_pool_free(publisher_data_t *block);
+void publisher_pool_free_from_isr(publisher_data_t *block);
+bool publisher_pool_owns(const publisher_data_t *block);
+bool publisher_pool_send(publisher_data_t *block);
+void publisher_pool_get_stats(publisher_pool_stats_t *stats);
+bool publisher_pool_poll(uint32_t now_ms, char *report, size_t report_size);
+
+#endif
+/* [] END OF FILE */
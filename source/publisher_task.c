@@ -43,6 +43,9 @@
 * so agrees to indemnify Cypress against all liability.
 *******************************************************************************/
 
+#include <inttypes.h>
+#include <stdio.h>
+
 #include "cyhal.h"
 #include "cybsp.h"
 
@@ -50,8 +53,18 @@
 
 /* Task header files */
 #include "publisher_task.h"
+#include "publisher_pool.h"
+#include "publisher_lanes.h"
+#include "publisher_window.h"
+#include "publisher_limit.h"
+#include "event_log.h"
+#include "payload_writer.h"
+#include "mqtt_topics.h"
 #include "mqtt_task.h"
 #include "subscriber_task.h"
+#include "radar_capture.h"
+#include "radar_task.h"
+#include "power_stats.h"
 
 /* Configuration file for MQTT client */
 #include "mqtt_client_config.h"
@@ -72,15 +85,37 @@
  */
 #define PUBLISH_RETRY_MS                (1000)
 
-/* Queue length of a message queue that is used to communicate with the 
- * publisher task.
+/* Longest coalesced message: the latest event, one ["IN macro", <ms>, <seq>]
+ * per event and the trace member, in JSON; CBOR is shorter.
  */
-#define PUBLISHER_TASK_QUEUE_LENGTH     (3u)
+#define COALESCE_PAYLOAD_SIZE           (176u + (PUBLISHER_COALESCE_MAX_EVENTS * 40u))
+
+/* Events of one message in a slot of the window */
+#if PUBLISHER_COALESCE_MS > 0
+#define MAX_EVENTS_IN_FLIGHT            (PUBLISHER_COALESCE_MAX_EVENTS)
+#else
+#define MAX_EVENTS_IN_FLIGHT            (1u)
+#endif
 
 /******************************************************************************
 * Function Prototypes
 *******************************************************************************/
-
+static void publish_message(cy_mqtt_t mqtt_connection, publisher_data_t *msg);
+static void publish_state(cy_mqtt_t mqtt_connection);
+#if PUBLISHER_COALESCE_MS > 0
+static void coalesce_event(cy_mqtt_t mqtt_connection, const publisher_data_t *msg);
+static void flush_events(cy_mqtt_t mqtt_connection);
+static TickType_t coalesce_wait(void);
+#endif
+#if EVENT_LOG_ENABLE
+static void publish_logged(cy_mqtt_t mqtt_connection, const event_log_record_t *record);
+static void replay_event(cy_mqtt_t mqtt_connection);
+static TickType_t replay_wait(void);
+#endif
+#if EVENT_LOG_ENABLE && (PUBLISHER_INFLIGHT_WINDOW > 1)
+static uint32_t acquire_events_slot(void);
+static void settle_events(void);
+#endif
 
 /******************************************************************************
 * Global Variables
@@ -88,11 +123,10 @@
 /* FreeRTOS task handle for this task. */
 TaskHandle_t publisher_task_handle;
 
-/* Handle of the queue holding the commands for the publisher task */
-QueueHandle_t publisher_task_q;
-
-/* Structure to store publish message information. */
-cy_mqtt_publish_info_t publish_info[2] =
+/* Structure to store publish message information. The topics are replaced
+ * by those of the topic table when the task starts.
+ */
+cy_mqtt_publish_info_t publish_info[PRESENCE_TOPIC_COUNT] =
 {
     {.qos = (cy_mqtt_qos_t) MQTT_MESSAGES_QOS,
     .topic = MQTT_PUB_TOPIC_STATUS,
@@ -100,12 +134,93 @@ cy_mqtt_publish_info_t publish_info[2] =
     .retain = false,
     .dup = false},
     {.qos = (cy_mqtt_qos_t) MQTT_MESSAGES_QOS,
-    .topic = MQTT_PUB_TOPIC_EVENTS,
-    .topic_len = (sizeof(MQTT_PUB_TOPIC_EVENTS) - 1),
+    .topic = PAYLOAD_EVENTS_TOPIC,
+    .topic_len = (sizeof(PAYLOAD_EVENTS_TOPIC) - 1),
     .retain = false,
     .dup = false},
+    {.qos = (cy_mqtt_qos_t) MQTT_TELEMETRY_QOS,
+    .topic = MQTT_PUB_TOPIC_DIAGNOSTICS,
+    .topic_len = (sizeof(MQTT_PUB_TOPIC_DIAGNOSTICS) - 1),
+    .retain = false,
+    .dup = false},
+    {.qos = (cy_mqtt_qos_t) MQTT_CAPTURE_QOS,
+    .topic = MQTT_PUB_TOPIC_CAPTURE,
+    .topic_len = (sizeof(MQTT_PUB_TOPIC_CAPTURE) - 1),
+    .retain = false,
+    .dup = false},
+    /* The broker keeps the latest state for subscribers that join later. */
+    {.qos = (cy_mqtt_qos_t) MQTT_MESSAGES_QOS,
+    .topic = PAYLOAD_STATE_TOPIC,
+    .topic_len = (sizeof(PAYLOAD_STATE_TOPIC) - 1),
+    .retain = true,
+    .dup = false},
 };
 
+/* Latest presence state taken from the mailbox, published again after a
+ * reconnection in case the broker lost its retained message.
+ */
+static presence_event_t current_state;
+static bool current_state_valid;
+
+/* False between the deinit and init commands of the MQTT client task: the
+ * state is only recorded and published after the reconnection, and with the
+ * event log, the events go to the log instead of the broker.
+ */
+static bool online = true;
+
+/* Payload of the state; the state is an ordered topic of the window, so the
+ * buffer is free again once the next slot for it is acquired.
+ */
+static char state_payload[MQTT_PUB_MSG_MAX_SIZE];
+
+#if PUBLISHER_COALESCE_MS > 0
+/* Events waiting for the end of the coalescing window */
+typedef struct
+{
+    presence_event_t event;
+#if LATENCY_TRACE_ENABLE
+    uint32_t trace_id;
+#endif
+} coalesced_event_t;
+
+static coalesced_event_t coalesced_events[PUBLISHER_COALESCE_MAX_EVENTS];
+static uint32_t num_coalesced;
+static TickType_t coalesce_start;
+
+/* State of the last event received, an arrival after absence is not held */
+static presence_event_state_t last_event_state = PRESENCE_EVENT_ABSENCE;
+
+static char coalesce_payload[COALESCE_PAYLOAD_SIZE];
+#endif
+
+#if EVENT_LOG_ENABLE
+static bool event_log_ready;
+static TickType_t last_replay;
+
+/* Payload of the logged events; events are an ordered topic of the window,
+ * so the buffer is free again once the next slot for them is acquired.
+ */
+static char logged_payload[MQTT_PUB_MSG_MAX_SIZE * 2];
+#endif
+
+#if EVENT_LOG_ENABLE && (PUBLISHER_INFLIGHT_WINDOW > 1)
+/* The events message in a slot of the window, settled once its result is
+ * known: live events whose publish failed go to the log, a replayed event
+ * leaves the log only once the broker has it. Events are an ordered topic,
+ * so at most one message is in flight.
+ */
+typedef enum
+{
+    EVENTS_IDLE,
+    EVENTS_LIVE,
+    EVENTS_REPLAYED
+} events_in_flight_t;
+
+static events_in_flight_t events_in_flight = EVENTS_IDLE;
+static presence_event_t in_flight_events[MAX_EVENTS_IN_FLIGHT];
+static uint32_t num_in_flight_events;
+#endif
+
 
 /******************************************************************************
  * Function Name: publisher_task
@@ -114,7 +229,8 @@ cy_mqtt_publish_info_t publish_info[2] =
  *  Task that sets up the user button GPIO for the publisher and publishes 
  *  MQTT messages to the broker. The user button init and deinit operations,
  *  and the MQTT publish operation is performed based on commands sent by other
- *  tasks and callbacks over a message queue.
+ *  tasks and callbacks over the publisher lanes. Messages from the publisher pool
+ *  are returned to it once handled.
  *
  * Parameters:
  *  void *pvParameters : Task parameter defined during task creation (unused)
@@ -135,20 +251,126 @@ void publisher_task(void *pvParameters)
     /* Command to the MQTT client task */
     mqtt_task_cmd_t mqtt_task_cmd;
 
-    /* Create a message queue to communicate with other tasks and callbacks. */
-    publisher_task_q = xQueueCreate(PUBLISHER_TASK_QUEUE_LENGTH, sizeof( struct publisher_data_t * ));
+    /* The topics of the device, formatted once at boot. */
+    for (uint32_t topic = 0; topic < PRESENCE_TOPIC_COUNT; topic++)
+    {
+        publish_info[topic].topic = mqtt_topics_publish((presence_topic_t)topic, &publish_info[topic].topic_len);
+    }
+
+    /* Create the lanes that carry the messages of other tasks and callbacks. */
+    if (!publisher_lanes_init())
+    {
+        printf("  Publisher: failed to create the publisher lanes\n\n");
+        vTaskSuspend(NULL);
+    }
+
+#if PUBLISHER_INFLIGHT_WINDOW > 1
+    if (!publisher_window_init(mqtt_connection))
+    {
+        printf("  Publisher: failed to start the publisher window\n\n");
+        vTaskSuspend(NULL);
+    }
+#endif
+
+#if EVENT_LOG_ENABLE
+    /* Events logged before a reset are replayed right away. */
+    event_log_ready = event_log_init();
+    if (!event_log_ready)
+    {
+        printf("  Publisher: event log not available\n\n");
+    }
+    last_replay = xTaskGetTickCount();
+#endif
+
+#if PUBLISHER_LIMIT_ENABLE
+    publisher_limit_init();
+#endif
 
     while (true)
     {
-        /* Wait for commands from other tasks and callbacks. */
-        if (pdTRUE == xQueueReceive(publisher_task_q, &publisher_q_data, portMAX_DELAY))
+        TickType_t wait = portMAX_DELAY;
+
+#if PUBLISHER_COALESCE_MS > 0
+        /* Publish the coalesced events once their window has ended. */
+        wait = coalesce_wait();
+        if (wait == 0u)
+        {
+            flush_events(mqtt_connection);
+            wait = portMAX_DELAY;
+        }
+#endif
+
+#if EVENT_LOG_ENABLE
+#if PUBLISHER_INFLIGHT_WINDOW > 1
+        /* Keep or drop the events of a completed slot. */
+        settle_events();
+#endif
+
+        /* Replay the logged events one at a time between the live ones. */
+        if (replay_wait() == 0u)
+        {
+            replay_event(mqtt_connection);
+        }
+        if (replay_wait() < wait)
         {
+            wait = replay_wait();
+        }
+#endif
+
+#if PUBLISHER_LIMIT_ENABLE
+        /* Publish the held messages whose tokens have arrived. */
+        for (publisher_data_t *held = publisher_limit_release(); held != NULL;
+             held = publisher_limit_release())
+        {
+            publish_message(mqtt_connection, held);
+        }
+        if (publisher_limit_wait() < wait)
+        {
+            wait = publisher_limit_wait();
+        }
+#endif
+
+#if RADAR_LOW_POWER_MODE
+        /* The timed work above is due on the next sensor wakeup: the radar
+         * task wakes this task after each FIFO batch, so no timer of its own
+         * wakes the MCU.
+         */
+        wait = portMAX_DELAY;
+#endif
+
+        /* Only the freshest state is published, older ones were overwritten.
+         * While offline it is only recorded, the init command publishes it.
+         */
+        if (publisher_lanes_take_state(&current_state))
+        {
+            current_state_valid = true;
+            if (online)
+            {
+                publish_state(mqtt_connection);
+            }
+        }
+
+        /* Wait for commands from other tasks and callbacks, events first. */
+        if (publisher_lanes_receive(&publisher_q_data, wait))
+        {
+            LATENCY_TRACE_STAMP(*publisher_q_data, LATENCY_TRACE_DEQUEUED);
+
             switch(publisher_q_data->cmd)
             {
                 case PUBLISHER_INIT:
                 {
                     /* Reserved for customer extension. */
                     printf("  Publisher: init event occurred\n\n");
+                    if (current_state_valid)
+                    {
+                        publish_state(mqtt_connection);
+                    }
+
+                    /* The retained state is current again; with the event
+                     * log, the replay delivers the logged events once, in
+                     * order.
+                     */
+                    online = true;
                     break;
                 }
 
@@ -156,41 +378,598 @@ void publisher_task(void *pvParameters)
                 {
                     printf("  Publisher: deinit event occurred\n\n");
                     /* Reserved for customer extension. */
+                    online = false;
                     break;
                 }
 
                 case PUBLISH_MQTT_MSG:
                 {
-                    uint8_t topic_idx = publisher_q_data->topic;
+#if PUBLISHER_LIMIT_ENABLE
+                    /* Messages above the rate of their topic are held or dropped. */
+                    publisher_q_data = publisher_limit_admit(publisher_q_data);
+#endif
+                    if (publisher_q_data != NULL)
+                    {
+                        /* The block is returned once published. */
+                        publish_message(mqtt_connection, publisher_q_data);
+                        publisher_q_data = NULL;
+                    }
+                    break;
+                }
 
-                    /* Publish the data received over the message queue. */
-                    publish_info[topic_idx].payload = publisher_q_data->data;
-                    publish_info[topic_idx].payload_len = strlen(publish_info[topic_idx].payload);
+                case PUBLISH_RADAR_CAPTURE:
+                {
+                    const uint8_t *payload;
+                    size_t payload_len;
 
-                    printf("  Publisher: Publishing '%s' on the topic '%s'\n\n",
-                           (char *) publish_info[topic_idx].payload, publish_info[topic_idx].topic);
+                    /* Raw frames are binary, publish the batch in place. */
+                    if (radar_capture_take_ready(&payload, &payload_len))
+                    {
+                        publish_info[PRESENCE_CAPTURE].payload = (const char *)payload;
+                        publish_info[PRESENCE_CAPTURE].payload_len = payload_len;
 
-                    result = cy_mqtt_publish(mqtt_connection, &publish_info[topic_idx]);
+                        result = cy_mqtt_publish(mqtt_connection, &publish_info[PRESENCE_CAPTURE]);
+                        radar_capture_release();
 
-                    if (result != CY_RSLT_SUCCESS)
-                    {
-                        printf("  Publisher: MQTT Publish failed with error 0x%0X.\n\n", (int)result);
+                        if (result != CY_RSLT_SUCCESS)
+                        {
+                            printf("  Publisher: MQTT Publish failed with error 0x%0X.\n\n", (int)result);
 
-                        /* Communicate the publish failure with the the MQTT 
-                         * client task.
-                         */
-                        mqtt_task_cmd = HANDLE_MQTT_PUBLISH_FAILURE;
-                        xQueueSend(mqtt_task_q, &mqtt_task_cmd, portMAX_DELAY);
+                            mqtt_task_cmd = HANDLE_MQTT_PUBLISH_FAILURE;
+                            xQueueSend(mqtt_task_q, &mqtt_task_cmd, portMAX_DELAY);
+                        }
                     }
 
                     break;
                 }
             }
+
+            /* The message has been published, return its block. */
+            if ((publisher_q_data != NULL) && publisher_pool_owns(publisher_q_data))
+            {
+                publisher_pool_free(publisher_q_data);
+            }
+        }
+        else if (wait != portMAX_DELAY)
+        {
+            /* Coalesced events, the replay or held messages were due. */
+            power_stats_timed_wakeup();
         }
     }
 }
 
+/******************************************************************************
+ * Function Name: publish_message
+ ******************************************************************************
+ * Summary:
+ *  Publishes a message of another task, or logs it while offline, and
+ *  returns its block to the publisher pool. Events are coalesced when
+ *  PUBLISHER_COALESCE_MS is set; with the publisher window a slot publishes
+ *  the message and returns the block once the broker has it.
+ *
+ * Parameters:
+ *  cy_mqtt_t mqtt_connection : MQTT connection handle
+ *  publisher_data_t *msg : message with the PUBLISH_MQTT_MSG command
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void publish_message(cy_mqtt_t mqtt_connection, publisher_data_t *msg)
+{
+#if EVENT_LOG_ENABLE
+    if (!online && event_log_ready && (msg->topic == PRESENCE_EVENTS))
+    {
+        (void)event_log_append(&msg->event);
+    }
+    else
+#endif
+#if PUBLISHER_COALESCE_MS > 0
+    if (msg->topic == PRESENCE_EVENTS)
+    {
+        coalesce_event(mqtt_connection, msg);
+    }
+    else
+#endif
+    {
+#if PUBLISHER_INFLIGHT_WINDOW > 1
+#if EVENT_LOG_ENABLE
+        /* The slot returns the block, the event is kept until the result. */
+        if (msg->topic == PRESENCE_EVENTS)
+        {
+            uint32_t slot = acquire_events_slot();
+
+            events_in_flight = EVENTS_LIVE;
+            in_flight_events[0] = msg->event;
+            num_in_flight_events = 1u;
+            publisher_window_submit(slot, msg->data, msg->data_len, msg);
+            return;
+        }
+#endif
+        /* The slot returns the block once the broker has it. */
+        publisher_window_submit(publisher_window_acquire(msg->topic), msg->data, msg->data_len, msg);
+        return;
+#else
+        cy_rslt_t result = publisher_publish(mqtt_connection, msg->topic, msg->data, msg->data_len);
+        LATENCY_TRACE_STAMP(*msg, LATENCY_TRACE_PUBLISHED);
+
+#if EVENT_LOG_ENABLE
+        /* Publishes fail until the MQTT client task sends deinit. */
+        if ((result != CY_RSLT_SUCCESS) && event_log_ready && (msg->topic == PRESENCE_EVENTS))
+        {
+            (void)event_log_append(&msg->event);
+        }
+#else
+        (void)result;
+#endif
+#endif
+    }
+
+    if (publisher_pool_owns(msg))
+    {
+        publisher_pool_free(msg);
+    }
+}
+
+/******************************************************************************
+ * Function Name: publish_state
+ ******************************************************************************
+ * Summary:
+ *  Publishes the current presence state as a retained message on the state
+ *  topic, with the members of the event it was taken from.
+ *
+ * Parameters:
+ *  cy_mqtt_t mqtt_connection : MQTT connection handle
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void publish_state(cy_mqtt_t mqtt_connection)
+{
+    payload_writer_t writer;
+    size_t len;
+#if PUBLISHER_INFLIGHT_WINDOW > 1
+    uint32_t slot = publisher_window_acquire(PRESENCE_STATE);
+#endif
+
+    payload_writer_init(&writer, PAYLOAD_FORMAT, state_payload, sizeof(state_payload));
+    presence_event_begin(&writer, &current_state, 0u);
+    payload_end(&writer);
+    len = payload_writer_finish(&writer);
+
+    /* A length of 0 would be published as text up to a NUL. */
+    if (len == 0u)
+    {
+        printf("[WARN] state payload does not fit, state not published\n");
+#if PUBLISHER_INFLIGHT_WINDOW > 1
+        publisher_window_release(slot);
+#endif
+        return;
+    }
+
+#if PUBLISHER_INFLIGHT_WINDOW > 1
+    (void)mqtt_connection;
+    publisher_window_submit(slot, state_payload, len, NULL);
+#else
+    (void)publisher_publish(mqtt_connection, PRESENCE_STATE, state_payload, len);
+#endif
+}
+
+/******************************************************************************
+ * Function Name: publisher_publish
+ ******************************************************************************
+ * Summary:
+ *  Publishes a payload on one of the topics of the application. A
+ *  failure is reported to the MQTT client task. Called by the publisher
+ *  task and the slots of the publisher window.
+ *
+ * Parameters:
+ *  cy_mqtt_t mqtt_connection : MQTT connection handle
+ *  presence_topic_t topic : topic to publish on
+ *  const char *payload : payload
+ *  size_t payload_len : length of a binary payload, 0 for NUL terminated text
+ *
+ * Return:
+ *  cy_rslt_t : result of cy_mqtt_publish()
+ *
+ ******************************************************************************/
+cy_rslt_t publisher_publish(cy_mqtt_t mqtt_connection, presence_topic_t topic, const char *payload,
+                            size_t payload_len)
+{
+    cy_rslt_t result;
+    mqtt_task_cmd_t mqtt_task_cmd;
 
+    /* A copy, the slots of the window publish on the same topic at once. */
+    cy_mqtt_publish_info_t info = publish_info[topic];
 
+    info.payload = payload;
+    info.payload_len = (payload_len != 0u) ? payload_len : strlen(payload);
+
+    if ((PAYLOAD_FORMAT == PAYLOAD_FORMAT_CBOR) && ((topic == PRESENCE_EVENTS) || (topic == PRESENCE_STATE)))
+    {
+        printf("  Publisher: Publishing %u bytes of CBOR on the topic '%s'\n\n",
+               (unsigned)info.payload_len, info.topic);
+    }
+    else
+    {
+        printf("  Publisher: Publishing '%.*s' on the topic '%s'\n\n",
+               (int)info.payload_len, payload, info.topic);
+    }
+
+    result = cy_mqtt_publish(mqtt_connection, &info);
+
+    if (result != CY_RSLT_SUCCESS)
+    {
+        printf("  Publisher: MQTT Publish failed with error 0x%0X.\n\n", (int)result);
+
+        /* Communicate the publish failure with the the MQTT client task. */
+        mqtt_task_cmd = HANDLE_MQTT_PUBLISH_FAILURE;
+        xQueueSend(mqtt_task_q, &mqtt_task_cmd, portMAX_DELAY);
+    }
+
+    return result;
+}
+
+#if PUBLISHER_COALESCE_MS > 0
+/******************************************************************************
+ * Function Name: coalesce_event
+ ******************************************************************************
+ * Summary:
+ *  Holds a presence event until the coalescing window of the first held
+ *  event ends. An arrival after absence, and the event that fills the
+ *  batch, publish the batch at once.
+ *
+ * Parameters:
+ *  cy_mqtt_t mqtt_connection : MQTT connection handle
+ *  const publisher_data_t *msg : message on the events topic
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void coalesce_event(cy_mqtt_t mqtt_connection, const publisher_data_t *msg)
+{
+    coalesced_event_t *held = &coalesced_events[num_coalesced];
+    bool arrival = (last_event_state == PRESENCE_EVENT_ABSENCE) &&
+                   (msg->event.state != PRESENCE_EVENT_ABSENCE);
+
+    if (num_coalesced == 0u)
+    {
+        coalesce_start = xTaskGetTickCount();
+    }
+
+    held->event = msg->event;
+#if LATENCY_TRACE_ENABLE
+    held->trace_id = msg->trace_id;
+#endif
+    num_coalesced++;
+    last_event_state = msg->event.state;
+
+    if (arrival || (num_coalesced == PUBLISHER_COALESCE_MAX_EVENTS))
+    {
+        flush_events(mqtt_connection);
+    }
+}
+
+/******************************************************************************
+ * Function Name: flush_events
+ ******************************************************************************
+ * Summary:
+ *  Publishes the held events as one message, for example
+ *  {"v": 1, "PRESENCE": "OUT", "seq": 42, ..., "events": [["IN micro",
+ *  81200, 41], ["OUT", 81950, 42]]}. The members of the schema are those
+ *  of the latest event, as in the single event messages, so subscribers
+ *  that only follow the state need no change; "events" lists each event
+ *  with its time in ms of the presence library time base and its
+ *  sequence number.
+ *
+ * Parameters:
+ *  cy_mqtt_t mqtt_connection : MQTT connection handle
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void flush_events(cy_mqtt_t mqtt_connection)
+{
+    payload_writer_t writer;
+    size_t len;
+    uint32_t i;
+#if PUBLISHER_INFLIGHT_WINDOW > 1
+    uint32_t slot;
+#endif
+
+    if (num_coalesced == 0u)
+    {
+        return;
+    }
+
+#if EVENT_LOG_ENABLE
+    if (!online && event_log_ready)
+    {
+        for (i = 0u; i < num_coalesced; i++)
+        {
+            (void)event_log_append(&coalesced_events[i].event);
+        }
+        num_coalesced = 0u;
+        return;
+    }
+#endif
+
+#if PUBLISHER_INFLIGHT_WINDOW > 1
+    /* Events are an ordered topic: once the slot is acquired, the previous
+     * message from the payload buffer has been published.
+     */
+#if EVENT_LOG_ENABLE
+    slot = acquire_events_slot();
+#else
+    slot = publisher_window_acquire(PRESENCE_EVENTS);
+#endif
+#endif
+
+    payload_writer_init(&writer, PAYLOAD_FORMAT, coalesce_payload, sizeof(coalesce_payload));
+    presence_event_begin(&writer, &coalesced_events[num_coalesced - 1u].event, 1u + LATENCY_TRACE_ENABLE);
+    payload_key(&writer, "events");
+    payload_begin_array(&writer, num_coalesced);
+    for (i = 0u; i < num_coalesced; i++)
+    {
+        payload_begin_array(&writer, 3u);
+        payload_string(&writer, presence_event_state_name(coalesced_events[i].event.state));
+        payload_uint(&writer, coalesced_events[i].event.timestamp_ms);
+        payload_uint(&writer, coalesced_events[i].event.seq);
+        payload_end(&writer);
+    }
+    payload_end(&writer);
+
+    /* The message is matched to the trace of its oldest event. */
+#if LATENCY_TRACE_ENABLE
+    payload_key(&writer, "trace");
+    payload_uint(&writer, coalesced_events[0].trace_id);
+#endif
+    payload_end(&writer);
+    len = payload_writer_finish(&writer);
+
+    /* A length of 0 would be published as text up to a NUL. */
+    if (len == 0u)
+    {
+        printf("[WARN] coalesced payload does not fit, %u events dropped\n", (unsigned)num_coalesced);
+#if PUBLISHER_INFLIGHT_WINDOW > 1
+        publisher_window_release(slot);
+#endif
+        num_coalesced = 0u;
+        return;
+    }
+
+#if PUBLISHER_INFLIGHT_WINDOW > 1
+    (void)mqtt_connection;
+#if EVENT_LOG_ENABLE
+    events_in_flight = EVENTS_LIVE;
+    for (i = 0u; i < num_coalesced; i++)
+    {
+        in_flight_events[i] = coalesced_events[i].event;
+    }
+    num_in_flight_events = num_coalesced;
+#endif
+    publisher_window_submit(slot, coalesce_payload, len, NULL);
+#elif EVENT_LOG_ENABLE
+    if ((publisher_publish(mqtt_connection, PRESENCE_EVENTS, coalesce_payload, len) != CY_RSLT_SUCCESS) &&
+        event_log_ready)
+    {
+        for (i = 0u; i < num_coalesced; i++)
+        {
+            (void)event_log_append(&coalesced_events[i].event);
+        }
+    }
+#else
+    (void)publisher_publish(mqtt_connection, PRESENCE_EVENTS, coalesce_payload, len);
+#endif
+
+    /* With the window, the events are stamped when handed to the slot. */
+#if LATENCY_TRACE_ENABLE
+    for (i = 0u; i < num_coalesced; i++)
+    {
+        latency_trace_stamp(coalesced_events[i].trace_id, LATENCY_TRACE_PUBLISHED);
+    }
+#endif
+
+    num_coalesced = 0u;
+}
+
+/******************************************************************************
+ * Function Name: coalesce_wait
+ ******************************************************************************
+ * Summary:
+ *  Returns the ticks until the coalescing window of the held events ends.
+ *
+ * Return:
+ *  TickType_t : 0 if the window has ended, portMAX_DELAY without events
+ *
+ ******************************************************************************/
+static TickType_t coalesce_wait(void)
+{
+    TickType_t window = pdMS_TO_TICKS(PUBLISHER_COALESCE_MS);
+    TickType_t elapsed;
+
+    if (num_coalesced == 0u)
+    {
+        return portMAX_DELAY;
+    }
+
+    elapsed = xTaskGetTickCount() - coalesce_start;
+    return (elapsed >= window) ? 0u : (window - elapsed);
+}
+#endif
+
+#if EVENT_LOG_ENABLE
+/******************************************************************************
+ * Function Name: publish_logged
+ ******************************************************************************
+ * Summary:
+ *  Replays an event of the log with its original timestamp and sequence
+ *  number. The event is flagged as replayed, so that subscribers that follow
+ *  the current state can skip it, and taken out of the log once published.
+ *
+ * Parameters:
+ *  cy_mqtt_t mqtt_connection : MQTT connection handle
+ *  const event_log_record_t *record : oldest logged event
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void publish_logged(cy_mqtt_t mqtt_connection, const event_log_record_t *record)
+{
+    size_t len;
+#if PUBLISHER_INFLIGHT_WINDOW > 1
+    uint32_t slot;
+#endif
+
+    /* No replayed event is in flight, the payload buffer is free. A record
+     * that does not fit would never be published: it is dropped.
+     */
+    len = event_log_format(record, true, logged_payload, sizeof(logged_payload));
+    if (len == 0u)
+    {
+        printf("[WARN] logged event %u does not fit, dropped from the log\n", (unsigned)record->seq);
+        event_log_pop();
+        return;
+    }
+
+#if PUBLISHER_INFLIGHT_WINDOW > 1
+    /* The record leaves the log once the slot result is settled. */
+    (void)mqtt_connection;
+    slot = acquire_events_slot();
+    events_in_flight = EVENTS_REPLAYED;
+    num_in_flight_events = 0u;
+    publisher_window_submit(slot, logged_payload, len, NULL);
+#else
+    if (publisher_publish(mqtt_connection, PRESENCE_EVENTS, logged_payload, len) == CY_RSLT_SUCCESS)
+    {
+        event_log_pop();
+    }
+#endif
+}
+
+/******************************************************************************
+ * Function Name: replay_event
+ ******************************************************************************
+ * Summary:
+ *  Publishes the oldest event of the log. A replayed event is taken out of
+ *  the log once published; a failed one is retried.
+ *
+ * Parameters:
+ *  cy_mqtt_t mqtt_connection : MQTT connection handle
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void replay_event(cy_mqtt_t mqtt_connection)
+{
+    event_log_record_t record;
+
+    last_replay = xTaskGetTickCount();
+    if (event_log_peek(&record))
+    {
+        publish_logged(mqtt_connection, &record);
+    }
+}
+
+/******************************************************************************
+ * Function Name: replay_wait
+ ******************************************************************************
+ * Summary:
+ *  Returns the ticks until the next event of the log is due for its replay,
+ *  EVENT_LOG_REPLAY_INTERVAL_MS after the previous one.
+ *
+ * Return:
+ *  TickType_t : 0 if due, portMAX_DELAY while offline, with an empty log, or
+ *  while the previous replayed event is in flight
+ *
+ ******************************************************************************/
+static TickType_t replay_wait(void)
+{
+    TickType_t interval = pdMS_TO_TICKS(EVENT_LOG_REPLAY_INTERVAL_MS);
+    TickType_t elapsed;
+    event_log_record_t record;
+
+    if (!online || !event_log_ready || !event_log_peek(&record))
+    {
+        return portMAX_DELAY;
+    }
+
+#if PUBLISHER_INFLIGHT_WINDOW > 1
+    /* The slot result wakes the publisher task. */
+    if (events_in_flight == EVENTS_REPLAYED)
+    {
+        return portMAX_DELAY;
+    }
+#endif
+
+    elapsed = xTaskGetTickCount() - last_replay;
+    return (elapsed >= interval) ? 0u : (interval - elapsed);
+}
+
+#if PUBLISHER_INFLIGHT_WINDOW > 1
+/******************************************************************************
+ * Function Name: acquire_events_slot
+ ******************************************************************************
+ * Summary:
+ *  Reserves a slot of the window for an events message. The previous events
+ *  message has completed once the slot is acquired, it is settled first.
+ *
+ * Return:
+ *  uint32_t : slot to pass to publisher_window_submit()
+ *
+ ******************************************************************************/
+static uint32_t acquire_events_slot(void)
+{
+    uint32_t slot = publisher_window_acquire(PRESENCE_EVENTS);
+
+    settle_events();
+    return slot;
+}
+
+/******************************************************************************
+ * Function Name: settle_events
+ ******************************************************************************
+ * Summary:
+ *  Takes the result of the events message of the window once it has
+ *  completed. The events of a failed live message are appended to the log,
+ *  a replayed event is taken out of the log once published; a failed one
+ *  stays and is replayed again.
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void settle_events(void)
+{
+    bool published;
+    uint32_t i;
+
+    if (!publisher_window_take_done(PRESENCE_EVENTS, &published))
+    {
+        return;
+    }
+
+    if ((events_in_flight == EVENTS_REPLAYED) && published)
+    {
+        event_log_pop();
+    }
+    else if ((events_in_flight == EVENTS_LIVE) && !published && event_log_ready)
+    {
+        for (i = 0u; i < num_in_flight_events; i++)
+        {
+            (void)event_log_append(&in_flight_events[i]);
+        }
+    }
+
+    events_in_flight = EVENTS_IDLE;
+    num_in_flight_events = 0u;
+}
+#endif
+#endif
 
 /* [] END OF FILE */
@@ -42,6 +42,10 @@
 #ifndef PUBLISHER_TASK_H_
 #define PUBLISHER_TASK_H_
 
+#include "cy_mqtt_api.h"
+#include "latency_trace.h"
+#include "presence_event.h"
+
 /*******************************************************************************
 * Macros
 ********************************************************************************/
@@ -50,6 +54,37 @@
 
 #define MQTT_PUB_QUEUE_LENGTH (10u)
 #define MQTT_PUB_MSG_MAX_SIZE (128u)
+
+/* Depths of the queues (lanes) towards the publisher task, see
+ * publisher_lanes.h: presence events, status replies and commands, and
+ * diagnostics and capture data.
+ */
+#define PUBLISHER_LANE_EVENTS_DEPTH     (3u)
+#define PUBLISHER_LANE_CONTROL_DEPTH    (2u)
+#define PUBLISHER_LANE_TELEMETRY_DEPTH  (2u)
+
+#define PUBLISHER_LANES_TOTAL_DEPTH     (PUBLISHER_LANE_EVENTS_DEPTH + PUBLISHER_LANE_CONTROL_DEPTH + \
+                                         PUBLISHER_LANE_TELEMETRY_DEPTH)
+
+/* Presence events that arrive within this many milliseconds of the first
+ * one are published together, as one message on the events topic. An
+ * arrival after absence is published at once. With 0 every event is
+ * published on its own.
+ */
+#ifndef PUBLISHER_COALESCE_MS
+#define PUBLISHER_COALESCE_MS           (0u)
+#endif
+
+/* Events of one coalesced message, a full batch is published at once */
+#define PUBLISHER_COALESCE_MAX_EVENTS   (8u)
+
+/* QoS 1 messages in flight to the broker, see publisher_window.h. With 1
+ * the publisher task waits for the PUBACK of each message before sending
+ * the next one.
+ */
+#ifndef PUBLISHER_INFLIGHT_WINDOW
+#define PUBLISHER_INFLIGHT_WINDOW       (1u)
+#endif
 /*******************************************************************************
 * Global Variables
 ********************************************************************************/
@@ -58,7 +93,8 @@ typedef enum
 {
     PUBLISHER_INIT,
     PUBLISHER_DEINIT,
-    PUBLISH_MQTT_MSG
+    PUBLISH_MQTT_MSG,
+    PUBLISH_RADAR_CAPTURE
 } publisher_cmd_t;
 
 /* Topics for the Publisher Task. */
@@ -66,6 +102,10 @@ typedef enum
 {
     PRESENCE_STATUS,
     PRESENCE_EVENTS,
+    PRESENCE_DIAGNOSTICS,
+    PRESENCE_CAPTURE,
+    PRESENCE_STATE,
+    PRESENCE_TOPIC_COUNT
 } presence_topic_t;
 
 /* Struct to be passed via the publisher task queue */
@@ -73,6 +113,11 @@ typedef struct{
     publisher_cmd_t cmd;
     presence_topic_t topic;
     char data[MQTT_PUB_MSG_MAX_SIZE * 2];
+    uint16_t data_len;      /* Length of a binary payload, 0 for NUL terminated text */
+    presence_event_t event;  /* PRESENCE_EVENTS only: the presence event */
+#if LATENCY_TRACE_ENABLE
+    uint32_t trace_id;      /* Latency trace of the message, 0 for none */
+#endif
 } publisher_data_t;
 
 /*******************************************************************************
@@ -84,6 +129,8 @@ typedef struct{
 * Function Prototypes
 ********************************************************************************/
 void publisher_task(void *pvParameters);
+cy_rslt_t publisher_publish(cy_mqtt_t mqtt_connection, presence_topic_t topic, const char *payload,
+                            size_t payload_len);
 
 #endif /* PUBLISHER_TASK_H_ */
 
@@ -0,0 +1,403 @@
+/******************************************************************************
+ * File Name:   publisher_window.c
+ *
+ * Description: Window of QoS 1 messages in flight to the broker.
+ *              cy_mqtt_publish() blocks until the broker acknowledges a QoS 1
+ *              message, so one publishing task sends at most one message per round
+ *              trip. The window keeps up to PUBLISHER_INFLIGHT_WINDOW messages in
+ *              flight, each published by a slot task of its own, and returns the
+ *              message block to the pool once its PUBACK has arrived.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "rtos_artifacts.h"
+
+#include "publisher_window.h"
+#include "publisher_pool.h"
+#include "publisher_lanes.h"
+#include "latency_trace.h"
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    bool busy;
+    presence_topic_t topic;
+    const char *payload;
+    size_t payload_len;
+    publisher_data_t *block;    /* Returned to the pool after the publish */
+    TaskHandle_t task;
+} window_slot_t;
+
+/*******************************************************************************
+ * Local Variables
+ ******************************************************************************/
+static window_slot_t slots[PUBLISHER_INFLIGHT_WINDOW];
+static uint8_t topic_in_flight[PRESENCE_TOPIC_COUNT];
+static cy_mqtt_t connection;
+
+/* Result of the last message of each reported topic, until taken */
+static bool done_pending[PRESENCE_TOPIC_COUNT];
+static bool done_published[PRESENCE_TOPIC_COUNT];
+
+/* Task waiting in publisher_window_acquire(), woken when a slot is freed */
+static TaskHandle_t dispatcher;
+
+static publisher_window_stats_t stats;
+
+/* Counts at the last report, the report gives the rate since then */
+static uint32_t reported_done;
+static uint32_t reported_published;
+static uint32_t reported_ack_ms_sum;
+static uint32_t last_report_ms;
+
+/*******************************************************************************
+ * Function Name: slot_task
+ *******************************************************************************
+ * Summary:
+ *   Publishes the messages submitted to one slot of the window. The slot is
+ *   freed, and the block of the message returned to the pool, when
+ *   cy_mqtt_publish() returns: for QoS 1 after the PUBACK. The result of a
+ *   message of the PUBLISHER_WINDOW_REPORTED_TOPICS is kept for the
+ *   publisher task, which is woken to take it.
+ *
+ * Parameters:
+ *   pvParameters: slot index
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void slot_task(void *pvParameters)
+{
+    window_slot_t *slot = &slots[(uint32_t)(uintptr_t)pvParameters];
+    TickType_t start;
+    uint32_t ack_ms;
+    cy_rslt_t result;
+    bool reported;
+
+    while (true)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        start = xTaskGetTickCount();
+        result = publisher_publish(connection, slot->topic, slot->payload, slot->payload_len);
+        ack_ms = (uint32_t)(xTaskGetTickCount() - start) * portTICK_PERIOD_MS;
+
+        if (slot->block != NULL)
+        {
+            LATENCY_TRACE_STAMP(*slot->block, LATENCY_TRACE_PUBLISHED);
+            if (publisher_pool_owns(slot->block))
+            {
+                publisher_pool_free(slot->block);
+            }
+        }
+
+        taskENTER_CRITICAL();
+        if (result == CY_RSLT_SUCCESS)
+        {
+            ++stats.published;
+            stats.ack_ms_sum += ack_ms;
+            if (ack_ms > stats.ack_ms_max)
+            {
+                stats.ack_ms_max = ack_ms;
+            }
+        }
+        else
+        {
+            ++stats.failed;
+        }
+        reported = ((PUBLISHER_WINDOW_REPORTED_TOPICS & (1u << slot->topic)) != 0u);
+        if (reported)
+        {
+            done_pending[slot->topic] = true;
+            done_published[slot->topic] = (result == CY_RSLT_SUCCESS);
+        }
+        --stats.in_flight;
+        --topic_in_flight[slot->topic];
+        slot->busy = false;
+        taskEXIT_CRITICAL();
+
+        if (dispatcher != NULL)
+        {
+            xTaskNotifyGive(dispatcher);
+        }
+        if (reported)
+        {
+            publisher_lanes_wake();
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: publisher_window_init
+ *******************************************************************************
+ * Summary:
+ *   Starts the slot tasks of the window.
+ *
+ * Parameters:
+ *   mqtt_connection: MQTT connection handle the slots publish on
+ *
+ * Return:
+ *   True on success
+ ******************************************************************************/
+bool publisher_window_init(cy_mqtt_t mqtt_connection)
+{
+    connection = mqtt_connection;
+
+    for (uint32_t i = 0; i < PUBLISHER_INFLIGHT_WINDOW; ++i)
+    {
+        if (pdPASS != xTaskCreate(slot_task, "Publisher slot", PUBLISHER_WINDOW_TASK_STACK_SIZE,
+                                  (void *)(uintptr_t)i, PUBLISHER_WINDOW_TASK_PRIORITY, &slots[i].task))
+        {
+            publisher_window_deinit();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: publisher_window_deinit
+ *******************************************************************************
+ * Summary:
+ *   Deletes the slot tasks of the window.
+ ******************************************************************************/
+void publisher_window_deinit(void)
+{
+    for (uint32_t i = 0; i < PUBLISHER_INFLIGHT_WINDOW; ++i)
+    {
+        if (slots[i].task != NULL)
+        {
+            vTaskDelete(slots[i].task);
+            slots[i].task = NULL;
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: publisher_window_acquire
+ *******************************************************************************
+ * Summary:
+ *   Reserves a slot for a message on a topic, waiting until one is free
+ *   and, for the PUBLISHER_WINDOW_ORDERED_TOPICS, until the previous message
+ *   of the topic has been acknowledged. Called by the publisher task only.
+ *
+ * Parameters:
+ *   topic: topic of the message
+ *
+ * Return:
+ *   Slot to pass to publisher_window_submit()
+ ******************************************************************************/
+uint32_t publisher_window_acquire(presence_topic_t topic)
+{
+    bool ordered = ((PUBLISHER_WINDOW_ORDERED_TOPICS & (1u << topic)) != 0u);
+    uint32_t slot;
+
+    dispatcher = xTaskGetCurrentTaskHandle();
+
+    while (true)
+    {
+        slot = PUBLISHER_INFLIGHT_WINDOW;
+
+        taskENTER_CRITICAL();
+        if (!ordered || (topic_in_flight[topic] == 0u))
+        {
+            for (uint32_t i = 0; i < PUBLISHER_INFLIGHT_WINDOW; ++i)
+            {
+                if (!slots[i].busy)
+                {
+                    slot = i;
+                    break;
+                }
+            }
+        }
+
+        if (slot < PUBLISHER_INFLIGHT_WINDOW)
+        {
+            slots[slot].busy = true;
+            slots[slot].topic = topic;
+            ++topic_in_flight[topic];
+            if (++stats.in_flight > stats.max_in_flight)
+            {
+                stats.max_in_flight = stats.in_flight;
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if (slot < PUBLISHER_INFLIGHT_WINDOW)
+        {
+            return slot;
+        }
+
+        /* A slot task notifies each publish that completes. */
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: publisher_window_submit
+ *******************************************************************************
+ * Summary:
+ *   Publishes a message from a slot reserved with publisher_window_acquire().
+ *   The payload must stay valid until the publish has completed: a block is
+ *   returned to the pool by the slot, other buffers are free once the next
+ *   slot of their ordered topic has been acquired.
+ *
+ * Parameters:
+ *   slot: reserved slot
+ *   payload: payload
+ *   payload_len: length of a binary payload, 0 for NUL terminated text
+ *   block: message block holding the payload, or NULL
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void publisher_window_submit(uint32_t slot, const char *payload, size_t payload_len, publisher_data_t *block)
+{
+    slots[slot].payload = payload;
+    slots[slot].payload_len = payload_len;
+    slots[slot].block = block;
+    xTaskNotifyGive(slots[slot].task);
+}
+
+/*******************************************************************************
+ * Function Name: publisher_window_release
+ *******************************************************************************
+ * Summary:
+ *   Frees a slot reserved with publisher_window_acquire() without
+ *   publishing, for example when the payload could not be written.
+ *
+ * Parameters:
+ *   slot: reserved slot
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void publisher_window_release(uint32_t slot)
+{
+    taskENTER_CRITICAL();
+    --stats.in_flight;
+    --topic_in_flight[slots[slot].topic];
+    slots[slot].busy = false;
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+ * Function Name: publisher_window_take_done
+ *******************************************************************************
+ * Summary:
+ *   Takes the result of the last message of a reported topic. Since these
+ *   topics are ordered, the result of a message is always available once
+ *   publisher_window_acquire() returned the next slot of its topic.
+ *
+ * Parameters:
+ *   topic: one of the PUBLISHER_WINDOW_REPORTED_TOPICS
+ *   published: set to true if the broker has the message
+ *
+ * Return:
+ *   True if a message of the topic completed since the last call
+ ******************************************************************************/
+bool publisher_window_take_done(presence_topic_t topic, bool *published)
+{
+    bool done;
+
+    taskENTER_CRITICAL();
+    done = done_pending[topic];
+    *published = done_published[topic];
+    done_pending[topic] = false;
+    taskEXIT_CRITICAL();
+
+    return done;
+}
+
+/*******************************************************************************
+ * Function Name: publisher_window_get_stats
+ ******************************************************************************/
+void publisher_window_get_stats(publisher_window_stats_t *window_stats)
+{
+    taskENTER_CRITICAL();
+    *window_stats = stats;
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+ * Function Name: publisher_window_poll
+ *******************************************************************************
+ * Summary:
+ *   Writes a JSON report of the window every PUBLISHER_WINDOW_REPORT_INTERVAL_MS
+ *   when messages were published since the last report: the throughput and
+ *   mean acknowledgement time since then, and the high-water marks.
+ *
+ * Parameters:
+ *   now_ms: current time in milliseconds
+ *   report: buffer for the JSON report
+ *   report_size: size of the buffer
+ *
+ * Return:
+ *   True if a report was written
+ ******************************************************************************/
+bool publisher_window_poll(uint32_t now_ms, char *report, size_t report_size)
+{
+    publisher_window_stats_t current;
+    uint32_t interval_ms = now_ms - last_report_ms;
+    uint32_t done;
+    uint32_t published;
+
+    if (interval_ms < PUBLISHER_WINDOW_REPORT_INTERVAL_MS)
+    {
+        return false;
+    }
+
+    publisher_window_get_stats(&current);
+    done = current.published + current.failed;
+    if (done == reported_done)
+    {
+        last_report_ms = now_ms;
+        return false;
+    }
+
+    published = current.published - reported_published;
+    snprintf(report, report_size,
+             "{\"publisher_window\": {\"window\": %u, \"in_flight\": %" PRIu32 ", \"max_in_flight\": %" PRIu32 ", "
+             "\"msgs_per_min\": %" PRIu32 ", \"ack_ms_avg\": %" PRIu32 ", \"ack_ms_max\": %" PRIu32 ", "
+             "\"published\": %" PRIu32 ", \"failed\": %" PRIu32 "}}",
+             (unsigned)PUBLISHER_INFLIGHT_WINDOW, current.in_flight, current.max_in_flight,
+             (uint32_t)(((uint64_t)published * 60000u) / interval_ms),
+             (published == 0u) ? 0u : ((current.ack_ms_sum - reported_ack_ms_sum) / published),
+             current.ack_ms_max,
+             current.published, current.failed);
+
+    reported_done = done;
+    reported_published = current.published;
+    reported_ack_ms_sum = current.ack_ms_sum;
+    last_report_ms = now_ms;
+
+    return true;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,102 @@
+/******************************************************************************
+ * File Name:   publisher_window.h
+ *
+ * Description: Window of QoS 1 messages in flight to the broker.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef PUBLISHER_WINDOW_H_
+#define PUBLISHER_WINDOW_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cy_mqtt_api.h"
+#include "publisher_task.h"
+#include "event_log.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Each slot of the window publishes from a task of its own, since
+ * cy_mqtt_publish() returns only once a QoS 1 message is acknowledged.
+ */
+#define PUBLISHER_WINDOW_TASK_PRIORITY      (PUBLISHER_TASK_PRIORITY)
+#define PUBLISHER_WINDOW_TASK_STACK_SIZE    (1024 * 2)
+
+/* Topics whose messages are published in order: at most one of their
+ * messages is in flight. The diagnostics reports may overtake each other.
+ */
+#define PUBLISHER_WINDOW_ORDERED_TOPICS     ((1u << PRESENCE_STATUS) | (1u << PRESENCE_EVENTS) | \
+                                             (1u << PRESENCE_STATE))
+
+/* Ordered topics whose publish results are handed back to the publisher
+ * task, see publisher_window_take_done(): the event log keeps the live
+ * events whose publish failed, and drops a replayed event only once the
+ * broker has it.
+ */
+#if EVENT_LOG_ENABLE
+#define PUBLISHER_WINDOW_REPORTED_TOPICS    (1u << PRESENCE_EVENTS)
+#else
+#define PUBLISHER_WINDOW_REPORTED_TOPICS    (0u)
+#endif
+
+_Static_assert((PUBLISHER_WINDOW_REPORTED_TOPICS & ~PUBLISHER_WINDOW_ORDERED_TOPICS) == 0u,
+               "Publish results are only reported for ordered topics");
+
+/* Interval of the window report on the diagnostics topic. The report is
+ * only sent after messages were published through the window.
+ */
+#define PUBLISHER_WINDOW_REPORT_INTERVAL_MS (60u * 1000u)
+
+#if PUBLISHER_INFLIGHT_WINDOW > CY_MQTT_MAX_OUTGOING_PUBLISHES
+#error "PUBLISHER_INFLIGHT_WINDOW exceeds the outgoing publishes of the MQTT library"
+#endif
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    uint32_t published;     /* Messages acknowledged by the broker */
+    uint32_t failed;        /* Messages whose publish failed */
+    uint32_t in_flight;     /* Messages currently in flight */
+    uint32_t max_in_flight; /* High-water mark of in_flight */
+    uint32_t ack_ms_sum;    /* Time from the publish to its acknowledgement */
+    uint32_t ack_ms_max;
+} publisher_window_stats_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+bool publisher_window_init(cy_mqtt_t mqtt_connection);
+void publisher_window_deinit(void);
+uint32_t publisher_window_acquire(presence_topic_t topic);
+void publisher_window_submit(uint32_t slot, const char *payload, size_t payload_len, publisher_data_t *block);
+void publisher_window_release(uint32_t slot);
+bool publisher_window_take_done(presence_topic_t topic, bool *published);
+void publisher_window_get_stats(publisher_window_stats_t *stats);
+bool publisher_window_poll(uint32_t now_ms, char *report, size_t report_size);
+
+#endif
+/* [] END OF FILE */
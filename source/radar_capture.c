@@ -0,0 +1,340 @@
+/******************************************************************************
+ * File Name:   radar_capture.c
+ *
+ * Description: This file streams raw radar frames over MQTT for offline
+ *              analysis. Frames are packed to 12 bits per sample and sent in
+ *              batches, each with a header identifying the radar profile.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <string.h>
+
+/* Header file includes */
+#include "rtos_artifacts.h"
+
+#include "publisher_task.h"
+#include "publisher_lanes.h"
+#include "radar_capture.h"
+#include "radar_settings.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define RADAR_CAPTURE_FRAME_BYTES \
+    RADAR_CAPTURE_PACKED_SIZE(RADAR_SETTINGS_NUM_SAMPLES_PER_FRAME)
+
+_Static_assert(RADAR_CAPTURE_FRAME_BYTES == RADAR_SETTINGS_FRAME_PACKED_BYTES,
+               "Capture packing does not match the radar profile");
+_Static_assert(RADAR_CAPTURE_FRAMES_PER_BATCH <= UINT8_MAX,
+               "num_frames is an 8-bit header field");
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    radar_capture_header_t header;
+    uint8_t frames[RADAR_CAPTURE_FRAMES_PER_BATCH][RADAR_CAPTURE_FRAME_BYTES];
+} radar_capture_batch_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static radar_capture_batch_t batches[RADAR_CAPTURE_NUM_BATCHES];
+
+/* Batches available for filling, and batches waiting to be published */
+static QueueHandle_t free_q;
+static QueueHandle_t ready_q;
+
+/* Batch being filled by the radar task */
+static radar_capture_batch_t *filling;
+
+/* Batch being published by the publisher task */
+static radar_capture_batch_t *publishing;
+
+static volatile bool enabled;
+static uint32_t sequence;
+static uint32_t dropped_since_batch;
+static radar_capture_stats_t stats;
+
+/* The payload is taken from the ready queue, so the message is constant */
+static publisher_data_t capture_q_data =
+{
+    .cmd = PUBLISH_RADAR_CAPTURE,
+    .topic = PRESENCE_CAPTURE,
+};
+
+static publisher_data_t * capture_msg = &capture_q_data;
+
+/*******************************************************************************
+ * Function Name: drop_frames
+ *******************************************************************************
+ * Summary:
+ *   Counts frames that could not be captured. The count is reported in the
+ *   header of the next batch.
+ *
+ * Parameters:
+ *   count: number of frames dropped
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void drop_frames(uint32_t count)
+{
+    dropped_since_batch += count;
+    stats.frames_dropped += count;
+}
+
+/*******************************************************************************
+ * Function Name: flush_batch
+ *******************************************************************************
+ * Summary:
+ *   Hands the batch being filled over to the publisher task. When the
+ *   telemetry lane of the publisher is full the batch is recycled and its frames are
+ *   counted as dropped.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+static void flush_batch(void)
+{
+    radar_capture_batch_t *batch = filling;
+
+    filling = NULL;
+
+    if ((xQueueSendToBack(ready_q, &batch, 0) != pdTRUE) ||
+        !publisher_lanes_send(capture_msg, 0))
+    {
+        /* Nothing waits for the batch any more. A batch queued on ready_q
+         * without a message is picked up with the next one.
+         */
+        if (xQueueReceive(ready_q, &batch, 0) == pdTRUE)
+        {
+            drop_frames(batch->header.num_frames);
+            xQueueSendToBack(free_q, &batch, 0);
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: radar_capture_init
+ *******************************************************************************
+ * Summary:
+ *   Creates the batch queues. Capture starts disabled.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void radar_capture_init(void)
+{
+    free_q = xQueueCreate(RADAR_CAPTURE_NUM_BATCHES, sizeof(radar_capture_batch_t *));
+    ready_q = xQueueCreate(RADAR_CAPTURE_NUM_BATCHES, sizeof(radar_capture_batch_t *));
+
+    for (uint32_t i = 0; i < RADAR_CAPTURE_NUM_BATCHES; ++i)
+    {
+        radar_capture_batch_t *batch = &batches[i];
+        xQueueSendToBack(free_q, &batch, 0);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: radar_capture_set_enabled
+ *******************************************************************************
+ * Summary:
+ *   Starts or stops streaming. Stopping discards a partially filled batch
+ *   on the next frame.
+ *
+ * Parameters:
+ *   enable: true to stream raw frames
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void radar_capture_set_enabled(bool enable)
+{
+    enabled = enable;
+}
+
+/*******************************************************************************
+ * Function Name: radar_capture_is_enabled
+ *******************************************************************************
+ * Summary:
+ *   Returns whether raw frames are being streamed.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   true if capture is enabled
+ ******************************************************************************/
+bool radar_capture_is_enabled(void)
+{
+    return enabled;
+}
+
+/*******************************************************************************
+ * Function Name: radar_capture_push
+ *******************************************************************************
+ * Summary:
+ *   Packs one raw frame into the current batch. Called from the radar task
+ *   for every frame read from the FIFO. Never blocks: when no batch buffer
+ *   is free the frame is dropped, so capture cannot stall acquisition. The
+ *   frames of a batch are always consecutive, a gap starts a new batch.
+ *
+ * Parameters:
+ *   raw: raw samples of one frame
+ *   timestamp_ms: capture time of the frame
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void radar_capture_push(const uint16_t *raw, uint32_t timestamp_ms)
+{
+    uint32_t frame_sequence = sequence++;
+
+    if (!enabled)
+    {
+        if (filling != NULL)
+        {
+            xQueueSendToBack(free_q, &filling, 0);
+            filling = NULL;
+        }
+        return;
+    }
+
+    if ((filling != NULL) && (dropped_since_batch != 0u))
+    {
+        /* Frames were dropped after this batch was started */
+        flush_batch();
+    }
+
+    if (filling == NULL)
+    {
+        if (xQueueReceive(free_q, &filling, 0) != pdTRUE)
+        {
+            filling = NULL;
+            drop_frames(1);
+            return;
+        }
+
+        radar_capture_header_t *header = &filling->header;
+        header->magic[0] = RADAR_CAPTURE_MAGIC_0;
+        header->magic[1] = RADAR_CAPTURE_MAGIC_1;
+        header->version = RADAR_CAPTURE_VERSION;
+        header->num_frames = 0;
+        header->profile_id = RADAR_SETTINGS_PROFILE_ID;
+        header->sequence = frame_sequence;
+        header->timestamp_ms = timestamp_ms;
+        header->frame_period_us = RADAR_SETTINGS_FRAME_PERIOD_US;
+        header->samples_per_frame = RADAR_SETTINGS_NUM_SAMPLES_PER_FRAME;
+        header->dropped = (dropped_since_batch > UINT16_MAX) ? UINT16_MAX : (uint16_t)dropped_since_batch;
+        dropped_since_batch = 0;
+    }
+
+    radar_capture_pack12(raw, filling->frames[filling->header.num_frames], RADAR_SETTINGS_NUM_SAMPLES_PER_FRAME);
+    filling->header.num_frames++;
+    stats.frames_captured++;
+
+    if (filling->header.num_frames == RADAR_CAPTURE_FRAMES_PER_BATCH)
+    {
+        flush_batch();
+    }
+}
+
+/*******************************************************************************
+ * Function Name: radar_capture_take_ready
+ *******************************************************************************
+ * Summary:
+ *   Returns the next batch to publish. Called from the publisher task on a
+ *   PUBLISH_RADAR_CAPTURE command; the batch stays valid until
+ *   radar_capture_release() is called.
+ *
+ * Parameters:
+ *   payload: set to the start of the batch
+ *   payload_len: set to the size of the batch in bytes
+ *
+ * Return:
+ *   true if a batch is ready
+ ******************************************************************************/
+bool radar_capture_take_ready(const uint8_t **payload, size_t *payload_len)
+{
+    if (xQueueReceive(ready_q, &publishing, 0) != pdTRUE)
+    {
+        publishing = NULL;
+        return false;
+    }
+
+    *payload = (const uint8_t *)publishing;
+    *payload_len = sizeof(radar_capture_header_t) +
+                   ((size_t)publishing->header.num_frames * RADAR_CAPTURE_FRAME_BYTES);
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: radar_capture_release
+ *******************************************************************************
+ * Summary:
+ *   Returns the batch obtained with radar_capture_take_ready() for reuse.
+ *
+ * Parameters:
+ *   none
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void radar_capture_release(void)
+{
+    if (publishing != NULL)
+    {
+        stats.batches_published++;
+        xQueueSendToBack(free_q, &publishing, 0);
+        publishing = NULL;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: radar_capture_get_stats
+ *******************************************************************************
+ * Summary:
+ *   Returns a consistent copy of the capture counters.
+ *
+ * Parameters:
+ *   capture_stats: destination of the counters
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void radar_capture_get_stats(radar_capture_stats_t *capture_stats)
+{
+    taskENTER_CRITICAL();
+    *capture_stats = stats;
+    taskEXIT_CRITICAL();
+}
+
+/* [] END OF FILE */
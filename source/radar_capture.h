@@ -0,0 +1,70 @@
+/******************************************************************************
+ * File Name:   radar_capture.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *              in radar_capture.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef RADAR_CAPTURE_H_
+#define RADAR_CAPTURE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "radar_capture_format.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Frames packed into one capture publish */
+#define RADAR_CAPTURE_FRAMES_PER_BATCH  (8u)
+
+/* Batch buffers. One is filled by the radar task while the others are being
+ * published. When none is free, frames are dropped and counted.
+ */
+#define RADAR_CAPTURE_NUM_BATCHES       (2u)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    uint32_t frames_captured;
+    uint32_t frames_dropped;
+    uint32_t batches_published;
+} radar_capture_stats_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+void radar_capture_init(void);
+void radar_capture_set_enabled(bool enabled);
+bool radar_capture_is_enabled(void);
+void radar_capture_push(const uint16_t *raw, uint32_t timestamp_ms);
+bool radar_capture_take_ready(const uint8_t **payload, size_t *payload_len);
+void radar_capture_release(void);
+void radar_capture_get_stats(radar_capture_stats_t *stats);
+
+#endif
+/* [] END OF FILE */
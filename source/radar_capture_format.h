@@ -0,0 +1,164 @@
+/******************************************************************************
+ * File Name:   radar_capture_format.h
+ *
+ * Description: This file defines the binary format of raw radar frame captures
+ *              published on the capture topic, of the recordings replayed on
+ *              the host, and the 12-bit sample packing.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef RADAR_CAPTURE_FORMAT_H_
+#define RADAR_CAPTURE_FORMAT_H_
+
+#include <stdint.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define RADAR_CAPTURE_MAGIC_0       ('R')
+#define RADAR_CAPTURE_MAGIC_1       ('C')
+#define RADAR_CAPTURE_VERSION       (1)
+
+/* Bytes needed for n 12-bit samples packed two per three bytes */
+#define RADAR_CAPTURE_PACKED_SIZE(n)    ((((n) * 3u) + 1u) / 2u)
+
+#define RADAR_RECORDING_MAGIC       "RREC"
+#define RADAR_RECORDING_VERSION     (1)
+
+/* Bytes of one frame record of a recording: timestamp plus packed samples */
+#define RADAR_RECORDING_FRAME_SIZE(n)   (sizeof(uint32_t) + RADAR_CAPTURE_PACKED_SIZE(n))
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+/* Header of one capture batch. All fields are little-endian. The header is
+ * followed by 'num_frames' frames of 'samples_per_frame' packed samples. The
+ * frames of a batch are consecutive: frame i has the sequence number
+ * 'sequence + i' and was captured at 'timestamp_ms + i * frame_period_us'.
+ */
+typedef struct __attribute__((packed))
+{
+    uint8_t  magic[2];
+    uint8_t  version;
+    uint8_t  num_frames;
+    uint32_t profile_id;        /* RADAR_SETTINGS_PROFILE_ID of the sender */
+    uint32_t sequence;          /* Sequence number of the first frame */
+    uint32_t timestamp_ms;      /* Capture time of the first frame */
+    uint32_t frame_period_us;
+    uint16_t samples_per_frame;
+    uint16_t dropped;           /* Frames dropped since the previous batch */
+} radar_capture_header_t;
+
+_Static_assert(sizeof(radar_capture_header_t) == 24, "Capture header must be packed");
+
+/* Ground truth of a recording, as labeled by the person recording the scene */
+typedef enum
+{
+    RADAR_TRUTH_ABSENCE = 0,
+    RADAR_TRUTH_MACRO_PRESENCE = 1,
+    RADAR_TRUTH_MICRO_PRESENCE = 2
+} radar_truth_t;
+
+/* Header of a recording file, built on the host from capture batches or
+ * synthetic scenes. All fields are little-endian. The header is followed by
+ * 'num_frames' frame records of 'frame_record_size' bytes, each a uint32_t
+ * capture time in ms and the packed samples, in capture order. The labels
+ * start at 'labels_offset'.
+ */
+typedef struct __attribute__((packed))
+{
+    char     magic[4];
+    uint16_t version;
+    uint16_t header_size;       /* Offset of the first frame record */
+    uint32_t profile_id;        /* RADAR_SETTINGS_PROFILE_ID of the recording */
+    uint32_t frame_period_us;
+    uint16_t samples_per_frame;
+    uint16_t frame_record_size;
+    uint32_t num_frames;
+    uint32_t num_labels;
+    uint32_t labels_offset;
+} radar_recording_header_t;
+
+/* Ground truth from 'start_ms' up to, not including, 'end_ms'. Labels are
+ * sorted and do not overlap; time not covered by a label is not scored.
+ */
+typedef struct __attribute__((packed))
+{
+    uint32_t start_ms;
+    uint32_t end_ms;
+    uint8_t  truth;             /* radar_truth_t */
+    uint8_t  reserved[3];
+} radar_recording_label_t;
+
+_Static_assert(sizeof(radar_recording_header_t) == 32, "Recording header must be packed");
+_Static_assert(sizeof(radar_recording_label_t) == 12, "Recording label must be packed");
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+
+/* Packs 12-bit samples two per three bytes: the first byte holds the low
+ * 8 bits of sample 0, the second byte the high 4 bits of sample 0 in its low
+ * nibble and the low 4 bits of sample 1 in its high nibble, the third byte
+ * the high 8 bits of sample 1.
+ */
+static inline void radar_capture_pack12(const uint16_t *samples, uint8_t *packed, uint32_t num_samples)
+{
+    uint32_t i = 0;
+
+    for (; (i + 1u) < num_samples; i += 2u)
+    {
+        uint16_t a = samples[i] & 0x0FFFu;
+        uint16_t b = samples[i + 1u] & 0x0FFFu;
+
+        *packed++ = (uint8_t)a;
+        *packed++ = (uint8_t)((a >> 8) | (b << 4));
+        *packed++ = (uint8_t)(b >> 4);
+    }
+
+    if (i < num_samples)
+    {
+        *packed++ = (uint8_t)samples[i];
+        *packed = (uint8_t)((samples[i] >> 8) & 0x0Fu);
+    }
+}
+
+/* Reverses radar_capture_pack12(). */
+static inline void radar_capture_unpack12(const uint8_t *packed, uint16_t *samples, uint32_t num_samples)
+{
+    uint32_t i = 0;
+
+    for (; (i + 1u) < num_samples; i += 2u)
+    {
+        samples[i] = (uint16_t)(packed[0] | ((packed[1] & 0x0Fu) << 8));
+        samples[i + 1u] = (uint16_t)((packed[1] >> 4) | (packed[2] << 4));
+        packed += 3;
+    }
+
+    if (i < num_samples)
+    {
+        samples[i] = (uint16_t)(packed[0] | ((packed[1] & 0x0Fu) << 8));
+    }
+}
+
+#endif
+/* [] END OF FILE */
@@ -39,11 +39,14 @@
 
 /* Header file for local tasks */
 #include "publisher_task.h"
+#include "publisher_pool.h"
 #include "radar_config_task.h"
 #include "radar_task.h"
+#include "radar_capture.h"
 #include "subscriber_task.h"
 
 #include "xensiv_radar_presence.h"
+#include "radar_settings.h"
 
 
 /* Strings length */
@@ -54,17 +57,8 @@
 #define ENABLE_STRING  ("enable")
 #define DISABLE_STRING ("disable")
 
-/* Max range min - max */
-#define MAX_RANGE_MIN_LIMIT (0.66f)
-#define MAX_RANGE_MAX_LIMIT (5.0f)
-
-/* Macro threshold min - max */
-#define MACRO_THRESHOLD_MIN_LIMIT (0.5f)
-#define MACRO_THRESHOLD_MAX_LIMIT (2.0f)
-
-/* Micro threshold min - max */
-#define MICRO_THRESHOLD_MIN_LIMIT (0.2f)
-#define MICRO_THRESHOLD_MAX_LIMIT (50.0f)
+_Static_assert(MAX_RANGE_MAX_LIMIT_MM <= RADAR_SETTINGS_MAX_RANGE_MM,
+               "max_range limit is beyond the range of the radar profile");
 
 /* Names for presence parameters */
 #define MAX_RANGE_STRING        ("max_range")
@@ -73,6 +67,7 @@
 #define BANDPASS_STRING         ("bandpass_filter")
 #define DECIMATION_STRING       ("decimation_filter")
 #define MODE_STRING             ("mode")
+#define RAW_CAPTURE_STRING      ("raw_capture")
 
 /* Names for presence mode */
 #define MACRO_ONLY_STRING      ("macro_only")
@@ -85,17 +80,14 @@
  ******************************************************************************/
 TaskHandle_t radar_config_task_handle = NULL;
 
-static publisher_data_t publisher_q_data =
-{
-    .cmd = PUBLISH_MQTT_MSG,
-    .topic = PRESENCE_STATUS,
-};
-
-static publisher_data_t * publisher_msg = &publisher_q_data;
-
 xensiv_radar_presence_config_t config;
 
 float32_t binlength = 0.0f;
+
+/* Set by the parser for each valid key of the presence algorithm; a message
+ * with only the capture key leaves the algorithm and its state alone.
+ */
+static bool presence_keys_seen;
 /*******************************************************************************
  * Function Name: check_bool_validation
  ********************************************************************************
@@ -281,6 +273,7 @@ static cy_rslt_t json_parser_cb(cy_JSON_object_t *json_object, void *arg)
         if (check_float_validation(float_value, MAX_RANGE_MIN_LIMIT, MAX_RANGE_MAX_LIMIT))
         {
             *config_error = false;
+            presence_keys_seen = true;
             config.max_range_bin =  (int32_t)(float_value/binlength);
             printf("new max_range value is: %f\r\n", float_value);
         }
@@ -297,6 +290,7 @@ static cy_rslt_t json_parser_cb(cy_JSON_object_t *json_object, void *arg)
         if (check_float_validation(float_value, MACRO_THRESHOLD_MIN_LIMIT, MACRO_THRESHOLD_MAX_LIMIT))
         {
             *config_error = false;
+            presence_keys_seen = true;
             printf("new macro_threshold value is: %f\r\n", float_value);
             config.macro_threshold = float_value;
         }
@@ -313,6 +307,7 @@ static cy_rslt_t json_parser_cb(cy_JSON_object_t *json_object, void *arg)
         if (check_float_validation(float_value, MICRO_THRESHOLD_MIN_LIMIT, MICRO_THRESHOLD_MAX_LIMIT))
         {
             *config_error = false;
+            presence_keys_seen = true;
             printf("new micro_threshold value is: %f\r\n", float_value);
             config.micro_threshold = float_value;
         }
@@ -327,6 +322,7 @@ static cy_rslt_t json_parser_cb(cy_JSON_object_t *json_object, void *arg)
         if (check_bool_validation(json_object->value, ENABLE_STRING, DISABLE_STRING))
         {
             *config_error = false;
+            presence_keys_seen = true;
             printf("new macro_fft_bandpass_filter value is: %s\r\n", json_object->value);
             config.macro_fft_bandpass_filter_enabled = string_to_bool(json_object->value, ENABLE_STRING, DISABLE_STRING);
             }
@@ -341,6 +337,7 @@ static cy_rslt_t json_parser_cb(cy_JSON_object_t *json_object, void *arg)
         if (check_bool_validation(json_object->value, ENABLE_STRING, DISABLE_STRING))
         {
             *config_error = false;
+            presence_keys_seen = true;
             printf("new micro_fft_decimation value is: %s\r\n", json_object->value);
             config.micro_fft_decimation_enabled = string_to_bool(json_object->value, ENABLE_STRING, DISABLE_STRING);
         }
@@ -356,6 +353,7 @@ static cy_rslt_t json_parser_cb(cy_JSON_object_t *json_object, void *arg)
         {
             xensiv_radar_presence_mode_t mode = string_to_mode(json_object->value);
             *config_error = false;
+            presence_keys_seen = true;
             printf("new mode value is: %s\r\n", json_object->value);
             config.mode = mode;
         }
@@ -365,6 +363,21 @@ static cy_rslt_t json_parser_cb(cy_JSON_object_t *json_object, void *arg)
             printf("invalid mode value\r\n");
         }
     }
+    else if (memcmp(json_object->object_string, RAW_CAPTURE_STRING, json_object->object_string_length) == 0)
+    {
+        if (check_bool_validation(json_object->value, ENABLE_STRING, DISABLE_STRING))
+        {
+            /* Capture does not affect the presence algorithm, apply it now */
+            *config_error = false;
+            printf("new raw_capture value is: %s\r\n", json_object->value);
+            radar_capture_set_enabled(string_to_bool(json_object->value, ENABLE_STRING, DISABLE_STRING));
+        }
+        else
+        {
+            *config_error = true;
+            printf("invalid raw_capture value\r\n");
+        }
+    }
     else
     {
         /* Invalid input json key */
@@ -396,6 +409,11 @@ void radar_config_task(void *pvParameters)
 
     char *msg_payload;
 
+    /* Reply published on the status topic */
+    const char *status;
+
+    publisher_data_t *publisher_msg;
+
     xensiv_radar_presence_handle_t handle = (xensiv_radar_presence_handle_t)pvParameters;
 
     /* Register JSON parser to parse input configuration JSON string */
@@ -406,6 +424,8 @@ void radar_config_task(void *pvParameters)
         /* Block till a notification is received from the subscriber task. */
         if (xQueueReceive(subscriber_msg_q, &msg_payload, portMAX_DELAY) == pdPASS )
         {
+            status = NULL;
+
             /* Get mutex to block any other json parse jobs */
             if (xSemaphoreTake(sem_sub_payload, portMAX_DELAY) == pdTRUE)
             {
@@ -418,21 +438,22 @@ void radar_config_task(void *pvParameters)
                 
                 binlength = xensiv_radar_presence_get_bin_length(handle);
 
+                presence_keys_seen = false;
                 result = cy_JSON_parser(msg_payload, strlen(msg_payload));
                 if (result != CY_RSLT_SUCCESS)
                 {
-                    snprintf(publisher_q_data.data,
-                             sizeof(publisher_q_data.data),
-                             "{\"json parser error: invalid json message!\"}");
-                             
+                    status = "{\"json parser error: invalid json message!\"}";
                 }
                 else
                 {
                     if(config_error)
                     {
-                        snprintf(publisher_q_data.data,
-                                 sizeof(publisher_q_data.data),
-                                 "{\"error in configuration parameter name or invalid value/range!\"}");
+                        status = "{\"error in configuration parameter name or invalid value/range!\"}";
+                    }
+                    else if (!presence_keys_seen)
+                    {
+                        /* Raw capture only, applied by the parser */
+                        status = "{\"raw capture updated\"}";
                     }
                     else
                     {
@@ -443,15 +464,11 @@ void radar_config_task(void *pvParameters)
                             if (result != XENSIV_RADAR_PRESENCE_OK)
                             {
                                 printf("Error while setting new presence config\r\n");
-                                snprintf(publisher_q_data.data,
-                                         sizeof(publisher_q_data.data),
-                                         "{\"presence configuration could not be updated\"}");
+                                status = "{\"presence configuration could not be updated\"}";
                             }
                             else
                             {
-                                snprintf(publisher_q_data.data,
-                                         sizeof(publisher_q_data.data),
-                                         "{\"presence configuration updated and application resumed\"}");
+                                status = "{\"presence configuration updated and application resumed\"}";
                                 xensiv_radar_presence_reset(handle);
                             }
 
@@ -464,8 +481,20 @@ void radar_config_task(void *pvParameters)
             }
             
             
-            /* Send message back to publish queue. */
-            xQueueSendToBack(publisher_task_q, &publisher_msg, 0);
+            /* Send message back to publish queue. The reply is dropped, and
+             * counted by the pool, when no block is free.
+             */
+            publisher_msg = (status != NULL) ? publisher_pool_alloc() : NULL;
+            if (publisher_msg != NULL)
+            {
+                publisher_msg->cmd = PUBLISH_MQTT_MSG;
+                publisher_msg->topic = PRESENCE_STATUS;
+#if LATENCY_TRACE_ENABLE
+                publisher_msg->trace_id = 0;
+#endif
+                snprintf(publisher_msg->data, sizeof(publisher_msg->data), "%s", status);
+                (void)publisher_pool_send(publisher_msg);
+            }
         }
     }
 }
@@ -35,6 +35,23 @@
 #define RADAR_CONFIG_TASK_PRIORITY   (5)
 #define RADAR_CONFIG_TASK_STACK_SIZE (1024 * 2)
 
+/* Limits of the parameters accepted on the configuration topic, also used by
+ * the host sweep tool
+ */
+
+/* Max range min - max */
+#define MAX_RANGE_MIN_LIMIT    (0.66f)
+#define MAX_RANGE_MAX_LIMIT_MM (5000)
+#define MAX_RANGE_MAX_LIMIT    (MAX_RANGE_MAX_LIMIT_MM / 1000.0f)
+
+/* Macro threshold min - max */
+#define MACRO_THRESHOLD_MIN_LIMIT (0.5f)
+#define MACRO_THRESHOLD_MAX_LIMIT (2.0f)
+
+/* Micro threshold min - max */
+#define MICRO_THRESHOLD_MIN_LIMIT (0.2f)
+#define MICRO_THRESHOLD_MAX_LIMIT (50.0f)
+
 /*******************************************************************************
  * Global Variables
  ******************************************************************************/
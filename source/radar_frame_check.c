@@ -0,0 +1,217 @@
+/******************************************************************************
+ * File Name:   radar_frame_check.c
+ *
+ * Description: This file detects ADC saturation and interference bursts from
+ *              other 60 GHz devices in raw radar frames, before they reach the
+ *              presence algorithm.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file from system */
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "cycle_counter.h"
+#include "radar_frame_check.h"
+#include "radar_settings.h"
+
+/*******************************************************************************
+ * Function Name: radar_frame_check_init
+ *******************************************************************************
+ * Summary:
+ *   Resets the baseline and the counters, and enables the cycle counter used
+ *   to measure the cost of the check.
+ *
+ * Parameters:
+ *   ctx: frame check context
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void radar_frame_check_init(radar_frame_check_t *ctx)
+{
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->min_sample = UINT16_MAX;
+    cycle_counter_init();
+}
+
+/*******************************************************************************
+ * Function Name: radar_frame_check
+ *******************************************************************************
+ * Summary:
+ *   Classifies one raw frame. The samples are 12-bit ADC codes and therefore
+ *   valid q15 values, so the CMSIS-DSP q15 statistics functions (SIMD on the
+ *   Cortex-M4) compute minimum, maximum, mean and power in a few passes.
+ *   Clipped samples are only counted when the extremes reach the ADC limits.
+ *   The AC energy (variance) is compared with a running baseline of the
+ *   accepted frames to detect interference bursts.
+ *
+ * Parameters:
+ *   ctx: frame check context
+ *   raw: raw samples of one frame
+ *   num_samples: number of samples
+ *
+ * Return:
+ *   Verdict for the frame
+ ******************************************************************************/
+radar_frame_verdict_t radar_frame_check(radar_frame_check_t *ctx, const uint16_t *raw, uint32_t num_samples)
+{
+    uint32_t start = cycle_counter_get();
+    radar_frame_verdict_t verdict = RADAR_FRAME_OK;
+    const q15_t *samples = (const q15_t *)raw;
+    q15_t min_value;
+    q15_t max_value;
+    q15_t mean;
+    q63_t power;
+    uint32_t index;
+
+    arm_min_q15(samples, num_samples, &min_value, &index);
+    arm_max_q15(samples, num_samples, &max_value, &index);
+
+    if ((min_value <= RADAR_FRAME_CHECK_CLIP_LOW) || (max_value >= RADAR_FRAME_CHECK_CLIP_HIGH))
+    {
+        uint32_t clipped = 0;
+        for (uint32_t i = 0; i < num_samples; ++i)
+        {
+            clipped += ((samples[i] <= RADAR_FRAME_CHECK_CLIP_LOW) || (samples[i] >= RADAR_FRAME_CHECK_CLIP_HIGH)) ? 1u : 0u;
+        }
+
+        if (clipped >= RADAR_FRAME_CHECK_MAX_CLIPPED)
+        {
+            verdict = RADAR_FRAME_CLIPPED;
+        }
+    }
+
+    if (verdict == RADAR_FRAME_OK)
+    {
+        /* arm_power_q15 returns the plain sum of squares of the codes */
+        arm_power_q15(samples, num_samples, &power);
+        arm_mean_q15(samples, num_samples, &mean);
+
+        float32_t energy = ((float32_t)power / (float32_t)num_samples) - ((float32_t)mean * (float32_t)mean);
+
+        bool jump = (ctx->baseline_frames >= RADAR_FRAME_CHECK_WARMUP_FRAMES) &&
+                    (energy > (ctx->baseline_energy * RADAR_FRAME_CHECK_ENERGY_JUMP));
+
+        if (jump && (++ctx->consecutive_jumps < RADAR_FRAME_CHECK_MAX_CONSECUTIVE))
+        {
+            verdict = RADAR_FRAME_INTERFERENCE;
+        }
+        else
+        {
+            if (jump)
+            {
+                /* The level persisted, take it as the new baseline */
+                ctx->baseline_energy = energy;
+            }
+            else
+            {
+                /* Exponential average with weight 1/16, plain average while seeding */
+                uint32_t weight = (ctx->baseline_frames < 16u) ? (ctx->baseline_frames + 1u) : 16u;
+                ctx->baseline_energy += (energy - ctx->baseline_energy) / (float32_t)weight;
+            }
+            ++ctx->baseline_frames;
+            ctx->consecutive_jumps = 0;
+        }
+    }
+
+    ++ctx->frames;
+    if (verdict == RADAR_FRAME_CLIPPED)
+    {
+        ++ctx->clipped_frames;
+    }
+    else if (verdict == RADAR_FRAME_INTERFERENCE)
+    {
+        ++ctx->interference_frames;
+    }
+
+    if (verdict != RADAR_FRAME_OK)
+    {
+        ctx->dropped_frames += RADAR_FRAME_CHECK_DROP;
+    }
+
+    if ((uint16_t)min_value < ctx->min_sample)
+    {
+        ctx->min_sample = (uint16_t)min_value;
+    }
+    if ((uint16_t)max_value > ctx->max_sample)
+    {
+        ctx->max_sample = (uint16_t)max_value;
+    }
+
+    uint32_t cycles = cycle_counter_get() - start;
+    ctx->cycles_total += cycles;
+    if (cycles > ctx->cycles_max)
+    {
+        ctx->cycles_max = cycles;
+    }
+
+    return verdict;
+}
+
+/*******************************************************************************
+ * Function Name: radar_frame_check_report
+ *******************************************************************************
+ * Summary:
+ *   Writes the counters since the last report as JSON, including the rates of
+ *   interference-hit and of saturated frames and the cost of the check relative to the frame budget,
+ *   and restarts the counters. The baseline is kept.
+ *
+ * Parameters:
+ *   ctx: frame check context
+ *   report: buffer for the JSON report
+ *   report_size: size of the buffer
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void radar_frame_check_report(radar_frame_check_t *ctx, char *report, size_t report_size)
+{
+    uint32_t frames = (ctx->frames > 0) ? ctx->frames : 1;
+    uint32_t cycles_avg = (uint32_t)(ctx->cycles_total / frames);
+
+    snprintf(report, report_size,
+             "{\"frame_check\": {\"frames\": %" PRIu32 ", \"clipped\": %" PRIu32 ", "
+             "\"interference\": %" PRIu32 ", \"dropped\": %" PRIu32 ", "
+             "\"interference_permille\": %" PRIu32 ", \"clipped_permille\": %" PRIu32 ", \"min\": %u, \"max\": %u, "
+             "\"cycles_avg\": %" PRIu32 ", \"cycles_max\": %" PRIu32 ", "
+             "\"budget_permille\": %" PRIu32 "}}",
+             ctx->frames, ctx->clipped_frames, ctx->interference_frames, ctx->dropped_frames,
+             (uint32_t)(((uint64_t)ctx->interference_frames * 1000u) / frames),
+             (uint32_t)(((uint64_t)ctx->clipped_frames * 1000u) / frames),
+             (unsigned int)ctx->min_sample, (unsigned int)ctx->max_sample,
+             cycles_avg, ctx->cycles_max,
+             (uint32_t)(((uint64_t)cycles_avg * 1000u) / RADAR_SETTINGS_FRAME_BUDGET_CYCLES));
+
+    ctx->frames = 0;
+    ctx->clipped_frames = 0;
+    ctx->interference_frames = 0;
+    ctx->dropped_frames = 0;
+    ctx->min_sample = UINT16_MAX;
+    ctx->max_sample = 0;
+    ctx->cycles_total = 0;
+    ctx->cycles_max = 0;
+}
+
+/* [] END OF FILE */
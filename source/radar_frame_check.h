@@ -0,0 +1,102 @@
+/******************************************************************************
+ * File Name:   radar_frame_check.h
+ *
+ * Description: This file contains the function prototypes and constants used
+ *              in radar_frame_check.c.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef RADAR_FRAME_CHECK_H_
+#define RADAR_FRAME_CHECK_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "xensiv_radar_presence.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Set this macro to 1 to drop corrupted frames before presence detection,
+ * or to 0 to only count and report them.
+ */
+#define RADAR_FRAME_CHECK_DROP              (1)
+
+/* Samples at or beyond these ADC codes are considered clipped */
+#define RADAR_FRAME_CHECK_CLIP_LOW          (0)
+#define RADAR_FRAME_CHECK_CLIP_HIGH         (4095)
+
+/* A frame with at least this many clipped samples is saturated */
+#define RADAR_FRAME_CHECK_MAX_CLIPPED       (2)
+
+/* A frame whose AC energy exceeds the running baseline by this factor is
+ * considered hit by an interference burst.
+ */
+#define RADAR_FRAME_CHECK_ENERGY_JUMP       (10.0f)
+
+/* Frames used to seed the energy baseline before interference is flagged */
+#define RADAR_FRAME_CHECK_WARMUP_FRAMES     (32)
+
+/* After this many consecutive high energy frames the level is accepted as
+ * the new baseline, so that a lasting change of the scene is not rejected.
+ */
+#define RADAR_FRAME_CHECK_MAX_CONSECUTIVE   (8)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef enum
+{
+    RADAR_FRAME_OK,
+    RADAR_FRAME_CLIPPED,
+    RADAR_FRAME_INTERFERENCE
+} radar_frame_verdict_t;
+
+typedef struct
+{
+    /* Running baseline of the AC energy per sample in ADC codes squared */
+    float32_t baseline_energy;
+    uint32_t baseline_frames;
+    uint32_t consecutive_jumps;
+
+    /* Counters since the last report */
+    uint32_t frames;
+    uint32_t clipped_frames;
+    uint32_t interference_frames;
+    uint32_t dropped_frames;
+    uint16_t min_sample;
+    uint16_t max_sample;
+
+    /* Cost of the check in CPU cycles since the last report */
+    uint64_t cycles_total;
+    uint32_t cycles_max;
+} radar_frame_check_t;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+void radar_frame_check_init(radar_frame_check_t *ctx);
+radar_frame_verdict_t radar_frame_check(radar_frame_check_t *ctx, const uint16_t *raw, uint32_t num_samples);
+void radar_frame_check_report(radar_frame_check_t *ctx, char *report, size_t report_size);
+
+#endif
+/* [] END OF FILE */
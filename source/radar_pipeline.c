@@ -0,0 +1,141 @@
+/******************************************************************************
+ * File Name:   radar_pipeline.c
+ *
+ * Description: This file contains the frame processing shared by the radar task
+ *              and the host replay tools: frame check, conversion and the default
+ *              configuration of the presence algorithm.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+/* Header file includes */
+#include "radar_pipeline.h"
+#include "stage_probe.h"
+
+/*******************************************************************************
+ * Compile time checks
+ ******************************************************************************/
+_Static_assert(RADAR_PIPELINE_SAMPLES_PER_FRAME == (XENSIV_BGT60TRXX_CONF_NUM_SAMPLES_PER_CHIRP *
+                                                    XENSIV_BGT60TRXX_CONF_NUM_CHIRPS_PER_FRAME *
+                                                    XENSIV_BGT60TRXX_CONF_NUM_RX_ANTENNAS),
+               "radar_settings.h is stale, run scripts/radar_settings_gen.py");
+_Static_assert(sizeof(float32_t) * RADAR_PIPELINE_SAMPLES_PER_FRAME == RADAR_SETTINGS_FRAME_FLOAT_BYTES,
+               "Frame buffer size does not match the radar profile");
+_Static_assert((RADAR_PIPELINE_MICRO_FFT_SIZE == 64) || (RADAR_PIPELINE_MICRO_FFT_SIZE == 128),
+               "Micro FFT size not covered by the ARM_TABLE_* defines in the Makefile");
+_Static_assert(RADAR_PIPELINE_DEFAULT_MAX_RANGE_BIN < RADAR_SETTINGS_NUM_RANGE_BINS,
+               "Default maximum range bin is beyond the range of the profile");
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+const xensiv_radar_presence_config_t radar_pipeline_default_config =
+{
+    .bandwidth                         = RADAR_SETTINGS_BANDWIDTH_HZ,
+    .num_samples_per_chirp             = XENSIV_BGT60TRXX_CONF_NUM_SAMPLES_PER_CHIRP,
+    .micro_fft_decimation_enabled      = false,
+    .micro_fft_size                    = RADAR_PIPELINE_MICRO_FFT_SIZE,
+    .macro_threshold                   = 0.5f,
+    .micro_threshold                   = 12.5f,
+    .min_range_bin                     = 1,
+    .max_range_bin                     = RADAR_PIPELINE_DEFAULT_MAX_RANGE_BIN,
+    .macro_compare_interval_ms         = 250,
+    .macro_movement_validity_ms        = 1000,
+    .micro_movement_validity_ms        = 4000,
+    .macro_movement_confirmations      = 0,
+    .macro_trigger_range               = 1,
+    .mode                              = XENSIV_RADAR_PRESENCE_MODE_MICRO_IF_MACRO,
+    .macro_fft_bandpass_filter_enabled = false,
+    .micro_movement_compare_idx       = 5
+};
+
+/*******************************************************************************
+ * Function Name: radar_pipeline_init
+ *******************************************************************************
+ * Summary:
+ *   Resets the frame check of a pipeline.
+ *
+ * Parameters:
+ *   ctx: pipeline context
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void radar_pipeline_init(radar_pipeline_t *ctx)
+{
+    radar_frame_check_init(&ctx->frame_check);
+}
+
+/*******************************************************************************
+ * Function Name: radar_pipeline_preprocess
+ *******************************************************************************
+ * Summary:
+ *   Checks one raw frame for saturation and interference, converts it to
+ *   float and averages its chirps.
+ *
+ * Parameters:
+ *   ctx: pipeline context
+ *   raw: RADAR_PIPELINE_SAMPLES_PER_FRAME samples read from the sensor FIFO
+ *
+ * Return:
+ *   The frame to pass to xensiv_radar_presence_process_frame(), or NULL if
+ *   the frame is dropped by the frame check
+ ******************************************************************************/
+float32_t *radar_pipeline_preprocess(radar_pipeline_t *ctx, const uint16_t *raw)
+{
+    /* Reject frames corrupted by ADC saturation or interference bursts */
+    STAGE_PROBE_BEGIN(STAGE_PROBE_FRAME_CHECK);
+    radar_frame_verdict_t verdict = radar_frame_check(&ctx->frame_check, raw, RADAR_PIPELINE_SAMPLES_PER_FRAME);
+    STAGE_PROBE_END(STAGE_PROBE_FRAME_CHECK);
+
+    if ((verdict != RADAR_FRAME_OK) && (RADAR_FRAME_CHECK_DROP != 0))
+    {
+        return NULL;
+    }
+
+    /* Data preprocessing */
+    STAGE_PROBE_BEGIN(STAGE_PROBE_CONVERT);
+    const uint16_t *bgt60_buffer_ptr = raw;
+    float32_t *frame_ptr = &ctx->frame[0];
+    for (int32_t sample = 0; sample < RADAR_PIPELINE_SAMPLES_PER_FRAME; ++sample)
+    {
+        *frame_ptr++ = ((float32_t)(*bgt60_buffer_ptr++) / 4096.0F);
+    }
+    STAGE_PROBE_END(STAGE_PROBE_CONVERT);
+
+    // calculate the average of the chirps first
+    STAGE_PROBE_BEGIN(STAGE_PROBE_CHIRP_AVERAGE);
+    arm_fill_f32(0, ctx->avg_chirp, RADAR_PIPELINE_SAMPLES_PER_CHIRP);
+
+    for (int chirp = 0; chirp < XENSIV_BGT60TRXX_CONF_NUM_CHIRPS_PER_FRAME; chirp++)
+    {
+        arm_add_f32(ctx->avg_chirp, &ctx->frame[RADAR_PIPELINE_SAMPLES_PER_CHIRP * chirp],
+                    ctx->avg_chirp, RADAR_PIPELINE_SAMPLES_PER_CHIRP);
+    }
+
+    arm_scale_f32(ctx->avg_chirp, 1.0f / XENSIV_BGT60TRXX_CONF_NUM_CHIRPS_PER_FRAME,
+                  ctx->avg_chirp, RADAR_PIPELINE_SAMPLES_PER_CHIRP);
+    STAGE_PROBE_END(STAGE_PROBE_CHIRP_AVERAGE);
+
+    return ctx->frame;
+}
+
+/* [] END OF FILE */
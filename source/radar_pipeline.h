@@ -0,0 +1,74 @@
+/******************************************************************************
+ * File Name:   radar_pipeline.h
+ *
+ * Description: This file contains the frame processing shared by the radar task
+ *              and the host replay tools: frame check, conversion and the default
+ *              configuration of the presence algorithm.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef RADAR_PIPELINE_H_
+#define RADAR_PIPELINE_H_
+
+#include <stdint.h>
+
+#include "radar_frame_check.h"
+#include "radar_settings.h"
+#include "xensiv_radar_presence.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define RADAR_PIPELINE_SAMPLES_PER_FRAME    RADAR_SETTINGS_NUM_SAMPLES_PER_FRAME
+#define RADAR_PIPELINE_SAMPLES_PER_CHIRP    XENSIV_BGT60TRXX_CONF_NUM_SAMPLES_PER_CHIRP
+
+/* Size of the micro motion FFT of the presence algorithm */
+#define RADAR_PIPELINE_MICRO_FFT_SIZE       (128)
+
+/* Highest range bin evaluated by the default presence configuration */
+#define RADAR_PIPELINE_DEFAULT_MAX_RANGE_BIN    (5)
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    /* Saturation and interference detection on raw frames */
+    radar_frame_check_t frame_check;
+
+    float32_t frame[RADAR_PIPELINE_SAMPLES_PER_FRAME];
+    float32_t avg_chirp[RADAR_PIPELINE_SAMPLES_PER_CHIRP];
+} radar_pipeline_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+extern const xensiv_radar_presence_config_t radar_pipeline_default_config;
+
+/*******************************************************************************
+ * Functions
+ ******************************************************************************/
+void radar_pipeline_init(radar_pipeline_t *ctx);
+float32_t *radar_pipeline_preprocess(radar_pipeline_t *ctx, const uint16_t *raw);
+
+#endif
+/* [] END OF FILE */
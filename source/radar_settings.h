@@ -1,3 +1,4 @@
+/* Generated from radar_settings.json by scripts/radar_settings_gen.py. Edit the JSON file, not this header. */
 #ifndef XENSIV_BGT60TRXX_CONF_H
 #define XENSIV_BGT60TRXX_CONF_H
 
@@ -56,4 +57,35 @@ uint32_t register_list[] = {
 };
 #endif
 
-#endif /* XENSIV_BGT60TRXX_CONF_H */
\ No newline at end of file
+/* Derived constants - generated by scripts/radar_settings_gen.py, do not edit */
+/* Chirp bandwidth, upper minus lower frequency */
+#define RADAR_SETTINGS_BANDWIDTH_HZ (459804000)
+/* Range covered by one bin of a num_samples_per_chirp point FFT */
+#define RADAR_SETTINGS_RANGE_BIN_LENGTH_M (0.326000f)
+#define RADAR_SETTINGS_RANGE_BIN_LENGTH_UM (326000)
+/* Unambiguous range bins of the real-valued IF signal */
+#define RADAR_SETTINGS_NUM_RANGE_BINS (64)
+#define RADAR_SETTINGS_MAX_RANGE_M (20.864017f)
+#define RADAR_SETTINGS_MAX_RANGE_MM (20864)
+#define RADAR_SETTINGS_FRAME_PERIOD_US (5004)
+/* Rounded up, for use as an RTOS timeout */
+#define RADAR_SETTINGS_FRAME_PERIOD_MS (6)
+/* CPU clock the frame budget refers to */
+#define RADAR_SETTINGS_CPU_CLOCK_HZ (100000000UL)
+/* CPU cycles available to process one frame in real time */
+#define RADAR_SETTINGS_FRAME_BUDGET_CYCLES (500396UL)
+#define RADAR_SETTINGS_NUM_SAMPLES_PER_FRAME (128)
+/* uint16_t samples as read from the FIFO */
+#define RADAR_SETTINGS_FRAME_BUFFER_BYTES (256)
+/* float32_t samples after conversion */
+#define RADAR_SETTINGS_FRAME_FLOAT_BYTES (512)
+/* 12-bit samples packed two per three bytes */
+#define RADAR_SETTINGS_FRAME_PACKED_BYTES (192)
+#define RADAR_SETTINGS_FIFO_DEPTH_SAMPLES (8192)
+/* Whole frames that fit into the sensor FIFO */
+#define RADAR_SETTINGS_FRAMES_PER_FIFO (64)
+/* CRC-32 of the register list, identifies the profile in captures */
+#define RADAR_SETTINGS_PROFILE_ID (0xdfa2a86cUL)
+/* End of derived constants */
+
+#endif /* XENSIV_BGT60TRXX_CONF_H */
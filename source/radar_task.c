@@ -37,15 +37,24 @@
 
 /* Header file for local task */
 #include "publisher_task.h"
+#include "publisher_pool.h"
+#include "publisher_lanes.h"
+#include "publisher_window.h"
+#include "publisher_limit.h"
+#include "payload_writer.h"
 #include "radar_config_task.h"
 
 #include "radar_task.h"
+#include "power_stats.h"
+#include "radar_capture.h"
 
 #include "xensiv_bgt60trxx_mtb.h"
 #include "xensiv_radar_presence.h"
 
 #define XENSIV_BGT60TRXX_CONF_IMPL
 #include "radar_settings.h"
+#include "radar_pipeline.h"
+#include "stage_probe.h"
 /*******************************************************************************
  * Macros
  ******************************************************************************/
@@ -69,11 +78,65 @@
                                              XENSIV_BGT60TRXX_CONF_NUM_CHIRPS_PER_FRAME *\
                                              XENSIV_BGT60TRXX_CONF_NUM_RX_ANTENNAS)
 
-#define NUM_CHIRPS_PER_FRAME                XENSIV_BGT60TRXX_CONF_NUM_CHIRPS_PER_FRAME
 #define NUM_SAMPLES_PER_CHIRP               XENSIV_BGT60TRXX_CONF_NUM_SAMPLES_PER_CHIRP
 
+/* In low power mode the sensor buffers several frames in its FIFO and the MCU
+ * only wakes up when the FIFO limit is reached.
+ */
+#if RADAR_LOW_POWER_MODE
+#define FRAMES_PER_WAKEUP                   RADAR_LOW_POWER_FRAMES_PER_WAKEUP
+#else
+#define FRAMES_PER_WAKEUP                   (1)
+#endif
+#define NUM_SAMPLES_PER_WAKEUP              (NUM_SAMPLES_PER_FRAME * FRAMES_PER_WAKEUP)
+
 #define GPIO_INTERRUPT_PRIORITY             (6)
 
+/* The sensor is considered stalled when no FIFO interrupt arrives within one
+ * frame period plus this margin.
+ */
+#define RADAR_WATCHDOG_MARGIN_MS            (20)
+#define RADAR_WATCHDOG_TIMEOUT_MS           ((RADAR_SETTINGS_FRAME_PERIOD_MS * FRAMES_PER_WAKEUP) + RADAR_WATCHDOG_MARGIN_MS)
+
+/* Consecutive FIFO read errors after which the sensor is re-initialized */
+#define RADAR_MAX_FIFO_ERRORS               (3)
+
+/* A recovery is retried this many times with the given delay, which bounds
+ * the time the sensor can be out of service per recovery.
+ */
+#define RADAR_RECOVERY_MAX_ATTEMPTS         (3)
+#define RADAR_RECOVERY_RETRY_DELAY_MS       (10)
+
+/* After a failed recovery the next one waits this long, doubled after each
+ * further failure up to the maximum. While the sensor stays dead, only the
+ * first failure and the recoveries at the maximum backoff are reported.
+ */
+#define RADAR_RECOVERY_BACKOFF_MIN_MS       (1000u)
+#define RADAR_RECOVERY_BACKOFF_MAX_MS       (5u * 60u * 1000u)
+
+/* Interval of the periodic frame check report on the diagnostics topic */
+#define RADAR_DIAGNOSTICS_INTERVAL_MS       (60000u)
+
+/*******************************************************************************
+ * Compile time checks of the radar profile in radar_settings.h
+ ******************************************************************************/
+_Static_assert(NUM_SAMPLES_PER_FRAME == RADAR_SETTINGS_NUM_SAMPLES_PER_FRAME,
+               "radar_settings.h is stale, run scripts/radar_settings_gen.py");
+_Static_assert(sizeof(uint16_t) * NUM_SAMPLES_PER_FRAME == RADAR_SETTINGS_FRAME_BUFFER_BYTES,
+               "FIFO buffer size does not match the radar profile");
+_Static_assert(NUM_SAMPLES_PER_FRAME <= RADAR_SETTINGS_FIFO_DEPTH_SAMPLES,
+               "One frame must fit into the sensor FIFO");
+/* Keep one frame of headroom for the samples produced while the FIFO is read */
+_Static_assert(FRAMES_PER_WAKEUP < RADAR_SETTINGS_FRAMES_PER_FIFO,
+               "RADAR_LOW_POWER_FRAMES_PER_WAKEUP exceeds the sensor FIFO");
+_Static_assert((NUM_SAMPLES_PER_CHIRP & (NUM_SAMPLES_PER_CHIRP - 1)) == 0,
+               "Samples per chirp must be a power of two for the range FFT");
+/* The Makefile only enables the CMSIS-DSP FFT tables up to 128 points. */
+_Static_assert(NUM_SAMPLES_PER_CHIRP <= 128,
+               "Range FFT size not covered by the ARM_TABLE_* defines in the Makefile");
+/* The range of an event is computed in micrometres with 32-bit integers */
+_Static_assert(((int64_t)RADAR_SETTINGS_NUM_RANGE_BINS * RADAR_SETTINGS_RANGE_BIN_LENGTH_UM) <= INT32_MAX,
+               "Range of the last bin overflows the event range");
 
 
 /*******************************************************************************
@@ -86,12 +149,38 @@ SemaphoreHandle_t sem_radar_presence = NULL;
 
 static cyhal_spi_t spi_obj;
 static xensiv_bgt60trxx_mtb_t bgt60_obj;
-static uint16_t bgt60_buffer[NUM_SAMPLES_PER_FRAME] __attribute__((aligned(2)));
-static float32_t frame[NUM_SAMPLES_PER_FRAME];
-static float32_t avg_chirp[NUM_SAMPLES_PER_CHIRP];
+static uint16_t bgt60_buffer[NUM_SAMPLES_PER_WAKEUP] __attribute__((aligned(2)));
+
+/* Diagnostics reports are written here and copied into a publisher pool
+ * block; at most one is published per wakeup.
+ */
+static char diagnostics_report[MQTT_PUB_MSG_MAX_SIZE * 2];
+
+/* Frame check and conversion, shared with the host replay tools */
+static radar_pipeline_t pipeline;
 
-static publisher_data_t publisher_q_data;
-static publisher_data_t * publisher_msg = &publisher_q_data;
+/* Frames read from the sensor, numbered as the frames of the capture
+ * batches, and the frame being processed
+ */
+static uint32_t frames_read;
+static uint32_t frame_index;
+
+/* Sequence number of the last presence event. It also counts the events
+ * dropped for lack of a pool block, so the backend sees the gap.
+ */
+static uint32_t event_seq;
+
+/* Counters of the sensor stall watchdog */
+static struct
+{
+    uint32_t irq_timeouts;
+    uint32_t fifo_errors;
+    uint32_t recoveries;
+    uint32_t recovery_failures;
+} watchdog_stats;
+
+/* Wait before the next recovery, zero while the sensor is fine */
+static uint32_t recovery_backoff_ms;
 /*******************************************************************************
  * Local Variables
  ******************************************************************************/
@@ -122,6 +211,8 @@ static void xensiv_bgt60trxx_interrupt_handler(void *args, cyhal_gpio_irq_event_
 
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
+    LATENCY_TRACE_IRQ_STAMP();
+
     vTaskNotifyGiveFromISR(radar_task_handle, &xHigherPriorityTaskWoken);
 
     /* Context switch needed? */
@@ -144,11 +235,30 @@ void presence_detection_cb(xensiv_radar_presence_handle_t handle,
                            const xensiv_radar_presence_event_t* event,
                            void *data)
 {
+    publisher_data_t *publisher_msg;
+    payload_writer_t writer;
+    bool payload = false;
+    presence_event_t presence_event =
+    {
+        .timestamp_ms = event->timestamp,
+        .frame = frame_index,
+        .range_mm = PRESENCE_EVENT_NO_RANGE,
+        .state = PRESENCE_EVENT_ABSENCE
+    };
+
     (void)data;
     (void)handle;
 
-    publisher_q_data.cmd = PUBLISH_MQTT_MSG;
-    publisher_q_data.topic =  PRESENCE_EVENTS;
+    STAGE_PROBE_BEGIN(STAGE_PROBE_EVENT_CB);
+
+    /* Each event gets a block of its own, so a burst of events cannot
+     * overwrite a message that is still waiting to be published.
+     */
+    publisher_msg = publisher_pool_alloc();
+    if (publisher_msg != NULL)
+    {
+        LATENCY_TRACE_BEGIN(*publisher_msg);
+    }
 
     switch (event->state)
     {
@@ -159,7 +269,8 @@ void presence_detection_cb(xensiv_radar_presence_handle_t handle,
                    event->range_bin,
                    event->timestamp);
 
-            snprintf(publisher_q_data.data, sizeof(publisher_q_data.data), "{\"PRESENCE\": \"IN macro\"}");
+            payload = true;
+            presence_event.state = PRESENCE_EVENT_MACRO;
             break;
 
         case XENSIV_RADAR_PRESENCE_STATE_MICRO_PRESENCE:
@@ -169,7 +280,8 @@ void presence_detection_cb(xensiv_radar_presence_handle_t handle,
                    event->range_bin,
                    event->timestamp);
 
-            snprintf(publisher_q_data.data, sizeof(publisher_q_data.data), "{\"PRESENCE\": \"IN micro\"}");
+            payload = true;
+            presence_event.state = PRESENCE_EVENT_MICRO;
             break;
 
         case XENSIV_RADAR_PRESENCE_STATE_ABSENCE:
@@ -177,7 +289,7 @@ void presence_detection_cb(xensiv_radar_presence_handle_t handle,
             cyhal_gpio_write(LED_RGB_RED, false);
             cyhal_gpio_write(LED_RGB_GREEN, true);
 
-            snprintf(publisher_q_data.data, sizeof(publisher_q_data.data), "{\"PRESENCE\": \"OUT\"}");
+            payload = true;
             break;
 
         default:
@@ -185,8 +297,94 @@ void presence_detection_cb(xensiv_radar_presence_handle_t handle,
             break;
     }
 
-    /* Send message back to publish queue. */
-    xQueueSendToBack(publisher_task_q, &publisher_msg, 0 );
+    if (payload)
+    {
+        presence_event.seq = ++event_seq;
+        if (presence_event.state != PRESENCE_EVENT_ABSENCE)
+        {
+            presence_event.range_mm = (event->range_bin * RADAR_SETTINGS_RANGE_BIN_LENGTH_UM) / 1000;
+        }
+
+        /* The state mailbox needs no pool block: the retained state is
+         * current even when the event itself is dropped.
+         */
+        (void)publisher_lanes_post_state(&presence_event);
+    }
+
+    if ((publisher_msg != NULL) && payload)
+    {
+        publisher_msg->cmd = PUBLISH_MQTT_MSG;
+        publisher_msg->topic = PRESENCE_EVENTS;
+        publisher_msg->event = presence_event;
+
+        /* The event schema in the format of the events topic; integers
+         * only, so the callback formats no float. The trace ID lets the
+         * test subscriber match the message to its trace.
+         */
+        payload_writer_init(&writer, PAYLOAD_FORMAT, publisher_msg->data, sizeof(publisher_msg->data));
+        presence_event_begin(&writer, &presence_event, LATENCY_TRACE_ENABLE);
+#if LATENCY_TRACE_ENABLE
+        payload_key(&writer, "trace");
+        payload_uint(&writer, publisher_msg->trace_id);
+#endif
+        payload_end(&writer);
+        publisher_msg->data_len = (uint16_t)payload_writer_finish(&writer);
+
+        /* A length of 0 would be published as text up to a NUL. */
+        if (publisher_msg->data_len == 0u)
+        {
+            printf("[WARN] event payload does not fit, event dropped\n");
+            publisher_pool_free(publisher_msg);
+        }
+        else
+        {
+            LATENCY_TRACE_STAMP(*publisher_msg, LATENCY_TRACE_QUEUED);
+
+            /* Send message back to publish queue. */
+            (void)publisher_pool_send(publisher_msg);
+        }
+    }
+    else if (publisher_msg != NULL)
+    {
+        publisher_pool_free(publisher_msg);
+    }
+    else if (payload)
+    {
+        printf("[WARN] publisher pool exhausted, event dropped\n");
+    }
+
+    STAGE_PROBE_END(STAGE_PROBE_EVENT_CB);
+}
+
+/*******************************************************************************
+* Function Name: publish_diagnostics
+********************************************************************************
+* Summary:
+* Copies the report in 'diagnostics_report' into a publisher pool block and
+* passes it to the publisher task. The report is dropped, and counted by the
+* pool, when no block is free or the telemetry lane is full.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  none
+*
+*******************************************************************************/
+static void publish_diagnostics(void)
+{
+    publisher_data_t *diagnostics_msg = publisher_pool_alloc();
+
+    if (diagnostics_msg != NULL)
+    {
+        diagnostics_msg->cmd = PUBLISH_MQTT_MSG;
+        diagnostics_msg->topic = PRESENCE_DIAGNOSTICS;
+#if LATENCY_TRACE_ENABLE
+        diagnostics_msg->trace_id = 0;
+#endif
+        snprintf(diagnostics_msg->data, sizeof(diagnostics_msg->data), "%s", diagnostics_report);
+        (void)publisher_pool_send(diagnostics_msg);
+    }
 }
 
 
@@ -294,7 +492,7 @@ static int32_t init_sensor(void)
     }
 
     if (xensiv_bgt60trxx_mtb_interrupt_init(&bgt60_obj,
-                                            NUM_SAMPLES_PER_FRAME,
+                                            NUM_SAMPLES_PER_WAKEUP,
                                             PIN_XENSIV_BGT60TRXX_IRQ,
                                             GPIO_INTERRUPT_PRIORITY,
                                             xensiv_bgt60trxx_interrupt_handler,
@@ -307,6 +505,162 @@ static int32_t init_sensor(void)
     return 0;
 }
 
+/*******************************************************************************
+* Function Name: process_frame
+********************************************************************************
+* Summary:
+* This function checks one raw frame for saturation and interference, converts
+* it to float, averages its chirps and runs the presence algorithm on it.
+*
+* Parameters:
+*  handle: presence algorithm handle
+*  raw: NUM_SAMPLES_PER_FRAME samples read from the sensor FIFO
+*  timestamp_ms: capture time of the frame
+*
+* Return:
+*  none
+*
+*******************************************************************************/
+static void process_frame(xensiv_radar_presence_handle_t handle, const uint16_t *raw, uint32_t timestamp_ms)
+{
+    STAGE_PROBE_BEGIN(STAGE_PROBE_FRAME);
+
+    /* Raw frames are captured before any check, so rejected frames can be
+     * analyzed offline too.
+     */
+    radar_capture_push(raw, timestamp_ms);
+    frame_index = frames_read++;
+
+    float32_t *frame = radar_pipeline_preprocess(&pipeline, raw);
+    if (frame == NULL)
+    {
+        STAGE_PROBE_END(STAGE_PROBE_FRAME);
+        return;
+    }
+
+    if (xSemaphoreTake(sem_radar_presence, portMAX_DELAY) == pdTRUE)
+    {
+        STAGE_PROBE_BEGIN(STAGE_PROBE_PRESENCE);
+        if((xensiv_radar_presence_process_frame(handle, frame, timestamp_ms)) != XENSIV_RADAR_PRESENCE_OK)
+        {
+            printf("Failed during frame processing\n");
+        }
+        STAGE_PROBE_END(STAGE_PROBE_PRESENCE);
+
+        xSemaphoreGive(sem_radar_presence);
+    }
+
+    STAGE_PROBE_END(STAGE_PROBE_FRAME);
+}
+
+/*******************************************************************************
+* Function Name: recover_sensor
+********************************************************************************
+* Summary:
+* This function re-initializes the radar sensor without rebooting the MCU after
+* a missing FIFO interrupt or repeated FIFO errors:
+*    1. Stops the frame generation and performs a soft reset of the sensor
+*    2. Re-applies the register list and the FIFO limit
+*    3. Restarts the frame generation and resets the presence algorithm
+* The sequence is retried 'RADAR_RECOVERY_MAX_ATTEMPTS' times. After a failed
+* recovery the next one is delayed by an exponential backoff, capped at
+* 'RADAR_RECOVERY_BACKOFF_MAX_MS'. The outcome and the watchdog counters are
+* published on the diagnostics topic, during a series of failures only for the
+* first one and for those at the maximum backoff.
+*
+* Parameters:
+*  handle: presence algorithm handle
+*  reason: cause of the recovery, included in the published event
+*
+* Return:
+*  none
+*
+*******************************************************************************/
+static void recover_sensor(xensiv_radar_presence_handle_t handle, const char *reason)
+{
+    bool recovered = false;
+    bool report = (recovery_backoff_ms == 0u) || (recovery_backoff_ms >= RADAR_RECOVERY_BACKOFF_MAX_MS);
+    TickType_t start;
+
+    if (recovery_backoff_ms > 0u)
+    {
+        vTaskDelay(pdMS_TO_TICKS(recovery_backoff_ms));
+    }
+    start = xTaskGetTickCount();
+
+    if (report)
+    {
+        printf("[WARN] radar sensor stalled (%s), re-initializing\n", reason);
+    }
+
+    for (uint32_t attempt = 0; (attempt < RADAR_RECOVERY_MAX_ATTEMPTS) && !recovered; ++attempt)
+    {
+        (void)xensiv_bgt60trxx_start_frame(&bgt60_obj.dev, false);
+
+        if ((xensiv_bgt60trxx_soft_reset(&bgt60_obj.dev, XENSIV_BGT60TRXX_RESET_SW) == XENSIV_BGT60TRXX_STATUS_OK) &&
+            (xensiv_bgt60trxx_config(&bgt60_obj.dev, register_list, XENSIV_BGT60TRXX_CONF_NUM_REGS) == XENSIV_BGT60TRXX_STATUS_OK) &&
+            (xensiv_bgt60trxx_set_fifo_limit(&bgt60_obj.dev, NUM_SAMPLES_PER_WAKEUP) == XENSIV_BGT60TRXX_STATUS_OK))
+        {
+            /* Drop interrupts raised before the reset */
+            (void)ulTaskNotifyTake(pdTRUE, 0);
+            recovered = (xensiv_bgt60trxx_start_frame(&bgt60_obj.dev, true) == XENSIV_BGT60TRXX_STATUS_OK);
+        }
+
+        if (!recovered)
+        {
+            vTaskDelay(pdMS_TO_TICKS(RADAR_RECOVERY_RETRY_DELAY_MS));
+        }
+    }
+
+    if (recovered)
+    {
+        ++watchdog_stats.recoveries;
+        recovery_backoff_ms = 0u;
+        report = true;
+
+        /* Frames were lost, restart the presence algorithm from a clean state */
+        if (xSemaphoreTake(sem_radar_presence, portMAX_DELAY) == pdTRUE)
+        {
+            xensiv_radar_presence_reset(handle);
+            xSemaphoreGive(sem_radar_presence);
+        }
+    }
+    else
+    {
+        ++watchdog_stats.recovery_failures;
+        if (recovery_backoff_ms == 0u)
+        {
+            recovery_backoff_ms = RADAR_RECOVERY_BACKOFF_MIN_MS;
+        }
+        else
+        {
+            recovery_backoff_ms = (recovery_backoff_ms >= (RADAR_RECOVERY_BACKOFF_MAX_MS / 2u)) ?
+                                  RADAR_RECOVERY_BACKOFF_MAX_MS : (recovery_backoff_ms * 2u);
+        }
+
+        if (report)
+        {
+            printf("[ERROR] radar sensor recovery failed, next attempt in %" PRIu32 " ms\n", recovery_backoff_ms);
+        }
+    }
+
+    if (!report)
+    {
+        return;
+    }
+
+    snprintf(diagnostics_report, sizeof(diagnostics_report),
+             "{\"radar_recovery\": {\"reason\": \"%s\", \"result\": \"%s\", \"duration_ms\": %" PRIu32 ", "
+             "\"irq_timeouts\": %" PRIu32 ", \"fifo_errors\": %" PRIu32 ", "
+             "\"recoveries\": %" PRIu32 ", \"failures\": %" PRIu32 "}}",
+             reason, recovered ? "ok" : "failed",
+             (uint32_t)((xTaskGetTickCount() - start) * portTICK_PERIOD_MS),
+             watchdog_stats.irq_timeouts, watchdog_stats.fifo_errors,
+             watchdog_stats.recoveries, watchdog_stats.recovery_failures);
+
+    publish_diagnostics();
+}
+
 /*******************************************************************************
  * Function Name: radar_task
  *******************************************************************************
@@ -330,27 +684,6 @@ void radar_task(void *pvParameters)
 
     xensiv_radar_presence_handle_t handle;
 
-    static const xensiv_radar_presence_config_t default_config =
-    {
-        .bandwidth                         = 460E6,
-        .num_samples_per_chirp             = XENSIV_BGT60TRXX_CONF_NUM_SAMPLES_PER_CHIRP,
-        .micro_fft_decimation_enabled      = false,
-        .micro_fft_size                    = 128,
-        .macro_threshold                   = 0.5f,
-        .micro_threshold                   = 12.5f,
-        .min_range_bin                     = 1,
-        .max_range_bin                     = 5,
-        .macro_compare_interval_ms         = 250,
-        .macro_movement_validity_ms        = 1000,
-        .micro_movement_validity_ms        = 4000,
-        .macro_movement_confirmations      = 0,
-        .macro_trigger_range               = 1,
-        .mode                              = XENSIV_RADAR_PRESENCE_MODE_MICRO_IF_MACRO,
-        .macro_fft_bandpass_filter_enabled = false,
-        .micro_movement_compare_idx       = 5
-    };
-
-
     if (init_sensor() != 0)
     {
         CY_ASSERT(0);
@@ -364,7 +697,7 @@ void radar_task(void *pvParameters)
     xensiv_radar_presence_set_malloc_free(pvPortMalloc,
                                           vPortFree);
 
-    if (xensiv_radar_presence_alloc(&handle, &default_config) != 0)
+    if (xensiv_radar_presence_alloc(&handle, &radar_pipeline_default_config) != 0)
     {
         CY_ASSERT(0);
     }
@@ -401,42 +734,93 @@ void radar_task(void *pvParameters)
 
     printf("Presence application running \n\n");
 
+    uint32_t consecutive_fifo_errors = 0;
+    uint32_t last_report_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+
+    radar_pipeline_init(&pipeline);
+    radar_capture_init();
+    STAGE_PROBE_INIT();
+
     for (;;)
     {
-        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
-        
-        if (xensiv_bgt60trxx_get_fifo_data(&bgt60_obj.dev,
-                                            bgt60_buffer,
-                                            NUM_SAMPLES_PER_FRAME) == XENSIV_BGT60TRXX_STATUS_OK)
-                                            
+        /* Wait for the FIFO interrupt, at most one frame period plus margin */
+        if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(RADAR_WATCHDOG_TIMEOUT_MS)) == 0)
+        {
+            ++watchdog_stats.irq_timeouts;
+            recover_sensor(handle, "irq_timeout");
+            consecutive_fifo_errors = 0;
+            continue;
+        }
+
+        STAGE_PROBE_BEGIN(STAGE_PROBE_FIFO_READ);
+        int32_t fifo_status = xensiv_bgt60trxx_get_fifo_data(&bgt60_obj.dev,
+                                                             bgt60_buffer,
+                                                             NUM_SAMPLES_PER_WAKEUP);
+        STAGE_PROBE_END(STAGE_PROBE_FIFO_READ);
+
+        if (fifo_status != XENSIV_BGT60TRXX_STATUS_OK)
         {
-            /* Data preprocessing */
-            uint16_t *bgt60_buffer_ptr = &bgt60_buffer[0];
-            float32_t *frame_ptr = &frame[0];
-            for (int32_t sample = 0; sample < NUM_SAMPLES_PER_FRAME; ++sample)
+            ++watchdog_stats.fifo_errors;
+            if (++consecutive_fifo_errors >= RADAR_MAX_FIFO_ERRORS)
             {
-                *frame_ptr++ = ((float32_t)(*bgt60_buffer_ptr++) / 4096.0F);
+                recover_sensor(handle, "fifo_error");
+                consecutive_fifo_errors = 0;
             }
+        }
+        else
+        {
+            consecutive_fifo_errors = 0;
 
-            // calculate the average of the chirps first
-            arm_fill_f32(0, avg_chirp, NUM_SAMPLES_PER_CHIRP);
-
-            for (int chirp = 0; chirp < NUM_CHIRPS_PER_FRAME; chirp++)
+            /* The last frame in the FIFO was captured just before the
+             * interrupt, the earlier ones one frame period apart.
+             */
+            uint32_t now_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
+            for (uint32_t i = 0; i < FRAMES_PER_WAKEUP; ++i)
             {
-                arm_add_f32(avg_chirp, &frame[NUM_SAMPLES_PER_CHIRP * chirp], avg_chirp, NUM_SAMPLES_PER_CHIRP);
+                uint32_t age_ms = ((FRAMES_PER_WAKEUP - 1 - i) * RADAR_SETTINGS_FRAME_PERIOD_US) / 1000;
+                process_frame(handle, &bgt60_buffer[i * NUM_SAMPLES_PER_FRAME], now_ms - age_ms);
             }
 
-            arm_scale_f32(avg_chirp, 1.0f / NUM_CHIRPS_PER_FRAME, avg_chirp, NUM_SAMPLES_PER_CHIRP);
-                
-            if (xSemaphoreTake(sem_radar_presence, portMAX_DELAY) == pdTRUE)
+#if RADAR_LOW_POWER_MODE
+            /* The publisher task does its timed work on this wakeup. */
+            publisher_lanes_wake();
+#endif
+
+            /* At most one report per wakeup, they share the diagnostics buffer */
+            if (power_stats_poll(now_ms, diagnostics_report, sizeof(diagnostics_report)))
+            {
+                publish_diagnostics();
+            }
+            else if ((now_ms - last_report_ms) >= RADAR_DIAGNOSTICS_INTERVAL_MS)
+            {
+                last_report_ms = now_ms;
+                radar_frame_check_report(&pipeline.frame_check, diagnostics_report, sizeof(diagnostics_report));
+                publish_diagnostics();
+            }
+            else if (STAGE_PROBE_POLL(now_ms, diagnostics_report, sizeof(diagnostics_report)))
             {
-                if((xensiv_radar_presence_process_frame(handle, frame, xTaskGetTickCount() * portTICK_PERIOD_MS)) != XENSIV_RADAR_PRESENCE_OK)
-                {
-                    printf("Failed during frame processing\n");
-                }
-                
-                xSemaphoreGive(sem_radar_presence);
+                publish_diagnostics();
             }
+            else if (publisher_pool_poll(now_ms, diagnostics_report, sizeof(diagnostics_report)))
+            {
+                publish_diagnostics();
+            }
+            else if (publisher_lanes_poll(now_ms, diagnostics_report, sizeof(diagnostics_report)))
+            {
+                publish_diagnostics();
+            }
+#if PUBLISHER_INFLIGHT_WINDOW > 1
+            else if (publisher_window_poll(now_ms, diagnostics_report, sizeof(diagnostics_report)))
+            {
+                publish_diagnostics();
+            }
+#endif
+#if PUBLISHER_LIMIT_ENABLE
+            else if (publisher_limit_poll(now_ms, diagnostics_report, sizeof(diagnostics_report)))
+            {
+                publish_diagnostics();
+            }
+#endif
         }
     }
 }
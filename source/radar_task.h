@@ -35,6 +35,16 @@
 #define RADAR_TASK_STACK_SIZE (1024 * 4)
 #define RADAR_TASK_PRIORITY   (3)
 
+/* Set this macro to 1 to let the sensor fill its FIFO with
+ * 'RADAR_LOW_POWER_FRAMES_PER_WAKEUP' frames while the MCU sleeps. The radar
+ * task then wakes up only on the FIFO interrupt and processes all buffered
+ * frames at once. The MCU enters deep sleep between wakeups when the System
+ * Idle Power Mode of the BSP is set to System Deep Sleep in the Device
+ * Configurator, which enables tickless idle in FreeRTOSConfig.h.
+ */
+#define RADAR_LOW_POWER_MODE                (0)
+#define RADAR_LOW_POWER_FRAMES_PER_WAKEUP   (16)
+
 /*******************************************************************************
  * Global Variables
  ******************************************************************************/
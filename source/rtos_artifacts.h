@@ -45,11 +45,11 @@
  * Global Variables
  ******************************************************************************/
 /* FreeRTOS task handle for radar task which performs radar data acquisition,
- *  runs presence algorithm, and puts presence events in publisher queue */
+ *  runs presence algorithm, and puts presence events in publisher lanes */
 extern TaskHandle_t radar_task_handle;
 
 /* FreeRTOS task handle for publisher task which receives messages in
- * publisher queue and transmits them to mqtt broker */
+ * publisher lanes and transmits them to mqtt broker */
 extern TaskHandle_t publisher_task_handle;
 
 /* FreeRTOS task handle for subscriber task which subscribes to given topics
@@ -64,9 +64,6 @@ extern TaskHandle_t radar_config_task_handle;
 /* FreeRTOS queue handle for mqtt task queue used for mqtt related events */
 extern QueueHandle_t mqtt_task_q;
 
-/* FreeRTOS queue handle for publisher queue used to send/receive publish data */
-extern QueueHandle_t publisher_task_q;
-
 /* FreeRTOS queue handle for subscriber queue used to send/receive data to subscriber task */
 extern QueueHandle_t subscriber_task_q;
 
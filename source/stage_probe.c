@@ -0,0 +1,313 @@
+/******************************************************************************
+ * File Name:   stage_probe.c
+ *
+ * Description: This file keeps the cycle count statistics of the stages of
+ *              the radar frame processing in fixed memory and reports them on the
+ *              diagnostics topic.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#include "stage_probe.h"
+
+#if STAGE_PROBE_ENABLE
+
+/* Header file from system */
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Header file includes */
+#include "radar_settings.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define STAGE_PROBE_SUB_BUCKETS             (1u << STAGE_PROBE_SUB_BITS)
+
+/* The bucket counters are 16 bit, they must not overflow within one report
+ * interval for a stage that runs once per frame.
+ */
+_Static_assert(((uint64_t)STAGE_PROBE_REPORT_INTERVAL_MS * 1000u) / RADAR_SETTINGS_FRAME_PERIOD_US < UINT16_MAX,
+               "STAGE_PROBE_REPORT_INTERVAL_MS too long for 16-bit histogram buckets");
+
+/* The storage is per thread on the host, where the replay tools run the frame
+ * processing on several threads. In the application the radar task records
+ * and reports all stages.
+ */
+#if defined(PRESENCE_HOST_BUILD)
+#define STAGE_PROBE_STORAGE                 static __thread
+#else
+#define STAGE_PROBE_STORAGE                 static
+#endif
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef struct
+{
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+    uint16_t buckets[STAGE_PROBE_NUM_BUCKETS];
+} stage_probe_stats_t;
+
+/* Statistics of the last interval, kept until they are published */
+typedef struct
+{
+    uint32_t count;
+    uint32_t min;
+    uint32_t mean;
+    uint32_t p50;
+    uint32_t p90;
+    uint32_t p99;
+    uint32_t max;
+} stage_probe_summary_t;
+
+/*******************************************************************************
+ * Global Variables
+ ******************************************************************************/
+static const char *const stage_names[STAGE_PROBE_NUM_STAGES] =
+{
+    [STAGE_PROBE_FIFO_READ]     = "fifo_read",
+    [STAGE_PROBE_FRAME_CHECK]   = "frame_check",
+    [STAGE_PROBE_CONVERT]       = "convert",
+    [STAGE_PROBE_CHIRP_AVERAGE] = "chirp_average",
+    [STAGE_PROBE_PRESENCE]      = "presence",
+    [STAGE_PROBE_EVENT_CB]      = "event_cb",
+    [STAGE_PROBE_FRAME]         = "frame",
+};
+
+STAGE_PROBE_STORAGE stage_probe_stats_t stats[STAGE_PROBE_NUM_STAGES];
+STAGE_PROBE_STORAGE stage_probe_summary_t summaries[STAGE_PROBE_NUM_STAGES];
+STAGE_PROBE_STORAGE uint32_t interval_start_ms;
+STAGE_PROBE_STORAGE bool interval_started;
+STAGE_PROBE_STORAGE uint32_t next_summary = STAGE_PROBE_NUM_STAGES;
+
+/*******************************************************************************
+ * Function Name: bucket_index
+ *******************************************************************************
+ * Summary:
+ *   Maps a duration to its histogram bucket. Durations below
+ *   2^(STAGE_PROBE_SUB_BITS + 1) have a bucket each; above, every power of
+ *   two is split into STAGE_PROBE_SUB_BUCKETS buckets of equal width.
+ ******************************************************************************/
+static inline uint32_t bucket_index(uint32_t cycles)
+{
+    uint32_t log2;
+
+    if (cycles < (2u * STAGE_PROBE_SUB_BUCKETS))
+    {
+        return cycles;
+    }
+    if (cycles >= (1u << STAGE_PROBE_MAX_LOG2))
+    {
+        return STAGE_PROBE_NUM_BUCKETS - 1u;
+    }
+
+    log2 = 31u - (uint32_t)__builtin_clz(cycles);
+    return ((log2 - STAGE_PROBE_SUB_BITS + 1u) << STAGE_PROBE_SUB_BITS) +
+           ((cycles >> (log2 - STAGE_PROBE_SUB_BITS)) & (STAGE_PROBE_SUB_BUCKETS - 1u));
+}
+
+/*******************************************************************************
+ * Function Name: bucket_upper_bound
+ ******************************************************************************/
+static uint32_t bucket_upper_bound(uint32_t index)
+{
+    uint32_t shift;
+
+    if (index < (2u * STAGE_PROBE_SUB_BUCKETS))
+    {
+        return index;
+    }
+
+    shift = (index >> STAGE_PROBE_SUB_BITS) - 1u;
+    return (((STAGE_PROBE_SUB_BUCKETS + (index & (STAGE_PROBE_SUB_BUCKETS - 1u))) + 1u) << shift) - 1u;
+}
+
+/*******************************************************************************
+ * Function Name: percentile
+ *******************************************************************************
+ * Summary:
+ *   Returns the upper bound of the bucket that holds the given percentile,
+ *   limited to the measured minimum and maximum.
+ ******************************************************************************/
+static uint32_t percentile(const stage_probe_stats_t *s, uint32_t percent)
+{
+    uint32_t total = 0;
+    uint32_t rank;
+    uint32_t seen = 0;
+    uint32_t value = s->max;
+
+    for (uint32_t i = 0; i < STAGE_PROBE_NUM_BUCKETS; ++i)
+    {
+        total += s->buckets[i];
+    }
+    rank = ((total * percent) + 99u) / 100u;
+
+    for (uint32_t i = 0; i < STAGE_PROBE_NUM_BUCKETS; ++i)
+    {
+        seen += s->buckets[i];
+        if ((seen >= rank) && (seen > 0u))
+        {
+            /* The last bucket has no upper bound */
+            value = (i < (STAGE_PROBE_NUM_BUCKETS - 1u)) ? bucket_upper_bound(i) : s->max;
+            break;
+        }
+    }
+
+    if (value > s->max)
+    {
+        value = s->max;
+    }
+    if (value < s->min)
+    {
+        value = s->min;
+    }
+    return value;
+}
+
+/*******************************************************************************
+ * Function Name: stage_probe_init
+ *******************************************************************************
+ * Summary:
+ *   Enables the cycle counter and clears the statistics of all stages.
+ ******************************************************************************/
+void stage_probe_init(void)
+{
+    cycle_counter_init();
+    memset(stats, 0, sizeof(stats));
+    interval_started = false;
+    next_summary = STAGE_PROBE_NUM_STAGES;
+}
+
+/*******************************************************************************
+ * Function Name: stage_probe_record
+ *******************************************************************************
+ * Summary:
+ *   Adds one duration of a stage to its statistics.
+ *
+ * Parameters:
+ *   stage: measured stage
+ *   cycles: duration in CPU cycles
+ *
+ * Return:
+ *   none
+ ******************************************************************************/
+void stage_probe_record(stage_probe_stage_t stage, uint32_t cycles)
+{
+    stage_probe_stats_t *s = &stats[stage];
+    uint16_t *bucket = &s->buckets[bucket_index(cycles)];
+
+    if ((s->count == 0u) || (cycles < s->min))
+    {
+        s->min = cycles;
+    }
+    if (cycles > s->max)
+    {
+        s->max = cycles;
+    }
+    s->count++;
+    s->total += cycles;
+    if (*bucket < UINT16_MAX)
+    {
+        (*bucket)++;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: stage_probe_poll
+ *******************************************************************************
+ * Summary:
+ *   When the report interval has elapsed, summarizes the statistics of all
+ *   stages and starts a new interval. The summaries are then reported one
+ *   stage per call, since a report of all stages does not fit into one
+ *   message. Meant to be called from the radar task after a frame.
+ *
+ * Parameters:
+ *   now_ms: current time in milliseconds
+ *   report: buffer for the JSON report
+ *   report_size: size of the buffer
+ *
+ * Return:
+ *   True if a report was written
+ ******************************************************************************/
+bool stage_probe_poll(uint32_t now_ms, char *report, size_t report_size)
+{
+    if (!interval_started)
+    {
+        interval_start_ms = now_ms;
+        interval_started = true;
+        return false;
+    }
+
+    if ((next_summary >= STAGE_PROBE_NUM_STAGES) && ((now_ms - interval_start_ms) >= STAGE_PROBE_REPORT_INTERVAL_MS))
+    {
+        for (uint32_t i = 0; i < STAGE_PROBE_NUM_STAGES; ++i)
+        {
+            const stage_probe_stats_t *s = &stats[i];
+            stage_probe_summary_t *summary = &summaries[i];
+
+            summary->count = s->count;
+            if (s->count > 0u)
+            {
+                summary->min = s->min;
+                summary->mean = (uint32_t)(s->total / s->count);
+                summary->p50 = percentile(s, 50u);
+                summary->p90 = percentile(s, 90u);
+                summary->p99 = percentile(s, 99u);
+                summary->max = s->max;
+            }
+        }
+
+        memset(stats, 0, sizeof(stats));
+        interval_start_ms = now_ms;
+        next_summary = 0;
+    }
+
+    /* Stages that did not run in the interval are not reported */
+    while ((next_summary < STAGE_PROBE_NUM_STAGES) && (summaries[next_summary].count == 0u))
+    {
+        next_summary++;
+    }
+    if (next_summary >= STAGE_PROBE_NUM_STAGES)
+    {
+        return false;
+    }
+
+    const stage_probe_summary_t *summary = &summaries[next_summary];
+    snprintf(report, report_size,
+             "{\"stage_cycles\": {\"stage\": \"%s\", \"count\": %" PRIu32 ", \"min\": %" PRIu32 ", "
+             "\"mean\": %" PRIu32 ", \"p50\": %" PRIu32 ", \"p90\": %" PRIu32 ", \"p99\": %" PRIu32 ", "
+             "\"max\": %" PRIu32 ", \"budget\": %" PRIu32 "}}",
+             stage_names[next_summary], summary->count, summary->min, summary->mean,
+             summary->p50, summary->p90, summary->p99, summary->max,
+             (uint32_t)RADAR_SETTINGS_FRAME_BUDGET_CYCLES);
+    next_summary++;
+
+    return true;
+}
+
+#endif /* STAGE_PROBE_ENABLE */
+
+/* [] END OF FILE */
@@ -0,0 +1,102 @@
+/******************************************************************************
+ * File Name:   stage_probe.h
+ *
+ * Description: This file provides compile time enabled cycle count probes
+ *              for the stages of the radar frame processing.
+ *
+ * Related Document: See README.md
+ *
+ * ===========================================================================
+ * Copyright (C) 2022 Infineon Technologies AG. All rights reserved.
+ * ===========================================================================
+ *
+ * ===========================================================================
+ * Infineon Technologies AG (INFINEON) is supplying this file for use
+ * exclusively with Infineon's sensor products. This file can be freely
+ * distributed within development tools and software supporting such
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES, FOR ANY REASON
+ * WHATSOEVER.
+ * ===========================================================================
+ */
+
+#ifndef STAGE_PROBE_H_
+#define STAGE_PROBE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Set this macro to 1 to measure the stages of the frame processing. When it
+ * is 0, the probes compile to nothing and stage_probe.c is empty.
+ */
+#ifndef STAGE_PROBE_ENABLE
+#define STAGE_PROBE_ENABLE                  (0)
+#endif
+
+/* Interval of the stage statistics on the diagnostics topic */
+#define STAGE_PROBE_REPORT_INTERVAL_MS      (60000u)
+
+/* The histogram of a stage resolves 1/2^STAGE_PROBE_SUB_BITS of a power of
+ * two, i.e. a percentile is reported with an error of at most 12.5%.
+ * Durations of 2^STAGE_PROBE_MAX_LOG2 cycles or more share the last bucket.
+ */
+#define STAGE_PROBE_SUB_BITS                (3)
+#define STAGE_PROBE_MAX_LOG2                (25)
+#define STAGE_PROBE_NUM_BUCKETS             ((2 << STAGE_PROBE_SUB_BITS) + \
+                                             ((STAGE_PROBE_MAX_LOG2 - STAGE_PROBE_SUB_BITS - 1) << STAGE_PROBE_SUB_BITS))
+
+/*******************************************************************************
+ * Types
+ ******************************************************************************/
+typedef enum
+{
+    STAGE_PROBE_FIFO_READ,              /* Per wakeup, all frames in the FIFO */
+    STAGE_PROBE_FRAME_CHECK,
+    STAGE_PROBE_CONVERT,
+    STAGE_PROBE_CHIRP_AVERAGE,
+    STAGE_PROBE_PRESENCE,               /* Includes the event callback */
+    STAGE_PROBE_EVENT_CB,
+    STAGE_PROBE_FRAME,                  /* Whole processing of one frame */
+    STAGE_PROBE_NUM_STAGES
+} stage_probe_stage_t;
+
+/*******************************************************************************
+ * Probes
+ ******************************************************************************/
+#if STAGE_PROBE_ENABLE
+
+#include "cycle_counter.h"
+
+/* Marks the start and the end of a stage within one block */
+#define STAGE_PROBE_BEGIN(stage)            uint32_t stage_probe_start_##stage = cycle_counter_get()
+#define STAGE_PROBE_END(stage)              stage_probe_record((stage), cycle_counter_get() - stage_probe_start_##stage)
+
+#define STAGE_PROBE_INIT()                  stage_probe_init()
+#define STAGE_PROBE_POLL(now_ms, report, report_size) \
+                                            stage_probe_poll((now_ms), (report), (report_size))
+
+void stage_probe_init(void);
+void stage_probe_record(stage_probe_stage_t stage, uint32_t cycles);
+bool stage_probe_poll(uint32_t now_ms, char *report, size_t report_size);
+
+#else
+
+#define STAGE_PROBE_BEGIN(stage)
+#define STAGE_PROBE_END(stage)              ((void)0)
+#define STAGE_PROBE_INIT()                  ((void)0)
+#define STAGE_PROBE_POLL(now_ms, report, report_size) \
+                                            (false)
+
+#endif
+
+#endif
+/* [] END OF FILE */
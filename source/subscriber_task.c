@@ -53,6 +53,8 @@
 #include "mqtt_task.h"
 #include "radar_config_task.h"
 #include "subscriber_task.h"
+#include "mqtt_topics.h"
+#include "power_stats.h"
 
 /* Configuration file for MQTT client */
 #include "mqtt_client_config.h"
@@ -64,12 +66,6 @@
 /******************************************************************************
 * Macros
 ******************************************************************************/
-/* Maximum number of retries for MQTT subscribe operation */
-#define MAX_SUBSCRIBE_RETRIES                   (3u)
-
-/* Time interval in milliseconds between MQTT subscribe retries. */
-#define MQTT_SUBSCRIBE_RETRY_INTERVAL_MS        (1000)
-
 /* The number of MQTT topics to be subscribed to. */
 #define SUBSCRIPTION_COUNT                      (1)
 
@@ -88,7 +84,9 @@ TaskHandle_t subscriber_task_handle;
 QueueHandle_t subscriber_task_q;
 QueueHandle_t subscriber_msg_q;
 
-/* Configure the subscription information structure. */
+/* Configure the subscription information structure. The topic is replaced by
+ * that of the topic table when the task starts.
+ */
 cy_mqtt_subscribe_info_t subscribe_info =
 {
     .qos = (cy_mqtt_qos_t) MQTT_MESSAGES_QOS,
@@ -136,6 +134,9 @@ void subscriber_task(void *pvParameters)
 
     mqtt_connection = (cy_mqtt_t ) pvParameters;
 
+    /* The configuration topic of the device, formatted once at boot. */
+    subscribe_info.topic = mqtt_topics_subscribe(&subscribe_info.topic_len);
+
     /* Initialize semaphore to protect payload */
     sem_sub_payload = xSemaphoreCreateMutex();
     if (sem_sub_payload == NULL)
@@ -225,6 +226,7 @@ static void subscribe_to_topic(void)
         }
 
         vTaskDelay(pdMS_TO_TICKS(MQTT_SUBSCRIBE_RETRY_INTERVAL_MS));
+        power_stats_timed_wakeup();
     }
 
     if (result != CY_RSLT_SUCCESS)
@@ -276,7 +278,8 @@ void mqtt_subscription_callback(cy_mqtt_publish_info_t *received_msg_info)
         return;
     }
 
-    if (strncmp(received_msg_info->topic, MQTT_SUB_TOPIC, sizeof(MQTT_SUB_TOPIC)-1) == 0) {
+    if ((received_msg_info->topic_len == subscribe_info.topic_len) &&
+        (strncmp(received_msg_info->topic, subscribe_info.topic, subscribe_info.topic_len) == 0)) {
         if (xSemaphoreTake(sem_sub_payload, portMAX_DELAY) == pdTRUE)
         {
             memset(sub_msg_payload, '\0', sizeof(sub_msg_payload));
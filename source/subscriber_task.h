@@ -54,6 +54,12 @@
 #define MQTT_SUB_QUEUE_LENGTH              (1u)
 #define MQTT_SUB_MSG_MAX_SIZE              (512u)
 
+/* Maximum number of retries for MQTT subscribe operation */
+#define MAX_SUBSCRIBE_RETRIES              (3u)
+
+/* Time interval in milliseconds between MQTT subscribe retries. */
+#define MQTT_SUBSCRIBE_RETRY_INTERVAL_MS   (1000)
+
 /*******************************************************************************
 * Global Variables
 ********************************************************************************/